@@ -51,9 +51,16 @@ namespace leo
 
 	Application::~Application()
 	{
+		WaitSimulation();
+
+		// the layers destroy their GL objects on the main thread
+		m_renderMode = RenderMode::MainThread;
+		ApplyRenderMode();
+
 		s_Application = nullptr;
 
 		m_layerStack.Clean();
+		m_renderBackend.Release();
 
 		m_window.Destroy();
 		leo::WINTerminate();
@@ -65,6 +72,11 @@ namespace leo
 
 		while (m_isRunning)
 		{
+			Timer frameTimer;
+
+			// the simulation thread must be idle before anything else touches the game state
+			WaitSimulation();
+
 			m_window.PollEvents();
 			m_timer.Tick();
 
@@ -82,11 +94,33 @@ namespace leo
 				layer->OnUpdate(dt);
 			}
 
-			m_entityManager.Update(dt);
+			if (m_simulationMode == SimulationMode::Serial)
+			{
+				Simulate(dt);
+				m_stats.simulateMs = m_simulateMs;
 
-			m_window.SwapBuffers();
+				for (auto& layer : m_layerStack)
+				{
+					layer->OnSync();
+				}
+			}
+			else
+			{
+				// publish frame N, then simulate frame N + 1 while we render frame N
+				for (auto& layer : m_layerStack)
+				{
+					layer->OnSync();
+				}
+
+				KickSimulation(dt);
+			}
+
+			Render();
+
+			m_stats.frameMs = frameTimer.ElapsedMillis();
 		}
 
+		WaitSimulation();
 	}
 
 	void Application::Stop()
@@ -94,6 +128,133 @@ namespace leo
 		m_isRunning = false;
 	}
 
+	void Application::Simulate(f32 dt)
+	{
+		Timer timer;
+
+		for (auto& layer : m_layerStack)
+		{
+			layer->OnSimulate(dt);
+		}
+
+		m_entityManager.Update(dt);
+
+		m_simulateMs = timer.ElapsedMillis();
+	}
+
+	void Application::KickSimulation(f32 dt)
+	{
+		if (!m_simulationThread)
+		{
+			m_simulationThread = std::make_unique<ThreadPool>(1);
+		}
+
+		m_simulation = m_simulationThread->Submit([this, dt]() { Simulate(dt); });
+	}
+
+	void Application::WaitSimulation()
+	{
+		if (!m_simulation.valid())
+		{
+			m_stats.waitMs = 0.0f;
+			return;
+		}
+
+		Timer timer;
+		m_simulation.get();
+		m_stats.waitMs = timer.ElapsedMillis();
+		m_stats.simulateMs = m_simulateMs;
+	}
+
+	void Application::Render()
+	{
+		Timer timer;
+
+		ApplyRenderMode();
+
+		if (m_renderThread)
+		{
+			CommandList& commands = m_renderThread->Recording();
+			for (auto& layer : m_layerStack)
+			{
+				layer->OnRecord(commands);
+			}
+
+			// the render thread swaps the buffers once the frame is replayed
+			m_renderThread->Submit();
+			m_stats.replayMs = m_renderThread->LastReplayMs();
+		}
+		else
+		{
+			for (auto& layer : m_layerStack)
+			{
+				layer->OnRender();
+			}
+
+			m_commands.Reset();
+			for (auto& layer : m_layerStack)
+			{
+				layer->OnRecord(m_commands);
+			}
+			m_commands.Replay(m_renderBackend);
+
+			m_window.SwapBuffers();
+			m_stats.replayMs = 0.0f;
+		}
+
+		m_stats.renderMs = timer.ElapsedMillis();
+	}
+
+	void Application::ApplyRenderMode()
+	{
+		bool threaded = m_renderMode == RenderMode::RenderThread;
+		if (threaded == (m_renderThread != nullptr)) return;
+
+		if (threaded)
+		{
+			// hand the context over to the render thread
+			m_window.DetachContext();
+
+			RenderThread::Hooks hooks;
+			hooks.onStart = [this]() { m_window.MakeContextCurrent(); };
+			hooks.onFrameEnd = [this]() { m_window.SwapBuffers(); };
+			hooks.onStop = [this]() { m_window.DetachContext(); };
+
+			m_renderThread = std::make_unique<RenderThread>(m_renderBackend, std::move(hooks));
+		}
+		else
+		{
+			// replays the last submitted frame and releases the context
+			m_renderThread.reset();
+			m_window.MakeContextCurrent();
+		}
+	}
+
+	void Application::SetSimulationMode(SimulationMode mode)
+	{
+		m_simulationMode = mode;
+	}
+
+	SimulationMode Application::GetSimulationMode() const
+	{
+		return m_simulationMode;
+	}
+
+	void Application::SetRenderMode(RenderMode mode)
+	{
+		m_renderMode = mode;
+	}
+
+	RenderMode Application::GetRenderMode() const
+	{
+		return m_renderMode;
+	}
+
+	const FrameStats& Application::GetFrameStats() const
+	{
+		return m_stats;
+	}
+
 	void Application::RaiseEvent(Event& event)
 	{
 		for (auto& layer : m_layerStack)
@@ -113,6 +274,11 @@ namespace leo
 		return m_layerStack;
 	}
 
+	EntityManager& Application::GetEntityManager()
+	{
+		return m_entityManager;
+	}
+
 	Application& Application::Get()
 	{
 		return *s_Application;
@@ -1,13 +1,41 @@
 #pragma once
+#include <memory>
+#include <future>
 #include <LEO/Platform/LeoWindow.h>
 #include <LEO/Utilities/LeoTimer.h>
+#include <LEO/Utilities/LeoThreadPool.h>
 #include <LEO/ECS/EntityManager.h>
 #include <LEO/ECS/ComponentArray.h>
 #include <LEO/ECS/ComponentStoreSparse.h>
+#include <LEO/Graphics/CommandList.h>
+#include <LEO/Graphics/RenderBackend.h>
+#include <LEO/Graphics/RenderThread.h>
 #include "LayerStack.h"
+#include "FrameState.h"
 
 namespace leo
 {
+	enum class SimulationMode
+	{
+		Serial,    // OnUpdate -> OnSimulate -> OnSync -> OnRender, all on the main thread (deterministic)
+		Pipelined  // simulation of frame N + 1 runs on a worker thread while the main thread renders frame N
+	};
+
+	enum class RenderMode
+	{
+		MainThread,  // OnRender, then the recorded commands are replayed on the main thread
+		RenderThread // the commands are replayed one frame behind by a thread owning the GL context, OnRender is not called
+	};
+
+	struct FrameStats
+	{
+		f32 frameMs    = 0.0f; // whole loop iteration
+		f32 simulateMs = 0.0f; // OnSimulate of every layer + EntityManager::Update
+		f32 renderMs   = 0.0f; // OnRender of every layer + SwapBuffers
+		f32 waitMs     = 0.0f; // time the main thread blocked on the simulation thread
+		f32 replayMs   = 0.0f; // render thread replay of the previous frame + SwapBuffers (RenderMode::RenderThread)
+	};
+
 	class Application
 	{
 	public:
@@ -18,15 +46,42 @@ namespace leo
 		void Stop();
 	public:
 		void RaiseEvent(Event& event);
+	public:
+		// Can be changed at any time, it takes effect at the next frame
+		void SetSimulationMode(SimulationMode mode);
+		SimulationMode GetSimulationMode() const;
+		// Can be changed at any time, it takes effect at the next frame.
+		// GL objects must not be created or destroyed on the main thread in RenderMode::RenderThread
+		void SetRenderMode(RenderMode mode);
+		RenderMode GetRenderMode() const;
+		const FrameStats& GetFrameStats() const;
 	public:
 		Window& GetWindow();
 		LayerStack& GetLayerStack();
+		EntityManager& GetEntityManager();
 	public:
 		static Application& Get();
+	private:
+		void Simulate(f32 dt);
+		void KickSimulation(f32 dt);
+		void WaitSimulation();
+		void Render();
+		void ApplyRenderMode();
 	private:
 		Window m_window;
 		LayerStack m_layerStack;
 		EntityManager m_entityManager;
+
+		SimulationMode m_simulationMode = SimulationMode::Serial;
+		std::unique_ptr<ThreadPool> m_simulationThread; // created the first time we run Pipelined
+		std::future<void> m_simulation;                 // the in-flight simulation, if any
+		FrameStats m_stats;
+		f32 m_simulateMs = 0.0f; // written by Simulate(), copied into m_stats once the simulation is joined
+
+		RenderMode m_renderMode = RenderMode::MainThread;
+		GLRenderBackend m_renderBackend;
+		CommandList m_commands;                     // RenderMode::MainThread
+		std::unique_ptr<RenderThread> m_renderThread; // RenderMode::RenderThread
 	public:
 		FrameTimer m_timer;
 		bool m_isRunning = false;
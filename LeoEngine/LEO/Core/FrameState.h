@@ -0,0 +1,43 @@
+#pragma once
+#include <utility>
+#include <LEO/Utilities/LeoTypes.h>
+
+namespace leo
+{
+	/// <summary>
+	/// Double-buffered extract of the data a frame needs to be rendered.
+	/// The simulation writes Back(), rendering reads Front().
+	/// Publish() swaps the two, it must be called from Layer::OnSync() where no simulation is running.
+	/// </summary>
+	/// <typeparam name="T">A Default-contratable type that holds the render-relevant data</typeparam>
+	template<typename T>
+	class FrameState
+	{
+	public:
+		FrameState() = default;
+
+		FrameState(const FrameState&) = delete;
+		FrameState& operator=(const FrameState&) = delete;
+	public:
+		// The state being built by the simulation (frame N + 1)
+		T& Back() { return m_states[m_front ^ 1u]; }
+
+		// The last published state, immutable while rendering (frame N)
+		const T& Front() const { return m_states[m_front]; }
+
+		// Makes the back state the new front, returns the new back state (the old front) for reuse
+		T& Publish()
+		{
+			m_front ^= 1u;
+			m_publishCount++;
+			return Back();
+		}
+
+		// Number of times Publish() was called, 0 means Front() is still the default state
+		u64 PublishCount() const { return m_publishCount; }
+	private:
+		T m_states[2] = {};
+		u32 m_front = 0;
+		u64 m_publishCount = 0;
+	};
+}
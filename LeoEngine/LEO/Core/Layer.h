@@ -1,5 +1,6 @@
 #pragma once
 #include <LEO/Utilities/LeoTypes.h>
+#include <LEO/Graphics/CommandList.h>
 #include "Event.h"
 
 namespace leo
@@ -12,6 +13,18 @@ namespace leo
 	public:
 		virtual void OnEvent(Event& event) {}
 		virtual void OnUpdate(leo::f32 dt) {}
+	public:
+		// Game simulation, in SimulationMode::Pipelined it runs on the simulation thread
+		// so it must not make GL calls, it should write the data needed for rendering into a FrameState Back()
+		virtual void OnSimulate(leo::f32 dt) {}
+		// Called on the main thread while no simulation is running, publish the FrameState(s) here
+		virtual void OnSync() {}
+		// Called on the main thread, render from the FrameState Front() only
+		// not called in RenderMode::RenderThread, the GL context belongs to the render thread
+		virtual void OnRender() {}
+		// Called on the main thread after OnRender, record the frame from the FrameState Front() only.
+		// The commands are replayed right away in RenderMode::MainThread, or one frame later by the render thread
+		virtual void OnRecord(CommandList& commands) {}
 	public:
 		virtual ~Layer() = default;
 	};
@@ -1,4 +1,5 @@
 #include <glad/glad.h>
+#include "GLStateCache.h"
 #include "BufferObjects.h"
 
 
@@ -22,7 +23,7 @@ namespace leo
 		return GL_STATIC_DRAW;
 	}
 
-	VertexAttributeDesc leo::GetAttributeDesc(ElementType t)
+	VertexAttributeDesc GetAttributeDesc(ElementType t)
 	{
 		switch (t)
 		{
@@ -38,6 +39,11 @@ namespace leo
 		case ElementType::UCHAR3_N:return { GL_UNSIGNED_BYTE, 3, true, 3 * sizeof(unsigned char) };
 		case ElementType::UCHAR4:  return { GL_UNSIGNED_BYTE, 4, false, 4 * sizeof(unsigned char) };
 		case ElementType::UCHAR4_N:return { GL_UNSIGNED_BYTE, 4, true, 4 * sizeof(unsigned char) };
+		case ElementType::HALF2:   return { GL_HALF_FLOAT, 2, false, 2 * sizeof(u16) };
+		case ElementType::HALF4:   return { GL_HALF_FLOAT, 4, false, 4 * sizeof(u16) };
+		case ElementType::USHORT2_N:return { GL_UNSIGNED_SHORT, 2, true, 2 * sizeof(u16) };
+		case ElementType::SHORT2_N:return { GL_SHORT, 2, true, 2 * sizeof(i16) };
+		case ElementType::INT_2_10_10_10_N: return { GL_INT_2_10_10_10_REV, 4, true, sizeof(u32) };
 		case ElementType::MAT4:    return { GL_FLOAT, 4, false, sizeof(glm::vec4) * 4 };
 		default: LEOASSERT(false, "Unknown ElementType"); return { 0,0,false,0 };
 		}
@@ -46,91 +52,206 @@ namespace leo
 	// ---------------- VertexBuffer ----------------
 
 	VertexBuffer::VertexBuffer(const void* data, u32 size, BufferUsage usage)
+		:
+		m_size(size),
+		m_usage(usage)
 	{
 		glGenBuffers(1, &m_id);
-		glBindBuffer(GL_ARRAY_BUFFER, m_id);
+		GetGLStateCache().BindBuffer(GL_ARRAY_BUFFER, m_id);
 		glBufferData(GL_ARRAY_BUFFER, size, data, BufferUsageToOpenGLFlag(usage));
-
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
 	VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept
 		:
-		m_id(other.m_id)
+		m_id(other.m_id),
+		m_size(other.m_size),
+		m_usage(other.m_usage)
 	{
 		other.m_id = 0;
+		other.m_size = 0;
 	}
 
 	VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept
 	{
-		glDeleteBuffers(1, &m_id);
+		GetGLStateCache().DeleteBuffer(m_id);
 
 		m_id = other.m_id;
+		m_size = other.m_size;
+		m_usage = other.m_usage;
+
 		other.m_id = 0;
+		other.m_size = 0;
 		return *this;
 	}
 
 	VertexBuffer::~VertexBuffer()
 	{
-		glDeleteBuffers(1, &m_id);
+		GetGLStateCache().DeleteBuffer(m_id);
 	}
 
 	void VertexBuffer::Bind() const
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, m_id);
+		GetGLStateCache().BindBuffer(GL_ARRAY_BUFFER, m_id);
 	}
 
 	void VertexBuffer::UnBind() const
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		GetGLStateCache().BindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	void VertexBuffer::SetData(const void* data, u32 size)
+	{
+		GetGLStateCache().BindBuffer(GL_ARRAY_BUFFER, m_id);
+
+		if (size > m_size)
+		{
+			glBufferData(GL_ARRAY_BUFFER, size, data, BufferUsageToOpenGLFlag(m_usage));
+			m_size = size;
+		}
+		else if (size > 0)
+		{
+			glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
+		}
+	}
+
+	void VertexBuffer::SetSubData(u32 offset, const void* data, u32 size)
+	{
+		LEOASSERTF(offset + size <= m_size, "SetSubData out of range: {} + {} bytes in a buffer of {}", offset, size, m_size);
+		if (size == 0) return;
+
+		GetGLStateCache().BindBuffer(GL_ARRAY_BUFFER, m_id);
+		glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+	}
+
+	void VertexBuffer::Orphan()
+	{
+		if (m_size == 0) return;
+
+		GetGLStateCache().BindBuffer(GL_ARRAY_BUFFER, m_id);
+		glBufferData(GL_ARRAY_BUFFER, m_size, nullptr, BufferUsageToOpenGLFlag(m_usage));
+	}
+
+	void VertexBuffer::CopyFrom(const VertexBuffer& src, u32 size)
+	{
+		LEOASSERTF(size <= src.m_size && size <= m_size, "CopyFrom of {} bytes, from a buffer of {} to a buffer of {}", size, src.m_size, m_size);
+		if (size == 0) return;
+
+		// the copy targets are not tracked by the state cache and don't disturb the array buffer binding
+		GetGLStateCache().BindBuffer(GL_COPY_READ_BUFFER, src.m_id);
+		GetGLStateCache().BindBuffer(GL_COPY_WRITE_BUFFER, m_id);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size);
 	}
 
 	// ---------------- IndexBuffer ----------------
 
 	IndexBuffer::IndexBuffer(const u32* data, u32 count, BufferUsage usage)
 		:
-		m_count(count)
+		m_usage(usage)
 	{
-		glGenBuffers(1, &m_id);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(u32), (const void*)data, BufferUsageToOpenGLFlag(usage));
+		Create(data, count, sizeof(u32));
+	}
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	IndexBuffer::IndexBuffer(const u16* data, u32 count, BufferUsage usage)
+		:
+		m_usage(usage)
+	{
+		Create(data, count, sizeof(u16));
+	}
+
+	IndexBuffer IndexBuffer::CreateCompact(std::span<const u32> indices, u32 vertex_count, BufferUsage usage)
+	{
+		if (vertex_count > 65536) {
+			return IndexBuffer(indices.data(), (u32)indices.size(), usage);
+		}
+
+		std::vector<u16> short_indices(indices.size());
+		for (u64 i = 0; i < indices.size(); i++)
+		{
+			LEOASSERTF(indices[i] < vertex_count, "Index {} out of range, the mesh has {} vertices", indices[i], vertex_count);
+			short_indices[i] = (u16)indices[i];
+		}
+		return IndexBuffer(short_indices.data(), (u32)short_indices.size(), usage);
+	}
+
+	void IndexBuffer::Create(const void* data, u32 count, u32 index_size)
+	{
+		m_count = count;
+		m_capacity = count;
+		m_indexSize = index_size;
+
+		// the element buffer binding is VAO state, don't attach the new buffer to whatever VAO is bound
+		GLStateCache& cache = GetGLStateCache();
+		cache.BindVertexArray(0);
+
+		glGenBuffers(1, &m_id);
+		cache.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * index_size, data, BufferUsageToOpenGLFlag(m_usage));
 	}
 
 	IndexBuffer::IndexBuffer(IndexBuffer&& other) noexcept
 		:
 		m_count(other.m_count),
+		m_capacity(other.m_capacity),
+		m_indexSize(other.m_indexSize),
+		m_usage(other.m_usage),
 		m_id(other.m_id)
 	{
 		other.m_id = 0;
+		other.m_capacity = 0;
 	}
 
 	IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other) noexcept
 	{
-		glDeleteBuffers(1, &m_id);
+		GetGLStateCache().DeleteBuffer(m_id);
 
 		m_id = other.m_id;
 		m_count = other.m_count;
+		m_capacity = other.m_capacity;
+		m_indexSize = other.m_indexSize;
+		m_usage = other.m_usage;
 
 		other.m_id = 0;
+		other.m_capacity = 0;
 
 		return *this;
 	}
 
 	IndexBuffer::~IndexBuffer()
 	{
-		glDeleteBuffers(1, &m_id);
+		GetGLStateCache().DeleteBuffer(m_id);
 	}
 
 	void IndexBuffer::Bind() const
 	{
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
+		GetGLStateCache().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
 	}
 
 	void IndexBuffer::UnBind() const
 	{
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		GetGLStateCache().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+
+	u32 IndexBuffer::GetIndexType() const
+	{
+		return m_indexSize == sizeof(u16) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	}
+
+	void IndexBuffer::SetData(const u32* data, u32 count)
+	{
+		LEOASSERT(m_indexSize == sizeof(u32), "SetData on a 16 bit index buffer");
+		GetGLStateCache().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
+
+		if (count > m_capacity)
+		{
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(u32), (const void*)data, BufferUsageToOpenGLFlag(m_usage));
+			m_capacity = count;
+		}
+		else if (count > 0)
+		{
+			glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, count * sizeof(u32), (const void*)data);
+		}
+
+		m_count = count;
 	}
 
 	// ---------------- VertexArray ----------------
@@ -146,33 +267,59 @@ namespace leo
 	{
 		other.m_id = 0;
 		m_buffers = std::move(other.m_buffers);
+		m_indexBuffer = std::move(other.m_indexBuffer);
 	}
 
 	VertexArray& VertexArray::operator=(VertexArray&& other) noexcept
 	{
-		glDeleteVertexArrays(1, &m_id);
+		GetGLStateCache().DeleteVertexArray(m_id);
 
 		m_id = other.m_id;
 		other.m_id = 0;
 
 		m_buffers = std::move(other.m_buffers);
+		m_indexBuffer = std::move(other.m_indexBuffer);
 
 		return *this;
 	}
 
 	VertexArray::~VertexArray()
 	{
-		glDeleteVertexArrays(1, &m_id);
+		GetGLStateCache().DeleteVertexArray(m_id);
 	}
 
 	void VertexArray::Bind() const
 	{
-		glBindVertexArray(m_id);
+		GetGLStateCache().BindVertexArray(m_id);
 	}
 
 	void VertexArray::UnBind() const
 	{
-		glBindVertexArray(0);
+		GetGLStateCache().BindVertexArray(0);
+	}
+
+	void VertexArray::AddBuffer(VertexBuffer&& vb, std::span<const ElementType> layout, u32 start, bool per_instance)
+	{
+		u32 stride = 0;
+		for (ElementType element : layout) {
+			stride += GetAttributeDesc(element).size_bytes;
+		}
+
+		Bind();
+		vb.Bind();
+		u32 offset = 0;
+		for (u32 i = 0; i < (u32)layout.size(); i++)
+		{
+			AddAttrib(start + i, layout[i], stride, offset, per_instance);
+		}
+		UnBind();
+		vb.UnBind();
+		m_buffers.emplace_back(std::move(vb));
+	}
+
+	void VertexArray::BindArrayBuffer(u32 buffer_id) const
+	{
+		GetGLStateCache().BindBuffer(GL_ARRAY_BUFFER, buffer_id);
 	}
 
 	void VertexArray::AddAttrib(u32 i, ElementType element_type, u32 stride, u32& offset, bool per_instance)
@@ -1,5 +1,6 @@
 #pragma once
 #include <vector>
+#include <span>
 #include <glm/glm.hpp>
 #include <LEO/Utilities/LeoTypes.h>
 #include <LEO/Log/Log.h>
@@ -13,7 +14,8 @@ namespace leo
 		Stream
 	};
 
-	enum class ElementType
+	// The values are stored in .leomesh files (MeshFile.h): new types go at the end
+	enum class ElementType : u32
 	{
 		FLOAT1, FLOAT1_N,
 		FLOAT2, FLOAT2_N,
@@ -21,6 +23,10 @@ namespace leo
 		FLOAT4, FLOAT4_N,
 		UCHAR3, UCHAR3_N,
 		UCHAR4, UCHAR4_N,
+		HALF2, HALF4,          // 16 bit floats, uvs and positions (the shader reads vec3 from HALF4, w = 1)
+		USHORT2_N,             // uvs in [0, 1]
+		SHORT2_N,              // octahedral unit vectors (VertexPacking.h)
+		INT_2_10_10_10_N,      // normals and tangents, xyz in [-1, 1]
 		MAT4
 	};
 
@@ -50,8 +56,26 @@ namespace leo
 	public:
 		void Bind() const;
 		void UnBind() const;
+
+		// Replaces the content, the storage is reallocated only when it grows
+		void SetData(const void* data, u32 size);
+
+		// Overwrites [offset, offset + size) of the allocated storage, never reallocates
+		void SetSubData(u32 offset, const void* data, u32 size);
+
+		// Gives the storage back to the driver for a new one of the same size (orphaning), writes that
+		// follow don't wait for the draws still reading the old content. The buffer id does not change
+		void Orphan();
+
+		// Copies the first size bytes of src to the start of this buffer, on the GPU
+		void CopyFrom(const VertexBuffer& src, u32 size);
+
+		inline u32 ID() const { return m_id; }
+		inline u32 GetSize() const { return m_size; }
 	private:
-		u32 m_id = 0;
+		u32 m_id   = 0;
+		u32 m_size = 0; // allocated bytes
+		BufferUsage m_usage = BufferUsage::Static;
 	};
 
 	class IndexBuffer
@@ -59,6 +83,10 @@ namespace leo
 	public:
 		IndexBuffer() = default;
 		IndexBuffer(const u32* data, u32 count, BufferUsage usage = BufferUsage::Static);
+		IndexBuffer(const u16* data, u32 count, BufferUsage usage = BufferUsage::Static);
+
+		// 16 bit indices when every index fits (vertex_count <= 65536), 32 bit otherwise
+		static IndexBuffer CreateCompact(std::span<const u32> indices, u32 vertex_count, BufferUsage usage = BufferUsage::Static);
 
 		IndexBuffer(const IndexBuffer& other) = delete;
 		IndexBuffer& operator=(const IndexBuffer& other) = delete;
@@ -71,10 +99,23 @@ namespace leo
 		void Bind() const;
 		void UnBind() const;
 
+		// Replaces the content, the storage is reallocated only when it grows. Only for 32 bit buffers.
+		// Leaves the buffer bound: the element buffer binding belongs to the bound VertexArray
+		void SetData(const u32* data, u32 count);
+
 		inline u32 GetCount() const { return m_count; }
+		inline u32 GetIndexSize() const { return m_indexSize; }
+
+		// GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, the type to draw with
+		u32 GetIndexType() const;
 	private:
-		u32 m_id    = 0;
-		u32 m_count = 0;
+		void Create(const void* data, u32 count, u32 index_size);
+	private:
+		u32 m_id        = 0;
+		u32 m_count     = 0;
+		u32 m_capacity  = 0; // allocated indices
+		u32 m_indexSize = 4; // bytes
+		BufferUsage m_usage = BufferUsage::Static;
 	};
 
 	/*
@@ -138,6 +179,23 @@ namespace leo
 			m_buffers.emplace_back(std::move(vb));
 		}
 
+		// Reads the attributes from a buffer owned elsewhere (a StreamBuffer), it must outlive the vertex array
+		template<u32 ELEMENTS_COUNT>
+		void AttachBuffer(u32 buffer_id, const Layout<ELEMENTS_COUNT>& layout, u32 start = 0, bool per_instance = false)
+		{
+			Bind();
+			BindArrayBuffer(buffer_id);
+			u32 offset = 0;
+			for (u32 i = start; i < start + ELEMENTS_COUNT; i++)
+			{
+				AddAttrib(i, layout[i - start], layout.GetStride(), offset, per_instance);
+			}
+			UnBind();
+		}
+
+		// Same as above for a layout known at runtime (a mesh file)
+		void AddBuffer(VertexBuffer&& vb, std::span<const ElementType> layout, u32 start = 0, bool per_instance = false);
+
 		void SetIndexBuffer(IndexBuffer&& ib)
 		{
 			Bind();
@@ -145,8 +203,13 @@ namespace leo
 			m_indexBuffer = std::move(ib);
 			UnBind();
 		}
+
+		// The buffers in the order they were added
+		inline VertexBuffer& GetBuffer(u32 i) { return m_buffers[i]; }
+		inline IndexBuffer& GetIndexBuffer() { return m_indexBuffer; }
 	private:
 		void AddAttrib(u32 i, ElementType element_type, u32 stride, u32& offset, bool per_instance);
+		void BindArrayBuffer(u32 buffer_id) const;
 
 		u32 m_id;
 		std::vector<VertexBuffer> m_buffers;
@@ -0,0 +1,72 @@
+#include <cstring>
+#include <glad/glad.h>
+#include <LEO/Log/LeoAssert.h>
+#include "GLStateCache.h"
+#include "CircleRenderer.h"
+
+namespace leo
+{
+	CircleRenderer::CircleRenderer()
+		:
+		m_shader(RESOURCES_PATH"Shaders/CircleShader/instanced"),
+		m_instances(REGION_INSTANCES * sizeof(CircleInstance))
+	{
+		float corners[] = {
+			-1.0f, -1.0f,
+			 1.0f, -1.0f,
+			 1.0f,  1.0f,
+			-1.0f,  1.0f
+		};
+
+		ElementType quad_arr[1] = { ElementType::FLOAT2 };
+		Layout<1> quad_layout(quad_arr);
+		m_vertexArray.AddBuffer(VertexBuffer(corners, sizeof(corners)), quad_layout);
+
+		ElementType instance_arr[3] = { INSTANCE_LAYOUT[0], INSTANCE_LAYOUT[1], INSTANCE_LAYOUT[2] };
+		Layout<3> instance_layout(instance_arr);
+		LEOASSERT(instance_layout.GetStride() == sizeof(CircleInstance), "CircleInstance does not match its layout");
+		m_vertexArray.AttachBuffer(m_instances.ID(), instance_layout, 1, true);
+
+		u32 indices[] = { 0, 1, 2, 0, 2, 3 };
+		m_vertexArray.SetIndexBuffer(IndexBuffer(indices, 6));
+
+		m_viewProjHandle = m_shader.GetUniformHandle("u_ViewProj");
+	}
+
+	void CircleRenderer::Begin(const glm::mat4& view_proj)
+	{
+		Clear();
+		m_viewProj = view_proj;
+	}
+
+	void CircleRenderer::End()
+	{
+		std::span<const CircleInstance> instances = Instances();
+		if (instances.empty()) return;
+
+		GetGLStateCache().SetEnabled(GL_BLEND, true);
+		GetGLStateCache().BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+		m_shader.Bind();
+		m_shader.SetUniform(m_viewProjHandle, m_viewProj);
+
+		m_vertexArray.Bind();
+
+		// the attributes point at the start of the buffer, each chunk is selected with its base instance
+		for (u32 first = 0; first < (u32)instances.size(); first += REGION_INSTANCES)
+		{
+			u32 count = glm::min((u32)instances.size() - first, REGION_INSTANCES);
+
+			StreamAllocation chunk = m_instances.Allocate(count * sizeof(CircleInstance), sizeof(CircleInstance));
+			if (!chunk) break;
+
+			memcpy(chunk.ptr, instances.data() + first, chunk.size);
+			glDrawElementsInstancedBaseInstance(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr, (GLsizei)count, chunk.offset / sizeof(CircleInstance));
+		}
+
+		m_instances.EndFrame();
+		m_vertexArray.UnBind();
+
+		m_shader.UnBind();
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <glm/glm.hpp>
+#include <LEO/Utilities/LeoTypes.h>
+#include <LEO/Utilities/LeoColors.h>
+#include "BufferObjects.h"
+#include "StreamBuffer.h"
+#include "Shader.h"
+
+namespace leo
+{
+	// Per-instance record of the instanced circle shader, matches CircleBatch::INSTANCE_LAYOUT
+	struct CircleInstance
+	{
+		glm::vec2 center;
+		f32       radius;
+		Color     color;  // UCHAR4_N
+	};
+	static_assert(sizeof(CircleInstance) == 16, "CircleInstance must stay tightly packed");
+
+	/// <summary>
+	/// The CPU side of CircleRenderer: packs the circles of a frame into CircleInstance records.
+	/// It does not touch OpenGL, so the packed stream can be checked without a context.
+	/// </summary>
+	class CircleBatch
+	{
+	public:
+		// center, radius, color
+		static constexpr ElementType INSTANCE_LAYOUT[3] = { ElementType::FLOAT2, ElementType::FLOAT1, ElementType::UCHAR4_N };
+	public:
+		CircleBatch() = default;
+	public:
+		void Clear() { m_instances.clear(); }
+		void Reserve(u32 count) { m_instances.reserve(count); }
+
+		void Circle(const glm::vec2& center, f32 radius, Color color) { m_instances.push_back(CircleInstance{ center, radius, color }); }
+
+		std::span<const CircleInstance> Instances() const { return m_instances; }
+		inline u32 Count() const { return (u32)m_instances.size(); }
+	private:
+		std::vector<CircleInstance> m_instances;
+	};
+
+	/// <summary>
+	/// Draws every circle of the frame with one instanced draw call per REGION_INSTANCES circles.
+	/// Each instance is a quad around the circle, the fragment shader uses the distance to the edge for antialiasing.
+	/// The instances are written straight into a persistently mapped StreamBuffer.
+	/// </summary>
+	class CircleRenderer : public CircleBatch
+	{
+	public:
+		static constexpr u32 REGION_INSTANCES = 65536; // instances per stream buffer region (1 MB), a frame should fit in one
+	public:
+		CircleRenderer(); // needs an OpenGL context
+
+		CircleRenderer(const CircleRenderer&) = delete;
+		CircleRenderer& operator=(const CircleRenderer&) = delete;
+	public:
+		void Begin(const glm::mat4& view_proj);
+		void End(); // draws with alpha blending
+	private:
+		ShaderProgram m_shader;
+		UniformHandle m_viewProjHandle;
+		StreamBuffer m_instances;
+		VertexArray m_vertexArray; // buffer 0: unit quad, attached: m_instances
+		glm::mat4 m_viewProj = glm::mat4(1.0f);
+	};
+}
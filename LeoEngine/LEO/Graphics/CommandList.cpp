@@ -0,0 +1,202 @@
+#include <LEO/Log/LeoAssert.h>
+#include "CommandList.h"
+
+namespace leo
+{
+	// ---------------- FrameArena ----------------
+
+	void* FrameArena::Allocate(u64 size, u64 alignment)
+	{
+		LEOASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0, "The alignment must be a power of two");
+
+		while (m_block < m_blocks.size())
+		{
+			Block& block = m_blocks[m_block];
+
+			u64 base = (u64)block.data.get();
+			u64 offset = ((base + m_offset + alignment - 1) & ~(alignment - 1)) - base;
+
+			if (offset + size <= block.size)
+			{
+				m_offset = offset + size;
+				m_used += size;
+				return block.data.get() + offset;
+			}
+
+			// the rest of this block is wasted until the next Reset
+			m_block++;
+			m_offset = 0;
+		}
+
+		// new blocks are always added at the end, big allocations get a block of their own size
+		u64 block_size = glm::max(BLOCK_SIZE, size + alignment);
+		m_blocks.push_back(Block{ std::make_unique<u8[]>(block_size), block_size });
+		m_block = (u32)m_blocks.size() - 1;
+		m_offset = 0;
+
+		return Allocate(size, alignment);
+	}
+
+	void FrameArena::Reset()
+	{
+		m_block = 0;
+		m_offset = 0;
+		m_used = 0;
+	}
+
+	u64 FrameArena::Capacity() const
+	{
+		u64 capacity = 0;
+		for (const Block& block : m_blocks) {
+			capacity += block.size;
+		}
+		return capacity;
+	}
+
+	// ---------------- CommandList ----------------
+
+	const char* CommandTypeName(CommandType type)
+	{
+		switch (type)
+		{
+		case CommandType::Clear:               return "Clear";
+		case CommandType::SetRenderState:      return "SetRenderState";
+		case CommandType::UpdateVertexBuffer:  return "UpdateVertexBuffer";
+		case CommandType::UpdateIndexBuffer:   return "UpdateIndexBuffer";
+		case CommandType::BindShader:          return "BindShader";
+		case CommandType::SetUniforms:         return "SetUniforms";
+		case CommandType::UpdateUniformBuffer: return "UpdateUniformBuffer";
+		case CommandType::BindUniformBuffer:   return "BindUniformBuffer";
+		case CommandType::PushUniforms:        return "PushUniforms";
+		case CommandType::BindTexture:         return "BindTexture";
+		case CommandType::BindVertexArray:     return "BindVertexArray";
+		case CommandType::BindMesh:            return "BindMesh";
+		case CommandType::DrawMesh:            return "DrawMesh";
+		case CommandType::DrawIndexed:         return "DrawIndexed";
+		case CommandType::Callback:            return "Callback";
+		default:                               return "Unknown";
+		}
+	}
+
+	void CommandList::Reset()
+	{
+		m_arena.Reset();
+		m_first = nullptr;
+		m_last = nullptr;
+		m_count = 0;
+		m_callbacks.clear();
+	}
+
+	void CommandList::Clear(u32 flags, Color color, f32 depth)
+	{
+		Push<ClearCmd>(CommandType::Clear) = ClearCmd{ flags, color, depth };
+	}
+
+	void CommandList::SetRenderState(const RenderState& state)
+	{
+		Push<SetRenderStateCmd>(CommandType::SetRenderState) = SetRenderStateCmd{ state };
+	}
+
+	void CommandList::UpdateVertexBuffer(VertexBuffer& buffer, const void* data, u32 size)
+	{
+		const void* copy = m_arena.Copy(static_cast<const u8*>(data), size);
+		Push<UpdateVertexBufferCmd>(CommandType::UpdateVertexBuffer) = UpdateVertexBufferCmd{ &buffer, copy, size };
+	}
+
+	void CommandList::UpdateIndexBuffer(VertexArray& vertex_array, const u32* indices, u32 count)
+	{
+		const u32* copy = m_arena.Copy(indices, count);
+		Push<UpdateIndexBufferCmd>(CommandType::UpdateIndexBuffer) = UpdateIndexBufferCmd{ &vertex_array, copy, count };
+	}
+
+	void CommandList::BindShader(const ShaderProgram& shader)
+	{
+		Push<BindShaderCmd>(CommandType::BindShader) = BindShaderCmd{ &shader };
+	}
+
+	void CommandList::SetUniforms(const ShaderProgram& shader, std::initializer_list<UniformValue> values)
+	{
+		UniformValue* copy = m_arena.Copy(values.begin(), values.size());
+		Push<SetUniformsCmd>(CommandType::SetUniforms) = SetUniformsCmd{ &shader, copy, (u32)values.size() };
+	}
+
+	void CommandList::UpdateUniformBuffer(UniformBuffer& buffer, const void* data, u32 size)
+	{
+		const void* copy = m_arena.Copy(static_cast<const u8*>(data), size);
+		Push<UpdateUniformBufferCmd>(CommandType::UpdateUniformBuffer) = UpdateUniformBufferCmd{ &buffer, copy, size };
+	}
+
+	void CommandList::BindUniformBuffer(const UniformBuffer& buffer, u32 binding)
+	{
+		Push<BindUniformBufferCmd>(CommandType::BindUniformBuffer) = BindUniformBufferCmd{ &buffer, binding };
+	}
+
+	void CommandList::PushUniforms(u32 binding, const void* data, u32 size)
+	{
+		const void* copy = m_arena.Copy(static_cast<const u8*>(data), size);
+		Push<PushUniformsCmd>(CommandType::PushUniforms) = PushUniformsCmd{ binding, copy, size };
+	}
+
+	void CommandList::BindTexture(const Texture* texture, u32 slot)
+	{
+		Push<BindTextureCmd>(CommandType::BindTexture) = BindTextureCmd{ texture, slot };
+	}
+
+	void CommandList::BindVertexArray(const VertexArray& vertex_array)
+	{
+		Push<BindVertexArrayCmd>(CommandType::BindVertexArray) = BindVertexArrayCmd{ &vertex_array };
+	}
+
+	void CommandList::BindMesh(const Mesh& mesh)
+	{
+		Push<BindMeshCmd>(CommandType::BindMesh) = BindMeshCmd{ &mesh };
+	}
+
+	void CommandList::DrawMesh(const Mesh& mesh)
+	{
+		Push<DrawMeshCmd>(CommandType::DrawMesh) = DrawMeshCmd{ &mesh };
+	}
+
+	void CommandList::DrawIndexed(u32 first_index, u32 index_count)
+	{
+		Push<DrawIndexedCmd>(CommandType::DrawIndexed) = DrawIndexedCmd{ first_index, index_count };
+	}
+
+	void CommandList::Callback(std::function<void()> func)
+	{
+		Push<CallbackCmd>(CommandType::Callback) = CallbackCmd{ (u32)m_callbacks.size() };
+		m_callbacks.emplace_back(std::move(func));
+	}
+
+	void CommandList::Replay(RenderBackend& backend) const
+	{
+		backend.BeginFrame();
+
+		for (const CommandHeader* header = m_first; header != nullptr; header = header->next)
+		{
+			switch (header->type)
+			{
+			case CommandType::Clear:               backend.Clear(Payload<ClearCmd>(header)); break;
+			case CommandType::SetRenderState:      backend.SetRenderState(Payload<SetRenderStateCmd>(header)); break;
+			case CommandType::UpdateVertexBuffer:  backend.UpdateVertexBuffer(Payload<UpdateVertexBufferCmd>(header)); break;
+			case CommandType::UpdateIndexBuffer:   backend.UpdateIndexBuffer(Payload<UpdateIndexBufferCmd>(header)); break;
+			case CommandType::BindShader:          backend.BindShader(Payload<BindShaderCmd>(header)); break;
+			case CommandType::SetUniforms:         backend.SetUniforms(Payload<SetUniformsCmd>(header)); break;
+			case CommandType::UpdateUniformBuffer: backend.UpdateUniformBuffer(Payload<UpdateUniformBufferCmd>(header)); break;
+			case CommandType::BindUniformBuffer:   backend.BindUniformBuffer(Payload<BindUniformBufferCmd>(header)); break;
+			case CommandType::PushUniforms:        backend.PushUniforms(Payload<PushUniformsCmd>(header)); break;
+			case CommandType::BindTexture:         backend.BindTexture(Payload<BindTextureCmd>(header)); break;
+			case CommandType::BindVertexArray:     backend.BindVertexArray(Payload<BindVertexArrayCmd>(header)); break;
+			case CommandType::BindMesh:            backend.BindMesh(Payload<BindMeshCmd>(header)); break;
+			case CommandType::DrawMesh:            backend.DrawMesh(Payload<DrawMeshCmd>(header)); break;
+			case CommandType::DrawIndexed:         backend.DrawIndexed(Payload<DrawIndexedCmd>(header)); break;
+			case CommandType::Callback:            backend.Callback(m_callbacks[Payload<CallbackCmd>(header).index]); break;
+			default:
+				LEOASSERT(false, "Unknown command in the command list");
+				break;
+			}
+		}
+
+		backend.EndFrame();
+	}
+}
@@ -0,0 +1,284 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <initializer_list>
+#include <glm/glm.hpp>
+#include <LEO/Utilities/LeoTypes.h>
+#include <LEO/Utilities/LeoColors.h>
+#include <LEO/Graphics/Shader.h>
+
+namespace leo
+{
+	class ShaderProgram;
+	class Texture;
+	class Mesh;
+	class VertexBuffer;
+	class VertexArray;
+	class UniformBuffer;
+	class RenderBackend;
+
+	/// <summary>
+	/// Linear allocator for the data of one frame, everything is freed at once by Reset() which keeps the memory.
+	/// Allocations never move, a pointer stays valid until the next Reset().
+	/// </summary>
+	class FrameArena
+	{
+	public:
+		static constexpr u64 BLOCK_SIZE = 64 * 1024;
+	public:
+		FrameArena() = default;
+
+		FrameArena(const FrameArena&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+
+		FrameArena(FrameArena&&) noexcept = default;
+		FrameArena& operator=(FrameArena&&) noexcept = default;
+	public:
+		void* Allocate(u64 size, u64 alignment = 16);
+
+		template<typename T>
+		T* Copy(const T* data, u64 count)
+		{
+			T* copy = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+			if (count > 0) memcpy(copy, data, sizeof(T) * count);
+			return copy;
+		}
+
+		void Reset();
+
+		inline u64 BytesUsed() const { return m_used; }
+		u64 Capacity() const;
+	private:
+		struct Block
+		{
+			std::unique_ptr<u8[]> data;
+			u64 size;
+		};
+	private:
+		std::vector<Block> m_blocks;
+		u32 m_block = 0;   // block being filled
+		u64 m_offset = 0;  // in the block being filled
+		u64 m_used = 0;
+	};
+
+	enum ClearFlags : u32
+	{
+		CLEAR_COLOR = (1 << 0),
+		CLEAR_DEPTH = (1 << 1)
+	};
+
+	struct RenderState
+	{
+		bool depthTest = true;  // GL_LEQUAL
+		bool blend     = false; // src alpha, 1 - src alpha
+	};
+
+	enum class UniformType : u8
+	{
+		Float, Vec2, Vec3, Vec4,
+		Int, IVec3,
+		UInt, UVec3,
+		Mat3, Mat4
+	};
+
+	// A named uniform value, the name is hashed once when recorded and the replay looks it up by hash
+	struct UniformValue
+	{
+		UniformName name;
+		UniformType type;
+		f32 data[16];
+
+		UniformValue(UniformName name, f32 v)                : UniformValue(name, UniformType::Float, &v, sizeof(v)) {}
+		UniformValue(UniformName name, const glm::vec2& v)   : UniformValue(name, UniformType::Vec2, &v, sizeof(v)) {}
+		UniformValue(UniformName name, const glm::vec3& v)   : UniformValue(name, UniformType::Vec3, &v, sizeof(v)) {}
+		UniformValue(UniformName name, const glm::vec4& v)   : UniformValue(name, UniformType::Vec4, &v, sizeof(v)) {}
+		UniformValue(UniformName name, i32 v)                : UniformValue(name, UniformType::Int, &v, sizeof(v)) {}
+		UniformValue(UniformName name, const glm::ivec3& v)  : UniformValue(name, UniformType::IVec3, &v, sizeof(v)) {}
+		UniformValue(UniformName name, u32 v)                : UniformValue(name, UniformType::UInt, &v, sizeof(v)) {}
+		UniformValue(UniformName name, const glm::uvec3& v)  : UniformValue(name, UniformType::UVec3, &v, sizeof(v)) {}
+		UniformValue(UniformName name, const glm::mat3& v)   : UniformValue(name, UniformType::Mat3, &v, sizeof(v)) {}
+		UniformValue(UniformName name, const glm::mat4& v)   : UniformValue(name, UniformType::Mat4, &v, sizeof(v)) {}
+
+		// Copied out, data only holds floats
+		template<typename T>
+		T As() const
+		{
+			static_assert(sizeof(T) <= sizeof(data) && std::is_trivially_copyable_v<T>);
+			T value;
+			memcpy(&value, data, sizeof(T));
+			return value;
+		}
+	private:
+		UniformValue(UniformName name, UniformType type, const void* value, u32 size)
+			:
+			name(name), type(type), data{}
+		{
+			memcpy(data, value, size);
+		}
+	};
+
+	enum class CommandType : u8
+	{
+		Clear,
+		SetRenderState,
+		UpdateVertexBuffer,
+		UpdateIndexBuffer,
+		BindShader,
+		SetUniforms,
+		UpdateUniformBuffer,
+		BindUniformBuffer,
+		PushUniforms,
+		BindTexture,
+		BindVertexArray,
+		BindMesh,
+		DrawMesh,
+		DrawIndexed,
+		Callback,
+		Count
+	};
+
+	const char* CommandTypeName(CommandType type);
+
+	// ---------------- Command payloads ----------------
+	// They point to engine objects, which must outlive the replay (one frame after the recording)
+
+	struct ClearCmd               { u32 flags; Color color; f32 depth; };
+	struct SetRenderStateCmd      { RenderState state; };
+	struct UpdateVertexBufferCmd  { VertexBuffer* buffer; const void* data; u32 size; };     // data is in the arena
+	struct UpdateIndexBufferCmd   { VertexArray* vertexArray; const u32* indices; u32 count; }; // binds the vertex array
+	struct BindShaderCmd          { const ShaderProgram* shader; };
+	struct SetUniformsCmd         { const ShaderProgram* shader; const UniformValue* values; u32 count; }; // shader must be bound
+	struct UpdateUniformBufferCmd { UniformBuffer* buffer; const void* data; u32 size; };   // data is in the arena
+	struct BindUniformBufferCmd   { const UniformBuffer* buffer; u32 binding; };
+	struct PushUniformsCmd        { u32 binding; const void* data; u32 size; };            // ring allocated by the backend
+	struct BindTextureCmd         { const Texture* texture; u32 slot; };   // texture may be nullptr
+	struct BindVertexArrayCmd     { const VertexArray* vertexArray; };
+	struct BindMeshCmd            { const Mesh* mesh; };
+	struct DrawMeshCmd            { const Mesh* mesh; };                   // mesh must be bound
+	struct DrawIndexedCmd         { u32 firstIndex; u32 indexCount; };     // triangles of the bound vertex array
+	struct CallbackCmd            { u32 index; };
+
+	/// <summary>
+	/// Backend agnostic list of render commands, recorded on the main thread and replayed later
+	/// (possibly on the render thread) into a RenderBackend.
+	/// The commands and their data are encoded in a FrameArena, recording does not touch OpenGL.
+	/// </summary>
+	class CommandList
+	{
+	public:
+		CommandList() = default;
+
+		CommandList(const CommandList&) = delete;
+		CommandList& operator=(const CommandList&) = delete;
+	public:
+		// Drops the commands, keeps the memory
+		void Reset();
+	public:
+		void Clear(u32 flags, Color color = BLACK, f32 depth = 1.0f);
+		void SetRenderState(const RenderState& state);
+
+		// The data is copied
+		void UpdateVertexBuffer(VertexBuffer& buffer, const void* data, u32 size);
+		void UpdateIndexBuffer(VertexArray& vertex_array, const u32* indices, u32 count);
+
+		void BindShader(const ShaderProgram& shader);
+		void SetUniforms(const ShaderProgram& shader, std::initializer_list<UniformValue> values);
+
+		// std140 blocks (UniformBuffer.h), the data is copied
+		void UpdateUniformBuffer(UniformBuffer& buffer, const void* data, u32 size);
+		void BindUniformBuffer(const UniformBuffer& buffer, u32 binding);
+		// Per draw block, the backend writes it into its UniformStream and binds the range
+		void PushUniforms(u32 binding, const void* data, u32 size);
+
+		template<typename Block>
+		void UpdateUniformBuffer(UniformBuffer& buffer, const Block& block) { UpdateUniformBuffer(buffer, &block, sizeof(Block)); }
+		template<typename Block>
+		void PushUniforms(u32 binding, const Block& block) { PushUniforms(binding, &block, sizeof(Block)); }
+		void BindTexture(const Texture* texture, u32 slot = 0); // nullptr unbinds the 2D texture of the slot
+		void BindVertexArray(const VertexArray& vertex_array);
+		void BindMesh(const Mesh& mesh);
+
+		void DrawMesh(const Mesh& mesh);
+		void DrawIndexed(u32 first_index, u32 index_count);
+
+		// Runs func on the replaying thread, for work that has no command (creating GL objects, ...)
+		void Callback(std::function<void()> func);
+	public:
+		// Feeds the commands, in order, to the backend
+		void Replay(RenderBackend& backend) const;
+
+		inline u32 CommandCount() const { return m_count; }
+		inline const FrameArena& Arena() const { return m_arena; }
+	private:
+		struct CommandHeader
+		{
+			CommandHeader* next;
+			CommandType type;
+		};
+	private:
+		template<typename T>
+		T& Push(CommandType type)
+		{
+			// the payload follows the header
+			constexpr u64 payload_offset = (sizeof(CommandHeader) + alignof(T) - 1) & ~(alignof(T) - 1);
+			constexpr u64 alignment = alignof(T) > alignof(CommandHeader) ? alignof(T) : alignof(CommandHeader);
+
+			u8* memory = static_cast<u8*>(m_arena.Allocate(payload_offset + sizeof(T), alignment));
+			CommandHeader* header = reinterpret_cast<CommandHeader*>(memory);
+			header->next = nullptr;
+			header->type = type;
+
+			if (m_last != nullptr) m_last->next = header;
+			else m_first = header;
+			m_last = header;
+			m_count++;
+
+			return *reinterpret_cast<T*>(memory + payload_offset);
+		}
+
+		template<typename T>
+		static const T& Payload(const CommandHeader* header)
+		{
+			constexpr u64 payload_offset = (sizeof(CommandHeader) + alignof(T) - 1) & ~(alignof(T) - 1);
+			return *reinterpret_cast<const T*>(reinterpret_cast<const u8*>(header) + payload_offset);
+		}
+	private:
+		FrameArena m_arena;
+		CommandHeader* m_first = nullptr;
+		CommandHeader* m_last = nullptr;
+		u32 m_count = 0;
+
+		std::vector<std::function<void()>> m_callbacks;
+	};
+
+	/// <summary>
+	/// Executes replayed commands. GLRenderBackend draws with OpenGL, NullRenderBackend only records them.
+	/// </summary>
+	class RenderBackend
+	{
+	public:
+		virtual ~RenderBackend() = default;
+	public:
+		virtual void BeginFrame() {}
+		virtual void EndFrame() {}
+
+		virtual void Clear(const ClearCmd& cmd) = 0;
+		virtual void SetRenderState(const SetRenderStateCmd& cmd) = 0;
+		virtual void UpdateVertexBuffer(const UpdateVertexBufferCmd& cmd) = 0;
+		virtual void UpdateIndexBuffer(const UpdateIndexBufferCmd& cmd) = 0;
+		virtual void BindShader(const BindShaderCmd& cmd) = 0;
+		virtual void SetUniforms(const SetUniformsCmd& cmd) = 0;
+		virtual void UpdateUniformBuffer(const UpdateUniformBufferCmd& cmd) = 0;
+		virtual void BindUniformBuffer(const BindUniformBufferCmd& cmd) = 0;
+		virtual void PushUniforms(const PushUniformsCmd& cmd) = 0;
+		virtual void BindTexture(const BindTextureCmd& cmd) = 0;
+		virtual void BindVertexArray(const BindVertexArrayCmd& cmd) = 0;
+		virtual void BindMesh(const BindMeshCmd& cmd) = 0;
+		virtual void DrawMesh(const DrawMeshCmd& cmd) = 0;
+		virtual void DrawIndexed(const DrawIndexedCmd& cmd) = 0;
+		virtual void Callback(const std::function<void()>& func) { func(); }
+	};
+}
@@ -0,0 +1,293 @@
+#include <bit>
+#include <cmath>
+#include <algorithm>
+#include <LEO/Utilities/LeoThreadPool.h>
+#include <LEO/Utilities/LeoTimer.h>
+#include "Culling.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define LEO_CULLING_X86 1
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#endif
+#else
+	#define LEO_CULLING_X86 0
+#endif
+
+// MSVC compiles AVX2 intrinsics without /arch, gcc and clang need the target on the function
+#if LEO_CULLING_X86 && (defined(__GNUC__) || defined(__clang__))
+	#define LEO_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define LEO_TARGET_AVX2
+#endif
+
+namespace leo
+{
+	// ---------------- Bounds ----------------
+
+	BoundingSphere BoundingSphere::FromAABB(glm::vec3 min, glm::vec3 max)
+	{
+		return BoundingSphere{ (min + max) * 0.5f, glm::length(max - min) * 0.5f };
+	}
+
+	BoundingSphere BoundingSphere::FromPositions(const f32* positions, u32 count, u32 stride)
+	{
+		if (count == 0) return BoundingSphere{};
+
+		glm::vec3 min(positions[0], positions[1], positions[2]);
+		glm::vec3 max = min;
+		for (u32 i = 1; i < count; i++)
+		{
+			const f32* p = positions + (u64)i * stride;
+			min = glm::min(min, glm::vec3(p[0], p[1], p[2]));
+			max = glm::max(max, glm::vec3(p[0], p[1], p[2]));
+		}
+		return FromAABB(min, max);
+	}
+
+	Frustum Frustum::FromMatrix(const glm::mat4& m)
+	{
+		// rows of the matrix (glm is column major), Gribb / Hartmann
+		glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+		glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+		glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+		glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+		Frustum frustum;
+		frustum.planes[0] = row3 + row0; // left
+		frustum.planes[1] = row3 - row0; // right
+		frustum.planes[2] = row3 + row1; // bottom
+		frustum.planes[3] = row3 - row1; // top
+		frustum.planes[4] = row3 + row2; // near
+		frustum.planes[5] = row3 - row2; // far
+
+		for (glm::vec4& plane : frustum.planes) {
+			plane /= glm::length(glm::vec3(plane));
+		}
+		return frustum;
+	}
+
+	bool Frustum::IsVisible(glm::vec3 center, f32 radius) const
+	{
+		for (const glm::vec4& p : planes)
+		{
+			if (!(p.x * center.x + p.y * center.y + p.z * center.z + p.w >= -radius)) return false;
+		}
+		return true;
+	}
+
+	// ---------------- Instance tests ----------------
+
+	// the same operations in the same order as TestAVX2, both paths give the same bits
+	static bool IsInstanceVisible(const Frustum& frustum, const BoundingSphere& bounds, const glm::mat4& m)
+	{
+		const glm::vec3 c = bounds.center;
+		f32 x = m[0][0] * c.x + m[1][0] * c.y + m[2][0] * c.z + m[3][0];
+		f32 y = m[0][1] * c.x + m[1][1] * c.y + m[2][1] * c.z + m[3][1];
+		f32 z = m[0][2] * c.x + m[1][2] * c.y + m[2][2] * c.z + m[3][2];
+
+		f32 s0 = m[0][0] * m[0][0] + m[0][1] * m[0][1] + m[0][2] * m[0][2];
+		f32 s1 = m[1][0] * m[1][0] + m[1][1] * m[1][1] + m[1][2] * m[1][2];
+		f32 s2 = m[2][0] * m[2][0] + m[2][1] * m[2][1] + m[2][2] * m[2][2];
+		f32 radius = bounds.radius * std::sqrt(std::max(std::max(s0, s1), s2));
+
+		return frustum.IsVisible(glm::vec3(x, y, z), radius);
+	}
+
+	static void TestScalar(const Frustum& frustum, const BoundingSphere& bounds, const glm::mat4* transforms, u32 begin, u32 end, u8* masks)
+	{
+		for (u32 i = begin; i < end; i += 8)
+		{
+			u32 n = std::min(8u, end - i);
+			u8 bits = 0;
+			for (u32 k = 0; k < n; k++)
+			{
+				if (IsInstanceVisible(frustum, bounds, transforms[i + k])) bits |= (u8)(1u << k);
+			}
+			masks[i / 8] = bits;
+		}
+	}
+
+#if LEO_CULLING_X86
+	// begin and end are multiples of 8
+	LEO_TARGET_AVX2 static void TestAVX2(const Frustum& frustum, const BoundingSphere& bounds, const glm::mat4* transforms, u32 begin, u32 end, u8* masks)
+	{
+		const f32* base = reinterpret_cast<const f32*>(transforms);
+		const __m256i stride = _mm256_setr_epi32(0, 16, 32, 48, 64, 80, 96, 112); // one mat4 = 16 floats
+
+		const __m256 cx = _mm256_set1_ps(bounds.center.x);
+		const __m256 cy = _mm256_set1_ps(bounds.center.y);
+		const __m256 cz = _mm256_set1_ps(bounds.center.z);
+		const __m256 radius = _mm256_set1_ps(bounds.radius);
+		const __m256 zero = _mm256_setzero_ps();
+
+		__m256 px[6], py[6], pz[6], pw[6];
+		for (u32 p = 0; p < 6; p++)
+		{
+			px[p] = _mm256_set1_ps(frustum.planes[p].x);
+			py[p] = _mm256_set1_ps(frustum.planes[p].y);
+			pz[p] = _mm256_set1_ps(frustum.planes[p].z);
+			pw[p] = _mm256_set1_ps(frustum.planes[p].w);
+		}
+
+		for (u32 i = begin; i < end; i += 8)
+		{
+			// element [column][row] of the 8 matrices
+			const f32* m = base + (u64)i * 16;
+			__m256 m00 = _mm256_i32gather_ps(m + 0, stride, 4);
+			__m256 m01 = _mm256_i32gather_ps(m + 1, stride, 4);
+			__m256 m02 = _mm256_i32gather_ps(m + 2, stride, 4);
+			__m256 m10 = _mm256_i32gather_ps(m + 4, stride, 4);
+			__m256 m11 = _mm256_i32gather_ps(m + 5, stride, 4);
+			__m256 m12 = _mm256_i32gather_ps(m + 6, stride, 4);
+			__m256 m20 = _mm256_i32gather_ps(m + 8, stride, 4);
+			__m256 m21 = _mm256_i32gather_ps(m + 9, stride, 4);
+			__m256 m22 = _mm256_i32gather_ps(m + 10, stride, 4);
+			__m256 m30 = _mm256_i32gather_ps(m + 12, stride, 4);
+			__m256 m31 = _mm256_i32gather_ps(m + 13, stride, 4);
+			__m256 m32 = _mm256_i32gather_ps(m + 14, stride, 4);
+
+			// no FMA, it would round differently from the scalar path
+			__m256 x = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, cx), _mm256_mul_ps(m10, cy)), _mm256_mul_ps(m20, cz)), m30);
+			__m256 y = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m01, cx), _mm256_mul_ps(m11, cy)), _mm256_mul_ps(m21, cz)), m31);
+			__m256 z = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m02, cx), _mm256_mul_ps(m12, cy)), _mm256_mul_ps(m22, cz)), m32);
+
+			__m256 s0 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, m00), _mm256_mul_ps(m01, m01)), _mm256_mul_ps(m02, m02));
+			__m256 s1 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m10, m10), _mm256_mul_ps(m11, m11)), _mm256_mul_ps(m12, m12));
+			__m256 s2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m20, m20), _mm256_mul_ps(m21, m21)), _mm256_mul_ps(m22, m22));
+			__m256 r = _mm256_mul_ps(radius, _mm256_sqrt_ps(_mm256_max_ps(_mm256_max_ps(s0, s1), s2)));
+			__m256 neg_r = _mm256_sub_ps(zero, r);
+
+			__m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (u32 p = 0; p < 6; p++)
+			{
+				__m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px[p], x), _mm256_mul_ps(py[p], y)), _mm256_mul_ps(pz[p], z)), pw[p]);
+				visible = _mm256_and_ps(visible, _mm256_cmp_ps(d, neg_r, _CMP_GE_OQ));
+			}
+
+			masks[i / 8] = (u8)_mm256_movemask_ps(visible);
+		}
+	}
+#endif
+
+	static bool DetectAVX2()
+	{
+#if LEO_CULLING_X86 && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) return false;
+
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx) return false;
+		if ((_xgetbv(0) & 0x6) != 0x6) return false; // the OS does not save the ymm registers
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#elif LEO_CULLING_X86
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+#else
+		return false;
+#endif
+	}
+
+	// ---------------- InstanceCuller ----------------
+
+	bool InstanceCuller::HasAVX2()
+	{
+		static const bool s_avx2 = DetectAVX2();
+		return s_avx2;
+	}
+
+	InstanceCuller::InstanceCuller(ThreadPool* pool)
+		:
+		m_pool(pool),
+		m_useSimd(HasAVX2())
+	{
+	}
+
+	u32 InstanceCuller::Cull(const Frustum& frustum, const BoundingSphere& bounds, std::span<const glm::mat4> transforms, glm::mat4* out)
+	{
+		Timer timer;
+
+		u32 count = (u32)transforms.size();
+		m_stats = CullStats{ count, 0, 0.0f, m_useSimd };
+		if (count == 0) return 0;
+
+		u32 chunks = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+		m_masks.resize((count + 7) / 8);
+		m_chunkCounts.assign(chunks, 0);
+
+		const glm::mat4* data = transforms.data();
+
+		auto test_chunks = [&](u32 begin, u32 end) {
+			for (u32 c = begin; c < end; c++) {
+				TestChunk(frustum, bounds, data, c * CHUNK_SIZE, std::min(count, (c + 1) * CHUNK_SIZE));
+			}
+		};
+
+		if (m_pool != nullptr) m_pool->ParallelFor(chunks, 1, test_chunks);
+		else test_chunks(0, chunks);
+
+		// the counts become the output offsets
+		u32 visible = 0;
+		for (u32& chunk : m_chunkCounts)
+		{
+			u32 chunk_visible = chunk;
+			chunk = visible;
+			visible += chunk_visible;
+		}
+
+		auto copy_chunks = [&](u32 begin, u32 end) {
+			for (u32 c = begin; c < end; c++) {
+				CopyChunk(data, c * CHUNK_SIZE, std::min(count, (c + 1) * CHUNK_SIZE), out + m_chunkCounts[c]);
+			}
+		};
+
+		if (m_pool != nullptr) m_pool->ParallelFor(chunks, 1, copy_chunks);
+		else copy_chunks(0, chunks);
+
+		m_stats.visible = visible;
+		m_stats.ms = timer.ElapsedMillis();
+		return visible;
+	}
+
+	void InstanceCuller::TestChunk(const Frustum& frustum, const BoundingSphere& bounds, const glm::mat4* transforms, u32 begin, u32 end)
+	{
+		u8* masks = m_masks.data();
+		u32 split = begin;
+
+#if LEO_CULLING_X86
+		if (m_useSimd)
+		{
+			split = begin + (end - begin) / 8 * 8;
+			TestAVX2(frustum, bounds, transforms, begin, split, masks);
+		}
+#endif
+		TestScalar(frustum, bounds, transforms, split, end, masks);
+
+		u32 visible = 0;
+		for (u32 i = begin / 8; i < (end + 7) / 8; i++) {
+			visible += (u32)std::popcount(masks[i]);
+		}
+		m_chunkCounts[begin / CHUNK_SIZE] = visible;
+	}
+
+	u32 InstanceCuller::CopyChunk(const glm::mat4* transforms, u32 begin, u32 end, glm::mat4* out) const
+	{
+		u32 written = 0;
+		for (u32 i = begin; i < end; i += 8)
+		{
+			u32 bits = m_masks[i / 8];
+			while (bits != 0)
+			{
+				out[written++] = transforms[i + std::countr_zero(bits)];
+				bits &= bits - 1;
+			}
+		}
+		return written;
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <span>
+#include <vector>
+#include <limits>
+#include <glm/glm.hpp>
+#include <LEO/Utilities/LeoTypes.h>
+
+namespace leo
+{
+	class ThreadPool;
+
+	// Bounds of a mesh in its local space
+	struct BoundingSphere
+	{
+		glm::vec3 center = glm::vec3(0.0f);
+		f32       radius = std::numeric_limits<f32>::infinity(); // unknown bounds, never culled
+
+		static BoundingSphere FromAABB(glm::vec3 min, glm::vec3 max);
+
+		// Sphere around the box of the positions, stride is in floats (the vertex size)
+		static BoundingSphere FromPositions(const f32* positions, u32 count, u32 stride);
+	};
+
+	// The 6 planes of a view frustum, normals point inside: (normal, distance), normalized
+	struct Frustum
+	{
+		glm::vec4 planes[6];
+
+		// Planes of an OpenGL clip space (-w..w), in the space the matrix transforms from (world for a view projection)
+		static Frustum FromMatrix(const glm::mat4& view_proj);
+
+		bool IsVisible(glm::vec3 center, f32 radius) const;
+	};
+
+	struct CullStats
+	{
+		u32  tested  = 0;
+		u32  visible = 0;
+		f32  ms      = 0.0f;
+		bool simd    = false; // the AVX2 path was used
+	};
+
+	/// <summary>
+	/// Frustum culling of instance transforms before they are uploaded.
+	/// The local bounding sphere of the mesh is moved by each transform (its radius scaled by the largest axis)
+	/// and tested against the 6 planes, 8 instances at a time with AVX2 when the CPU has it, one at a time otherwise.
+	/// The transforms are split in chunks of CHUNK_SIZE over the ThreadPool: a first pass writes one visibility bit
+	/// per instance and counts each chunk, a second pass copies the visible transforms to their final offset,
+	/// so the output keeps the input order and does not depend on the thread count or on the path used.
+	/// </summary>
+	class InstanceCuller
+	{
+	public:
+		static constexpr u32 CHUNK_SIZE = 4096; // instances per task, multiple of 8
+	public:
+		explicit InstanceCuller(ThreadPool* pool = nullptr); // nullptr: single threaded
+
+		InstanceCuller(const InstanceCuller&) = delete;
+		InstanceCuller& operator=(const InstanceCuller&) = delete;
+	public:
+		// Writes the visible transforms to out (room for transforms.size()), returns how many were written.
+		// out can be mapped memory (StreamBuffer), it is only written sequentially
+		u32 Cull(const Frustum& frustum, const BoundingSphere& bounds, std::span<const glm::mat4> transforms, glm::mat4* out);
+
+		void SetThreadPool(ThreadPool* pool) { m_pool = pool; }
+
+		// Disables the AVX2 path, to compare with the scalar one
+		void SetUseSimd(bool use) { m_useSimd = use && HasAVX2(); }
+
+		inline const CullStats& LastStats() const { return m_stats; }
+
+		// Checked once, the CPU and the OS must support AVX2
+		static bool HasAVX2();
+	private:
+		void TestChunk(const Frustum& frustum, const BoundingSphere& bounds, const glm::mat4* transforms, u32 begin, u32 end);
+		u32 CopyChunk(const glm::mat4* transforms, u32 begin, u32 end, glm::mat4* out) const;
+	private:
+		ThreadPool* m_pool = nullptr;
+		bool m_useSimd = false;
+
+		std::vector<u8>  m_masks;        // one visibility bit per instance
+		std::vector<u32> m_chunkCounts;  // visible instances per chunk, then their output offset
+		CullStats m_stats;
+	};
+}
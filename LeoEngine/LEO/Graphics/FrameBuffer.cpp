@@ -1,5 +1,6 @@
 #include <glad/glad.h>
 #include <LEO/Log/Log.h>
+#include "GLStateCache.h"
 #include "FrameBuffer.h"
 
 
@@ -49,11 +50,11 @@ namespace leo
 
         if (m_depth_texture)
         {
-            glDeleteTextures(1, &m_depth_texture->m_id);
+            GetGLStateCache().DeleteTexture(m_depth_texture->m_id);
             m_depth_texture->m_id = 0;
         }
 
-        glDeleteFramebuffers(1, &m_id);
+        GetGLStateCache().DeleteFramebuffer(m_id);
 
         m_id = other.m_id;
         other.m_id = 0;
@@ -79,58 +80,22 @@ namespace leo
 
 		if (m_depth_texture)
 		{
-			glDeleteTextures(1, &m_depth_texture->m_id);
+			GetGLStateCache().DeleteTexture(m_depth_texture->m_id);
 			m_depth_texture->m_id = 0;
 		}
 
-		glDeleteFramebuffers(1, &m_id);
+		GetGLStateCache().DeleteFramebuffer(m_id);
 	}
 
     void FrameBuffer::Bind() const
     {
-        glBindFramebuffer(GL_FRAMEBUFFER, m_id);
-
-        constexpr static GLenum drawbuffers[32] = {
-            GL_COLOR_ATTACHMENT0,
-            GL_COLOR_ATTACHMENT1,
-            GL_COLOR_ATTACHMENT2,
-            GL_COLOR_ATTACHMENT3,
-            GL_COLOR_ATTACHMENT4,
-            GL_COLOR_ATTACHMENT5,
-            GL_COLOR_ATTACHMENT6,
-            GL_COLOR_ATTACHMENT7,
-            GL_COLOR_ATTACHMENT8,
-            GL_COLOR_ATTACHMENT9,
-            GL_COLOR_ATTACHMENT10,
-            GL_COLOR_ATTACHMENT11,
-            GL_COLOR_ATTACHMENT12,
-            GL_COLOR_ATTACHMENT13,
-            GL_COLOR_ATTACHMENT14,
-            GL_COLOR_ATTACHMENT15,
-            GL_COLOR_ATTACHMENT16,
-            GL_COLOR_ATTACHMENT17,
-            GL_COLOR_ATTACHMENT18,
-            GL_COLOR_ATTACHMENT19,
-            GL_COLOR_ATTACHMENT20,
-            GL_COLOR_ATTACHMENT21,
-            GL_COLOR_ATTACHMENT22,
-            GL_COLOR_ATTACHMENT23,
-            GL_COLOR_ATTACHMENT24,
-            GL_COLOR_ATTACHMENT25,
-            GL_COLOR_ATTACHMENT26,
-            GL_COLOR_ATTACHMENT27,
-            GL_COLOR_ATTACHMENT28,
-            GL_COLOR_ATTACHMENT29,
-            GL_COLOR_ATTACHMENT30,
-            GL_COLOR_ATTACHMENT31
-        };
-
-        glDrawBuffers((GLsizei)m_color_attachments.size(), drawbuffers);
+        // the draw buffers are framebuffer object state, they are set once in SetDrawBuffers
+        GetGLStateCache().BindFramebuffer(m_id);
     }
 
     void FrameBuffer::UnBind() const
     {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GetGLStateCache().BindFramebuffer(0);
     }
 
     void FrameBuffer::BindColorTexture(u8 index, u32 slot) const
@@ -199,7 +164,7 @@ namespace leo
         m_depth = 0;
 
         glGenFramebuffers(1, &m_id);
-        glBindFramebuffer(GL_FRAMEBUFFER, m_id);
+        GetGLStateCache().BindFramebuffer(m_id);
 
         colorAttachmentCount = CheckColorAttachmentNumber(colorAttachmentCount);
 
@@ -221,6 +186,7 @@ namespace leo
         glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_depth_texture->m_id, 0);
 
         //LOGDEBUG("FrameBuffer({}): Created with size ({},{}) and {} color attachments", m_id, m_width, m_height, colorAttachmentCount);
+        SetDrawBuffers();
         LEOASSERT(CheckFramebufferStatus(m_id) == GL_FRAMEBUFFER_COMPLETE, "Frame buffer error");
     }
 
@@ -232,7 +198,7 @@ namespace leo
         m_depth = depth;
 
         glGenFramebuffers(1, &m_id);
-        glBindFramebuffer(GL_FRAMEBUFFER, m_id);
+        GetGLStateCache().BindFramebuffer(m_id);
 
         colorAttachmentCount = CheckColorAttachmentNumber(colorAttachmentCount);
 
@@ -256,6 +222,7 @@ namespace leo
         */
 
         //LOGDEBUG("FrameBuffer({}): Created with size ({},{},{}) and {} color attachments", m_id, m_width, m_height, m_depth, colorAttachmentCount);
+        SetDrawBuffers();
         LEOASSERT(CheckFramebufferStatus(m_id) == GL_FRAMEBUFFER_COMPLETE, "Frame buffer error");
     }
 
@@ -267,7 +234,7 @@ namespace leo
         m_depth = 0;
 
         glGenFramebuffers(1, &m_id);
-        glBindFramebuffer(GL_FRAMEBUFFER, m_id);
+        GetGLStateCache().BindFramebuffer(m_id);
 
         colorAttachmentCount = CheckColorAttachmentNumber(colorAttachmentCount);
 
@@ -279,6 +246,7 @@ namespace leo
         glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, tex.m_id, 0);
 
         //LOGDEBUG("FrameBuffer({}): Created with size ({},{}) and {} color attachments Layered", m_id, m_width, m_height, colorAttachmentCount);
+        SetDrawBuffers();
         LEOASSERT(CheckFramebufferStatus(m_id) == GL_FRAMEBUFFER_COMPLETE, "Frame buffer error");
     }
 
@@ -290,7 +258,7 @@ namespace leo
         m_depth = colorAttachmentCount;
 
         glGenFramebuffers(1, &m_id);
-        glBindFramebuffer(GL_FRAMEBUFFER, m_id);
+        GetGLStateCache().BindFramebuffer(m_id);
 
         Texture& tex = m_color_attachments.emplace_back(DIM_3D, Texture::TexSize(m_width, m_height, m_depth), format,
             min_filter, mag_filter,
@@ -300,6 +268,7 @@ namespace leo
         glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, tex.m_id, 0);
 
         //LOGDEBUG("FrameBuffer({}): Created with size ({},{},{})", m_id, m_width, m_height, m_depth);
+        SetDrawBuffers();
         LEOASSERT(CheckFramebufferStatus(m_id) == GL_FRAMEBUFFER_COMPLETE, "Frame buffer error");
     }
 
@@ -323,9 +292,52 @@ namespace leo
         return colorAttachmentCount;
     }
 
+    void FrameBuffer::SetDrawBuffers()
+    {
+        if (m_color_attachments.empty()) return;
+
+        constexpr static GLenum drawbuffers[32] = {
+            GL_COLOR_ATTACHMENT0,
+            GL_COLOR_ATTACHMENT1,
+            GL_COLOR_ATTACHMENT2,
+            GL_COLOR_ATTACHMENT3,
+            GL_COLOR_ATTACHMENT4,
+            GL_COLOR_ATTACHMENT5,
+            GL_COLOR_ATTACHMENT6,
+            GL_COLOR_ATTACHMENT7,
+            GL_COLOR_ATTACHMENT8,
+            GL_COLOR_ATTACHMENT9,
+            GL_COLOR_ATTACHMENT10,
+            GL_COLOR_ATTACHMENT11,
+            GL_COLOR_ATTACHMENT12,
+            GL_COLOR_ATTACHMENT13,
+            GL_COLOR_ATTACHMENT14,
+            GL_COLOR_ATTACHMENT15,
+            GL_COLOR_ATTACHMENT16,
+            GL_COLOR_ATTACHMENT17,
+            GL_COLOR_ATTACHMENT18,
+            GL_COLOR_ATTACHMENT19,
+            GL_COLOR_ATTACHMENT20,
+            GL_COLOR_ATTACHMENT21,
+            GL_COLOR_ATTACHMENT22,
+            GL_COLOR_ATTACHMENT23,
+            GL_COLOR_ATTACHMENT24,
+            GL_COLOR_ATTACHMENT25,
+            GL_COLOR_ATTACHMENT26,
+            GL_COLOR_ATTACHMENT27,
+            GL_COLOR_ATTACHMENT28,
+            GL_COLOR_ATTACHMENT29,
+            GL_COLOR_ATTACHMENT30,
+            GL_COLOR_ATTACHMENT31
+        };
+
+
+        glDrawBuffers((GLsizei)m_color_attachments.size(), drawbuffers);
+    }
+
     u32 CheckFramebufferStatus(u32 framebuffer_object)
     {
-        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_object);
+        GetGLStateCache().BindFramebuffer(framebuffer_object);
         u32 status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
 
         if (status != GL_FRAMEBUFFER_COMPLETE)
@@ -354,7 +366,7 @@ namespace leo
             }
         }
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GetGLStateCache().BindFramebuffer(0);
         return status;
     }
 
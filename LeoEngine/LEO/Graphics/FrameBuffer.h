@@ -64,6 +64,8 @@ namespace leo
 			TextureMinFiltering min_filter, TextureMagFiltering mag_filter, TextureFormat format);
 
 		u32 CheckColorAttachmentNumber(u32 colorAttachmentCount);
+		// draw buffers are stored in the framebuffer object, set once when it is created (must be bound)
+		void SetDrawBuffers();
 	private:
 		u32 m_id     = 0;
 		u32 m_width  = 0;
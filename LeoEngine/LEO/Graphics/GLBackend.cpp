@@ -0,0 +1,213 @@
+#include <type_traits>
+#include <vector>
+#include <memory>
+#include <glad/glad.h>
+#include <LEO/Log/LeoAssert.h>
+#include "GLBackend.h"
+
+namespace leo
+{
+	static GLCallCounts g_mockCounts;
+	static bool g_mockInstalled = false;
+	static GLuint g_mockNextId = 0;
+	static std::vector<std::unique_ptr<u8[]>> g_mockMappings; // host memory behind the mapped buffers
+	static std::vector<GLFunction> g_mockTrace;
+	static bool g_mockTraceEnabled = false;
+
+	// the real entries, saved by InstallMockGLBackend
+	struct SavedGLFunctions
+	{
+#define LEO_GL_SAVED(name) decltype(glad_gl##name) name = nullptr;
+		LEO_GL_FUNCTIONS(LEO_GL_SAVED)
+#undef LEO_GL_SAVED
+	};
+	static SavedGLFunctions g_saved;
+
+	const char* GLFunctionName(GLFunction function)
+	{
+		switch (function)
+		{
+#define LEO_GL_NAME(name) case GLFunction::name: return "gl" #name;
+			LEO_GL_FUNCTIONS(LEO_GL_NAME)
+#undef LEO_GL_NAME
+		default: return "Unknown";
+		}
+	}
+
+	u64 GLCallCounts::Total() const
+	{
+		u64 total = 0;
+		for (u64 count : calls) {
+			total += count;
+		}
+		return total;
+	}
+
+	// ---------------- Mock entries ----------------
+
+	static void CountMockCall(GLFunction function)
+	{
+		g_mockCounts.calls[(u32)function]++;
+		if (g_mockTraceEnabled) {
+			g_mockTrace.push_back(function);
+		}
+	}
+
+	// counts the call and returns a zero value
+	template<GLFunction F, typename Fn>
+	struct MockStub;
+
+	template<GLFunction F, typename R, typename... Args>
+	struct MockStub<F, R(APIENTRY*)(Args...)>
+	{
+		static R APIENTRY Call(Args...)
+		{
+			CountMockCall(F);
+			if constexpr (!std::is_void_v<R>) {
+				return R{};
+			}
+		}
+	};
+
+	template<GLFunction F>
+	static void APIENTRY MockGen(GLsizei n, GLuint* ids)
+	{
+		CountMockCall(F);
+		for (GLsizei i = 0; i < n; i++) {
+			ids[i] = ++g_mockNextId;
+		}
+	}
+
+	template<GLFunction F>
+	static GLuint APIENTRY MockCreate(GLenum)
+	{
+		CountMockCall(F);
+		return ++g_mockNextId;
+	}
+
+	static GLuint APIENTRY MockCreateProgram()
+	{
+		CountMockCall(GLFunction::CreateProgram);
+		return ++g_mockNextId;
+	}
+
+	template<GLFunction F>
+	static void APIENTRY MockGetObjectiv(GLuint, GLenum pname, GLint* params)
+	{
+		CountMockCall(F);
+		bool status = pname == GL_COMPILE_STATUS || pname == GL_LINK_STATUS || pname == GL_VALIDATE_STATUS || pname == GL_COMPLETION_STATUS_KHR;
+		*params = status ? GL_TRUE : 0;
+	}
+
+	static void APIENTRY MockGetIntegerv(GLenum pname, GLint* data)
+	{
+		CountMockCall(GLFunction::GetIntegerv);
+		switch (pname)
+		{
+		case GL_MAX_DRAW_BUFFERS:                *data = 8; break;
+		case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT: *data = 256; break;
+		default:                                 *data = 0; break;
+		}
+	}
+
+	static GLenum APIENTRY MockCheckFramebufferStatus(GLenum)
+	{
+		CountMockCall(GLFunction::CheckFramebufferStatus);
+		return GL_FRAMEBUFFER_COMPLETE;
+	}
+
+	static const GLubyte* APIENTRY MockGetString(GLenum)
+	{
+		CountMockCall(GLFunction::GetString);
+		return (const GLubyte*)"LeoEngine mock backend";
+	}
+
+	static void* APIENTRY MockMapBufferRange(GLenum, GLintptr, GLsizeiptr length, GLbitfield)
+	{
+		CountMockCall(GLFunction::MapBufferRange);
+		g_mockMappings.push_back(std::make_unique<u8[]>(length));
+		return g_mockMappings.back().get();
+	}
+
+	static GLsync APIENTRY MockFenceSync(GLenum, GLbitfield)
+	{
+		CountMockCall(GLFunction::FenceSync);
+		return reinterpret_cast<GLsync>((u64)++g_mockNextId);
+	}
+
+	static GLenum APIENTRY MockClientWaitSync(GLsync, GLbitfield, GLuint64)
+	{
+		CountMockCall(GLFunction::ClientWaitSync);
+		return GL_ALREADY_SIGNALED;
+	}
+
+	void InstallMockGLBackend()
+	{
+		LEOASSERT(!g_mockInstalled, "The mock GL backend is already installed");
+
+#define LEO_GL_INSTALL(name)                                                                   \
+		g_saved.name = glad_gl##name;                                                          \
+		glad_gl##name = &MockStub<GLFunction::name, decltype(glad_gl##name)>::Call;
+		LEO_GL_FUNCTIONS(LEO_GL_INSTALL)
+#undef LEO_GL_INSTALL
+
+		glad_glGenBuffers = &MockGen<GLFunction::GenBuffers>;
+		glad_glGenFramebuffers = &MockGen<GLFunction::GenFramebuffers>;
+		glad_glGenTextures = &MockGen<GLFunction::GenTextures>;
+		glad_glGenVertexArrays = &MockGen<GLFunction::GenVertexArrays>;
+		glad_glCreateShader = &MockCreate<GLFunction::CreateShader>;
+		glad_glCreateProgram = &MockCreateProgram;
+		glad_glGetShaderiv = &MockGetObjectiv<GLFunction::GetShaderiv>;
+		glad_glGetProgramiv = &MockGetObjectiv<GLFunction::GetProgramiv>;
+		glad_glGetIntegerv = &MockGetIntegerv;
+		glad_glCheckFramebufferStatus = &MockCheckFramebufferStatus;
+		glad_glGetString = &MockGetString;
+		glad_glMapBufferRange = &MockMapBufferRange;
+		glad_glFenceSync = &MockFenceSync;
+		glad_glClientWaitSync = &MockClientWaitSync;
+
+		g_mockCounts = {};
+		g_mockTrace.clear();
+		g_mockInstalled = true;
+	}
+
+	void RestoreGLBackend()
+	{
+		LEOASSERT(g_mockInstalled, "The mock GL backend is not installed");
+
+#define LEO_GL_RESTORE(name) glad_gl##name = g_saved.name;
+		LEO_GL_FUNCTIONS(LEO_GL_RESTORE)
+#undef LEO_GL_RESTORE
+
+		g_mockMappings.clear();
+		g_mockTrace.clear();
+		g_mockTraceEnabled = false;
+		g_mockInstalled = false;
+	}
+
+	bool IsMockGLBackendInstalled()
+	{
+		return g_mockInstalled;
+	}
+
+	const GLCallCounts& GetMockGLCallCounts()
+	{
+		return g_mockCounts;
+	}
+
+	void ResetMockGLCallCounts()
+	{
+		g_mockCounts = {};
+		g_mockTrace.clear();
+	}
+
+	void EnableMockGLCallTrace(bool enable)
+	{
+		g_mockTraceEnabled = enable;
+	}
+
+	std::span<const GLFunction> GetMockGLCallTrace()
+	{
+		return g_mockTrace;
+	}
+}
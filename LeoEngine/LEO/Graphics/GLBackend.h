@@ -0,0 +1,145 @@
+#pragma once
+#include <span>
+#include <LEO/Utilities/LeoTypes.h>
+
+/*
+* Every OpenGL entry point used by LEO/Graphics.
+* The engine calls OpenGL only through the glad function table (glX is a macro for the glad_glX pointer),
+* so the whole backend can be swapped by rewriting these entries, this is what the mock backend does.
+* Keep the list sorted, a function missing here is not counted (and crashes) under the mock backend.
+*/
+#define LEO_GL_FUNCTIONS(X)                \
+	X(ActiveTexture)                       \
+	X(AttachShader)                        \
+	X(BindBuffer)                          \
+	X(BindBufferBase)                      \
+	X(BindBufferRange)                     \
+	X(BindFramebuffer)                     \
+	X(BindTexture)                         \
+	X(BindVertexArray)                     \
+	X(BlendFunc)                           \
+	X(BufferData)                          \
+	X(BufferStorage)                       \
+	X(BufferSubData)                       \
+	X(CheckFramebufferStatus)              \
+	X(Clear)                               \
+	X(ClearColor)                          \
+	X(ClearDepth)                          \
+	X(ClientWaitSync)                      \
+	X(CompileShader)                       \
+	X(CopyBufferSubData)                   \
+	X(CreateProgram)                       \
+	X(CreateShader)                        \
+	X(DebugMessageCallback)                \
+	X(DebugMessageControl)                 \
+	X(DeleteBuffers)                       \
+	X(DeleteFramebuffers)                  \
+	X(DeleteProgram)                       \
+	X(DeleteShader)                        \
+	X(DeleteSync)                          \
+	X(DeleteTextures)                      \
+	X(DeleteVertexArrays)                  \
+	X(DepthFunc)                           \
+	X(Disable)                             \
+	X(DrawBuffer)                          \
+	X(DrawBuffers)                         \
+	X(DrawElements)                        \
+	X(DrawElementsInstanced)               \
+	X(DrawElementsInstancedBaseInstance)   \
+	X(Enable)                              \
+	X(EnableVertexAttribArray)             \
+	X(FenceSync)                           \
+	X(FramebufferTexture)                  \
+	X(FramebufferTexture2D)                \
+	X(GenBuffers)                          \
+	X(GenFramebuffers)                     \
+	X(GenTextures)                         \
+	X(GenVertexArrays)                     \
+	X(GenerateMipmap)                      \
+	X(GetActiveUniform)                    \
+	X(GetFloatv)                           \
+	X(GetIntegerv)                         \
+	X(GetProgramBinary)                    \
+	X(GetProgramInfoLog)                   \
+	X(GetProgramiv)                        \
+	X(GetShaderInfoLog)                    \
+	X(GetShaderiv)                         \
+	X(GetString)                           \
+	X(GetUniformLocation)                  \
+	X(IsEnabled)                           \
+	X(LinkProgram)                         \
+	X(MapBufferRange)                      \
+	X(MaxShaderCompilerThreadsARB)         \
+	X(MaxShaderCompilerThreadsKHR)         \
+	X(ProgramBinary)                       \
+	X(ProgramParameteri)                   \
+	X(ReadBuffer)                          \
+	X(ShaderSource)                        \
+	X(TexImage1D)                          \
+	X(TexImage2D)                          \
+	X(TexImage3D)                          \
+	X(TexParameterf)                       \
+	X(TexParameteri)                       \
+	X(TexSubImage1D)                       \
+	X(TexSubImage2D)                       \
+	X(TexSubImage3D)                       \
+	X(Uniform1f)                           \
+	X(Uniform1i)                           \
+	X(Uniform1ui)                          \
+	X(Uniform2f)                           \
+	X(Uniform2fv)                          \
+	X(Uniform3f)                           \
+	X(Uniform3fv)                          \
+	X(Uniform3i)                           \
+	X(Uniform3ui)                          \
+	X(Uniform4f)                           \
+	X(UniformMatrix3fv)                    \
+	X(UniformMatrix4fv)                    \
+	X(UnmapBuffer)                         \
+	X(UseProgram)                          \
+	X(ValidateProgram)                     \
+	X(VertexAttribDivisor)                 \
+	X(VertexAttribPointer)
+
+namespace leo
+{
+	enum class GLFunction : u32
+	{
+#define LEO_GL_ENUM(name) name,
+		LEO_GL_FUNCTIONS(LEO_GL_ENUM)
+#undef LEO_GL_ENUM
+		Count
+	};
+
+	const char* GLFunctionName(GLFunction function);
+
+	// Number of calls per entry point made while the mock backend is installed
+	struct GLCallCounts
+	{
+		u64 calls[(u32)GLFunction::Count] = {};
+
+		u64 operator[](GLFunction function) const { return calls[(u32)function]; }
+		u64 Total() const;
+	};
+
+	/// <summary>
+	/// Replaces every entry of LEO_GL_FUNCTIONS with a stub that only counts the call.
+	/// Gen/Create functions return increasing ids, status queries report success, fences are always signaled
+	/// and mapped buffers point to host memory (valid until RestoreGLBackend),
+	/// so the Graphics classes can be created and used without an OpenGL context.
+	/// </summary>
+	void InstallMockGLBackend();
+
+	// Puts back the entries saved by InstallMockGLBackend
+	void RestoreGLBackend();
+
+	bool IsMockGLBackendInstalled();
+
+	const GLCallCounts& GetMockGLCallCounts();
+	// Also clears the trace
+	void ResetMockGLCallCounts();
+
+	// Records the order of the mock calls too (off by default), the trace is cleared by ResetMockGLCallCounts
+	void EnableMockGLCallTrace(bool enable);
+	std::span<const GLFunction> GetMockGLCallTrace();
+}
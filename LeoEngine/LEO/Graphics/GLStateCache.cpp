@@ -0,0 +1,270 @@
+#include <glad/glad.h>
+#include <LEO/Log/LeoAssert.h>
+#include "GLStateCache.h"
+
+namespace leo
+{
+	static constexpr u32 k_capabilities[] = { GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE, GL_SCISSOR_TEST };
+
+	GLStateCache& GetGLStateCache()
+	{
+		static GLStateCache cache;
+		return cache;
+	}
+
+	void GLStateCache::Invalidate()
+	{
+		m_program = UNKNOWN;
+		m_vertexArray = UNKNOWN;
+		m_arrayBuffer = UNKNOWN;
+		m_elementBuffer = UNKNOWN;
+		m_uniformBuffer = UNKNOWN;
+		m_framebuffer = UNKNOWN;
+
+		for (UniformRange& range : m_uniformBindings) range = { UNKNOWN, 0, 0 };
+
+		m_activeUnit = UNKNOWN;
+		for (auto& unit : m_textures) {
+			for (u32& texture : unit) texture = UNKNOWN;
+		}
+
+		for (u32& capability : m_capabilities) capability = UNKNOWN;
+		m_blendSrc = UNKNOWN;
+		m_blendDst = UNKNOWN;
+		m_depthFunc = UNKNOWN;
+	}
+
+	bool GLStateCache::Change(u32& tracked, u32 value)
+	{
+		if (tracked == value && !m_bypass)
+		{
+			m_stats.skipped++;
+			return false;
+		}
+
+		tracked = value;
+		m_stats.issued++;
+		return true;
+	}
+
+	i32 GLStateCache::TextureTargetIndex(u32 target)
+	{
+		switch (target)
+		{
+		case GL_TEXTURE_1D:       return 0;
+		case GL_TEXTURE_2D:       return 1;
+		case GL_TEXTURE_3D:       return 2;
+		case GL_TEXTURE_2D_ARRAY: return 3;
+		default:                  return -1;
+		}
+	}
+
+	i32 GLStateCache::CapabilityIndex(u32 capability)
+	{
+		for (i32 i = 0; i < (i32)CAPABILITIES; i++) {
+			if (k_capabilities[i] == capability) return i;
+		}
+		return -1;
+	}
+
+	void GLStateCache::UseProgram(u32 program)
+	{
+		if (Change(m_program, program)) {
+			glUseProgram(program);
+		}
+	}
+
+	void GLStateCache::BindVertexArray(u32 vao)
+	{
+		if (Change(m_vertexArray, vao))
+		{
+			glBindVertexArray(vao);
+			m_elementBuffer = UNKNOWN;
+		}
+	}
+
+	void GLStateCache::BindBuffer(u32 target, u32 buffer)
+	{
+		u32* tracked = nullptr;
+		switch (target)
+		{
+		case GL_ARRAY_BUFFER:         tracked = &m_arrayBuffer; break;
+		case GL_ELEMENT_ARRAY_BUFFER: tracked = &m_elementBuffer; break;
+		case GL_UNIFORM_BUFFER:       tracked = &m_uniformBuffer; break;
+		default:
+			m_stats.issued++;
+			glBindBuffer(target, buffer);
+			return;
+		}
+
+		if (Change(*tracked, buffer)) {
+			glBindBuffer(target, buffer);
+		}
+	}
+
+	void GLStateCache::BindFramebuffer(u32 framebuffer)
+	{
+		if (Change(m_framebuffer, framebuffer)) {
+			glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		}
+	}
+
+	void GLStateCache::BindUniformBuffer(u32 binding, u32 buffer, u32 offset, u32 size)
+	{
+		LEOASSERTF(binding < MAX_UNIFORM_BINDINGS, "Uniform binding {} is out of range (max {})", binding, MAX_UNIFORM_BINDINGS);
+
+		UniformRange& range = m_uniformBindings[binding];
+		if (range.buffer == buffer && range.offset == offset && range.size == size && !m_bypass)
+		{
+			m_stats.skipped++;
+			return;
+		}
+
+		range = { buffer, offset, size };
+		m_uniformBuffer = buffer;
+		m_stats.issued++;
+
+		if (size == 0) glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+		else glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, offset, size);
+	}
+
+	void GLStateCache::ActiveTexture(u32 unit)
+	{
+		LEOASSERTF(unit < MAX_TEXTURE_UNITS, "Texture unit {} is out of range (max {})", unit, MAX_TEXTURE_UNITS);
+
+		if (Change(m_activeUnit, unit)) {
+			glActiveTexture(GL_TEXTURE0 + unit);
+		}
+	}
+
+	void GLStateCache::BindTexture(u32 target, u32 texture)
+	{
+		i32 index = TextureTargetIndex(target);
+		if (index < 0 || m_activeUnit == UNKNOWN)
+		{
+			// the unit is unknown, the binding can't be recorded
+			if (index >= 0) {
+				for (auto& unit : m_textures) unit[index] = UNKNOWN;
+			}
+			m_stats.issued++;
+			glBindTexture(target, texture);
+			return;
+		}
+
+		if (Change(m_textures[m_activeUnit][index], texture)) {
+			glBindTexture(target, texture);
+		}
+	}
+
+	void GLStateCache::BindTextureUnit(u32 unit, u32 target, u32 texture)
+	{
+		i32 index = TextureTargetIndex(target);
+
+		// nothing to do, not even the unit switch
+		if (index >= 0 && unit < MAX_TEXTURE_UNITS && m_textures[unit][index] == texture && !m_bypass)
+		{
+			m_stats.skipped++;
+			return;
+		}
+
+		ActiveTexture(unit);
+		BindTexture(target, texture);
+	}
+
+	void GLStateCache::SetEnabled(u32 capability, bool enabled)
+	{
+		i32 index = CapabilityIndex(capability);
+		if (index >= 0 && !Change(m_capabilities[index], enabled ? 1 : 0)) return;
+		if (index < 0) m_stats.issued++;
+
+		if (enabled) glEnable(capability);
+		else glDisable(capability);
+	}
+
+	bool GLStateCache::IsEnabled(u32 capability)
+	{
+		i32 index = CapabilityIndex(capability);
+		if (index >= 0 && m_capabilities[index] != UNKNOWN) {
+			return m_capabilities[index] == 1;
+		}
+
+		bool enabled = glIsEnabled(capability) == GL_TRUE;
+		if (index >= 0) m_capabilities[index] = enabled ? 1 : 0;
+		return enabled;
+	}
+
+	void GLStateCache::BlendFunc(u32 src, u32 dst)
+	{
+		if (m_blendSrc == src && m_blendDst == dst && !m_bypass)
+		{
+			m_stats.skipped++;
+			return;
+		}
+
+		m_blendSrc = src;
+		m_blendDst = dst;
+		m_stats.issued++;
+		glBlendFunc(src, dst);
+	}
+
+	void GLStateCache::DepthFunc(u32 func)
+	{
+		if (Change(m_depthFunc, func)) {
+			glDepthFunc(func);
+		}
+	}
+
+	void GLStateCache::DeleteProgram(u32 program)
+	{
+		if (program == 0) return;
+
+		// a deleted program stays in use until another one is bound, its id can be handed out again
+		if (m_program == program) m_program = UNKNOWN;
+		glDeleteProgram(program);
+	}
+
+	void GLStateCache::DeleteVertexArray(u32 vao)
+	{
+		if (vao == 0) return;
+
+		if (m_vertexArray == vao)
+		{
+			m_vertexArray = 0;
+			m_elementBuffer = UNKNOWN;
+		}
+		glDeleteVertexArrays(1, &vao);
+	}
+
+	void GLStateCache::DeleteBuffer(u32 buffer)
+	{
+		if (buffer == 0) return;
+
+		if (m_arrayBuffer == buffer) m_arrayBuffer = 0;
+		if (m_elementBuffer == buffer) m_elementBuffer = 0;
+		if (m_uniformBuffer == buffer) m_uniformBuffer = 0;
+		for (UniformRange& range : m_uniformBindings) {
+			if (range.buffer == buffer) range = { 0, 0, 0 };
+		}
+		glDeleteBuffers(1, &buffer);
+	}
+
+	void GLStateCache::DeleteTexture(u32 texture)
+	{
+		if (texture == 0) return;
+
+		for (auto& unit : m_textures) {
+			for (u32& bound : unit) {
+				if (bound == texture) bound = 0;
+			}
+		}
+		glDeleteTextures(1, &texture);
+	}
+
+	void GLStateCache::DeleteFramebuffer(u32 framebuffer)
+	{
+		if (framebuffer == 0) return;
+
+		if (m_framebuffer == framebuffer) m_framebuffer = 0;
+		glDeleteFramebuffers(1, &framebuffer);
+	}
+}
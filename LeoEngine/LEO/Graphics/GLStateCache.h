@@ -0,0 +1,102 @@
+#pragma once
+#include <LEO/Utilities/LeoTypes.h>
+
+namespace leo
+{
+	struct GLStateCacheStats
+	{
+		u64 issued  = 0; // state calls sent to OpenGL
+		u64 skipped = 0; // state calls dropped because the value was already set
+	};
+
+	/// <summary>
+	/// Shadow copy of the OpenGL binding and capability state of the context, calls that would not
+	/// change the state are skipped. Every state change in LEO/Graphics goes through it, state changed
+	/// with raw gl calls must be followed by Invalidate (or the matching cache call).
+	/// Unknown state (after Invalidate) is always issued. The GL context is single threaded, so is this.
+	/// </summary>
+	class GLStateCache
+	{
+	public:
+		static constexpr u32 MAX_TEXTURE_UNITS = 32;
+		static constexpr u32 MAX_UNIFORM_BINDINGS = 16;
+	public:
+		GLStateCache() { Invalidate(); }
+	public:
+		// Forget everything, the next call of each kind is issued
+		void Invalidate();
+
+		// Issue every call (the tracked state is still updated), used to measure the cache
+		void SetBypass(bool bypass) { m_bypass = bypass; }
+		bool IsBypassed() const { return m_bypass; }
+
+		void UseProgram(u32 program);
+		// the element buffer binding is part of the vertex array, it is forgotten on a VAO change
+		void BindVertexArray(u32 vao);
+		// GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER and GL_UNIFORM_BUFFER are tracked, other targets are passed through
+		void BindBuffer(u32 target, u32 buffer);
+		void BindFramebuffer(u32 framebuffer);
+		// indexed GL_UNIFORM_BUFFER binding, size 0 binds the whole buffer; also sets the generic binding like GL does
+		void BindUniformBuffer(u32 binding, u32 buffer, u32 offset = 0, u32 size = 0);
+
+		void ActiveTexture(u32 unit);
+		// binds on the active unit
+		void BindTexture(u32 target, u32 texture);
+		void BindTextureUnit(u32 unit, u32 target, u32 texture);
+
+		// GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE and GL_SCISSOR_TEST are tracked, other capabilities are passed through
+		void SetEnabled(u32 capability, bool enabled);
+		bool IsEnabled(u32 capability);
+		void BlendFunc(u32 src, u32 dst);
+		void DepthFunc(u32 func);
+
+		// Deleting an object unbinds it, these keep the cache in sync
+		void DeleteProgram(u32 program);
+		void DeleteVertexArray(u32 vao);
+		void DeleteBuffer(u32 buffer);
+		void DeleteTexture(u32 texture);
+		void DeleteFramebuffer(u32 framebuffer);
+	public:
+		const GLStateCacheStats& Stats() const { return m_stats; }
+		void ResetStats() { m_stats = {}; }
+	private:
+		static constexpr u32 UNKNOWN = 0xFFFFFFFF;
+		static constexpr u32 TEXTURE_TARGETS = 4; // 1D, 2D, 3D, 2D array
+		static constexpr u32 CAPABILITIES = 4;
+	private:
+		// true when the call has to be issued, updates the tracked value and the stats
+		bool Change(u32& tracked, u32 value);
+		static i32 TextureTargetIndex(u32 target);
+		static i32 CapabilityIndex(u32 capability);
+	private:
+		bool m_bypass = false;
+
+		u32 m_program;
+		u32 m_vertexArray;
+		u32 m_arrayBuffer;
+		u32 m_elementBuffer;
+		u32 m_uniformBuffer;
+		u32 m_framebuffer;
+
+		u32 m_activeUnit;
+		u32 m_textures[MAX_TEXTURE_UNITS][TEXTURE_TARGETS];
+
+		struct UniformRange
+		{
+			u32 buffer;
+			u32 offset;
+			u32 size;
+		};
+		UniformRange m_uniformBindings[MAX_UNIFORM_BINDINGS];
+
+		u32 m_capabilities[CAPABILITIES]; // 0, 1 or UNKNOWN
+		u32 m_blendSrc;
+		u32 m_blendDst;
+		u32 m_depthFunc;
+
+		GLStateCacheStats m_stats;
+	};
+
+	// The cache of the engine's OpenGL context
+	GLStateCache& GetGLStateCache();
+}
@@ -31,7 +31,7 @@ namespace leo
 		LEOCHECK(false, GenarateOpenGLErrorMessage(source, type, id, severity, length, message, userParam));
 	}
 
-	void leo::GraphicsInitialization()
+	void GraphicsInitialization()
 	{
 		LEOASSERT(g_innitglad == false, "GLAD is already Initialized.");
 
@@ -54,6 +54,9 @@ namespace leo
 
 		// print OpenGL version
 		LEOLOGINFO("Using OpenGL {}", (const char*)glGetString(GL_VERSION));
+
+		// nothing is known about the new context
+		GetGLStateCache().Invalidate();
 		g_innitglad = true;
 	}
 
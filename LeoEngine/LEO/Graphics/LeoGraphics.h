@@ -1,9 +1,29 @@
 #pragma once
+#include "GLBackend.h"
+#include "GLStateCache.h"
 #include "BufferObjects.h"
+#include "VertexPacking.h"
+#include "StreamBuffer.h"
+#include "UniformBuffer.h"
 #include "Mesh.h"
+#include "MeshFile.h"
+#include "ObjImporter.h"
+#include "MeshOptimizer.h"
 #include "Shader.h"
+#include "ShaderCache.h"
+#include "ShaderCompiler.h"
+#include "Culling.h"
 #include "Texture.h"
+#include "TextureFile.h"
+#include "TextureLoader.h"
+#include "TextureAtlas.h"
 #include "FrameBuffer.h"
+#include "Renderer2D.h"
+#include "CircleRenderer.h"
+#include "RenderQueue.h"
+#include "CommandList.h"
+#include "RenderBackend.h"
+#include "RenderThread.h"
 
 namespace leo
 {
@@ -1,5 +1,12 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+#include <LEO/Log/Log.h>
+#include <LEO/Utilities/LeoFileUtilities.h>
+#include <LEO/Utilities/LeoTimer.h>
+#include "MeshFile.h"
+#include "ObjImporter.h"
+#include "MeshOptimizer.h"
+#include "VertexPacking.h"
 #include "Mesh.h"
 
 
@@ -24,16 +31,14 @@ namespace leo
 		:
 		m_vertexArray(std::move(va)),
 		m_indexBuffer(std::move(ib)),
-		m_layout_size(layout_size),
-		m_count(0)
+		m_layout_size(layout_size)
 	{}
 
 	Mesh::Mesh(VertexArray& va, IndexBuffer& ib, u32 layout_size, const glm::mat4* model_arr, u32 count)
 		:
 		m_vertexArray(std::move(va)),
 		m_indexBuffer(std::move(ib)),
-		m_layout_size(layout_size),
-		m_count(0)
+		m_layout_size(layout_size)
 	{
 		LEOASSERT(model_arr != nullptr, "model array is null");
 		LEOASSERT(count != 0, "count can't be 0");
@@ -43,47 +48,76 @@ namespace leo
 
 	Mesh::Mesh(Mesh&& other) noexcept
 		:
+		m_instanceCount(other.m_instanceCount),
+		m_instanceUploaded(other.m_instanceUploaded),
+		m_instanceCapacity(other.m_instanceCapacity),
+		m_instanceAttrib(other.m_instanceAttrib),
+		m_layout_size(other.m_layout_size),
 		m_vertexArray(std::move(other.m_vertexArray)),
 		m_indexBuffer(std::move(other.m_indexBuffer)),
-		m_layout_size(other.m_layout_size),
-		m_count(other.m_count)
-	{}
+		m_instanceBuffer(std::move(other.m_instanceBuffer)),
+		m_bounds(other.m_bounds)
+	{
+		other.m_instanceCount = 0;
+		other.m_instanceUploaded = 0;
+		other.m_instanceCapacity = 0;
+		other.m_layout_size = 0;
+	}
 
 	Mesh& Mesh::operator=(Mesh&& other) noexcept
 	{
 		m_vertexArray = std::move(other.m_vertexArray);
 		m_indexBuffer = std::move(other.m_indexBuffer);
+		m_instanceBuffer = std::move(other.m_instanceBuffer);
 		m_layout_size = other.m_layout_size;
-		m_count = other.m_count;
+		m_instanceCount = other.m_instanceCount;
+		m_instanceUploaded = other.m_instanceUploaded;
+		m_instanceCapacity = other.m_instanceCapacity;
+		m_instanceAttrib = other.m_instanceAttrib;
+		m_bounds = other.m_bounds;
 
-		m_layout_size = 0;
-		m_count = 0;
+		other.m_layout_size = 0;
+		other.m_instanceCount = 0;
+		other.m_instanceUploaded = 0;
+		other.m_instanceCapacity = 0;
 
 		return *this;
 	}
 
 	void Mesh::Draw() const
+	{
+		Bind();
+		DrawBound();
+	}
+
+	void Mesh::Bind() const
 	{
 		m_vertexArray.Bind();
 		m_indexBuffer.Bind();
+	}
 
-		if (m_count == 0)
+	void Mesh::UnBind() const
+	{
+		m_vertexArray.UnBind();
+		m_indexBuffer.UnBind();
+	}
+
+	void Mesh::DrawBound() const
+	{
+		if (!HasInstanceArray())
 		{
-			glDrawElements(GL_TRIANGLES, m_indexBuffer.GetCount(), GL_UNSIGNED_INT, nullptr);
+			glDrawElements(GL_TRIANGLES, m_indexBuffer.GetCount(), m_indexBuffer.GetIndexType(), nullptr);
 		}
-		else
+		else if (m_instanceCount != 0)
 		{
 			glDrawElementsInstanced(GL_TRIANGLES, m_indexBuffer.GetCount(),
-				GL_UNSIGNED_INT, nullptr, m_count);
+				m_indexBuffer.GetIndexType(), nullptr, m_instanceCount);
 		}
-		
-		m_vertexArray.UnBind();
-		m_indexBuffer.UnBind();
 	}
 
 	bool Mesh::HasInstanceArray() const
 	{
-		return m_count != 0;
+		return m_instanceCapacity != 0;
 	}
 
 	void Mesh::MakeInstancedArray(const glm::mat4* model_arr, u32 count)
@@ -91,13 +125,59 @@ namespace leo
 		LEOASSERT(model_arr != nullptr, "model array is null");
 		LEOASSERT(count != 0, "count can not be zero");
 
-		m_count = count;
+		UpdateInstances(std::span<const glm::mat4>(model_arr, count));
+		SetInstanceCount(count);
+	}
+
+	void Mesh::UpdateInstances(std::span<const glm::mat4> transforms, u32 offset)
+	{
+		LEOASSERTF(offset <= m_instanceUploaded, "Instances written at {}, past the {} uploaded ones", offset, m_instanceUploaded);
+		if (transforms.empty()) return;
+
+		u32 end = offset + (u32)transforms.size();
+
+		// every uploaded instance is replaced, nothing has to be kept
+		bool rewrite = offset == 0 && end >= m_instanceUploaded;
+		if (rewrite) m_instanceUploaded = 0;
+
+		u32 capacity = m_instanceCapacity;
+		ReserveInstances(end);
+		if (rewrite && capacity == m_instanceCapacity) {
+			m_instanceBuffer.Orphan();
+		}
+
+		m_instanceBuffer.SetSubData(offset * (u32)sizeof(glm::mat4), transforms.data(), (u32)transforms.size_bytes());
+		m_instanceUploaded = glm::max(m_instanceUploaded, end);
+		m_instanceCount = rewrite ? end : glm::max(m_instanceCount, end);
+	}
+
+	void Mesh::ReserveInstances(u32 capacity)
+	{
+		if (capacity <= m_instanceCapacity) return;
+
+		u32 new_capacity = glm::max(capacity, m_instanceCapacity + m_instanceCapacity / 2);
+		VertexBuffer buffer(nullptr, new_capacity * (u32)sizeof(glm::mat4), BufferUsage::Dynamic);
+		buffer.CopyFrom(m_instanceBuffer, m_instanceUploaded * (u32)sizeof(glm::mat4));
+
+		// the slots are taken once, a reallocation points the same attributes to the new buffer
+		if (m_instanceCapacity == 0)
+		{
+			m_instanceAttrib = m_layout_size;
+			m_layout_size += 4;
+		}
 
-		leo::VertexBuffer model_VBO(model_arr, m_count * sizeof(glm::mat4));
 		leo::ElementType layout_arr[1] = { leo::ElementType::MAT4 };
 		leo::Layout<1> layout(layout_arr);
-		m_vertexArray.AddBuffer(std::move(model_VBO), layout, m_layout_size, true);
-		m_layout_size += 4;
+		m_vertexArray.AttachBuffer(buffer.ID(), layout, m_instanceAttrib, true);
+
+		m_instanceBuffer = std::move(buffer);
+		m_instanceCapacity = new_capacity;
+	}
+
+	void Mesh::SetInstanceCount(u32 count)
+	{
+		LEOASSERTF(count <= m_instanceUploaded, "{} instances drawn, {} were uploaded", count, m_instanceUploaded);
+		m_instanceCount = count;
 	}
 
 	Mesh Mesh::GenerateMesh(DefaultMesh shape)
@@ -111,6 +191,75 @@ namespace leo
 		}
 	}
 
+	Mesh Mesh::Load(const std::string& filepath)
+	{
+		Timer timer;
+
+		MappedFile file(filepath);
+		if (!file.IsOpen())
+		{
+			LEOLOGERROR("Failed to open the mesh {}", filepath);
+			return Mesh{};
+		}
+
+		// every index is range checked, a corrupt or foreign file would have the GPU read past the vertex buffer.
+		// The upload reads the index pages right after, they are touched once more from the cache
+		std::string error = ValidateMeshFile(file.Bytes());
+		if (!error.empty())
+		{
+			LEOLOGERROR("Invalid mesh {}: {}", filepath, error);
+			return Mesh{};
+		}
+
+		MeshFileView view = ViewMeshFile(file.Bytes());
+
+		VertexArray vertexArray;
+		vertexArray.AddBuffer(VertexBuffer(view.vertices.data(), (u32)view.vertices.size()), view.layout);
+
+		IndexBuffer indexBuffer = view.header->indexSize == sizeof(u16)
+			? IndexBuffer(reinterpret_cast<const u16*>(view.indices.data()), view.header->indexCount)
+			: IndexBuffer(reinterpret_cast<const u32*>(view.indices.data()), view.header->indexCount);
+
+		Mesh mesh{ vertexArray, indexBuffer, (u32)view.layout.size() };
+		mesh.m_bounds = view.Bounds();
+
+		LEOLOGVERBOSE("Loaded {}: {} vertices, {} indices in {:.2f}ms", filepath, view.header->vertexCount, view.header->indexCount, timer.ElapsedMillis());
+		return mesh;
+	}
+
+	Mesh Mesh::LoadObj(const std::string& filepath, ThreadPool* pool)
+	{
+		static_assert(sizeof(Vertex) == 8 * sizeof(f32), "Vertex is uploaded as FLOAT3 FLOAT2 FLOAT3");
+
+		ObjMeshData data = ImportObjFile(filepath, pool);
+		if (!data.error.empty())
+		{
+			LEOLOGERROR("Failed to import {}: {}", filepath, data.error);
+			return Mesh{};
+		}
+
+		const ObjImportStats& stats = data.stats;
+		LEOLOGVERBOSE("Imported {}: {} triangles, {} vertices ({} positions) in {:.2f}ms, {:.1f} MB/s",
+			filepath, stats.triangles, stats.vertices, stats.positions, stats.ms, stats.MBPerSecond());
+
+		VertexBuffer vertexBuffer(data.vertices.data(), (u32)(data.vertices.size() * sizeof(Vertex)));
+
+		ElementType arr[3] = { ElementType::FLOAT3, ElementType::FLOAT2, ElementType::FLOAT3_N };
+		Layout<3> layout(arr);
+
+		VertexArray vertexArray;
+		vertexArray.AddBuffer(std::move(vertexBuffer), layout);
+
+		IndexBuffer indexBuffer = IndexBuffer::CreateCompact(data.indices, (u32)data.vertices.size());
+
+		Mesh mesh{ vertexArray, indexBuffer, 3 };
+		if (!data.vertices.empty()) {
+			mesh.m_bounds = BoundingSphere::FromPositions(&data.vertices[0].pos.x, (u32)data.vertices.size(), 8);
+		}
+
+		return mesh;
+	}
+
 	Mesh Mesh::GenerateCube()
 	{
 		float vertexs[] = {
@@ -152,11 +301,14 @@ namespace leo
 			-0.5f, -0.5f,  0.5f,     0.0f, 1.0f,    0.0f, -1.0f,  0.0f,		 -1.0f, 0.0f, 0.0f,   0.0f,  0.0f, -1.0f //23
 		};
 
-		VertexBuffer vertexBuffer(vertexs, sizeof(vertexs));
-
-		ElementType arr[5] = { ElementType::FLOAT3, ElementType::FLOAT2, ElementType::FLOAT3_N, ElementType::FLOAT3_N, ElementType::FLOAT3_N };
+		// 24 bytes per vertex instead of 56
+		ElementType src[5] = { ElementType::FLOAT3, ElementType::FLOAT2, ElementType::FLOAT3, ElementType::FLOAT3, ElementType::FLOAT3 };
+		ElementType arr[5] = { ElementType::HALF4, ElementType::HALF2, ElementType::INT_2_10_10_10_N, ElementType::INT_2_10_10_10_N, ElementType::INT_2_10_10_10_N };
 		Layout<5> layout(arr);
 
+		std::vector<u8> packed = PackVertices(vertexs, src, arr);
+		VertexBuffer vertexBuffer(packed.data(), (u32)packed.size());
+
 		VertexArray vertexArray;
 		vertexArray.AddBuffer(std::move(vertexBuffer), layout);
 
@@ -175,9 +327,10 @@ namespace leo
 			// SOUTH
 			22, 23, 20, /**/ 22, 20, 21
 		};
-		IndexBuffer indexBuffer(indices, 36);
+		IndexBuffer indexBuffer = IndexBuffer::CreateCompact(indices, 24);
 
 		Mesh mesh{ vertexArray, indexBuffer, 5 };
+		mesh.m_bounds = BoundingSphere::FromAABB(glm::vec3(-0.5f), glm::vec3(0.5f));
 
 		return mesh;
 	}
@@ -249,18 +402,25 @@ namespace leo
 			//vertex_buffer.emplace_back(v.bitangent.z);
 		}
 
-		VertexBuffer vertexBuffer((const void*)vertex_buffer.data(), (u32)(vertex_buffer.size() * sizeof(float)));
+		// the grid order reuses a row of vertices only after the whole next row, too late for the cache
+		MeshOptimizationReport report = OptimizeMesh(vertex_buffer, 8, indices);
+		LEOLOGVERBOSE("Sphere {}: {}", prec, report.ToString());
 
-		ElementType arr[3] = { ElementType::FLOAT3, ElementType::FLOAT2, ElementType::FLOAT3_N };
+		// 16 bytes per vertex instead of 32
+		ElementType src[3] = { ElementType::FLOAT3, ElementType::FLOAT2, ElementType::FLOAT3 };
+		ElementType arr[3] = { ElementType::HALF4, ElementType::HALF2, ElementType::INT_2_10_10_10_N };
 		Layout<3> layout(arr);
 
+		std::vector<u8> packed = PackVertices(vertex_buffer, src, arr);
+		VertexBuffer vertexBuffer(packed.data(), (u32)packed.size());
+
 		VertexArray vertexArray;
 		vertexArray.AddBuffer(std::move(vertexBuffer), layout);
 
-
-		IndexBuffer indexBuffer(indices.data(), (u32)indices.size());
+		IndexBuffer indexBuffer = IndexBuffer::CreateCompact(indices, report.verticesAfter);
 
 		Mesh mesh{ vertexArray, indexBuffer, 3 };
+		mesh.m_bounds = BoundingSphere{ glm::vec3(0.0f), 1.0f };
 
 		return mesh;
 	}
@@ -275,11 +435,14 @@ namespace leo
 			-0.5f,  0.5f, 0.0f,            0.0f, (float)repet,     0.0f,  0.0f, 1.0f,  -1.0f,  0.0f, 0.0f,	0.0f,  -1.0f, 0.0f //3
 		};
 
-		VertexBuffer vertexBuffer(vertexs, sizeof(vertexs));
-
-		ElementType arr[5] = { ElementType::FLOAT3, ElementType::FLOAT2, ElementType::FLOAT3_N, ElementType::FLOAT3_N, ElementType::FLOAT3_N };
+		// 24 bytes per vertex instead of 56
+		ElementType src[5] = { ElementType::FLOAT3, ElementType::FLOAT2, ElementType::FLOAT3, ElementType::FLOAT3, ElementType::FLOAT3 };
+		ElementType arr[5] = { ElementType::HALF4, ElementType::HALF2, ElementType::INT_2_10_10_10_N, ElementType::INT_2_10_10_10_N, ElementType::INT_2_10_10_10_N };
 		Layout<5> layout(arr);
 
+		std::vector<u8> packed = PackVertices(vertexs, src, arr);
+		VertexBuffer vertexBuffer(packed.data(), (u32)packed.size());
+
 		VertexArray vertexArray;
 		vertexArray.AddBuffer(std::move(vertexBuffer), layout);
 
@@ -289,9 +452,10 @@ namespace leo
 			3, 0, 2
 		};
 
-		IndexBuffer indexBuffer(indices, 6);
+		IndexBuffer indexBuffer = IndexBuffer::CreateCompact(indices, 4);
 
 		Mesh mesh{ vertexArray, indexBuffer, 5 };
+		mesh.m_bounds = BoundingSphere::FromAABB(glm::vec3(-0.5f, -0.5f, 0.0f), glm::vec3(0.5f, 0.5f, 0.0f));
 
 		return mesh;
 	}
@@ -319,7 +483,7 @@ namespace leo
 			0, 2, 3
 		};
 
-		IndexBuffer indexBuffer(indices, 6);
+		IndexBuffer indexBuffer = IndexBuffer::CreateCompact(indices, 4);
 
 		Mesh mesh{ vertexArray, indexBuffer, 1 };
 		mesh.m_layout_size = 1;
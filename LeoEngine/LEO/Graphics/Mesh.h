@@ -1,6 +1,10 @@
 #pragma once
+#include <bit>
+#include <functional>
 #include <string>
+#include <span>
 #include "BufferObjects.h"
+#include "Culling.h"
 
 namespace leo
 {
@@ -46,7 +50,11 @@ namespace leo
         ~Mesh() = default;
     public:
         // Drawing
-        void Draw() const;
+        void Draw() const;       // binds and draws, the mesh stays bound (GLStateCache skips the rebind)
+
+        void Bind() const;
+        void UnBind() const;
+        void DrawBound() const;  // draws, the mesh must be bound (used to skip redundant binds)
     public:
         // Factory functions
         static Mesh GenerateMesh(DefaultMesh shape);
@@ -54,14 +62,71 @@ namespace leo
         static Mesh GenerateSphere(u32 precision = 48);
         static Mesh GenerateQuad(u32 repeat = 1);
         static Mesh GenerateScreenFilledQuad();
+
+        // Maps a .leomesh (MeshFile.h) and uploads its blobs straight from the mapped pages.
+        // An invalid file is logged and gives an empty mesh
+        static Mesh Load(const std::string& filepath);
+
+        // Imports a Wavefront OBJ (ObjImporter.h), parsed over the pool when there is one.
+        // A file that fails to import is logged and gives an empty mesh
+        static Mesh LoadObj(const std::string& filepath, ThreadPool* pool = nullptr);
     public:
-        // Instancing
+        // Instancing: one mat4 per instance, in the 4 attributes after the vertex layout
         bool HasInstanceArray() const;
+
+        // Replaces the instances, draws count instances
         void MakeInstancedArray(const glm::mat4* model_arr, u32 count);
+
+        // Uploads transforms to [offset, offset + size), offset at most the uploaded count. The drawn count grows to cover them.
+        // The buffer grows when needed, rewriting every uploaded instance from offset 0 orphans it instead of waiting on the GPU
+        void UpdateInstances(std::span<const glm::mat4> transforms, u32 offset = 0);
+
+        // Room for capacity instances (grows by at least 1.5x), the uploaded instances are kept
+        void ReserveInstances(u32 capacity);
+
+        // Number of instances drawn, at most the uploaded ones (e.g. the visible count after culling).
+        // Lowering it keeps the instances past it, they are still copied when the buffer grows
+        void SetInstanceCount(u32 count);
+
+        inline u32 GetInstanceCount() const { return m_instanceCount; }
+        inline u32 GetUploadedInstanceCount() const { return m_instanceUploaded; }
+        inline u32 GetInstanceCapacity() const { return m_instanceCapacity; }
+    public:
+        // Local space bounds, used to cull the instances (InstanceCuller). Unknown (never culled) unless set
+        inline const BoundingSphere& GetBounds() const { return m_bounds; }
+        void SetBounds(const BoundingSphere& bounds) { m_bounds = bounds; }
     private:
-        u32 m_count = 0;
+        u32 m_instanceCount = 0;    // drawn
+        u32 m_instanceUploaded = 0; // valid in the buffer, what a reallocation copies
+        u32 m_instanceCapacity = 0;
+        u32 m_instanceAttrib = 0; // first attribute of the instance mat4
         u32 m_layout_size = 0;
         VertexArray m_vertexArray;
         IndexBuffer m_indexBuffer;
+        VertexBuffer m_instanceBuffer;
+        BoundingSphere m_bounds;
     };
 }
+
+// Hash of the values, consistent with operator== (0.0 and -0.0 hash the same), for std::unordered_map<leo::Vertex, ...>
+template<>
+struct std::hash<leo::Vertex>
+{
+    size_t operator()(const leo::Vertex& v) const noexcept
+    {
+        const float values[8] = { v.pos.x, v.pos.y, v.pos.z, v.texCord.x, v.texCord.y, v.normal.x, v.normal.y, v.normal.z };
+
+        uint64_t hash = 14695981039346656037ull;
+        for (float value : values)
+        {
+            hash ^= std::bit_cast<uint32_t>(value + 0.0f); // -0.0 + 0.0 is 0.0
+            hash *= 1099511628211ull;
+        }
+
+        // the low bits select the bucket, mix the high ones in
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        return (size_t)hash;
+    }
+};
@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <filesystem>
+#include <vector>
+#include <LEO/Log/Log.h>
+#include "MeshFile.h"
+
+namespace leo
+{
+	static_assert(sizeof(ElementType) == sizeof(u32), "ElementType is stored as a u32");
+	static_assert(sizeof(MeshFileHeader) == 112, "The header layout is the file format");
+
+	static u64 AlignUp(u64 value)
+	{
+		return (value + MESH_FILE_ALIGNMENT - 1) & ~(u64)(MESH_FILE_ALIGNMENT - 1);
+	}
+
+	// the per vertex types, MAT4 is for instances (update when types are added after it)
+	static bool IsVertexElement(ElementType element)
+	{
+		return (u32)element < (u32)ElementType::MAT4;
+	}
+
+	BoundingSphere MeshFileView::Bounds() const
+	{
+		return BoundingSphere{ glm::vec3(header->boundsCenter[0], header->boundsCenter[1], header->boundsCenter[2]), header->boundsRadius };
+	}
+
+	bool WriteMeshFile(const std::string& filepath, std::span<const ElementType> layout, std::span<const u8> vertices,
+		std::span<const u32> indices, const BoundingSphere& bounds)
+	{
+		LEOASSERTF(!layout.empty() && layout.size() <= MESH_FILE_MAX_ATTRIBUTES, "A mesh file has 1 to {} attributes, not {}", MESH_FILE_MAX_ATTRIBUTES, layout.size());
+
+		u32 stride = 0;
+		for (ElementType element : layout)
+		{
+			LEOASSERT(IsVertexElement(element), "Only vertex attributes are stored in a mesh file");
+			stride += GetAttributeDesc(element).size_bytes;
+		}
+		LEOASSERTF(vertices.size() % stride == 0, "{} bytes is not a whole number of vertices of {} bytes", vertices.size(), stride);
+
+		MeshFileHeader header = {};
+		header.magic = MESH_FILE_MAGIC;
+		header.version = MESH_FILE_VERSION;
+		header.vertexCount = (u32)(vertices.size() / stride);
+		header.vertexStride = stride;
+		header.indexCount = (u32)indices.size();
+		header.indexSize = header.vertexCount <= 65536 ? sizeof(u16) : sizeof(u32);
+		header.attributeCount = (u32)layout.size();
+		header.vertexOffset = AlignUp(sizeof(MeshFileHeader));
+		header.indexOffset = AlignUp(header.vertexOffset + vertices.size());
+		header.boundsCenter[0] = bounds.center.x;
+		header.boundsCenter[1] = bounds.center.y;
+		header.boundsCenter[2] = bounds.center.z;
+		header.boundsRadius = bounds.radius;
+		std::copy(layout.begin(), layout.end(), header.attributes);
+
+		std::vector<u8> index_blob((u64)header.indexCount * header.indexSize);
+		for (u64 i = 0; i < indices.size(); i++)
+		{
+			if (indices[i] >= header.vertexCount)
+			{
+				LEOLOGERROR("Failed to write the mesh file {}: index {} is {}, the mesh has {} vertices", filepath, i, indices[i], header.vertexCount);
+				return false;
+			}
+			if (header.indexSize == sizeof(u16))
+			{
+				u16 index = (u16)indices[i];
+				std::memcpy(&index_blob[i * sizeof(u16)], &index, sizeof(u16));
+			}
+			else std::memcpy(&index_blob[i * sizeof(u32)], &indices[i], sizeof(u32));
+		}
+
+		// written next to the final file and renamed, a crash never leaves a truncated mesh behind
+		std::filesystem::path path = filepath;
+		std::filesystem::path temp = path;
+		temp += ".tmp";
+
+		{
+			static const char padding[MESH_FILE_ALIGNMENT] = {};
+
+			std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(padding, header.vertexOffset - sizeof(header));
+			file.write(reinterpret_cast<const char*>(vertices.data()), vertices.size());
+			file.write(padding, header.indexOffset - header.vertexOffset - vertices.size());
+			file.write(reinterpret_cast<const char*>(index_blob.data()), index_blob.size());
+			if (!file)
+			{
+				LEOLOGERROR("Failed to write the mesh file {}", temp.string());
+				return false;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temp, path, error);
+		if (error)
+		{
+			LEOLOGERROR("Failed to write the mesh file {}: {}", filepath, error.message());
+			std::filesystem::remove(temp, error);
+			return false;
+		}
+
+		return true;
+	}
+
+	std::string ValidateMeshFile(std::span<const u8> file, bool check_indices)
+	{
+		if (file.size() < sizeof(MeshFileHeader)) return std::format("{} bytes, smaller than the header", file.size());
+
+		MeshFileHeader header;
+		std::memcpy(&header, file.data(), sizeof(header));
+
+		if (header.magic != MESH_FILE_MAGIC)     return "not a .leomesh file";
+		if (header.version != MESH_FILE_VERSION) return std::format("version {}, expected {}", header.version, MESH_FILE_VERSION);
+
+		if (header.attributeCount == 0 || header.attributeCount > MESH_FILE_MAX_ATTRIBUTES) {
+			return std::format("{} attributes", header.attributeCount);
+		}
+
+		u32 stride = 0;
+		for (u32 i = 0; i < header.attributeCount; i++)
+		{
+			if (!IsVertexElement(header.attributes[i])) return std::format("attribute {} has the unknown type {}", i, (u32)header.attributes[i]);
+			stride += GetAttributeDesc(header.attributes[i]).size_bytes;
+		}
+		if (stride != header.vertexStride) return std::format("vertex stride {}, the layout is {} bytes", header.vertexStride, stride);
+
+		if (header.indexSize != sizeof(u16) && header.indexSize != sizeof(u32)) return std::format("index size {}", header.indexSize);
+		if (header.indexCount % 3 != 0) return std::format("{} indices is not a whole number of triangles", header.indexCount);
+
+		u64 vertex_bytes = (u64)header.vertexCount * header.vertexStride;
+		u64 index_bytes = (u64)header.indexCount * header.indexSize;
+
+		if (header.vertexOffset % MESH_FILE_ALIGNMENT != 0 || header.indexOffset % MESH_FILE_ALIGNMENT != 0) return "unaligned blobs";
+		if (header.vertexOffset > file.size() || header.indexOffset > file.size()) return "blob offsets past the end of the file";
+		if (header.vertexOffset < sizeof(MeshFileHeader) || header.indexOffset < header.vertexOffset + vertex_bytes) return "overlapping blobs";
+		if (index_bytes > file.size() - header.indexOffset) {
+			return std::format("truncated: {} bytes, the blobs end at {}", file.size(), header.indexOffset + index_bytes);
+		}
+
+		if (check_indices)
+		{
+			const u8* blob = file.data() + header.indexOffset;
+			for (u64 i = 0; i < header.indexCount; i++)
+			{
+				u32 index = 0;
+				if (header.indexSize == sizeof(u16))
+				{
+					u16 short_index;
+					std::memcpy(&short_index, blob + i * sizeof(u16), sizeof(u16));
+					index = short_index;
+				}
+				else std::memcpy(&index, blob + i * sizeof(u32), sizeof(u32));
+
+				if (index >= header.vertexCount) return std::format("index {} is {}, the mesh has {} vertices", i, index, header.vertexCount);
+			}
+		}
+
+		return {};
+	}
+
+	MeshFileView ViewMeshFile(std::span<const u8> file)
+	{
+		LEOASSERT(file.size() >= sizeof(MeshFileHeader), "ViewMeshFile needs a validated file");
+
+		MeshFileView view;
+		view.header = reinterpret_cast<const MeshFileHeader*>(file.data());
+		view.layout = { view.header->attributes, view.header->attributeCount };
+		view.vertices = file.subspan(view.header->vertexOffset, (u64)view.header->vertexCount * view.header->vertexStride);
+		view.indices = file.subspan(view.header->indexOffset, (u64)view.header->indexCount * view.header->indexSize);
+		return view;
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <span>
+#include <string>
+#include <LEO/Utilities/LeoTypes.h>
+#include "BufferObjects.h"
+#include "Culling.h"
+
+namespace leo
+{
+	constexpr u32 MESH_FILE_MAGIC          = 0x48534D4C; // "LMSH"
+	constexpr u32 MESH_FILE_VERSION        = 1;
+	constexpr u32 MESH_FILE_ALIGNMENT      = 64;         // the vertex and index blobs start on a cache line
+	constexpr u32 MESH_FILE_MAX_ATTRIBUTES = 12;
+
+	/// <summary>
+	/// Header of a .leomesh file, followed by the vertex blob and the index blob at aligned offsets.
+	/// The blobs are in the layout the GPU reads (little endian), a loader maps the file and uploads
+	/// them as they are: no parsing and no copy on the CPU side.
+	/// </summary>
+	struct MeshFileHeader
+	{
+		u32 magic;
+		u32 version;
+		u32 vertexCount;
+		u32 vertexStride;   // bytes, the stride of Layout(attributes)
+		u32 indexCount;
+		u32 indexSize;      // 2 or 4 bytes
+		u32 attributeCount;
+		u32 reserved;
+		u64 vertexOffset;   // from the start of the file
+		u64 indexOffset;
+		f32 boundsCenter[3];
+		f32 boundsRadius;
+		ElementType attributes[MESH_FILE_MAX_ATTRIBUTES];
+	};
+
+	// The blobs of a validated file, they point into the file bytes
+	struct MeshFileView
+	{
+		const MeshFileHeader* header = nullptr;
+		std::span<const ElementType> layout;
+		std::span<const u8> vertices;
+		std::span<const u8> indices;
+
+		BoundingSphere Bounds() const;
+	};
+
+	// Writes a .leomesh, the indices are stored in 16 bits when the vertex count allows it.
+	// vertices: vertex_count * stride of the layout bytes. Logs and returns false on failure (an index out of range included)
+	bool WriteMeshFile(const std::string& filepath, std::span<const ElementType> layout, std::span<const u8> vertices,
+		std::span<const u32> indices, const BoundingSphere& bounds = {});
+
+	// Empty when the bytes are a valid .leomesh, the reason otherwise.
+	// check_indices also reads every index to check its range (the whole file is touched)
+	std::string ValidateMeshFile(std::span<const u8> file, bool check_indices = true);
+
+	// The blobs of a file ValidateMeshFile accepted
+	MeshFileView ViewMeshFile(std::span<const u8> file);
+}
@@ -0,0 +1,367 @@
+#include <cmath>
+#include <format>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include <LEO/Log/Log.h>
+#include <LEO/Utilities/LeoTimer.h>
+#include "MeshOptimizer.h"
+
+namespace leo
+{
+	// ---------------- Analysis ----------------
+
+	/*
+	* FIFO cache simulated with timestamps: a vertex is in the cache if it was inserted
+	* less than cache_size insertions ago. Moving the time forward by cache_size empties it.
+	*/
+	struct FifoCache
+	{
+		std::vector<u32> timestamps;
+		u32 time;
+		u32 size;
+
+		FifoCache(u32 vertex_count, u32 cache_size)
+			:
+			timestamps(vertex_count, 0),
+			time(cache_size + 1),
+			size(cache_size)
+		{}
+
+		// returns the number of misses of the triangle
+		u32 Add(const u32* triangle)
+		{
+			u32 misses = 0;
+			for (u32 k = 0; k < 3; k++)
+			{
+				u32& stamp = timestamps[triangle[k]];
+				if (time - stamp > size)
+				{
+					stamp = time++;
+					misses++;
+				}
+			}
+			return misses;
+		}
+
+		void Reset() { time += size + 1; }
+	};
+
+	VertexCacheStats AnalyzeVertexCache(std::span<const u32> indices, u32 vertex_count, u32 cache_size)
+	{
+		VertexCacheStats stats;
+		u32 triangles = (u32)indices.size() / 3;
+		if (triangles == 0 || vertex_count == 0) return stats;
+
+		FifoCache cache(vertex_count, cache_size);
+		for (u32 t = 0; t < triangles; t++) {
+			stats.transformed += cache.Add(&indices[t * 3]);
+		}
+
+		stats.acmr = (f32)stats.transformed / (f32)triangles;
+		stats.atvr = (f32)stats.transformed / (f32)vertex_count;
+		return stats;
+	}
+
+	// ---------------- Vertex cache ----------------
+
+	static constexpr u32 k_forsythCacheSize = 32;
+	static constexpr u32 k_forsythMaxValence = 32; // the valence score is flat after this
+
+	struct ForsythTables
+	{
+		f32 cache[k_forsythCacheSize];
+		f32 valence[k_forsythMaxValence + 1];
+
+		ForsythTables()
+		{
+			// the last triangle's vertices get a fixed score, they are in the cache but
+			// reusing them right away does not help the strip-like order
+			for (u32 i = 0; i < k_forsythCacheSize; i++)
+			{
+				cache[i] = i < 3 ? 0.75f : std::pow(1.0f - (f32)(i - 3) / (f32)(k_forsythCacheSize - 3), 1.5f);
+			}
+
+			// vertices with few triangles left are finished first, so they leave no lone triangle behind
+			valence[0] = 0.0f;
+			for (u32 i = 1; i <= k_forsythMaxValence; i++)
+			{
+				valence[i] = 2.0f / std::sqrt((f32)i);
+			}
+		}
+	};
+
+	void OptimizeVertexCache(std::span<u32> indices, u32 vertex_count)
+	{
+		static const ForsythTables tables;
+
+		u32 triangles = (u32)indices.size() / 3;
+		if (triangles == 0) return;
+
+		// triangles of each vertex, the active ones first
+		std::vector<u32> active(vertex_count, 0);
+		for (u32 index : indices) {
+			LEOASSERTF(index < vertex_count, "Index {} out of range, the mesh has {} vertices", index, vertex_count);
+			active[index]++;
+		}
+
+		std::vector<u32> offsets(vertex_count + 1, 0);
+		for (u32 v = 0; v < vertex_count; v++) {
+			offsets[v + 1] = offsets[v] + active[v];
+		}
+
+		std::vector<u32> adjacency(indices.size());
+		{
+			std::vector<u32> fill(offsets.begin(), offsets.end() - 1);
+			for (u32 t = 0; t < triangles; t++)
+			{
+				for (u32 k = 0; k < 3; k++) {
+					adjacency[fill[indices[t * 3 + k]]++] = t;
+				}
+			}
+		}
+
+		std::vector<i32> cache_position(vertex_count, -1);
+		std::vector<f32> vertex_score(vertex_count);
+
+		auto score_of = [&](u32 v) {
+			if (active[v] == 0) return -1.0f;
+			f32 score = cache_position[v] >= 0 ? tables.cache[cache_position[v]] : 0.0f;
+			return score + tables.valence[std::min(active[v], k_forsythMaxValence)];
+		};
+
+		for (u32 v = 0; v < vertex_count; v++) {
+			vertex_score[v] = score_of(v);
+		}
+
+		std::vector<f32> triangle_score(triangles);
+		std::vector<bool> emitted(triangles, false);
+		for (u32 t = 0; t < triangles; t++) {
+			triangle_score[t] = vertex_score[indices[t * 3]] + vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+		}
+
+		u32 best = (u32)(std::max_element(triangle_score.begin(), triangle_score.end()) - triangle_score.begin());
+		u32 scan = 0; // the next triangle to try when the cache has no candidate left
+
+		std::vector<u32> output;
+		output.reserve(indices.size());
+
+		u32 cache[k_forsythCacheSize + 3];
+		u32 cache_count = 0;
+
+		for (u32 step = 0; step < triangles; step++)
+		{
+			if (best == ~0u)
+			{
+				while (emitted[scan]) scan++;
+				best = scan;
+			}
+
+			const u32 tri[3] = { indices[best * 3], indices[best * 3 + 1], indices[best * 3 + 2] };
+			output.insert(output.end(), tri, tri + 3);
+			emitted[best] = true;
+
+			// the triangle is no longer active for its vertices
+			for (u32 v : tri)
+			{
+				u32* begin = &adjacency[offsets[v]];
+				u32* it = std::find(begin, begin + active[v], best);
+				std::swap(*it, begin[active[v] - 1]);
+				active[v]--;
+			}
+
+			// the triangle's vertices go to the front, the others move back
+			u32 new_cache[k_forsythCacheSize + 3] = { tri[0], tri[1], tri[2] };
+			u32 new_count = 3;
+			for (u32 i = 0; i < cache_count; i++)
+			{
+				u32 v = cache[i];
+				if (v != tri[0] && v != tri[1] && v != tri[2]) new_cache[new_count++] = v;
+			}
+
+			for (u32 i = 0; i < new_count; i++)
+			{
+				u32 v = new_cache[i];
+				cache_position[v] = i < k_forsythCacheSize ? (i32)i : -1;
+				vertex_score[v] = score_of(v);
+			}
+
+			// rescore the triangles around the vertices that moved, the best one comes next
+			best = ~0u;
+			f32 best_score = -1.0f;
+			for (u32 i = 0; i < new_count; i++)
+			{
+				u32 v = new_cache[i];
+				for (u32 a = offsets[v]; a < offsets[v] + active[v]; a++)
+				{
+					u32 t = adjacency[a];
+					f32 score = vertex_score[indices[t * 3]] + vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+					triangle_score[t] = score;
+					if (score > best_score)
+					{
+						best_score = score;
+						best = t;
+					}
+				}
+			}
+
+			cache_count = std::min(new_count, k_forsythCacheSize);
+			std::copy(new_cache, new_cache + cache_count, cache);
+		}
+
+		std::copy(output.begin(), output.end(), indices.begin());
+	}
+
+	// ---------------- Overdraw ----------------
+
+	void OptimizeOverdraw(std::span<u32> indices, const f32* positions, u32 vertex_count, u32 stride, f32 threshold)
+	{
+		u32 triangles = (u32)indices.size() / 3;
+		if (triangles == 0) return;
+
+		// hard boundaries: a triangle whose 3 vertices miss starts a cluster, the cache restarts there anyway
+		std::vector<u32> clusters;
+		{
+			FifoCache cache(vertex_count, VERTEX_CACHE_SIZE);
+			for (u32 t = 0; t < triangles; t++)
+			{
+				if (cache.Add(&indices[t * 3]) == 3) clusters.push_back(t);
+			}
+		}
+		clusters.push_back(triangles);
+
+		// soft boundaries: cut a cluster again once its first part is about as cache friendly as the whole
+		std::vector<u32> splits;
+		{
+			FifoCache cache(vertex_count, VERTEX_CACHE_SIZE);
+			for (u64 c = 0; c + 1 < clusters.size(); c++)
+			{
+				u32 begin = clusters[c];
+				u32 end = clusters[c + 1];
+
+				cache.Reset();
+				u32 misses = 0;
+				for (u32 t = begin; t < end; t++) misses += cache.Add(&indices[t * 3]);
+				f32 limit = threshold * (f32)misses / (f32)(end - begin);
+
+				cache.Reset();
+				splits.push_back(begin);
+				u32 start = begin;
+				u32 running = 0;
+				for (u32 t = begin; t < end; t++)
+				{
+					running += cache.Add(&indices[t * 3]);
+					if (t + 1 < end && (f32)running / (f32)(t + 1 - start) <= limit)
+					{
+						splits.push_back(t + 1);
+						start = t + 1;
+						running = 0;
+						cache.Reset();
+					}
+				}
+			}
+		}
+		splits.push_back(triangles);
+
+		auto position = [&](u32 v) { const f32* p = positions + (u64)v * stride; return glm::vec3(p[0], p[1], p[2]); };
+
+		// area weighted centroid and normal of each cluster
+		u32 cluster_count = (u32)splits.size() - 1;
+		std::vector<glm::vec3> centroids(cluster_count, glm::vec3(0.0f));
+		std::vector<glm::vec3> normals(cluster_count, glm::vec3(0.0f));
+		glm::vec3 mesh_centroid(0.0f);
+		f32 mesh_area = 0.0f;
+
+		for (u32 c = 0; c < cluster_count; c++)
+		{
+			f32 area = 0.0f;
+			for (u32 t = splits[c]; t < splits[c + 1]; t++)
+			{
+				glm::vec3 a = position(indices[t * 3]);
+				glm::vec3 b = position(indices[t * 3 + 1]);
+				glm::vec3 d = position(indices[t * 3 + 2]);
+				glm::vec3 normal = glm::cross(b - a, d - a); // length = 2 * area
+				f32 weight = glm::length(normal);
+
+				centroids[c] += (a + b + d) * (weight / 3.0f);
+				normals[c] += normal;
+				area += weight;
+			}
+
+			mesh_centroid += centroids[c];
+			mesh_area += area;
+			centroids[c] = area > 0.0f ? centroids[c] / area : position(indices[splits[c] * 3]);
+		}
+		if (mesh_area > 0.0f) mesh_centroid /= mesh_area;
+
+		// clusters facing away from the center are drawn first
+		std::vector<f32> keys(cluster_count);
+		std::vector<u32> order(cluster_count);
+		for (u32 c = 0; c < cluster_count; c++)
+		{
+			f32 length = glm::length(normals[c]);
+			keys[c] = length > 0.0f ? glm::dot(centroids[c] - mesh_centroid, normals[c] / length) : 0.0f;
+			order[c] = c;
+		}
+		std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b) { return keys[a] > keys[b]; });
+
+		std::vector<u32> output;
+		output.reserve(indices.size());
+		for (u32 c : order) {
+			output.insert(output.end(), indices.begin() + splits[c] * 3, indices.begin() + splits[c + 1] * 3);
+		}
+		std::copy(output.begin(), output.end(), indices.begin());
+	}
+
+	// ---------------- Vertex fetch ----------------
+
+	u32 OptimizeVertexFetch(std::span<u32> indices, std::vector<f32>& vertices, u32 stride)
+	{
+		u32 vertex_count = (u32)(vertices.size() / stride);
+		std::vector<u32> remap(vertex_count, ~0u);
+
+		u32 next = 0;
+		for (u32& index : indices)
+		{
+			LEOASSERTF(index < vertex_count, "Index {} out of range, the mesh has {} vertices", index, vertex_count);
+			if (remap[index] == ~0u) remap[index] = next++;
+			index = remap[index];
+		}
+
+		std::vector<f32> reordered((u64)next * stride);
+		for (u32 v = 0; v < vertex_count; v++)
+		{
+			if (remap[v] == ~0u) continue;
+			std::copy_n(vertices.begin() + (u64)v * stride, stride, reordered.begin() + (u64)remap[v] * stride);
+		}
+
+		vertices.swap(reordered);
+		return next;
+	}
+
+	// ---------------- Pipeline ----------------
+
+	std::string MeshOptimizationReport::ToString() const
+	{
+		return std::format("ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}, {} -> {} vertices, {} bit indices, {:.2f}ms",
+			before.acmr, after.acmr, before.atvr, after.atvr, verticesBefore, verticesAfter, shortIndices ? 16 : 32, ms);
+	}
+
+	MeshOptimizationReport OptimizeMesh(std::vector<f32>& vertices, u32 stride, std::vector<u32>& indices, f32 overdraw_threshold)
+	{
+		Timer timer;
+		MeshOptimizationReport report;
+
+		u32 vertex_count = (u32)(vertices.size() / stride);
+		report.verticesBefore = vertex_count;
+		report.before = AnalyzeVertexCache(indices, vertex_count);
+
+		OptimizeVertexCache(indices, vertex_count);
+		OptimizeOverdraw(indices, vertices.data(), vertex_count, stride, overdraw_threshold);
+		report.verticesAfter = OptimizeVertexFetch(indices, vertices, stride);
+
+		report.after = AnalyzeVertexCache(indices, report.verticesAfter);
+		report.shortIndices = report.verticesAfter <= 65536;
+		report.ms = timer.ElapsedMillis();
+		return report;
+	}
+}
@@ -0,0 +1,408 @@
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <format>
+#include <utility>
+#include <LEO/Log/Log.h>
+#include <LEO/Utilities/LeoFileUtilities.h>
+#include <LEO/Utilities/LeoThreadPool.h>
+#include <LEO/Utilities/LeoTimer.h>
+#include "ObjImporter.h"
+
+namespace leo
+{
+	static constexpr u32 k_shardCount = 64; // deduplication shards, fixed so the vertex order is too
+	static constexpr u32 k_absent = ~0u;
+
+	struct ObjCorner
+	{
+		u32 position;
+		u32 texCoord; // k_absent when the face has no uv
+		u32 normal;   // k_absent when the face has no normal
+	};
+
+	struct ObjChunk
+	{
+		const char* begin = nullptr;
+		const char* end = nullptr;
+
+		// counted by the first pass, then turned into the first index of the chunk
+		u32 lines = 0;
+		u32 positions = 0;
+		u32 texCoords = 0;
+		u32 normals = 0;
+
+		std::vector<ObjCorner> corners; // 3 per triangle
+		u64 cornerBase = 0;
+		std::string error;
+	};
+
+	// ---------------- Parsing ----------------
+
+	static const char* SkipSpaces(const char* p, const char* end)
+	{
+		while (p < end && (*p == ' ' || *p == '\t')) p++;
+		return p;
+	}
+
+	static const char* LineEnd(const char* p, const char* end)
+	{
+		const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+		return newline != nullptr ? newline : end;
+	}
+
+	static bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\t';
+	}
+
+	// 'v', 't' (vt), 'n' (vn) or 'f', p moves after it. 0 for the statements that are ignored
+	static char Statement(const char*& p, const char* end)
+	{
+		if (end - p >= 2 && (p[0] == 'v' || p[0] == 'f') && IsSpace(p[1])) { return *p++; }
+		if (end - p >= 3 && p[0] == 'v' && (p[1] == 't' || p[1] == 'n') && IsSpace(p[2]))
+		{
+			p += 2;
+			return p[-1];
+		}
+		return 0;
+	}
+
+	static bool ParseFloats(const char* p, const char* end, f32* out, u32 count)
+	{
+		for (u32 i = 0; i < count; i++)
+		{
+			p = SkipSpaces(p, end);
+			std::from_chars_result result = std::from_chars(p, end, out[i]);
+			if (result.ec != std::errc()) return false;
+			p = result.ptr;
+		}
+		return true;
+	}
+
+	// 1 based, negative: relative to the end. Returns the 0 based index or k_absent when out of range
+	static u32 ResolveIndex(i64 index, u32 defined, u32 total)
+	{
+		i64 resolved = index > 0 ? index - 1 : (i64)defined + index;
+		return index != 0 && resolved >= 0 && resolved < (i64)total ? (u32)resolved : k_absent;
+	}
+
+	static void CountChunk(ObjChunk& chunk)
+	{
+		for (const char* p = chunk.begin; p < chunk.end; )
+		{
+			const char* line_end = LineEnd(p, chunk.end);
+			const char* s = SkipSpaces(p, line_end);
+
+			switch (Statement(s, line_end))
+			{
+			case 'v': chunk.positions++; break;
+			case 't': chunk.texCoords++; break;
+			case 'n': chunk.normals++; break;
+			}
+
+			chunk.lines++;
+			p = line_end + 1;
+		}
+	}
+
+	struct ObjAttributes
+	{
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec2> texCoords;
+		std::vector<glm::vec3> normals;
+	};
+
+	static void ParseChunk(ObjChunk& chunk, ObjAttributes& attributes)
+	{
+		u32 position = chunk.positions; // the next v of this chunk, also the number defined before the line
+		u32 texCoord = chunk.texCoords;
+		u32 normal = chunk.normals;
+		u32 line = chunk.lines;
+
+		const u32 total_positions = (u32)attributes.positions.size();
+		const u32 total_texCoords = (u32)attributes.texCoords.size();
+		const u32 total_normals = (u32)attributes.normals.size();
+
+		std::vector<ObjCorner> polygon;
+
+		for (const char* p = chunk.begin; p < chunk.end; line++)
+		{
+			const char* line_end = LineEnd(p, chunk.end);
+			const char* s = SkipSpaces(p, line_end);
+			const char* end = (line_end > s && line_end[-1] == '\r') ? line_end - 1 : line_end;
+			p = line_end + 1;
+
+			switch (Statement(s, end))
+			{
+			case 'v':
+				if (!ParseFloats(s, end, &attributes.positions[position++].x, 3)) chunk.error = std::format("line {}: invalid position", line + 1);
+				break;
+			case 't':
+				if (!ParseFloats(s, end, &attributes.texCoords[texCoord++].x, 2)) chunk.error = std::format("line {}: invalid uv", line + 1);
+				break;
+			case 'n':
+				if (!ParseFloats(s, end, &attributes.normals[normal++].x, 3)) chunk.error = std::format("line {}: invalid normal", line + 1);
+				break;
+			case 'f':
+			{
+				// v, v/t, v//n or v/t/n
+				polygon.clear();
+				for (s = SkipSpaces(s, end); s < end; s = SkipSpaces(s, end))
+				{
+					i64 values[3] = { 0, 0, 0 };
+					for (u32 k = 0; k < 3 && s < end && !IsSpace(*s); k++)
+					{
+						if (k > 0)
+						{
+							if (*s != '/') break;
+							s++;
+							if (s < end && *s == '/') continue; // v//n: no uv
+						}
+
+						std::from_chars_result result = std::from_chars(s, end, values[k]);
+						if (result.ec != std::errc()) { values[0] = 0; break; }
+						s = result.ptr;
+					}
+
+					ObjCorner corner;
+					corner.position = ResolveIndex(values[0], position, total_positions);
+					corner.texCoord = values[1] != 0 ? ResolveIndex(values[1], texCoord, total_texCoords) : k_absent;
+					corner.normal = values[2] != 0 ? ResolveIndex(values[2], normal, total_normals) : k_absent;
+
+					if (corner.position == k_absent || (values[1] != 0 && corner.texCoord == k_absent) || (values[2] != 0 && corner.normal == k_absent))
+					{
+						chunk.error = std::format("line {}: invalid or out of range index", line + 1);
+						break;
+					}
+
+					polygon.push_back(corner);
+					while (s < end && !IsSpace(*s)) s++;
+				}
+
+				if (chunk.error.empty() && polygon.size() < 3) chunk.error = std::format("line {}: a face needs 3 vertices", line + 1);
+
+				for (u64 i = 2; chunk.error.empty() && i < polygon.size(); i++)
+				{
+					chunk.corners.push_back(polygon[0]);
+					chunk.corners.push_back(polygon[i - 1]);
+					chunk.corners.push_back(polygon[i]);
+				}
+				break;
+			}
+			}
+
+			if (!chunk.error.empty()) return;
+		}
+	}
+
+	// ---------------- Deduplication ----------------
+
+	static u32 ShardOf(u32 hash)
+	{
+		static_assert(k_shardCount == 64, "the shard is the top 6 bits of the hash");
+		return hash >> 26;
+	}
+
+	// Open addressing table of the vertices of a shard, millions of inserts are much faster than with std::unordered_map
+	struct VertexTable
+	{
+		std::vector<u32> slots;  // vertex + 1, 0 when empty
+		std::vector<u32> hashes; // of the vertex in the slot, compared before the vertex
+		u32 count = 0;
+
+		// The index of the vertex in vertices, added if it is new
+		u32 Insert(const Vertex& vertex, u32 hash, std::vector<Vertex>& vertices)
+		{
+			if ((count + 1) * 2 > (u32)slots.size()) Grow();
+
+			u32 mask = (u32)slots.size() - 1;
+			for (u32 i = hash & mask; ; i = (i + 1) & mask)
+			{
+				if (slots[i] == 0)
+				{
+					vertices.push_back(vertex);
+					slots[i] = (u32)vertices.size();
+					hashes[i] = hash;
+					count++;
+					return slots[i] - 1;
+				}
+
+				if (hashes[i] == hash && vertices[slots[i] - 1] == vertex) return slots[i] - 1;
+			}
+		}
+
+		void Grow()
+		{
+			std::vector<u32> old_slots = std::move(slots);
+			std::vector<u32> old_hashes = std::move(hashes);
+
+			u32 size = std::max<u32>(1024, (u32)old_slots.size() * 2);
+			slots.assign(size, 0);
+			hashes.assign(size, 0);
+
+			for (u64 j = 0; j < old_slots.size(); j++)
+			{
+				if (old_slots[j] == 0) continue;
+
+				u32 i = old_hashes[j] & (size - 1);
+				while (slots[i] != 0) i = (i + 1) & (size - 1);
+				slots[i] = old_slots[j];
+				hashes[i] = old_hashes[j];
+			}
+		}
+	};
+
+	// ---------------- Import ----------------
+
+	template<typename Func>
+	static void ForEachRange(ThreadPool* pool, u32 count, Func&& func)
+	{
+		if (pool != nullptr) pool->ParallelFor(count, 1, func);
+		else func(0, count);
+	}
+
+	ObjMeshData ImportObj(std::string_view text, ThreadPool* pool)
+	{
+		Timer timer;
+		ObjMeshData data;
+		data.stats.bytes = text.size();
+
+		// line aligned chunks
+		std::vector<ObjChunk> chunks;
+		const char* text_end = text.data() + text.size();
+		for (const char* p = text.data(); p < text_end; )
+		{
+			const char* end = p + std::min<u64>(OBJ_CHUNK_SIZE, text_end - p);
+			end = end < text_end ? LineEnd(end, text_end) + 1 : end;
+			end = std::min(end, text_end);
+
+			ObjChunk& chunk = chunks.emplace_back();
+			chunk.begin = p;
+			chunk.end = end;
+			p = end;
+		}
+		data.stats.chunks = (u32)chunks.size();
+
+		ForEachRange(pool, (u32)chunks.size(), [&](u32 begin, u32 end) {
+			for (u32 i = begin; i < end; i++) CountChunk(chunks[i]);
+		});
+
+		// the counts become the first line and the first v/vt/vn of each chunk
+		u32 lines = 0;
+		for (ObjChunk& chunk : chunks)
+		{
+			lines += std::exchange(chunk.lines, lines);
+			data.stats.positions += std::exchange(chunk.positions, data.stats.positions);
+			data.stats.texCoords += std::exchange(chunk.texCoords, data.stats.texCoords);
+			data.stats.normals += std::exchange(chunk.normals, data.stats.normals);
+		}
+
+		ObjAttributes attributes;
+		attributes.positions.resize(data.stats.positions);
+		attributes.texCoords.resize(data.stats.texCoords);
+		attributes.normals.resize(data.stats.normals);
+
+		ForEachRange(pool, (u32)chunks.size(), [&](u32 begin, u32 end) {
+			for (u32 i = begin; i < end; i++) ParseChunk(chunks[i], attributes);
+		});
+
+		u64 corner_count = 0;
+		for (ObjChunk& chunk : chunks)
+		{
+			if (!chunk.error.empty())
+			{
+				data.error = chunk.error;
+				return data;
+			}
+
+			chunk.cornerBase = corner_count;
+			corner_count += chunk.corners.size();
+		}
+
+		if (corner_count > 0xFFFFFFFFull)
+		{
+			data.error = std::format("{} triangles, more than 32 bit indices can draw", corner_count / 3);
+			return data;
+		}
+
+		data.stats.triangles = (u32)(corner_count / 3);
+		data.stats.parseMs = timer.ElapsedMillis();
+
+		auto vertex_of = [&](const ObjCorner& corner) {
+			Vertex vertex = {};
+			vertex.pos = attributes.positions[corner.position];
+			if (corner.texCoord != k_absent) vertex.texCord = attributes.texCoords[corner.texCoord];
+			if (corner.normal != k_absent) vertex.normal = attributes.normals[corner.normal];
+			return vertex;
+		};
+
+		// the hash of each corner, its top bits select the shard. Then each shard numbers its vertices in the order of first use
+		std::vector<u32> hashes(corner_count);
+		data.indices.resize(corner_count);
+
+		ForEachRange(pool, (u32)chunks.size(), [&](u32 begin, u32 end) {
+			std::hash<Vertex> hash;
+			for (u32 i = begin; i < end; i++)
+			{
+				for (u64 c = 0; c < chunks[i].corners.size(); c++)
+				{
+					u64 h = hash(vertex_of(chunks[i].corners[c]));
+					hashes[chunks[i].cornerBase + c] = (u32)(h ^ (h >> 32));
+				}
+			}
+		});
+
+		std::vector<std::vector<Vertex>> shard_vertices(k_shardCount);
+
+		ForEachRange(pool, k_shardCount, [&](u32 begin, u32 end) {
+			std::vector<VertexTable> tables(end - begin);
+			for (const ObjChunk& chunk : chunks)
+			{
+				for (u64 c = 0; c < chunk.corners.size(); c++)
+				{
+					u64 corner = chunk.cornerBase + c;
+					u32 shard = ShardOf(hashes[corner]);
+					if (shard < begin || shard >= end) continue;
+
+					data.indices[corner] = tables[shard - begin].Insert(vertex_of(chunk.corners[c]), hashes[corner], shard_vertices[shard]);
+				}
+			}
+		});
+
+		std::vector<u32> shard_base(k_shardCount);
+		for (u32 shard = 0; shard < k_shardCount; shard++)
+		{
+			shard_base[shard] = (u32)data.vertices.size();
+			data.vertices.insert(data.vertices.end(), shard_vertices[shard].begin(), shard_vertices[shard].end());
+		}
+
+		ForEachRange(pool, (u32)chunks.size(), [&](u32 begin, u32 end) {
+			for (u32 i = begin; i < end; i++)
+			{
+				for (u64 c = chunks[i].cornerBase; c < chunks[i].cornerBase + chunks[i].corners.size(); c++) {
+					data.indices[c] += shard_base[ShardOf(hashes[c])];
+				}
+			}
+		});
+
+		data.stats.vertices = (u32)data.vertices.size();
+		data.stats.ms = timer.ElapsedMillis();
+		data.stats.dedupMs = data.stats.ms - data.stats.parseMs;
+		return data;
+	}
+
+	ObjMeshData ImportObjFile(const std::string& filepath, ThreadPool* pool)
+	{
+		MappedFile file(filepath);
+		if (!file.IsOpen())
+		{
+			ObjMeshData data;
+			data.error = std::format("can't open {}", filepath);
+			return data;
+		}
+
+		std::span<const u8> bytes = file.Bytes();
+		return ImportObj(std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size()), pool);
+	}
+}
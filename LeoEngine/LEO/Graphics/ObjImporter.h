@@ -0,0 +1,51 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <LEO/Utilities/LeoTypes.h>
+#include "Mesh.h"
+
+namespace leo
+{
+	class ThreadPool;
+
+	struct ObjImportStats
+	{
+		u64 bytes     = 0;
+		u32 positions = 0; // v lines
+		u32 texCoords = 0; // vt lines
+		u32 normals   = 0; // vn lines
+		u32 triangles = 0; // after triangulation of the polygons
+		u32 vertices  = 0; // unique, after deduplication
+		u32 chunks    = 0;
+		f32 parseMs   = 0.0f;
+		f32 dedupMs   = 0.0f;
+		f32 ms        = 0.0f;
+
+		f32 MBPerSecond() const { return ms > 0.0f ? (f32)((f64)bytes / (1024.0 * 1024.0) / (ms / 1000.0f)) : 0.0f; }
+	};
+
+	// Indexed triangles, the Vertex layout is FLOAT3 FLOAT2 FLOAT3 (missing uvs and normals are 0)
+	struct ObjMeshData
+	{
+		std::vector<Vertex> vertices;
+		std::vector<u32>    indices;
+		ObjImportStats      stats;
+		std::string         error; // empty when the import succeeded
+	};
+
+	constexpr u64 OBJ_CHUNK_SIZE = 1 << 20; // bytes of text per parse task
+
+	/// <summary>
+	/// Wavefront OBJ import of the geometry: v, vt, vn and f (polygons are triangulated as fans, negative indices
+	/// are relative). Other statements (o, g, s, usemtl, ...) are ignored.
+	/// The text is split in line aligned chunks of about OBJ_CHUNK_SIZE bytes parsed over the ThreadPool:
+	/// a first pass counts the lines and the v/vt/vn of each chunk, so the second pass knows where each chunk's
+	/// data goes and resolves the indices as it parses (std::from_chars). Equal vertices (std::hash<Vertex>)
+	/// are merged in shards, one thread per shard, the result does not depend on the thread count.
+	/// </summary>
+	ObjMeshData ImportObj(std::string_view text, ThreadPool* pool = nullptr); // nullptr: single threaded
+
+	// Maps the file (MappedFile) and imports it
+	ObjMeshData ImportObjFile(const std::string& filepath, ThreadPool* pool = nullptr);
+}
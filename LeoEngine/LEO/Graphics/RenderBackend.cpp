@@ -0,0 +1,303 @@
+#include <glad/glad.h>
+#include <LEO/Log/LeoAssert.h>
+#include "GLStateCache.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "Mesh.h"
+#include "RenderBackend.h"
+
+namespace leo
+{
+	// ---------------- GLRenderBackend ----------------
+
+	GLRenderBackend::~GLRenderBackend()
+	{
+		LEOASSERT(m_uniformStream == nullptr, "GLRenderBackend::Release must be called before the GL context is destroyed");
+	}
+
+	void GLRenderBackend::Release()
+	{
+		m_uniformStream.reset();
+	}
+
+	void GLRenderBackend::EndFrame()
+	{
+		if (m_uniformStream != nullptr) m_uniformStream->EndFrame();
+	}
+
+	void GLRenderBackend::Clear(const ClearCmd& cmd)
+	{
+		GLbitfield mask = 0;
+
+		if (cmd.flags & CLEAR_COLOR)
+		{
+			glClearColor(cmd.color.r / 255.0f, cmd.color.g / 255.0f, cmd.color.b / 255.0f, cmd.color.a / 255.0f);
+			mask |= GL_COLOR_BUFFER_BIT;
+		}
+
+		if (cmd.flags & CLEAR_DEPTH)
+		{
+			glClearDepth(cmd.depth);
+			mask |= GL_DEPTH_BUFFER_BIT;
+		}
+
+		if (mask != 0) glClear(mask);
+	}
+
+	void GLRenderBackend::SetRenderState(const SetRenderStateCmd& cmd)
+	{
+		GLStateCache& cache = GetGLStateCache();
+
+		cache.SetEnabled(GL_DEPTH_TEST, cmd.state.depthTest);
+		if (cmd.state.depthTest) cache.DepthFunc(GL_LEQUAL);
+
+		cache.SetEnabled(GL_BLEND, cmd.state.blend);
+		if (cmd.state.blend) cache.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	}
+
+	void GLRenderBackend::UpdateVertexBuffer(const UpdateVertexBufferCmd& cmd)
+	{
+		cmd.buffer->SetData(cmd.data, cmd.size);
+	}
+
+	void GLRenderBackend::UpdateIndexBuffer(const UpdateIndexBufferCmd& cmd)
+	{
+		// the element buffer binding belongs to the vertex array
+		cmd.vertexArray->Bind();
+		cmd.vertexArray->GetIndexBuffer().SetData(cmd.indices, cmd.count);
+	}
+
+	void GLRenderBackend::BindShader(const BindShaderCmd& cmd)
+	{
+		cmd.shader->Bind();
+	}
+
+	void GLRenderBackend::SetUniforms(const SetUniformsCmd& cmd)
+	{
+		for (u32 i = 0; i < cmd.count; i++)
+		{
+			const UniformValue& value = cmd.values[i];
+
+			// the name was hashed when recorded, only the handle lookup is left
+			switch (value.type)
+			{
+			case UniformType::Float: cmd.shader->SetUniform(value.name, value.As<f32>()); break;
+			case UniformType::Vec2:  cmd.shader->SetUniform(value.name, value.As<glm::vec2>()); break;
+			case UniformType::Vec3:  cmd.shader->SetUniform(value.name, value.As<glm::vec3>()); break;
+			case UniformType::Vec4:  cmd.shader->SetUniform(value.name, value.As<glm::vec4>()); break;
+			case UniformType::Int:   cmd.shader->SetUniform(value.name, value.As<i32>()); break;
+			case UniformType::IVec3: cmd.shader->SetUniform(value.name, value.As<glm::ivec3>()); break;
+			case UniformType::UInt:  cmd.shader->SetUniform(value.name, value.As<u32>()); break;
+			case UniformType::UVec3: cmd.shader->SetUniform(value.name, value.As<glm::uvec3>()); break;
+			case UniformType::Mat3:  cmd.shader->SetUniform(value.name, value.As<glm::mat3>()); break;
+			case UniformType::Mat4:  cmd.shader->SetUniform(value.name, value.As<glm::mat4>()); break;
+			}
+		}
+	}
+
+	void GLRenderBackend::UpdateUniformBuffer(const UpdateUniformBufferCmd& cmd)
+	{
+		cmd.buffer->SetData(cmd.data, cmd.size);
+	}
+
+	void GLRenderBackend::BindUniformBuffer(const BindUniformBufferCmd& cmd)
+	{
+		cmd.buffer->Bind(cmd.binding);
+	}
+
+	void GLRenderBackend::PushUniforms(const PushUniformsCmd& cmd)
+	{
+		if (m_uniformStream == nullptr) {
+			m_uniformStream = std::make_unique<UniformStream>();
+		}
+
+		m_uniformStream->Push(cmd.binding, cmd.data, cmd.size);
+	}
+
+	void GLRenderBackend::BindTexture(const BindTextureCmd& cmd)
+	{
+		if (cmd.texture != nullptr) {
+			cmd.texture->Bind(cmd.slot);
+		}
+		else {
+			GetGLStateCache().BindTextureUnit(cmd.slot, GL_TEXTURE_2D, 0);
+		}
+	}
+
+	void GLRenderBackend::BindVertexArray(const BindVertexArrayCmd& cmd)
+	{
+		cmd.vertexArray->Bind();
+	}
+
+	void GLRenderBackend::BindMesh(const BindMeshCmd& cmd)
+	{
+		cmd.mesh->Bind();
+	}
+
+	void GLRenderBackend::DrawMesh(const DrawMeshCmd& cmd)
+	{
+		cmd.mesh->DrawBound();
+	}
+
+	void GLRenderBackend::DrawIndexed(const DrawIndexedCmd& cmd)
+	{
+		glDrawElements(GL_TRIANGLES, cmd.indexCount, GL_UNSIGNED_INT, reinterpret_cast<void*>((u64)cmd.firstIndex * sizeof(u32)));
+	}
+
+	// ---------------- NullRenderBackend ----------------
+
+	static constexpr u64 k_fnvOffset = 14695981039346656037ull;
+	static constexpr u64 k_fnvPrime = 1099511628211ull;
+
+	void NullRenderBackend::BeginFrame()
+	{
+		m_trace.clear();
+		m_hash = k_fnvOffset;
+		m_thread = std::this_thread::get_id();
+	}
+
+	void NullRenderBackend::EndFrame()
+	{
+		m_frames++;
+	}
+
+	u32 NullRenderBackend::Count(CommandType type) const
+	{
+		u32 count = 0;
+		for (CommandType recorded : m_trace) {
+			if (recorded == type) count++;
+		}
+		return count;
+	}
+
+	void NullRenderBackend::Record(CommandType type)
+	{
+		m_trace.push_back(type);
+		Mix(type);
+	}
+
+	void NullRenderBackend::Mix(const void* data, u64 size)
+	{
+		const u8* bytes = static_cast<const u8*>(data);
+		for (u64 i = 0; i < size; i++)
+		{
+			m_hash ^= bytes[i];
+			m_hash *= k_fnvPrime;
+		}
+	}
+
+	// the payloads are hashed field by field, their padding is not initialized
+
+	void NullRenderBackend::Clear(const ClearCmd& cmd)
+	{
+		Record(CommandType::Clear);
+		Mix(cmd.flags);
+		Mix(cmd.color);
+		Mix(cmd.depth);
+	}
+
+	void NullRenderBackend::SetRenderState(const SetRenderStateCmd& cmd)
+	{
+		Record(CommandType::SetRenderState);
+		Mix(cmd.state.depthTest);
+		Mix(cmd.state.blend);
+	}
+
+	void NullRenderBackend::UpdateVertexBuffer(const UpdateVertexBufferCmd& cmd)
+	{
+		Record(CommandType::UpdateVertexBuffer);
+		Mix(cmd.buffer);
+		Mix(cmd.size);
+		Mix(cmd.data, cmd.size);
+	}
+
+	void NullRenderBackend::UpdateIndexBuffer(const UpdateIndexBufferCmd& cmd)
+	{
+		Record(CommandType::UpdateIndexBuffer);
+		Mix(cmd.vertexArray);
+		Mix(cmd.count);
+		Mix(cmd.indices, (u64)cmd.count * sizeof(u32));
+	}
+
+	void NullRenderBackend::BindShader(const BindShaderCmd& cmd)
+	{
+		Record(CommandType::BindShader);
+		Mix(cmd.shader);
+	}
+
+	void NullRenderBackend::SetUniforms(const SetUniformsCmd& cmd)
+	{
+		Record(CommandType::SetUniforms);
+		Mix(cmd.shader);
+		Mix(cmd.count);
+
+		for (u32 i = 0; i < cmd.count; i++)
+		{
+			const UniformValue& value = cmd.values[i];
+			Mix(value.name.hash);
+			Mix(value.type);
+			Mix(value.data, sizeof(value.data));
+		}
+	}
+
+	void NullRenderBackend::UpdateUniformBuffer(const UpdateUniformBufferCmd& cmd)
+	{
+		Record(CommandType::UpdateUniformBuffer);
+		Mix(cmd.buffer);
+		Mix(cmd.size);
+		Mix(cmd.data, cmd.size);
+	}
+
+	void NullRenderBackend::BindUniformBuffer(const BindUniformBufferCmd& cmd)
+	{
+		Record(CommandType::BindUniformBuffer);
+		Mix(cmd.buffer);
+		Mix(cmd.binding);
+	}
+
+	void NullRenderBackend::PushUniforms(const PushUniformsCmd& cmd)
+	{
+		Record(CommandType::PushUniforms);
+		Mix(cmd.binding);
+		Mix(cmd.size);
+		Mix(cmd.data, cmd.size);
+	}
+
+	void NullRenderBackend::BindTexture(const BindTextureCmd& cmd)
+	{
+		Record(CommandType::BindTexture);
+		Mix(cmd.texture);
+		Mix(cmd.slot);
+	}
+
+	void NullRenderBackend::BindVertexArray(const BindVertexArrayCmd& cmd)
+	{
+		Record(CommandType::BindVertexArray);
+		Mix(cmd.vertexArray);
+	}
+
+	void NullRenderBackend::BindMesh(const BindMeshCmd& cmd)
+	{
+		Record(CommandType::BindMesh);
+		Mix(cmd.mesh);
+	}
+
+	void NullRenderBackend::DrawMesh(const DrawMeshCmd& cmd)
+	{
+		Record(CommandType::DrawMesh);
+		Mix(cmd.mesh);
+	}
+
+	void NullRenderBackend::DrawIndexed(const DrawIndexedCmd& cmd)
+	{
+		Record(CommandType::DrawIndexed);
+		Mix(cmd.firstIndex);
+		Mix(cmd.indexCount);
+	}
+
+	void NullRenderBackend::Callback(const std::function<void()>& func)
+	{
+		Record(CommandType::Callback);
+		func();
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <thread>
+#include <memory>
+#include <LEO/Utilities/LeoTypes.h>
+#include "CommandList.h"
+#include "UniformBuffer.h"
+
+namespace leo
+{
+	/// <summary>
+	/// Replays command lists with OpenGL (through the GLStateCache).
+	/// Must be used on the thread that owns the GL context.
+	/// </summary>
+	class GLRenderBackend final : public RenderBackend
+	{
+	public:
+		~GLRenderBackend() override;
+	public:
+		void EndFrame() override;
+
+		void Clear(const ClearCmd& cmd) override;
+		void SetRenderState(const SetRenderStateCmd& cmd) override;
+		void UpdateVertexBuffer(const UpdateVertexBufferCmd& cmd) override;
+		void UpdateIndexBuffer(const UpdateIndexBufferCmd& cmd) override;
+		void BindShader(const BindShaderCmd& cmd) override;
+		void SetUniforms(const SetUniformsCmd& cmd) override;
+		void UpdateUniformBuffer(const UpdateUniformBufferCmd& cmd) override;
+		void BindUniformBuffer(const BindUniformBufferCmd& cmd) override;
+		void PushUniforms(const PushUniformsCmd& cmd) override;
+		void BindTexture(const BindTextureCmd& cmd) override;
+		void BindVertexArray(const BindVertexArrayCmd& cmd) override;
+		void BindMesh(const BindMeshCmd& cmd) override;
+		void DrawMesh(const DrawMeshCmd& cmd) override;
+		void DrawIndexed(const DrawIndexedCmd& cmd) override;
+	public:
+		// Frees the GL objects of the backend, call it while the context is still alive
+		void Release();
+	private:
+		std::unique_ptr<UniformStream> m_uniformStream; // created by the first PushUniforms, on the replaying thread
+	};
+
+	/// <summary>
+	/// Records the replayed commands without drawing anything, used to test the recording,
+	/// the encoding and the render thread without a GPU. Callbacks are still run.
+	/// The results describe the last replayed frame, read them once the replay is done (RenderThread::Flush).
+	/// </summary>
+	class NullRenderBackend final : public RenderBackend
+	{
+	public:
+		void BeginFrame() override;
+		void EndFrame() override;
+
+		void Clear(const ClearCmd& cmd) override;
+		void SetRenderState(const SetRenderStateCmd& cmd) override;
+		void UpdateVertexBuffer(const UpdateVertexBufferCmd& cmd) override;
+		void UpdateIndexBuffer(const UpdateIndexBufferCmd& cmd) override;
+		void BindShader(const BindShaderCmd& cmd) override;
+		void SetUniforms(const SetUniformsCmd& cmd) override;
+		void UpdateUniformBuffer(const UpdateUniformBufferCmd& cmd) override;
+		void BindUniformBuffer(const BindUniformBufferCmd& cmd) override;
+		void PushUniforms(const PushUniformsCmd& cmd) override;
+		void BindTexture(const BindTextureCmd& cmd) override;
+		void BindVertexArray(const BindVertexArrayCmd& cmd) override;
+		void BindMesh(const BindMeshCmd& cmd) override;
+		void DrawMesh(const DrawMeshCmd& cmd) override;
+		void DrawIndexed(const DrawIndexedCmd& cmd) override;
+		void Callback(const std::function<void()>& func) override;
+	public:
+		std::span<const CommandType> Trace() const { return m_trace; }
+		u32 Count(CommandType type) const;
+
+		// FNV-1a of every command and its arguments (buffer data and uniform values included)
+		inline u64 Hash() const { return m_hash; }
+		inline u64 FramesReplayed() const { return m_frames; }
+		inline std::thread::id ReplayThread() const { return m_thread; }
+	private:
+		void Record(CommandType type);
+		void Mix(const void* data, u64 size);
+
+		template<typename T>
+		void Mix(const T& value) { Mix(&value, sizeof(T)); }
+	private:
+		std::vector<CommandType> m_trace;
+		u64 m_hash = 0;
+		u64 m_frames = 0;
+		std::thread::id m_thread;
+	};
+}
@@ -0,0 +1,223 @@
+#include <bit>
+#include <glad/glad.h>
+#include <LEO/Log/LeoAssert.h>
+#include "GLStateCache.h"
+#include "RenderQueue.h"
+
+namespace leo
+{
+	static constexpr u64 k_stateMask = RenderQueue::MAX_STATES - 1;
+	static constexpr u64 k_depthMask = (1ull << 24) - 1;
+
+	void RenderQueue::Clear()
+	{
+		m_commands.clear();
+		m_keys.clear();
+		m_ops.clear();
+
+		m_shaderIds.clear();
+		m_textureIds.clear();
+		m_meshIds.clear();
+
+		m_stats = {};
+	}
+
+	u64 RenderQueue::MakeKey(RenderPass pass, u32 shader, u32 texture, u32 mesh, f32 depth)
+	{
+		// positive floats compare like their bit patterns, keep the 24 most significant bits
+		u64 depth_bits = (u64)(std::bit_cast<u32>(glm::max(depth, 0.0f)) >> 8) & k_depthMask;
+
+		u64 key = (u64)pass << 60;
+
+		if (pass == RenderPass::Transparent)
+		{
+			key |= (~depth_bits & k_depthMask) << 36;
+			key |= ((u64)shader & k_stateMask) << 24;
+			key |= ((u64)texture & k_stateMask) << 12;
+			key |= ((u64)mesh & k_stateMask);
+		}
+		else
+		{
+			key |= ((u64)shader & k_stateMask) << 48;
+			key |= ((u64)texture & k_stateMask) << 36;
+			key |= ((u64)mesh & k_stateMask) << 24;
+			key |= depth_bits;
+		}
+
+		return key;
+	}
+
+	u32 RenderQueue::StateId(std::unordered_map<const void*, u32>& ids, const void* object)
+	{
+		if (object == nullptr) return 0;
+
+		auto [it, inserted] = ids.try_emplace(object, (u32)ids.size() + 1);
+		LEOASSERTF(it->second < MAX_STATES, "RenderQueue supports at most {} distinct states per frame", MAX_STATES);
+		return it->second;
+	}
+
+	void RenderQueue::Submit(RenderPass pass, const ShaderProgram* shader, const Texture* texture, const Mesh* mesh, f32 depth, u32 user)
+	{
+		LEOASSERT(shader != nullptr && mesh != nullptr, "A render command needs a shader and a mesh");
+
+		u32 shader_id = StateId(m_shaderIds, shader);
+		u32 texture_id = StateId(m_textureIds, texture);
+		u32 mesh_id = StateId(m_meshIds, mesh);
+
+		m_commands.push_back(RenderCommand{ shader, texture, mesh, user });
+		m_keys.push_back(MakeKey(pass, shader_id, texture_id, mesh_id, depth));
+	}
+
+	void RenderQueue::RadixSort()
+	{
+		const u32 count = (u32)m_keys.size();
+
+		m_sorted.resize(count);
+		m_sortScratch.resize(count);
+
+		// one pass over the keys for the 8 byte histograms
+		u32 histograms[8][256] = {};
+		for (u32 i = 0; i < count; i++)
+		{
+			u64 key = m_keys[i];
+			m_sorted[i] = SortItem{ key, i };
+
+			for (u32 b = 0; b < 8; b++) {
+				histograms[b][(key >> (b * 8)) & 0xFF]++;
+			}
+		}
+
+		// LSD, stable, bytes shared by every key are skipped
+		for (u32 b = 0; b < 8; b++)
+		{
+			u32* histogram = histograms[b];
+			if (histogram[(m_sorted[0].key >> (b * 8)) & 0xFF] == count) continue;
+
+			u32 offset = 0;
+			for (u32 v = 0; v < 256; v++)
+			{
+				u32 n = histogram[v];
+				histogram[v] = offset;
+				offset += n;
+			}
+
+			for (const SortItem& item : m_sorted) {
+				m_sortScratch[histogram[(item.key >> (b * 8)) & 0xFF]++] = item;
+			}
+
+			m_sorted.swap(m_sortScratch);
+		}
+	}
+
+	std::span<const RenderOp> RenderQueue::Compile()
+	{
+		m_ops.clear();
+		m_stats = {};
+		m_stats.commands = (u32)m_commands.size();
+
+		if (m_commands.empty()) return m_ops;
+
+		RadixSort();
+
+		const ShaderProgram* shader = nullptr;
+		const Texture* texture = nullptr;
+		const Mesh* mesh = nullptr;
+		bool first = true;
+
+		for (const SortItem& item : m_sorted)
+		{
+			const RenderCommand& command = m_commands[item.command];
+
+			if (first || command.shader != shader)
+			{
+				m_ops.push_back(RenderOp{ RenderOp::Type::BindShader, item.command });
+				shader = command.shader;
+				m_stats.shaderBinds++;
+			}
+
+			// texture units are not part of the program state, a new shader keeps the bound texture
+			if (first || command.texture != texture)
+			{
+				m_ops.push_back(RenderOp{ RenderOp::Type::BindTexture, item.command });
+				texture = command.texture;
+				m_stats.textureBinds++;
+			}
+
+			if (first || command.mesh != mesh)
+			{
+				m_ops.push_back(RenderOp{ RenderOp::Type::BindMesh, item.command });
+				mesh = command.mesh;
+				m_stats.meshBinds++;
+			}
+
+			m_ops.push_back(RenderOp{ RenderOp::Type::Draw, item.command });
+			first = false;
+		}
+
+		return m_ops;
+	}
+
+	void RenderQueue::Execute(const PerDrawFunc& per_draw)
+	{
+		Compile();
+		if (m_ops.empty()) return;
+
+		for (const RenderOp& op : m_ops)
+		{
+			const RenderCommand& command = m_commands[op.command];
+
+			switch (op.type)
+			{
+			case RenderOp::Type::BindShader:
+				command.shader->Bind();
+				break;
+			case RenderOp::Type::BindTexture:
+				if (command.texture != nullptr) {
+					command.texture->Bind(0);
+				}
+				else {
+					GetGLStateCache().BindTextureUnit(0, GL_TEXTURE_2D, 0);
+				}
+				break;
+			case RenderOp::Type::BindMesh:
+				command.mesh->Bind();
+				break;
+			case RenderOp::Type::Draw:
+				if (per_draw) per_draw(*command.shader, command);
+				command.mesh->DrawBound();
+				break;
+			}
+		}
+
+		const RenderCommand& last = m_commands[m_ops.back().command];
+		last.mesh->UnBind();
+		last.shader->UnBind();
+	}
+
+	void RenderQueue::Record(CommandList& commands, const RecordPerDrawFunc& per_draw)
+	{
+		Compile();
+
+		for (const RenderOp& op : m_ops)
+		{
+			const RenderCommand& command = m_commands[op.command];
+
+			switch (op.type)
+			{
+			case RenderOp::Type::BindShader:
+				commands.BindShader(*command.shader);
+				break;
+			case RenderOp::Type::BindTexture:
+				commands.BindTexture(command.texture, 0);
+				break;
+			case RenderOp::Type::BindMesh:
+				commands.BindMesh(*command.mesh);
+				break;
+			case RenderOp::Type::Draw:
+				if (per_draw) per_draw(commands, *command.shader, command);
+				commands.DrawMesh(*command.mesh);
+				break;
+			}
+		}
+	}
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <functional>
+#include <unordered_map>
+#include <LEO/Utilities/LeoTypes.h>
+#include "Shader.h"
+#include "Texture.h"
+#include "Mesh.h"
+#include "CommandList.h"
+
+namespace leo
+{
+	enum class RenderPass : u8
+	{
+		Opaque      = 0, // sorted by state, then front to back
+		Transparent = 1, // sorted back to front, then by state
+		Overlay     = 2  // sorted by state, then front to back
+	};
+
+	struct RenderCommand
+	{
+		const ShaderProgram* shader;
+		const Texture*       texture; // bound on slot 0, may be nullptr
+		const Mesh*          mesh;
+		u32                  user;    // given back to the per-draw callback (index of a transform, ...)
+	};
+
+	// One step of the final command list, binds are only emitted when the state changes
+	struct RenderOp
+	{
+		enum class Type : u8 { BindShader, BindTexture, BindMesh, Draw };
+
+		Type type;
+		u32  command; // index in RenderQueue::Commands()
+	};
+
+	struct RenderQueueStats
+	{
+		u32 commands     = 0;
+		u32 shaderBinds  = 0;
+		u32 textureBinds = 0;
+		u32 meshBinds    = 0;
+	};
+
+	/// <summary>
+	/// Records draw commands with a 64-bit sort key and submits them sorted, without redundant binds.
+	/// Key: | pass 4 | shader 12 | texture 12 | mesh 12 | depth 24 |  (Transparent: | pass | ~depth | shader | texture | mesh |)
+	/// Shaders, textures and meshes get a small id the first time they are seen in a frame.
+	/// Compile only sorts and builds the RenderOp list, it does not touch OpenGL.
+	/// </summary>
+	class RenderQueue
+	{
+	public:
+		static constexpr u32 MAX_STATES = 1 << 12; // distinct shaders, textures or meshes per frame
+	public:
+		using PerDrawFunc = std::function<void(const ShaderProgram&, const RenderCommand&)>;
+		using RecordPerDrawFunc = std::function<void(CommandList&, const ShaderProgram&, const RenderCommand&)>;
+	public:
+		RenderQueue() = default;
+	public:
+		void Clear();
+
+		// depth is the view space distance (>= 0)
+		void Submit(RenderPass pass, const ShaderProgram* shader, const Texture* texture, const Mesh* mesh, f32 depth, u32 user = 0);
+
+		// Sorts the commands and builds the final command list, CPU only
+		std::span<const RenderOp> Compile();
+
+		// Compiles and runs the command list, per_draw is called before each draw to set the per-draw uniforms
+		void Execute(const PerDrawFunc& per_draw = {});
+
+		// Compiles and records the command list into commands, per_draw records the per-draw uniforms
+		void Record(CommandList& commands, const RecordPerDrawFunc& per_draw = {});
+	public:
+		std::span<const RenderCommand> Commands() const { return m_commands; }
+		std::span<const RenderOp> Ops() const { return m_ops; }
+		const RenderQueueStats& Stats() const { return m_stats; }
+		u64 Key(u32 command) const { return m_keys[command]; }
+
+		static u64 MakeKey(RenderPass pass, u32 shader, u32 texture, u32 mesh, f32 depth);
+	private:
+		u32 StateId(std::unordered_map<const void*, u32>& ids, const void* object);
+		void RadixSort();
+	private:
+		struct SortItem
+		{
+			u64 key;
+			u32 command;
+		};
+	private:
+		std::vector<RenderCommand> m_commands;
+		std::vector<u64> m_keys;
+		std::vector<SortItem> m_sorted;
+		std::vector<SortItem> m_sortScratch;
+		std::vector<RenderOp> m_ops;
+
+		// per frame ids, 0 is nullptr
+		std::unordered_map<const void*, u32> m_shaderIds;
+		std::unordered_map<const void*, u32> m_textureIds;
+		std::unordered_map<const void*, u32> m_meshIds;
+
+		RenderQueueStats m_stats;
+	};
+}
@@ -0,0 +1,96 @@
+#include <LEO/Log/LeoAssert.h>
+#include <LEO/Utilities/LeoTimer.h>
+#include "RenderThread.h"
+
+namespace leo
+{
+	RenderThread::RenderThread(RenderBackend& backend, Hooks hooks)
+		:
+		m_backend(backend),
+		m_hooks(std::move(hooks))
+	{
+		m_thread = std::thread([this]() { ThreadLoop(); });
+	}
+
+	RenderThread::~RenderThread()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_frameSubmitted.notify_one();
+
+		m_thread.join();
+	}
+
+	void RenderThread::Submit()
+	{
+		Timer timer;
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			// the other list is the one being replayed, it can only be reused once it is done
+			m_frameReplayed.wait(lock, [this]() { return m_submitted == nullptr; });
+			m_submitted = &m_lists[m_recording];
+		}
+		m_frameSubmitted.notify_one();
+
+		m_waitMs = timer.ElapsedMillis();
+
+		m_recording ^= 1u;
+		m_lists[m_recording].Reset();
+	}
+
+	void RenderThread::Flush()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_frameReplayed.wait(lock, [this]() { return m_submitted == nullptr; });
+	}
+
+	u64 RenderThread::FramesReplayed() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_framesReplayed;
+	}
+
+	f32 RenderThread::LastReplayMs() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_replayMs;
+	}
+
+	void RenderThread::ThreadLoop()
+	{
+		if (m_hooks.onStart) m_hooks.onStart();
+
+		while (true)
+		{
+			const CommandList* commands = nullptr;
+
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_frameSubmitted.wait(lock, [this]() { return m_stop || m_submitted != nullptr; });
+
+				// on stop the submitted frame is still replayed
+				if (m_submitted == nullptr) break;
+
+				commands = m_submitted;
+			}
+
+			Timer timer;
+			commands->Replay(m_backend);
+			if (m_hooks.onFrameEnd) m_hooks.onFrameEnd();
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_replayMs = timer.ElapsedMillis();
+				m_framesReplayed++;
+				m_submitted = nullptr;
+			}
+			m_frameReplayed.notify_all();
+		}
+
+		if (m_hooks.onStop) m_hooks.onStop();
+	}
+}
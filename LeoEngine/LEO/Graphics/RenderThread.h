@@ -0,0 +1,70 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <LEO/Utilities/LeoTypes.h>
+#include "CommandList.h"
+
+namespace leo
+{
+	/// <summary>
+	/// A dedicated thread replaying command lists into a RenderBackend, one frame behind the recording thread.
+	/// The main thread records frame N + 1 into Recording() while the render thread replays frame N,
+	/// Submit() only blocks when the render thread is still busy with the previous frame.
+	/// With the GL backend the context must be made current on the render thread (onStart) and
+	/// no GL call may be made from any other thread while it runs.
+	/// </summary>
+	class RenderThread final
+	{
+	public:
+		using Hook = std::function<void()>;
+
+		struct Hooks
+		{
+			Hook onStart;    // render thread, before the first frame (make the context current)
+			Hook onFrameEnd; // render thread, after each replayed frame (swap buffers)
+			Hook onStop;     // render thread, after the last frame (release the context)
+		};
+	public:
+		RenderThread(RenderBackend& backend, Hooks hooks = {});
+
+		RenderThread(const RenderThread&) = delete;
+		RenderThread& operator=(const RenderThread&) = delete;
+
+		~RenderThread(); // replays the submitted frame, then joins
+	public:
+		// The list being recorded, main thread only
+		inline CommandList& Recording() { return m_lists[m_recording]; }
+
+		// Hands Recording() to the render thread and starts a new list
+		void Submit();
+
+		// Blocks until every submitted frame has been replayed
+		void Flush();
+	public:
+		u64 FramesReplayed() const;
+		f32 LastReplayMs() const; // render thread time of the last frame
+		inline f32 LastWaitMs() const { return m_waitMs; }     // time Submit blocked on the render thread
+	private:
+		void ThreadLoop();
+	private:
+		RenderBackend& m_backend;
+		Hooks m_hooks;
+
+		CommandList m_lists[2];
+		u32 m_recording = 0;
+		const CommandList* m_submitted = nullptr; // handed to the render thread, nullptr once replayed
+
+		mutable std::mutex m_mutex;
+		std::condition_variable m_frameSubmitted;
+		std::condition_variable m_frameReplayed;
+		bool m_stop = false;
+
+		u64 m_framesReplayed = 0;
+		f32 m_replayMs = 0.0f;
+		f32 m_waitMs = 0.0f;
+
+		std::thread m_thread;
+	};
+}
@@ -0,0 +1,286 @@
+#include <algorithm>
+#include <glad/glad.h>
+#include <LEO/Log/LeoAssert.h>
+#include "GLStateCache.h"
+#include "Renderer2D.h"
+
+namespace leo
+{
+	// ---------------- Batch2D ----------------
+
+	void Batch2D::Clear()
+	{
+		m_vertices.clear();
+		m_indices.clear();
+		m_runs.clear();
+		m_drawCalls.clear();
+		m_sortedIndices.clear();
+	}
+
+	u32 Batch2D::Append(u32 vertex_count, u32 index_count)
+	{
+		if (m_runs.empty() || m_runs.back().shader != m_shader || m_runs.back().texture != m_texture)
+		{
+			m_runs.push_back(DrawCall2D{ m_shader, m_texture, (u32)m_indices.size(), 0 });
+		}
+		m_runs.back().indexCount += index_count;
+
+		u32 first = (u32)m_vertices.size();
+		m_vertices.resize(m_vertices.size() + vertex_count);
+		m_indices.reserve(m_indices.size() + index_count);
+		return first;
+	}
+
+	void Batch2D::Triangle(const glm::vec2& a, const glm::vec2& b, const glm::vec2& c, Color color)
+	{
+		u32 first = Append(3, 3);
+
+		m_vertices[first + 0] = Vertex2D{ a, glm::vec2(0.0f, 0.0f), color };
+		m_vertices[first + 1] = Vertex2D{ b, glm::vec2(1.0f, 0.0f), color };
+		m_vertices[first + 2] = Vertex2D{ c, glm::vec2(0.5f, 1.0f), color };
+
+		m_indices.insert(m_indices.end(), { first, first + 1, first + 2 });
+	}
+
+	void Batch2D::Quad(const glm::vec2& min, const glm::vec2& max, Color color, const glm::vec2& uv_min, const glm::vec2& uv_max)
+	{
+		u32 first = Append(4, 6);
+
+		m_vertices[first + 0] = Vertex2D{ { min.x, min.y }, { uv_min.x, uv_min.y }, color };
+		m_vertices[first + 1] = Vertex2D{ { max.x, min.y }, { uv_max.x, uv_min.y }, color };
+		m_vertices[first + 2] = Vertex2D{ { max.x, max.y }, { uv_max.x, uv_max.y }, color };
+		m_vertices[first + 3] = Vertex2D{ { min.x, max.y }, { uv_min.x, uv_max.y }, color };
+
+		m_indices.insert(m_indices.end(), { first, first + 1, first + 2, first, first + 2, first + 3 });
+	}
+
+	void Batch2D::Polygon(const glm::vec2* points, u32 count, Color color)
+	{
+		LEOASSERT(points != nullptr, "Polygon points are null");
+		if (count < 3) return;
+
+		u32 first = Append(count, (count - 2) * 3);
+
+		for (u32 i = 0; i < count; i++)
+		{
+			m_vertices[first + i] = Vertex2D{ points[i], glm::vec2(0.0f), color };
+		}
+
+		for (u32 i = 1; i + 1 < count; i++)
+		{
+			m_indices.insert(m_indices.end(), { first, first + i, first + i + 1 });
+		}
+	}
+
+	void Batch2D::Circle(const glm::vec2& center, f32 radius, Color color, u32 segments)
+	{
+		LEOASSERT(segments >= 3, "A circle needs at least 3 segments");
+
+		// center + ring, the uv maps the circle in [0, 1]
+		u32 first = Append(segments + 1, segments * 3);
+		m_vertices[first] = Vertex2D{ center, glm::vec2(0.5f), color };
+
+		const f32 step = glm::two_pi<f32>() / (f32)segments;
+		for (u32 i = 0; i < segments; i++)
+		{
+			glm::vec2 dir(glm::cos(step * i), glm::sin(step * i));
+			m_vertices[first + 1 + i] = Vertex2D{ center + dir * radius, 0.5f + 0.5f * dir, color };
+		}
+
+		for (u32 i = 0; i < segments; i++)
+		{
+			m_indices.insert(m_indices.end(), { first, first + 1 + i, first + 1 + (i + 1) % segments });
+		}
+	}
+
+	void Batch2D::Line(const glm::vec2& a, const glm::vec2& b, f32 thickness, Color color)
+	{
+		glm::vec2 d = b - a;
+		f32 length = glm::length(d);
+		if (length == 0.0f) return;
+
+		glm::vec2 n = glm::vec2(-d.y, d.x) * (0.5f * thickness / length);
+
+		u32 first = Append(4, 6);
+
+		m_vertices[first + 0] = Vertex2D{ a - n, { 0.0f, 0.0f }, color };
+		m_vertices[first + 1] = Vertex2D{ b - n, { 1.0f, 0.0f }, color };
+		m_vertices[first + 2] = Vertex2D{ b + n, { 1.0f, 1.0f }, color };
+		m_vertices[first + 3] = Vertex2D{ a + n, { 0.0f, 1.0f }, color };
+
+		m_indices.insert(m_indices.end(), { first, first + 1, first + 2, first, first + 2, first + 3 });
+	}
+
+	void Batch2D::Build()
+	{
+		m_drawCalls.clear();
+
+		if (m_order == BatchOrder::Submission)
+		{
+			m_drawCalls.assign(m_runs.begin(), m_runs.end());
+			return;
+		}
+
+		// group the runs by key, keys are few so a linear search is fine
+		m_runGroup.resize(m_runs.size());
+		for (u32 r = 0; r < (u32)m_runs.size(); r++)
+		{
+			const DrawCall2D& run = m_runs[r];
+
+			u32 group = 0;
+			while (group < m_drawCalls.size() && (m_drawCalls[group].shader != run.shader || m_drawCalls[group].texture != run.texture)) {
+				group++;
+			}
+
+			if (group == m_drawCalls.size()) {
+				m_drawCalls.push_back(DrawCall2D{ run.shader, run.texture, 0, 0 });
+			}
+
+			m_drawCalls[group].indexCount += run.indexCount;
+			m_runGroup[r] = group;
+		}
+
+		u32 offset = 0;
+		for (DrawCall2D& call : m_drawCalls)
+		{
+			call.firstIndex = offset;
+			offset += call.indexCount;
+		}
+
+		// copy every run at the end of its group
+		m_sortedIndices.resize(m_indices.size());
+		for (DrawCall2D& call : m_drawCalls) {
+			call.indexCount = 0;
+		}
+
+		for (u32 r = 0; r < (u32)m_runs.size(); r++)
+		{
+			const DrawCall2D& run = m_runs[r];
+			DrawCall2D& call = m_drawCalls[m_runGroup[r]];
+
+			std::copy_n(m_indices.begin() + run.firstIndex, run.indexCount, m_sortedIndices.begin() + call.firstIndex + call.indexCount);
+			call.indexCount += run.indexCount;
+		}
+	}
+
+	// ---------------- Renderer2D ----------------
+
+	Renderer2D::Renderer2D()
+		:
+		m_defaultShader(RESOURCES_PATH"Shaders/Renderer2D/batch")
+	{
+		u8 white[4] = { 255, 255, 255, 255 };
+		m_whiteTexture = Texture(1, 1, TextureFormat::RGBA8UB, white);
+
+		ElementType arr[3] = { ElementType::FLOAT2, ElementType::FLOAT2, ElementType::UCHAR4_N };
+		Layout<3> layout(arr);
+
+		m_vertexArray.AddBuffer(VertexBuffer(nullptr, 0, BufferUsage::Stream), layout);
+		m_vertexArray.SetIndexBuffer(IndexBuffer(static_cast<const u32*>(nullptr), 0, BufferUsage::Stream));
+	}
+
+	void Renderer2D::Begin(const glm::mat4& view_proj)
+	{
+		Clear();
+		SetShader(nullptr);
+		SetTexture(nullptr);
+		m_viewProj = view_proj;
+	}
+
+	void Renderer2D::End()
+	{
+		Build();
+
+		std::span<const Vertex2D> vertices = Vertices();
+		std::span<const u32> indices = Indices();
+		std::span<const DrawCall2D> draw_calls = DrawCalls();
+
+		m_lastDrawCalls = (u32)draw_calls.size();
+		if (draw_calls.empty()) return;
+
+		// one upload for the whole frame
+		m_vertexArray.Bind();
+		m_vertexArray.GetBuffer(0).SetData(vertices.data(), (u32)vertices.size_bytes());
+		m_vertexArray.GetIndexBuffer().SetData(indices.data(), (u32)indices.size());
+
+		GLStateCache& cache = GetGLStateCache();
+		bool depth_test = cache.IsEnabled(GL_DEPTH_TEST);
+		cache.SetEnabled(GL_DEPTH_TEST, false);
+		cache.SetEnabled(GL_BLEND, true);
+		cache.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+		const ShaderProgram* bound_shader = nullptr;
+		const Texture* bound_texture = nullptr;
+
+		for (const DrawCall2D& call : draw_calls)
+		{
+			const ShaderProgram* shader = call.shader != nullptr ? call.shader : &m_defaultShader;
+			const Texture* texture = call.texture != nullptr ? call.texture : &m_whiteTexture;
+
+			if (shader != bound_shader)
+			{
+				static constexpr UniformName k_viewProj = "u_ViewProj";
+				static constexpr UniformName k_texture = "u_Texture";
+
+				shader->Bind();
+				shader->SetUniform(k_viewProj, m_viewProj);
+				shader->SetUniform(k_texture, 0);
+				bound_shader = shader;
+			}
+
+			if (texture != bound_texture)
+			{
+				texture->Bind(0);
+				bound_texture = texture;
+			}
+
+			glDrawElements(GL_TRIANGLES, call.indexCount, GL_UNSIGNED_INT, reinterpret_cast<void*>((u64)call.firstIndex * sizeof(u32)));
+		}
+
+		m_vertexArray.UnBind();
+		bound_shader->UnBind();
+
+		cache.SetEnabled(GL_DEPTH_TEST, depth_test);
+	}
+
+	void Renderer2D::End(CommandList& commands)
+	{
+		Build();
+
+		std::span<const Vertex2D> vertices = Vertices();
+		std::span<const u32> indices = Indices();
+		std::span<const DrawCall2D> draw_calls = DrawCalls();
+
+		m_lastDrawCalls = (u32)draw_calls.size();
+		if (draw_calls.empty()) return;
+
+		commands.UpdateVertexBuffer(m_vertexArray.GetBuffer(0), vertices.data(), (u32)vertices.size_bytes());
+		commands.UpdateIndexBuffer(m_vertexArray, indices.data(), (u32)indices.size());
+		commands.SetRenderState(RenderState{ false, true });
+		commands.BindVertexArray(m_vertexArray);
+
+		const ShaderProgram* bound_shader = nullptr;
+		const Texture* bound_texture = nullptr;
+
+		for (const DrawCall2D& call : draw_calls)
+		{
+			const ShaderProgram* shader = call.shader != nullptr ? call.shader : &m_defaultShader;
+			const Texture* texture = call.texture != nullptr ? call.texture : &m_whiteTexture;
+
+			if (shader != bound_shader)
+			{
+				commands.BindShader(*shader);
+				commands.SetUniforms(*shader, { { "u_ViewProj", m_viewProj }, { "u_Texture", 0 } });
+				bound_shader = shader;
+			}
+
+			if (texture != bound_texture)
+			{
+				commands.BindTexture(texture, 0);
+				bound_texture = texture;
+			}
+
+			commands.DrawIndexed(call.firstIndex, call.indexCount);
+		}
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <glm/glm.hpp>
+#include <LEO/Utilities/LeoTypes.h>
+#include <LEO/Utilities/LeoColors.h>
+#include "BufferObjects.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "CommandList.h"
+
+namespace leo
+{
+	struct Vertex2D
+	{
+		glm::vec2 position;
+		glm::vec2 uv;
+		Color     color;
+	};
+
+	// A range of the index stream drawn with one shader and one texture (nullptr = the renderer defaults)
+	struct DrawCall2D
+	{
+		const ShaderProgram* shader;
+		const Texture*       texture;
+		u32                  firstIndex;
+		u32                  indexCount;
+	};
+
+	enum class BatchOrder
+	{
+		Submission, // draw calls follow the submission order, a new one each time the shader or texture changes
+		ByKey       // one draw call per (shader, texture), primitives keep their order inside a key
+	};
+
+	/// <summary>
+	/// The CPU side of Renderer2D: appends primitives into one vertex/index stream and
+	/// splits it into draw calls keyed by shader and texture. It does not touch OpenGL,
+	/// so the generated buffers and draw calls can be inspected without a context.
+	/// </summary>
+	class Batch2D
+	{
+	public:
+		static constexpr u32 DEFAULT_CIRCLE_SEGMENTS = 32;
+	public:
+		Batch2D() = default;
+	public:
+		void Clear(); // drops the primitives, keeps the memory
+
+		// Key of the next primitives
+		void SetShader(const ShaderProgram* shader) { m_shader = shader; }
+		void SetTexture(const Texture* texture) { m_texture = texture; }
+		void SetOrder(BatchOrder order) { m_order = order; }
+	public:
+		// Primitives, counter-clockwise
+		void Triangle(const glm::vec2& a, const glm::vec2& b, const glm::vec2& c, Color color);
+		void Quad(const glm::vec2& min, const glm::vec2& max, Color color, const glm::vec2& uv_min = glm::vec2(0.0f), const glm::vec2& uv_max = glm::vec2(1.0f));
+		void Polygon(const glm::vec2* points, u32 count, Color color); // convex, triangulated as a fan
+		void Circle(const glm::vec2& center, f32 radius, Color color, u32 segments = DEFAULT_CIRCLE_SEGMENTS);
+		void Line(const glm::vec2& a, const glm::vec2& b, f32 thickness, Color color);
+	public:
+		// Builds the final index stream and draw-call list, called by Renderer2D::End
+		void Build();
+
+		std::span<const Vertex2D>   Vertices() const { return m_vertices; }
+		std::span<const u32>        Indices() const { return m_order == BatchOrder::ByKey ? m_sortedIndices : m_indices; }
+		std::span<const DrawCall2D> DrawCalls() const { return m_drawCalls; }
+	private:
+		// Reserves vertices and indices for a primitive with the current key, returns the first vertex index
+		u32 Append(u32 vertex_count, u32 index_count);
+	private:
+		const ShaderProgram* m_shader = nullptr;
+		const Texture* m_texture = nullptr;
+		BatchOrder m_order = BatchOrder::Submission;
+
+		std::vector<Vertex2D> m_vertices;
+		std::vector<u32> m_indices;
+		std::vector<DrawCall2D> m_runs;        // consecutive primitives with the same key, in submission order
+
+		std::vector<DrawCall2D> m_drawCalls;
+		std::vector<u32> m_sortedIndices;      // m_indices grouped by key (BatchOrder::ByKey)
+		std::vector<u32> m_runGroup;           // per run, the draw call it goes to
+	};
+
+	/// <summary>
+	/// Batched 2D renderer, everything submitted between Begin and End is uploaded once
+	/// and drawn with as few draw calls as the keys allow.
+	/// Custom shaders get the same inputs as the default one (resources/Shaders/Renderer2D).
+	/// </summary>
+	class Renderer2D : public Batch2D
+	{
+	public:
+		Renderer2D(); // needs an OpenGL context
+
+		Renderer2D(const Renderer2D&) = delete;
+		Renderer2D& operator=(const Renderer2D&) = delete;
+	public:
+		void Begin(const glm::mat4& view_proj);
+		void End(); // draws with alpha blending and no depth test
+		void End(CommandList& commands); // same, recorded (the vertices are copied into the list)
+
+		inline u32 LastDrawCallCount() const { return m_lastDrawCalls; }
+	private:
+		ShaderProgram m_defaultShader;
+		Texture m_whiteTexture;
+		VertexArray m_vertexArray;
+		glm::mat4 m_viewProj = glm::mat4(1.0f);
+		u32 m_lastDrawCalls = 0;
+	};
+}
@@ -1,26 +1,22 @@
+#include <algorithm>
 #include <glad/glad.h>
 #include <LEO/Log/Log.h>
-#include <LEO/Utilities/LeoFileUtilities.h>
+#include "GLStateCache.h"
+#include "ShaderCompiler.h"
 #include "Shader.h"
 
 
 namespace leo
 {
-	u32 CompileShader(const char* source, u32 type);
-	u32 CreateShaderProgramFromSource(const char* vertSrc, const char* geoSrc, const char* fragSrc);
-
 	ShaderProgram::ShaderProgram(const std::string& filepath)
 		:
 		m_program_id(0)
 	{
-		std::string vert_source = ReadFile(filepath + ".vert");
-		std::string geom_source = ReadFile(filepath + ".geom");
-		std::string frag_source = ReadFile(filepath + ".frag");
-
-		LEOASSERT(vert_source != "", "Vertex shader missing!");
-		LEOASSERT(frag_source != "", "Fragment shader missing!");
+		ShaderCompiler compiler;
+		ShaderTicket ticket = compiler.Submit(filepath);
+		compiler.WaitAll();
 
-		Reload(vert_source.c_str(), ((geom_source == "") ? nullptr : geom_source.c_str()), frag_source.c_str());
+		*this = compiler.Take(ticket);
 	}
 
 	ShaderProgram::ShaderProgram(const char* vertSrc, const char* fragSrc)
@@ -46,7 +42,7 @@ namespace leo
 
 	ShaderProgram& ShaderProgram::operator=(ShaderProgram&& other) noexcept
 	{
-		glDeleteProgram(m_program_id);
+		GetGLStateCache().DeleteProgram(m_program_id);
 
 		m_program_id = other.m_program_id;
 		m_uniforms = std::move(other.m_uniforms);
@@ -58,25 +54,19 @@ namespace leo
 
 	ShaderProgram::~ShaderProgram()
 	{
-		glDeleteProgram(m_program_id);
+		GetGLStateCache().DeleteProgram(m_program_id);
 	}
 
 	bool ShaderProgram::Reload(const char* vertexSrc, const char* geoSrc, const char* fragSrc)
 	{
-		u32 new_program = CreateShaderProgramFromSource(vertexSrc, geoSrc, fragSrc);
-
-		if (new_program == 0) // if new program failed to Compiled
-		{
-			return false; // we do nothing and return false
-		}
-
-		// delete old 
-		glDeleteProgram(m_program_id);
-		m_uniforms.clear();
+		ShaderCompiler compiler;
+		ShaderTicket ticket = compiler.Submit(vertexSrc, geoSrc, fragSrc);
+		compiler.WaitAll();
 
-		// replace
-		m_program_id = new_program;
+		// the error is logged by the compiler, the current program is kept
+		if (!compiler.IsReady(ticket)) return false;
 
+		*this = compiler.Take(ticket);
 		return true;
 	}
 
@@ -87,268 +77,224 @@ namespace leo
 
 	void ShaderProgram::Bind() const
 	{
-		glUseProgram(m_program_id);
+		GetGLStateCache().UseProgram(m_program_id);
 	}
 
 	void ShaderProgram::UnBind() const
 	{
-		glUseProgram(0);
+		GetGLStateCache().UseProgram(0);
 	}
 
-	bool ShaderProgram::SetUniform(const std::string& name, float num) const
+	UniformHandle ShaderProgram::GetUniformHandle(UniformName name) const
 	{
-		i32 location = GetLocation(name);
+		auto it = std::lower_bound(m_uniforms.begin(), m_uniforms.end(), name.hash,
+			[](const ReflectedUniform& uniform, u64 hash) { return uniform.hash < hash; });
 
-		if (location != -1)
-		{
-			glUniform1f(location, num);
-			return true;
+		if (it == m_uniforms.end() || it->hash != name.hash) {
+			return UniformHandle{};
 		}
 
-		return false;
+		return UniformHandle{ it->location, it->type, m_program_id };
 	}
 
-	bool ShaderProgram::SetUniform(const std::string& name, glm::vec2 a) const
+	bool ShaderProgram::SetUniform(UniformHandle handle, float num) const
 	{
-		i32 location = GetLocation(name);
+		if (!CheckHandle(handle, GL_FLOAT)) return false;
 
-		if (location != -1)
-		{
-			glUniform2f(location, a.x, a.y);
-			return true;
-		}
-
-		return false;
+		glUniform1f(handle.location, num);
+		return true;
 	}
 
-	bool ShaderProgram::SetUniform(const std::string& name, glm::vec3 a) const
+	bool ShaderProgram::SetUniform(UniformHandle handle, glm::vec2 a) const
 	{
-		i32 location = GetLocation(name);
-
-		if (location != -1)
-		{
-			glUniform3f(location, a.x, a.y, a.z);
-			return true;
-		}
+		if (!CheckHandle(handle, GL_FLOAT_VEC2)) return false;
 
-		return false;
+		glUniform2f(handle.location, a.x, a.y);
+		return true;
 	}
 
-	bool ShaderProgram::SetUniform(const std::string& name, glm::vec4 a) const
+	bool ShaderProgram::SetUniform(UniformHandle handle, glm::vec3 a) const
 	{
-		i32 location = GetLocation(name);
-
-		if (location != -1)
-		{
-			glUniform4f(location, a.x, a.y, a.z, a.w);
-			return true;
-		}
+		if (!CheckHandle(handle, GL_FLOAT_VEC3)) return false;
 
-		return false;
+		glUniform3f(handle.location, a.x, a.y, a.z);
+		return true;
 	}
 
-	bool ShaderProgram::SetUniform(const std::string& name, int i) const
+	bool ShaderProgram::SetUniform(UniformHandle handle, glm::vec4 a) const
 	{
-		i32 location = GetLocation(name);
-
-		if (location != -1)
-		{
-			glUniform1i(location, i);
-			return true;
-		}
+		if (!CheckHandle(handle, GL_FLOAT_VEC4)) return false;
 
-		return false;
+		glUniform4f(handle.location, a.x, a.y, a.z, a.w);
+		return true;
 	}
 
-	bool ShaderProgram::SetUniform(const std::string& name, glm::ivec3 a) const
+	bool ShaderProgram::SetUniform(UniformHandle handle, int i) const
 	{
-		i32 location = GetLocation(name);
+		if (!CheckHandle(handle, GL_INT)) return false;
 
-		if (location != -1)
-		{
-			glUniform3i(location, a.x, a.y, a.z);
-			return true;
-		}
-
-		return false;
+		glUniform1i(handle.location, i);
+		return true;
 	}
 
-	bool ShaderProgram::SetUniform(const std::string& name, glm::uvec3 a) const
+	bool ShaderProgram::SetUniform(UniformHandle handle, glm::ivec3 a) const
 	{
-		i32 location = GetLocation(name);
+		if (!CheckHandle(handle, GL_INT_VEC3)) return false;
 
-		if (location != -1)
-		{
-			glUniform3ui(location, a.x, a.y, a.z);
-			return true;
-		}
-
-		return false;
+		glUniform3i(handle.location, a.x, a.y, a.z);
+		return true;
 	}
 
-	bool ShaderProgram::SetUniform(const std::string& name, unsigned int i) const
+	bool ShaderProgram::SetUniform(UniformHandle handle, glm::uvec3 a) const
 	{
-		i32 location = GetLocation(name);
+		if (!CheckHandle(handle, GL_UNSIGNED_INT_VEC3)) return false;
 
-		if (location != -1)
-		{
-			glUniform1ui(location, i);
-			return true;
-		}
-
-		return false;
+		glUniform3ui(handle.location, a.x, a.y, a.z);
+		return true;
 	}
 
-	bool ShaderProgram::SetUniform(const std::string& name, const glm::mat4& mat) const
+	bool ShaderProgram::SetUniform(UniformHandle handle, unsigned int i) const
 	{
-		i32 location = GetLocation(name);
-
-		if (location != -1)
-		{
-			glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(mat));
-			return true;
-		}
+		if (!CheckHandle(handle, GL_UNSIGNED_INT)) return false;
 
-		return false;
+		glUniform1ui(handle.location, i);
+		return true;
 	}
 
-	bool ShaderProgram::SetUniform(const std::string& name, const glm::mat3& mat) const
+	bool ShaderProgram::SetUniform(UniformHandle handle, const glm::mat4& mat) const
 	{
-		i32 location = GetLocation(name);
-
-		if (location != -1)
-		{
-			glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(mat));
-			return true;
-		}
+		if (!CheckHandle(handle, GL_FLOAT_MAT4)) return false;
 
-		return false;
+		glUniformMatrix4fv(handle.location, 1, GL_FALSE, glm::value_ptr(mat));
+		return true;
 	}
 
-	bool ShaderProgram::SetUniform(const std::string& name, const std::vector<glm::vec2>& vec_arr, u32 size)
+	bool ShaderProgram::SetUniform(UniformHandle handle, const glm::mat3& mat) const
 	{
+		if (!CheckHandle(handle, GL_FLOAT_MAT3)) return false;
 
-		for (u32 i = 0; i < size; i++)
-		{
-			i32 location = GetLocation(name + "[" + std::to_string(i) + "]");
-
-			if (location == -1) {
-				return false;
-			}
-
-			glUniform2f(location, vec_arr[i].x, vec_arr[i].y);
-		}
-
+		glUniformMatrix3fv(handle.location, 1, GL_FALSE, glm::value_ptr(mat));
 		return true;
 	}
 
-	bool ShaderProgram::SetUniform(const std::string& name, const std::vector<glm::vec3>& vec_arr, u32 size)
+	bool ShaderProgram::SetUniform(UniformName name, const std::vector<glm::vec2>& vec_arr, u32 size)
 	{
-		for (u32 i = 0; i < size; i++)
-		{
-			i32 location = GetLocation(name + "[" + std::to_string(i) + "]");
+		UniformHandle handle = GetUniformHandle(name);
+		if (!CheckHandle(handle, GL_FLOAT_VEC2) || size > vec_arr.size()) return false;
 
-			if (location == -1) {
-				return false;
-			}
+		glUniform2fv(handle.location, size, glm::value_ptr(vec_arr[0]));
+		return true;
+	}
 
-			glUniform3f(location, vec_arr[i].x, vec_arr[i].y, vec_arr[i].z);
-		}
+	bool ShaderProgram::SetUniform(UniformName name, const std::vector<glm::vec3>& vec_arr, u32 size)
+	{
+		UniformHandle handle = GetUniformHandle(name);
+		if (!CheckHandle(handle, GL_FLOAT_VEC3) || size > vec_arr.size()) return false;
 
+		glUniform3fv(handle.location, size, glm::value_ptr(vec_arr[0]));
 		return true;
 	}
 
-	i32 ShaderProgram::GetLocation(const std::string& name) const
+	// samplers and images are set with an int, booleans with any scalar
+	static bool IsOpaqueType(u32 type)
 	{
-		if (m_uniforms.find(name) != m_uniforms.end())
+		switch (type)
 		{
-			return m_uniforms[name];
+		case GL_FLOAT: case GL_FLOAT_VEC2: case GL_FLOAT_VEC3: case GL_FLOAT_VEC4:
+		case GL_DOUBLE: case GL_DOUBLE_VEC2: case GL_DOUBLE_VEC3: case GL_DOUBLE_VEC4:
+		case GL_INT: case GL_INT_VEC2: case GL_INT_VEC3: case GL_INT_VEC4:
+		case GL_UNSIGNED_INT: case GL_UNSIGNED_INT_VEC2: case GL_UNSIGNED_INT_VEC3: case GL_UNSIGNED_INT_VEC4:
+		case GL_BOOL: case GL_BOOL_VEC2: case GL_BOOL_VEC3: case GL_BOOL_VEC4:
+		case GL_FLOAT_MAT2: case GL_FLOAT_MAT3: case GL_FLOAT_MAT4:
+		case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT3x2:
+		case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x2: case GL_FLOAT_MAT4x3:
+		case GL_DOUBLE_MAT2: case GL_DOUBLE_MAT3: case GL_DOUBLE_MAT4:
+		case GL_DOUBLE_MAT2x3: case GL_DOUBLE_MAT2x4: case GL_DOUBLE_MAT3x2:
+		case GL_DOUBLE_MAT3x4: case GL_DOUBLE_MAT4x2: case GL_DOUBLE_MAT4x3:
+			return false;
+		default:
+			return true;
 		}
+	}
 
-		i32 loc;
-		loc = glGetUniformLocation(m_program_id, name.c_str());
+	static bool UniformTypeMatches(u32 uniform_type, u32 value_type)
+	{
+		if (uniform_type == value_type) return true;
 
-		if (loc != -1)
+		switch (value_type)
 		{
-			m_uniforms[name] = loc;
+		case GL_INT:          return uniform_type == GL_BOOL || IsOpaqueType(uniform_type);
+		case GL_UNSIGNED_INT: return uniform_type == GL_BOOL;
+		case GL_FLOAT:        return uniform_type == GL_BOOL;
+		default:              return false;
 		}
-
-		return loc;
 	}
 
-	bool ShaderProgram::IsValid() const
+	bool ShaderProgram::CheckHandle(UniformHandle handle, u32 value_type) const
 	{
-		return m_program_id != 0;
-	}
+		if (!handle.IsValid()) return false;
 
+		LEOASSERTF(handle.program == m_program_id, "Uniform handle of program {} used with program {}, resolve it again after a Reload", handle.program, m_program_id);
+		LEOASSERTF(UniformTypeMatches(handle.type, value_type), "Uniform at location {} of program {} has the GL type 0x{:X}, it is set with a value of type 0x{:X}",
+			handle.location, m_program_id, handle.type, value_type);
+		(void)value_type;
 
-	u32 CompileShader(const char* source, u32 type)
-	{
-		if (source == nullptr) return 0;
-
-		u32 id = glCreateShader(type);
-
-		glShaderSource(id, 1, &source, nullptr);
-		glCompileShader(id);
+		return true;
+	}
 
-		int resoult;
-		glGetShaderiv(id, GL_COMPILE_STATUS, &resoult);
-		if (resoult == GL_FALSE)
-		{
-			//if (type == GL_VERTEX_SHADER)
-			//{
-			//	LOGERROR("<VERTEX SHADER COMPILE ERROR>");
-			//}
-			//else if (type == GL_FRAGMENT_SHADER)
-			//{
-			//	LOGERROR("<FRAGMENT SHADER COMPILE ERROR>");
-			//}
-			//else if (type == GL_GEOMETRY_SHADER)
-			//{
-			//	LOGERROR("<GEOMETRY SHADER COMPILE ERROR>");
-			//}
-
-			//char msg[512];
-			//glGetShaderInfoLog(id, 512, NULL, msg);
-			//LOGERROR("error").Note(msg);
-
-			glDeleteShader(id);
-			return 0;
-		}
+	void ShaderProgram::Adopt(u32 program)
+	{
+		GetGLStateCache().DeleteProgram(m_program_id);
 
-		return id;
+		m_program_id = program;
+		Reflect();
 	}
 
-	u32 CreateShaderProgramFromSource(const char* vertSrc, const char* geoSrc, const char* fragSrc)
+	void ShaderProgram::Reflect()
 	{
-		u32 vs = CompileShader(vertSrc, GL_VERTEX_SHADER);
-		u32 gs = CompileShader(geoSrc, GL_GEOMETRY_SHADER);
-		u32 fs = CompileShader(fragSrc, GL_FRAGMENT_SHADER);
-
-		u32 programid = glCreateProgram();
+		m_uniforms.clear();
 
-		if (vs == 0 || fs == 0) return 0;
-		if (geoSrc != nullptr && gs == 0) return 0;
+		GLint count = 0;
+		GLint max_length = 0;
+		glGetProgramiv(m_program_id, GL_ACTIVE_UNIFORMS, &count);
+		glGetProgramiv(m_program_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
 
+		std::string name(glm::max(max_length, 1), '\0');
 
-		glAttachShader(programid, vs);
-		if (gs != 0)
+		for (GLint i = 0; i < count; i++)
 		{
-			glAttachShader(programid, gs);
+			GLsizei length = 0;
+			GLint size = 0;
+			GLenum type = 0;
+			glGetActiveUniform(m_program_id, (GLuint)i, max_length, &length, &size, &type, name.data());
+
+			// members of uniform blocks have no location
+			i32 location = glGetUniformLocation(m_program_id, name.c_str());
+			if (location == -1) continue;
+
+			std::string_view reflected(name.data(), length);
+			m_uniforms.push_back(ReflectedUniform{ HashUniformName(reflected), location, type, size, std::string(reflected) });
+
+			// arrays are reported as "arr[0]", they can be set by "arr" too
+			if (reflected.ends_with("[0]"))
+			{
+				std::string_view array_name = reflected.substr(0, reflected.size() - 3);
+				m_uniforms.push_back(ReflectedUniform{ HashUniformName(array_name), location, type, size, std::string(array_name) });
+			}
 		}
-		glAttachShader(programid, fs);
 
-		glLinkProgram(programid);
-		glValidateProgram(programid);
+		std::sort(m_uniforms.begin(), m_uniforms.end(),
+			[](const ReflectedUniform& a, const ReflectedUniform& b) { return a.hash < b.hash; });
 
-		glDeleteShader(vs);
-		if (gs != 0)
-		{
-			glDeleteShader(gs);
+		for (u64 i = 1; i < m_uniforms.size(); i++) {
+			LEOASSERTF(m_uniforms[i - 1].hash != m_uniforms[i].hash, "Uniform name hash collision: {} and {}", m_uniforms[i - 1].name, m_uniforms[i].name);
 		}
-		glDeleteShader(fs);
+	}
 
-		return programid;
+	bool ShaderProgram::IsValid() const
+	{
+		return m_program_id != 0;
 	}
 }
 
+
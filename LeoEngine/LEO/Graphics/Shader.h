@@ -2,11 +2,55 @@
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
+#include <span>
 #include <LEO/Utilities/LeoTypes.h>
 
 namespace leo
 {
+	// FNV-1a of a uniform name, usable at compile time
+	constexpr u64 HashUniformName(std::string_view name)
+	{
+		u64 hash = 14695981039346656037ull;
+		for (char c : name)
+		{
+			hash ^= (u8)c;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	// A hashed uniform name, declare it static constexpr to hash at compile time
+	struct UniformName
+	{
+		u64 hash;
+
+		constexpr UniformName(const char* name) : hash(HashUniformName(name)) {}
+		constexpr UniformName(std::string_view name) : hash(HashUniformName(name)) {}
+		UniformName(const std::string& name) : hash(HashUniformName(name)) {}
+	};
+
+	// A uniform location resolved once (GetUniformHandle), valid until the program is reloaded
+	struct UniformHandle
+	{
+		i32 location = -1;
+		u32 type     = 0; // GL type from the reflection, checked against the value in debug builds
+		u32 program  = 0;
+
+		inline bool IsValid() const { return location != -1; }
+	};
+
+	// An active uniform found at link time (glGetActiveUniform), uniform block members are not listed
+	struct ReflectedUniform
+	{
+		u64 hash;
+		i32 location;
+		u32 type;
+		i32 count; // array size, 1 otherwise
+		std::string name;
+	};
+
 	class ShaderProgram
 	{
 	public:
@@ -36,24 +80,40 @@ namespace leo
 		void Bind() const;
 		void UnBind() const;
 	public:
-		bool SetUniform(const std::string& name, float num) const;
-		bool SetUniform(const std::string& name, glm::vec2 a) const;
-		bool SetUniform(const std::string& name, glm::vec3 a) const;
-		bool SetUniform(const std::string& name, glm::vec4 a) const;
-		bool SetUniform(const std::string& name, int i) const;
-		bool SetUniform(const std::string& name, glm::ivec3 a) const;
-		bool SetUniform(const std::string& name, glm::uvec3 a) const;
-		bool SetUniform(const std::string& name, unsigned int i) const;
-		bool SetUniform(const std::string& name, const glm::mat4& mat) const;
-		bool SetUniform(const std::string& name, const glm::mat3& mat) const;
+		// Binary search in the reflected uniforms, an invalid handle when the uniform is not active
+		UniformHandle GetUniformHandle(UniformName name) const;
+
+		// The program must be bound. No lookup, returns false for an invalid handle
+		bool SetUniform(UniformHandle handle, float num) const;
+		bool SetUniform(UniformHandle handle, glm::vec2 a) const;
+		bool SetUniform(UniformHandle handle, glm::vec3 a) const;
+		bool SetUniform(UniformHandle handle, glm::vec4 a) const;
+		bool SetUniform(UniformHandle handle, int i) const;
+		bool SetUniform(UniformHandle handle, glm::ivec3 a) const;
+		bool SetUniform(UniformHandle handle, glm::uvec3 a) const;
+		bool SetUniform(UniformHandle handle, unsigned int i) const;
+		bool SetUniform(UniformHandle handle, const glm::mat4& mat) const;
+		bool SetUniform(UniformHandle handle, const glm::mat3& mat) const;
+
+		// By name, one lookup per call
+		template<typename T>
+		bool SetUniform(UniformName name, const T& value) const { return SetUniform(GetUniformHandle(name), value); }
 	public:
-		bool SetUniform(const std::string& name, const std::vector<glm::vec2>& vec_arr, u32 size);
-		bool SetUniform(const std::string& name, const std::vector<glm::vec3>& vec_arr, u32 size);
+		// Whole arrays, the name is the one of the array ("arr" or "arr[0]")
+		bool SetUniform(UniformName name, const std::vector<glm::vec2>& vec_arr, u32 size);
+		bool SetUniform(UniformName name, const std::vector<glm::vec3>& vec_arr, u32 size);
+	public:
+		// Sorted by hash
+		inline std::span<const ReflectedUniform> Uniforms() const { return m_uniforms; }
 	private:
-		i32 GetLocation(const std::string& name) const;
+		void Adopt(u32 program); // takes ownership of a linked program
+		void Reflect();
+		bool CheckHandle(UniformHandle handle, u32 value_type) const;
 		bool IsValid() const;
 	private:
 		u32 m_program_id = 0;
-		mutable std::unordered_map<std::string, i32> m_uniforms; // storing uniforms locations
+		std::vector<ReflectedUniform> m_uniforms; // reflected at link time
+	private:
+		friend class ShaderCompiler;
 	};
 }
\ No newline at end of file
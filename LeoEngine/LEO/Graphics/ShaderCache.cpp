@@ -0,0 +1,202 @@
+#include <fstream>
+#include <vector>
+#include <format>
+#include <glad/glad.h>
+#include <LEO/Log/Log.h>
+#include "GLStateCache.h"
+#include "ShaderCache.h"
+
+namespace leo
+{
+	static constexpr u32 k_binaryMagic = 0x4342504C; // "LPBC"
+	static constexpr u32 k_binaryVersion = 1;
+
+	struct ProgramBinaryHeader
+	{
+		u32 magic;
+		u32 version;
+		u64 key;
+		u32 format; // driver specific, from glGetProgramBinary
+		u32 size;
+	};
+
+	static u64 Fnv1a(u64 hash, const void* data, u64 size)
+	{
+		const u8* bytes = static_cast<const u8*>(data);
+		for (u64 i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	static u64 Fnv1a(u64 hash, std::string_view text)
+	{
+		// the terminator separates the strings, "ab" + "c" and "a" + "bc" differ
+		hash = Fnv1a(hash, text.data(), text.size());
+		return Fnv1a(hash, "", 1);
+	}
+
+	static std::string_view GLString(GLenum name)
+	{
+		const GLubyte* string = glGetString(name);
+		return string != nullptr ? reinterpret_cast<const char*>(string) : "";
+	}
+
+	void ShaderCache::SetDirectory(const std::filesystem::path& directory)
+	{
+		m_directory = directory;
+		if (m_directory.empty()) return;
+
+		std::error_code error;
+		std::filesystem::create_directories(m_directory, error);
+		if (error)
+		{
+			LEOLOGWARN("Shader cache disabled, can't create {}: {}", m_directory.string(), error.message());
+			m_directory.clear();
+		}
+	}
+
+	u64 ShaderCache::Key(const char* vert_src, const char* geo_src, const char* frag_src)
+	{
+		if (m_driver.empty()) {
+			m_driver = std::format("{}|{}|{}", GLString(GL_VENDOR), GLString(GL_RENDERER), GLString(GL_VERSION));
+		}
+
+		u64 hash = 14695981039346656037ull;
+		hash = Fnv1a(hash, m_driver);
+		hash = Fnv1a(hash, vert_src != nullptr ? vert_src : "");
+		hash = Fnv1a(hash, geo_src != nullptr ? geo_src : "");
+		hash = Fnv1a(hash, frag_src != nullptr ? frag_src : "");
+		return hash;
+	}
+
+	u32 ShaderCache::Load(u64 key)
+	{
+		if (!IsEnabled()) return 0;
+
+		std::filesystem::path path = PathOf(key);
+		std::ifstream file(path, std::ios::binary);
+		if (!file) return 0;
+
+		ProgramBinaryHeader header = {};
+		std::vector<u8> binary;
+
+		bool valid = (bool)file.read(reinterpret_cast<char*>(&header), sizeof(header))
+			&& header.magic == k_binaryMagic
+			&& header.version == k_binaryVersion
+			&& header.key == key
+			&& header.size > 0;
+
+		if (valid)
+		{
+			binary.resize(header.size);
+			valid = (bool)file.read(reinterpret_cast<char*>(binary.data()), header.size);
+		}
+		file.close();
+
+		u32 program = 0;
+		if (valid)
+		{
+			program = glCreateProgram();
+			glProgramBinary(program, header.format, binary.data(), (GLsizei)binary.size());
+
+			GLint status = GL_FALSE;
+			glGetProgramiv(program, GL_LINK_STATUS, &status);
+			if (status != GL_TRUE)
+			{
+				GetGLStateCache().DeleteProgram(program);
+				program = 0;
+			}
+		}
+
+		if (program == 0)
+		{
+			// stale (driver update) or corrupted, it is replaced by the next Store
+			m_stats.rejected++;
+			std::error_code error;
+			std::filesystem::remove(path, error);
+			return 0;
+		}
+
+		m_stats.hits++;
+		return program;
+	}
+
+	void ShaderCache::Store(u64 key, u32 program)
+	{
+		if (!IsEnabled() || program == 0) return;
+
+		GLint length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0) return; // the driver does not support program binaries
+
+		std::vector<u8> binary(length);
+		GLenum format = 0;
+		GLsizei written = 0;
+		glGetProgramBinary(program, length, &written, &format, binary.data());
+		if (written <= 0) return;
+
+		ProgramBinaryHeader header = { k_binaryMagic, k_binaryVersion, key, format, (u32)written };
+
+		// written next to the final file and renamed, a crash never leaves a truncated binary behind
+		std::filesystem::path path = PathOf(key);
+		std::filesystem::path temp = path;
+		temp += ".tmp";
+
+		{
+			std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(binary.data()), written);
+			if (!file)
+			{
+				LEOLOGWARN("Failed to write the shader cache entry {}", temp.string());
+				return;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temp, path, error);
+		if (error)
+		{
+			LEOLOGWARN("Failed to write the shader cache entry {}: {}", path.string(), error.message());
+			std::filesystem::remove(temp, error);
+			return;
+		}
+
+		m_stats.stores++;
+	}
+
+	void ShaderCache::Clear()
+	{
+		if (!IsEnabled()) return;
+
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator(m_directory, error))
+		{
+			if (entry.path().extension() == ".bin") {
+				std::filesystem::remove(entry.path(), error);
+			}
+		}
+	}
+
+	void ShaderCache::LogReport() const
+	{
+		u32 programs = m_stats.hits + m_stats.misses;
+		LEOLOGINFO("Shader startup: {} programs in {:.2f}ms, {} from cache ({:.2f}ms), {} compiled from source ({:.2f}ms), {} rejected binaries, cache {}",
+			programs, m_stats.loadMs + m_stats.compileMs, m_stats.hits, m_stats.loadMs, m_stats.misses, m_stats.compileMs,
+			m_stats.rejected, IsEnabled() ? m_directory.string() : "disabled");
+	}
+
+	std::filesystem::path ShaderCache::PathOf(u64 key) const
+	{
+		return m_directory / std::format("{:016x}.bin", key);
+	}
+
+	ShaderCache& GetShaderCache()
+	{
+		static ShaderCache cache;
+		return cache;
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <filesystem>
+#include <LEO/Utilities/LeoTypes.h>
+
+namespace leo
+{
+	struct ShaderCacheStats
+	{
+		u32 hits     = 0; // programs loaded from a binary
+		u32 misses   = 0; // programs compiled from source
+		u32 stores   = 0; // binaries written
+		u32 rejected = 0; // binaries found but refused by the driver (or corrupted), compiled from source instead
+		f32 loadMs    = 0.0f;
+		f32 compileMs = 0.0f;
+	};
+
+	/// <summary>
+	/// On-disk cache of linked programs (glGetProgramBinary / glProgramBinary), used by ShaderProgram.
+	/// A binary is keyed by a hash of the sources and of the GL vendor, renderer and version strings,
+	/// so a driver update or an edited shader never loads a stale program. Anything unexpected falls
+	/// back to compiling from source. Disabled until a directory is set.
+	/// </summary>
+	class ShaderCache
+	{
+	public:
+		ShaderCache() = default;
+
+		ShaderCache(const ShaderCache&) = delete;
+		ShaderCache& operator=(const ShaderCache&) = delete;
+	public:
+		// Creates the directory if needed, an empty path disables the cache
+		void SetDirectory(const std::filesystem::path& directory);
+		inline bool IsEnabled() const { return !m_directory.empty(); }
+
+		// Key of a program, geo_src may be nullptr. Needs the GL context (driver strings)
+		u64 Key(const char* vert_src, const char* geo_src, const char* frag_src);
+
+		// A linked program, or 0 when there is no usable binary for this key
+		u32 Load(u64 key);
+
+		// Saves the binary of a linked program, it must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+		void Store(u64 key, u32 program);
+
+		void Clear(); // deletes every cached binary
+	public:
+		// Timings of ShaderProgram creation, with and without the cache
+		void AddLoadTime(f32 ms) { m_stats.loadMs += ms; }
+		void AddCompileTime(f32 ms) { m_stats.compileMs += ms; m_stats.misses++; }
+
+		inline const ShaderCacheStats& Stats() const { return m_stats; }
+		void ResetStats() { m_stats = {}; }
+
+		// Logs the startup report: programs from cache / from source and the time spent in each
+		void LogReport() const;
+	private:
+		std::filesystem::path PathOf(u64 key) const;
+	private:
+		std::filesystem::path m_directory;
+		std::string m_driver; // vendor, renderer and version, queried on first use
+		ShaderCacheStats m_stats;
+	};
+
+	// The cache used by ShaderProgram
+	ShaderCache& GetShaderCache();
+}
@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <format>
+#include <utility>
+#include <glad/glad.h>
+#include <LEO/Log/Log.h>
+#include <LEO/Utilities/LeoFileUtilities.h>
+#include <LEO/Utilities/LeoTimer.h>
+#include "GLStateCache.h"
+#include "ShaderCache.h"
+#include "ShaderCompiler.h"
+
+namespace leo
+{
+	static constexpr u32 k_stageTypes[3] = { GL_VERTEX_SHADER, GL_GEOMETRY_SHADER, GL_FRAGMENT_SHADER };
+	static constexpr const char* k_stageNames[3] = { "vertex", "geometry", "fragment" };
+
+	static std::string ShaderInfoLog(u32 shader)
+	{
+		GLint length = 0;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+
+		std::string log(std::max(length, 1), '\0');
+		GLsizei written = 0;
+		glGetShaderInfoLog(shader, (GLsizei)log.size(), &written, log.data());
+		log.resize(written);
+		return log;
+	}
+
+	static std::string ProgramInfoLog(u32 program)
+	{
+		GLint length = 0;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+
+		std::string log(std::max(length, 1), '\0');
+		GLsizei written = 0;
+		glGetProgramInfoLog(program, (GLsizei)log.size(), &written, log.data());
+		log.resize(written);
+		return log;
+	}
+
+	bool ShaderCompiler::IsParallel()
+	{
+		return GLAD_GL_KHR_parallel_shader_compile || GLAD_GL_ARB_parallel_shader_compile;
+	}
+
+	// once per process, the driver keeps the setting for the context
+	static void EnableDriverCompilerThreads()
+	{
+		static bool s_enabled = false;
+		if (s_enabled || !ShaderCompiler::IsParallel()) return;
+		s_enabled = true;
+
+		// 0xFFFFFFFF lets the driver choose the number of threads
+		if (GLAD_GL_KHR_parallel_shader_compile) glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+		else if (GLAD_GL_ARB_parallel_shader_compile) glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+	}
+
+	ShaderCompiler::~ShaderCompiler()
+	{
+		for (Build& build : m_builds) {
+			DeleteObjects(build);
+		}
+	}
+
+	ShaderTicket ShaderCompiler::Submit(const std::string& filepath)
+	{
+		std::string vert_source = ReadFile(filepath + ".vert");
+		std::string geom_source = ReadFile(filepath + ".geom");
+		std::string frag_source = ReadFile(filepath + ".frag");
+
+		LEOASSERTF(vert_source != "", "Vertex shader missing! {}", filepath);
+		LEOASSERTF(frag_source != "", "Fragment shader missing! {}", filepath);
+
+		return Submit(vert_source.c_str(), ((geom_source == "") ? nullptr : geom_source.c_str()), frag_source.c_str(), filepath);
+	}
+
+	ShaderTicket ShaderCompiler::Submit(const char* vertSrc, const char* geoSrc, const char* fragSrc, const std::string& name)
+	{
+		LEOASSERT(vertSrc != nullptr && fragSrc != nullptr, "A program needs a vertex and a fragment shader");
+
+		ShaderTicket ticket{ (u32)m_builds.size() };
+		Build& build = m_builds.emplace_back();
+		build.name = name;
+
+		ShaderCache& cache = GetShaderCache();
+		Timer timer;
+
+		if (cache.IsEnabled())
+		{
+			build.key = cache.Key(vertSrc, geoSrc, fragSrc);
+
+			u32 program = cache.Load(build.key);
+			if (program != 0)
+			{
+				build.result.Adopt(program);
+				build.state = ShaderBuildState::Ready;
+				cache.AddLoadTime(timer.ElapsedMillis());
+				return ticket;
+			}
+		}
+
+		EnableDriverCompilerThreads();
+
+		const char* sources[3] = { vertSrc, geoSrc, fragSrc };
+		build.program = glCreateProgram();
+
+		for (u32 i = 0; i < 3; i++)
+		{
+			if (sources[i] == nullptr) continue;
+
+			u32 shader = glCreateShader(k_stageTypes[i]);
+			glShaderSource(shader, 1, &sources[i], nullptr);
+			glCompileShader(shader);
+			glAttachShader(build.program, shader);
+			build.shaders[i] = shader;
+		}
+
+		// linked without querying the compile status, it would wait for the compile.
+		// A stage that failed to compile fails the link and is reported by Finish
+		glProgramParameteri(build.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE); // lets the ShaderCache read the binary back
+		glLinkProgram(build.program);
+
+		build.submitMs = timer.ElapsedMillis();
+		m_pending++;
+		return ticket;
+	}
+
+	u32 ShaderCompiler::Poll()
+	{
+		for (Build& build : m_builds)
+		{
+			if (build.state == ShaderBuildState::Pending && IsComplete(build)) {
+				Finish(build);
+			}
+		}
+		return m_pending;
+	}
+
+	void ShaderCompiler::WaitAll()
+	{
+		for (Build& build : m_builds)
+		{
+			if (build.state == ShaderBuildState::Pending) {
+				Finish(build);
+			}
+		}
+	}
+
+	ShaderBuildState ShaderCompiler::State(ShaderTicket ticket) const
+	{
+		LEOASSERTF(ticket.index < m_builds.size(), "Shader ticket {} was not returned by this compiler", ticket.index);
+		return m_builds[ticket.index].state;
+	}
+
+	const std::string& ShaderCompiler::Error(ShaderTicket ticket) const
+	{
+		LEOASSERTF(ticket.index < m_builds.size(), "Shader ticket {} was not returned by this compiler", ticket.index);
+		return m_builds[ticket.index].error;
+	}
+
+	ShaderProgram ShaderCompiler::Take(ShaderTicket ticket)
+	{
+		LEOASSERTF(ticket.index < m_builds.size(), "Shader ticket {} was not returned by this compiler", ticket.index);
+		Build& build = m_builds[ticket.index];
+
+		LEOASSERTF(build.state != ShaderBuildState::Taken, "The program {} was already taken", build.name);
+		if (build.state != ShaderBuildState::Ready) return ShaderProgram{};
+
+		build.state = ShaderBuildState::Taken;
+		return std::move(build.result);
+	}
+
+	bool ShaderCompiler::IsComplete(const Build& build) const
+	{
+		// without the extension the completion can't be queried, Finish blocks
+		if (!IsParallel()) return true;
+
+		GLint complete = GL_FALSE;
+		glGetProgramiv(build.program, GL_COMPLETION_STATUS_KHR, &complete);
+		return complete == GL_TRUE;
+	}
+
+	void ShaderCompiler::Finish(Build& build)
+	{
+		Timer timer;
+
+		GLint linked = GL_FALSE;
+		glGetProgramiv(build.program, GL_LINK_STATUS, &linked);
+
+		if (linked != GL_TRUE)
+		{
+			// a stage that did not compile explains the failure better than the link log
+			for (u32 i = 0; i < 3 && build.error.empty(); i++)
+			{
+				if (build.shaders[i] == 0) continue;
+
+				GLint compiled = GL_FALSE;
+				glGetShaderiv(build.shaders[i], GL_COMPILE_STATUS, &compiled);
+				if (compiled != GL_TRUE) {
+					build.error = std::format("{}: {} shader compile error:\n{}", build.name, k_stageNames[i], ShaderInfoLog(build.shaders[i]));
+				}
+			}
+
+			if (build.error.empty()) {
+				build.error = std::format("{}: program link error:\n{}", build.name, ProgramInfoLog(build.program));
+			}
+
+			LEOLOGERROR("{}", build.error);
+
+			DeleteObjects(build);
+			build.state = ShaderBuildState::Failed;
+		}
+		else
+		{
+			ShaderCache& cache = GetShaderCache();
+			cache.Store(build.key, build.program);
+
+			u32 program = build.program;
+			build.program = 0;
+			DeleteObjects(build); // the shaders, the program now belongs to the ShaderProgram
+
+			build.result.Adopt(program);
+			build.state = ShaderBuildState::Ready;
+			cache.AddCompileTime(build.submitMs + timer.ElapsedMillis());
+		}
+
+		m_pending--;
+	}
+
+	void ShaderCompiler::DeleteObjects(Build& build)
+	{
+		for (u32& shader : build.shaders)
+		{
+			// attached shaders are only flagged, they are freed with the program
+			if (shader != 0) glDeleteShader(shader);
+			shader = 0;
+		}
+
+		GetGLStateCache().DeleteProgram(build.program);
+		build.program = 0;
+	}
+}
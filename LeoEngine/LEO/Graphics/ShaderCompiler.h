@@ -0,0 +1,91 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <LEO/Utilities/LeoTypes.h>
+#include "Shader.h"
+
+namespace leo
+{
+	enum class ShaderBuildState : u8
+	{
+		Pending, // submitted, the driver is compiling / linking
+		Ready,   // linked, Take gives the program
+		Failed,  // compile or link error, see Error
+		Taken    // the program was moved out
+	};
+
+	// A program submitted to a ShaderCompiler, only valid with the compiler that returned it
+	struct ShaderTicket
+	{
+		static constexpr u32 INVALID = 0xFFFFFFFF;
+
+		u32 index = INVALID;
+
+		inline bool IsValid() const { return index != INVALID; }
+	};
+
+	/// <summary>
+	/// Builds many programs without waiting on each one: Submit starts the compile and link of a program
+	/// and returns at once, Poll collects the ones the driver finished. With GL_KHR_parallel_shader_compile
+	/// the driver compiles on its own threads and Poll never blocks (GL_COMPLETION_STATUS_KHR), without it
+	/// the status queries of Poll block like a plain ShaderProgram would, but all the sources were handed to
+	/// the driver first. Programs in the ShaderCache are loaded by Submit and are ready immediately.
+	/// Compile and link errors are logged with the program name, the stage and the driver info log.
+	/// </summary>
+	class ShaderCompiler
+	{
+	public:
+		ShaderCompiler() = default; // needs an OpenGL context to submit
+
+		ShaderCompiler(const ShaderCompiler&) = delete;
+		ShaderCompiler& operator=(const ShaderCompiler&) = delete;
+
+		~ShaderCompiler(); // deletes the programs that were not taken
+	public:
+		// Reads filepath + ".vert", ".geom" (optional) and ".frag", the name in the error messages is the filepath
+		ShaderTicket Submit(const std::string& filepath);
+
+		// geoSrc may be nullptr. The sources are copied by the driver, they can be freed on return
+		ShaderTicket Submit(const char* vertSrc, const char* geoSrc, const char* fragSrc, const std::string& name = "shader");
+
+		// Finishes every program the driver is done with, returns the number still pending
+		u32 Poll();
+
+		// Blocks until every submitted program is ready or failed
+		void WaitAll();
+	public:
+		ShaderBuildState State(ShaderTicket ticket) const;
+		inline bool IsReady(ShaderTicket ticket) const { return State(ticket) == ShaderBuildState::Ready; }
+		inline bool IsDone(ShaderTicket ticket) const { return State(ticket) != ShaderBuildState::Pending; }
+
+		// The compile / link error of a failed program, empty otherwise
+		const std::string& Error(ShaderTicket ticket) const;
+
+		// Moves the program out, only once. An invalid ShaderProgram when it is not ready
+		ShaderProgram Take(ShaderTicket ticket);
+
+		inline u32 Pending() const { return m_pending; }
+
+		// GL_KHR_parallel_shader_compile (or the ARB version) is supported by the driver
+		static bool IsParallel();
+	private:
+		struct Build
+		{
+			std::string name;
+			u64 key = 0; // ShaderCache key, 0 when the cache is disabled
+			u32 shaders[3] = {}; // vertex, geometry, fragment, until the link is done
+			u32 program = 0;
+			f32 submitMs = 0.0f; // time spent in Submit, the program itself builds in the background
+			ShaderBuildState state = ShaderBuildState::Pending;
+			ShaderProgram result;
+			std::string error;
+		};
+	private:
+		bool IsComplete(const Build& build) const;
+		void Finish(Build& build);
+		void DeleteObjects(Build& build);
+	private:
+		std::vector<Build> m_builds;
+		u32 m_pending = 0;
+	};
+}
@@ -0,0 +1,276 @@
+#include <utility>
+#include <glad/glad.h>
+#include <LEO/Log/Log.h>
+#include "GLStateCache.h"
+#include "StreamBuffer.h"
+
+namespace leo
+{
+	// ---------------- GLFenceBackend ----------------
+
+	class GLFenceBackend final : public FenceBackend
+	{
+	public:
+		u64 Insert() override
+		{
+			return (u64)glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+
+		bool IsSignaled(u64 fence) override
+		{
+			GLenum result = glClientWaitSync((GLsync)fence, 0, 0);
+			return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+		}
+
+		void Wait(u64 fence) override
+		{
+			// the first wait flushes, so the fence is guaranteed to reach the GPU
+			GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+			while (true)
+			{
+				GLenum result = glClientWaitSync((GLsync)fence, flags, 1000000000ull);
+				if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) return;
+				if (result == GL_WAIT_FAILED)
+				{
+					LEOLOGERROR("glClientWaitSync failed, the stream buffer region may still be in use");
+					return;
+				}
+				flags = 0;
+			}
+		}
+
+		void Delete(u64 fence) override
+		{
+			glDeleteSync((GLsync)fence);
+		}
+	};
+
+	FenceBackend& GetGLFenceBackend()
+	{
+		static GLFenceBackend backend;
+		return backend;
+	}
+
+	// ---------------- FakeFenceBackend ----------------
+
+	u64 FakeFenceBackend::Insert()
+	{
+		m_live++;
+		return ++m_last;
+	}
+
+	bool FakeFenceBackend::IsSignaled(u64 fence)
+	{
+		return fence <= m_completed;
+	}
+
+	void FakeFenceBackend::Wait(u64 fence)
+	{
+		m_waits++;
+		Complete(fence);
+	}
+
+	void FakeFenceBackend::Delete(u64 fence)
+	{
+		LEOASSERT(fence != 0 && fence <= m_last && m_live > 0, "Deleting an unknown fence");
+		m_live--;
+	}
+
+	void FakeFenceBackend::Complete(u64 fence)
+	{
+		if (fence > m_completed) m_completed = fence;
+	}
+
+	// ---------------- StreamAllocator ----------------
+
+	StreamAllocator::StreamAllocator(u32 region_size, u32 region_count, FenceBackend& fences)
+		:
+		m_backend(&fences),
+		m_fences(region_count, 0),
+		m_regionSize(region_size)
+	{
+		LEOASSERT(region_count > 0, "A stream allocator needs at least one region");
+	}
+
+	StreamAllocator::StreamAllocator(StreamAllocator&& other) noexcept
+		:
+		m_backend(other.m_backend),
+		m_fences(std::move(other.m_fences)),
+		m_regionSize(other.m_regionSize),
+		m_region(other.m_region),
+		m_cursor(other.m_cursor),
+		m_regionReady(other.m_regionReady),
+		m_stats(other.m_stats)
+	{
+		other.m_fences.clear();
+	}
+
+	StreamAllocator& StreamAllocator::operator=(StreamAllocator&& other) noexcept
+	{
+		for (u64 fence : m_fences) {
+			if (fence != 0) m_backend->Delete(fence);
+		}
+
+		m_backend = other.m_backend;
+		m_fences = std::move(other.m_fences);
+		m_regionSize = other.m_regionSize;
+		m_region = other.m_region;
+		m_cursor = other.m_cursor;
+		m_regionReady = other.m_regionReady;
+		m_stats = other.m_stats;
+
+		other.m_fences.clear();
+		return *this;
+	}
+
+	StreamAllocator::~StreamAllocator()
+	{
+		for (u64 fence : m_fences) {
+			if (fence != 0) m_backend->Delete(fence);
+		}
+	}
+
+	u32 StreamAllocator::Allocate(u32 size, u32 alignment)
+	{
+		LEOASSERT(alignment != 0, "The alignment can't be 0");
+		if (size > m_regionSize) return INVALID_OFFSET;
+
+		if (!m_regionReady) WaitRegion();
+
+		u32 base = m_region * m_regionSize;
+		u32 offset = (base + m_cursor + alignment - 1) / alignment * alignment;
+
+		if (offset + size > base + m_regionSize)
+		{
+			// the rest of the frame goes to the next region, this one is fenced now
+			Advance();
+			m_stats.wraps++;
+
+			base = m_region * m_regionSize;
+			offset = (base + alignment - 1) / alignment * alignment;
+
+			WaitRegion();
+			if (offset + size > base + m_regionSize) return INVALID_OFFSET; // the alignment padding does not fit
+		}
+
+		m_cursor = offset + size - base;
+		m_stats.allocations++;
+		m_stats.bytes += size;
+		return offset;
+	}
+
+	void StreamAllocator::EndFrame()
+	{
+		m_stats.frames++;
+
+		// nothing was written, the region can be kept for the next frame
+		if (m_cursor == 0) return;
+
+		Advance();
+	}
+
+	void StreamAllocator::Advance()
+	{
+		LEOASSERT(m_fences[m_region] == 0, "The region is already fenced");
+		m_fences[m_region] = m_backend->Insert();
+
+		m_region = (m_region + 1) % RegionCount();
+		m_cursor = 0;
+		m_regionReady = false;
+	}
+
+	void StreamAllocator::WaitRegion()
+	{
+		u64& fence = m_fences[m_region];
+
+		if (fence != 0)
+		{
+			if (!m_backend->IsSignaled(fence))
+			{
+				m_stats.stalls++;
+				m_backend->Wait(fence);
+			}
+
+			m_backend->Delete(fence);
+			fence = 0;
+		}
+
+		m_regionReady = true;
+	}
+
+	// ---------------- StreamBuffer ----------------
+
+	StreamBuffer::StreamBuffer(u32 region_size, u32 region_count, FenceBackend* fences)
+		:
+		m_ring(region_size, region_count, fences != nullptr ? *fences : GetGLFenceBackend())
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		u32 size = m_ring.Size();
+
+		glGenBuffers(1, &m_id);
+		GetGLStateCache().BindBuffer(GL_ARRAY_BUFFER, m_id);
+		glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+
+		m_data = static_cast<u8*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+		LEOASSERTF(m_data != nullptr, "Failed to map a stream buffer of {} bytes", size);
+	}
+
+	StreamBuffer::StreamBuffer(StreamBuffer&& other) noexcept
+		:
+		m_id(other.m_id),
+		m_data(other.m_data),
+		m_ring(std::move(other.m_ring))
+	{
+		other.m_id = 0;
+		other.m_data = nullptr;
+	}
+
+	StreamBuffer& StreamBuffer::operator=(StreamBuffer&& other) noexcept
+	{
+		Release();
+
+		m_id = other.m_id;
+		m_data = other.m_data;
+		m_ring = std::move(other.m_ring);
+
+		other.m_id = 0;
+		other.m_data = nullptr;
+		return *this;
+	}
+
+	StreamBuffer::~StreamBuffer()
+	{
+		Release();
+	}
+
+	StreamAllocation StreamBuffer::Allocate(u32 size, u32 alignment)
+	{
+		LEOASSERT(m_data != nullptr, "The stream buffer is not created");
+
+		u32 offset = m_ring.Allocate(size, alignment);
+		if (offset == StreamAllocator::INVALID_OFFSET)
+		{
+			LEOLOGERROR("Stream buffer allocation of {} bytes does not fit in a region of {} bytes", size, m_ring.RegionSize());
+			return StreamAllocation{};
+		}
+
+		return StreamAllocation{ m_data + offset, offset, size };
+	}
+
+	void StreamBuffer::EndFrame()
+	{
+		m_ring.EndFrame();
+	}
+
+	void StreamBuffer::Release()
+	{
+		if (m_id == 0) return;
+
+		GetGLStateCache().BindBuffer(GL_ARRAY_BUFFER, m_id);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		GetGLStateCache().DeleteBuffer(m_id);
+
+		m_id = 0;
+		m_data = nullptr;
+	}
+}
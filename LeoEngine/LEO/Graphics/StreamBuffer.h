@@ -0,0 +1,153 @@
+#pragma once
+#include <vector>
+#include <LEO/Utilities/LeoTypes.h>
+
+namespace leo
+{
+	/// <summary>
+	/// Fences telling the CPU when the GPU is done with the commands issued so far.
+	/// A fence is a non zero handle, 0 means "no fence".
+	/// </summary>
+	class FenceBackend
+	{
+	public:
+		virtual ~FenceBackend() = default;
+	public:
+		virtual u64 Insert() = 0;                  // after the commands to wait for
+		virtual bool IsSignaled(u64 fence) = 0;    // never blocks
+		virtual void Wait(u64 fence) = 0;          // blocks until signaled
+		virtual void Delete(u64 fence) = 0;
+	};
+
+	// glFenceSync / glClientWaitSync, shared by every StreamBuffer, needs the GL context
+	FenceBackend& GetGLFenceBackend();
+
+	/// <summary>
+	/// Fences without a GPU, for testing the StreamAllocator bookkeeping.
+	/// Fences are signaled in order when Complete() is called (the "GPU" catching up);
+	/// Wait() on a pending fence completes it and counts the stall.
+	/// </summary>
+	class FakeFenceBackend final : public FenceBackend
+	{
+	public:
+		u64 Insert() override;
+		bool IsSignaled(u64 fence) override;
+		void Wait(u64 fence) override;
+		void Delete(u64 fence) override;
+	public:
+		// signals every fence up to and including this one
+		void Complete(u64 fence);
+		void CompleteAll() { Complete(m_last); }
+
+		inline u64 LastInserted() const { return m_last; }
+		inline u64 Waits() const { return m_waits; }
+		inline u64 LiveFences() const { return m_live; }
+	private:
+		u64 m_last = 0;
+		u64 m_completed = 0;
+		u64 m_waits = 0;
+		u64 m_live = 0;
+	};
+
+	/// <summary>
+	/// Sub-allocates a buffer split in regions (3 for triple buffering) used round robin.
+	/// A region is fenced when the ring leaves it, and is waited for before it is written again,
+	/// so the CPU never overwrites data the GPU may still be reading.
+	/// Only offsets are handed out, the memory itself belongs to the caller (StreamBuffer).
+	/// </summary>
+	class StreamAllocator
+	{
+	public:
+		static constexpr u32 INVALID_OFFSET = 0xFFFFFFFF;
+
+		struct Stats
+		{
+			u64 frames      = 0;
+			u64 allocations = 0;
+			u64 bytes       = 0;
+			u64 stalls      = 0; // a region was still in use by the GPU when it was needed
+			u64 wraps       = 0; // a frame did not fit in one region
+		};
+	public:
+		StreamAllocator(u32 region_size, u32 region_count, FenceBackend& fences);
+
+		StreamAllocator(const StreamAllocator&) = delete;
+		StreamAllocator& operator=(const StreamAllocator&) = delete;
+
+		StreamAllocator(StreamAllocator&& other) noexcept;
+		StreamAllocator& operator=(StreamAllocator&& other) noexcept;
+
+		~StreamAllocator(); // deletes the pending fences
+	public:
+		// Offset of size bytes in the whole buffer, a multiple of alignment (not necessarily a power of two).
+		// When the current region is full the ring moves on to the next one.
+		// Returns INVALID_OFFSET only when the request is bigger than a region.
+		u32 Allocate(u32 size, u32 alignment);
+
+		// Fences the current region and moves on to the next one, call once the draws reading this frame's allocations are issued
+		void EndFrame();
+	public:
+		inline u32 Region() const { return m_region; }
+		inline u32 RegionSize() const { return m_regionSize; }
+		inline u32 RegionCount() const { return (u32)m_fences.size(); }
+		inline u32 Size() const { return m_regionSize * RegionCount(); }
+		inline const Stats& GetStats() const { return m_stats; }
+	private:
+		void Advance();
+		void WaitRegion();
+	private:
+		FenceBackend* m_backend = nullptr;
+		std::vector<u64> m_fences; // per region, 0 when the GPU is not using it
+		u32 m_regionSize = 0;
+		u32 m_region = 0;
+		u32 m_cursor = 0;          // bytes used in the current region
+		bool m_regionReady = false; // the current region was waited for
+		Stats m_stats;
+	};
+
+	struct StreamAllocation
+	{
+		void* ptr  = nullptr;
+		u32 offset = 0; // in the buffer, to use as draw offset or base instance
+		u32 size   = 0;
+
+		explicit operator bool() const { return ptr != nullptr; }
+	};
+
+	/// <summary>
+	/// A persistently mapped buffer (glBufferStorage, coherent) for data rewritten every frame:
+	/// dynamic vertices, instances. The storage is allocated and mapped once, each frame writes
+	/// into its own region through Allocate() and draws from the returned offset, so no GL buffer
+	/// is ever reallocated or orphaned. Attach it to a VertexArray with VertexArray::AttachBuffer.
+	/// The draws reading an allocation must be issued before the next Allocate or EndFrame call.
+	/// </summary>
+	class StreamBuffer
+	{
+	public:
+		static constexpr u32 DEFAULT_REGION_COUNT = 3;
+	public:
+		StreamBuffer() = default;
+		StreamBuffer(u32 region_size, u32 region_count = DEFAULT_REGION_COUNT, FenceBackend* fences = nullptr); // GL fences by default
+
+		StreamBuffer(const StreamBuffer&) = delete;
+		StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+		StreamBuffer(StreamBuffer&& other) noexcept;
+		StreamBuffer& operator=(StreamBuffer&& other) noexcept;
+
+		~StreamBuffer();
+	public:
+		StreamAllocation Allocate(u32 size, u32 alignment = 16);
+		void EndFrame();
+
+		inline u32 ID() const { return m_id; }
+		inline const StreamAllocator::Stats& GetStats() const { return m_ring.GetStats(); }
+		inline const StreamAllocator& Allocator() const { return m_ring; }
+	private:
+		void Release();
+	private:
+		u32 m_id = 0;
+		u8* m_data = nullptr; // mapped for the whole life of the buffer
+		StreamAllocator m_ring = StreamAllocator(0, 1, GetGLFenceBackend());
+	};
+}
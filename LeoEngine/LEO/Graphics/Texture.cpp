@@ -1,5 +1,6 @@
 #include <glad/glad.h>
 #include <LEO/Log/LeoAssert.h>
+#include "GLStateCache.h"
 #include "Texture.h"
 
 namespace leo
@@ -11,7 +12,60 @@ namespace leo
         GL_TEXTURE_2D_ARRAY
     };
 
-    Texture::Texture(u32 width, u32 height, TextureFormat format, u8* data)
+    struct GLTextureFormat
+    {
+        GLint internalFormat = 0;
+        GLenum format = 0;
+        GLenum type = 0;
+    };
+
+    static GLTextureFormat ToGL(TextureFormat format)
+    {
+        GLTextureFormat gl;
+
+        switch (format)
+        {
+        case TextureFormat::RGBA8UB:
+            gl.internalFormat = GL_RGBA8;
+            gl.format = GL_RGBA;
+            gl.type = GL_UNSIGNED_BYTE;
+            break;
+        case TextureFormat::RGBA16F:
+            gl.internalFormat = GL_RGBA16F;
+            gl.format = GL_RGBA;
+            gl.type = GL_FLOAT;
+            break;
+        case TextureFormat::RGBA32F:
+            gl.internalFormat = GL_RGBA32F;
+            gl.format = GL_RGBA;
+            gl.type = GL_FLOAT;
+            break;
+        case TextureFormat::RGBA32UI:
+            gl.internalFormat = GL_RGBA32UI;
+            gl.format = GL_RGBA_INTEGER;
+            gl.type = GL_UNSIGNED_INT;
+            break;
+        case TextureFormat::R32UI:
+            gl.internalFormat = GL_R32UI;
+            gl.format = GL_RED_INTEGER;
+            gl.type = GL_UNSIGNED_INT;
+            break;
+        case TextureFormat::R32F:
+            gl.internalFormat = GL_R32F;
+            gl.format = GL_RED;
+            gl.type = GL_FLOAT;
+            break;
+        case TextureFormat::DEPTH_COMPONENT32F:
+            gl.internalFormat = GL_DEPTH_COMPONENT32F;
+            gl.format = GL_DEPTH_COMPONENT;
+            gl.type = GL_FLOAT;
+            break;
+        }
+
+        return gl;
+    }
+
+    Texture::Texture(u32 width, u32 height, TextureFormat format, const u8* data)
         :
         Texture(DIM_2D, { width, height, 0 }, format,
             TextureMinFiltering::MIN_NEAREST, TextureMagFiltering::MAG_NEAREST,
@@ -23,7 +77,7 @@ namespace leo
         TextureDimensions dimensions, TexSize size,
         TextureFormat format,
         TextureMinFiltering min_filter, TextureMagFiltering mag_filter,
-        TextureWrapping S, TextureWrapping T, u8* data
+        TextureWrapping S, TextureWrapping T, const u8* data
     )
         :
         m_params(dimensions, size, format, min_filter, mag_filter, S, T)
@@ -40,6 +94,7 @@ namespace leo
     Texture::Texture(Texture&& other) noexcept
         :
         m_id(other.m_id),
+        m_minimap(other.m_minimap),
         m_params(other.m_params)
     {
         other.m_id = 0;
@@ -47,8 +102,9 @@ namespace leo
 
     Texture& Texture::operator=(Texture&& other) noexcept
     {
-        glDeleteTextures(1, &m_id);
+        GetGLStateCache().DeleteTexture(m_id);
         m_id = other.m_id;
+        m_minimap = other.m_minimap;
         m_params = other.m_params;
         other.m_id = 0;
         return *this;
@@ -56,18 +112,17 @@ namespace leo
 
     Texture::~Texture()
     {
-        glDeleteTextures(1, &m_id);
+        GetGLStateCache().DeleteTexture(m_id);
     }
 
     void Texture::Bind(u32 slot) const
     {
-        glActiveTexture(GL_TEXTURE0 + slot);
-        glBindTexture(TYPE[m_params.dimensions], m_id);
+        GetGLStateCache().BindTextureUnit(slot, TYPE[m_params.dimensions], m_id);
     }
 
     void Texture::UnBind() const
     {
-        glBindTexture(TYPE[m_params.dimensions], 0);
+        GetGLStateCache().BindTexture(TYPE[m_params.dimensions], 0);
     }
 
     void Texture::SetFiltering(TextureMinFiltering min_filter, TextureMagFiltering mag_filter)
@@ -75,7 +130,7 @@ namespace leo
         m_params.min_filter = min_filter;
         m_params.mag_filter = mag_filter;
 
-        glBindTexture(TYPE[m_params.dimensions], m_id);
+        GetGLStateCache().BindTexture(TYPE[m_params.dimensions], m_id);
         m_minimap = false;
 
         switch (m_params.min_filter)
@@ -113,8 +168,6 @@ namespace leo
             glTexParameteri(TYPE[m_params.dimensions], GL_TEXTURE_MAG_FILTER, GL_LINEAR);
             break;
         }
-
-        glBindTexture(TYPE[m_params.dimensions], 0);
     }
 
     void Texture::SetWrapping(TextureWrapping S, TextureWrapping T)
@@ -122,7 +175,7 @@ namespace leo
         m_params.wrapping_s = S;
         m_params.wrapping_t = T;
 
-        glBindTexture(TYPE[m_params.dimensions], m_id);
+        GetGLStateCache().BindTexture(TYPE[m_params.dimensions], m_id);
 
         switch (m_params.wrapping_s)
         {
@@ -155,89 +208,88 @@ namespace leo
             glTexParameteri(TYPE[m_params.dimensions], GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
             break;
         }
-
-        glBindTexture(TYPE[m_params.dimensions], 0);
     }
 
-    void Texture::SetImageData(u8* data, TextureFormat format)
+    void Texture::SetImageData(const u8* data, TextureFormat format)
     {
         m_params.format = format;
 
-        glBindTexture(TYPE[m_params.dimensions], m_id);
+        GetGLStateCache().BindTexture(TYPE[m_params.dimensions], m_id);
 
-        GLint internalFormat = 0;
-        GLenum color_format = 0;
-        GLenum type = 0;
+        UploadLevel(0, data);
 
-        switch (m_params.format)
+        if (m_minimap)
         {
-        case TextureFormat::RGBA8UB:
-            internalFormat = GL_RGBA8;
-            color_format = GL_RGBA;
-            type = GL_UNSIGNED_BYTE;
-            break;
-        case TextureFormat::RGBA16F:
-            internalFormat = GL_RGBA16F;
-            color_format = GL_RGBA;
-            type = GL_FLOAT;
-            break;
-        case TextureFormat::RGBA32F:
-            internalFormat = GL_RGBA32F;
-            color_format = GL_RGBA;
-            type = GL_FLOAT;
-            break;
-        case TextureFormat::RGBA32UI:
-            internalFormat = GL_RGBA32UI;
-            color_format = GL_RGBA_INTEGER;
-            type = GL_UNSIGNED_INT;
-            break;
-        case TextureFormat::R32UI:
-            internalFormat = GL_R32UI;
-            color_format = GL_RED_INTEGER;
-            type = GL_UNSIGNED_INT;
-            break;
-        case TextureFormat::R32F:
-            internalFormat = GL_R32F;
-            color_format = GL_RED;
-            type = GL_FLOAT;
-            break;
-        case TextureFormat::DEPTH_COMPONENT32F:
-            internalFormat = GL_DEPTH_COMPONENT32F;
-            color_format = GL_DEPTH_COMPONENT;
-            type = GL_FLOAT;
-            break;
+            glGenerateMipmap(TYPE[m_params.dimensions]);
+
+            //GLfloat anisoSetting = 0.0f; 
+            //glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &anisoSetting); 
+            //glTexParameterf(TYPE[m_params.dimensions], GL_TEXTURE_MAX_ANISOTROPY_EXT, anisoSetting);
         }
+    }
+
+    void Texture::SetLevelData(u32 level, const u8* data)
+    {
+        GetGLStateCache().BindTexture(TYPE[m_params.dimensions], m_id);
+
+        UploadLevel(level, data);
+    }
+
+    void Texture::SetSubImageData(const TexSize& offset, const TexSize& size, const u8* data)
+    {
+        const GLTextureFormat gl = ToGL(m_params.format);
+
+        GetGLStateCache().BindTexture(TYPE[m_params.dimensions], m_id);
 
         switch (m_params.dimensions)
         {
         case DIM_1D:
-            glTexImage1D(TYPE[m_params.dimensions], 0,
-                internalFormat, m_params.size.x, 0, color_format, type, data);
+            glTexSubImage1D(TYPE[m_params.dimensions], 0, offset.x, size.x, gl.format, gl.type, data);
             break;
         case DIM_2D:
-            glTexImage2D(TYPE[m_params.dimensions], 0,
-                internalFormat, m_params.size.x, m_params.size.y, 0, color_format, type, data);
+            glTexSubImage2D(TYPE[m_params.dimensions], 0, offset.x, offset.y, size.x, size.y, gl.format, gl.type, data);
             break;
         case DIM_3D:
-            glTexImage3D(TYPE[m_params.dimensions], 0,
-                internalFormat, m_params.size.x, m_params.size.y, m_params.size.z, 0, color_format, type, data);
-            break;
         case DIM_2D_ARRAY:
-            glTexImage3D(TYPE[m_params.dimensions], 0,
-                internalFormat, m_params.size.x, m_params.size.y, m_params.size.z, 0, color_format, type, data);
+            glTexSubImage3D(TYPE[m_params.dimensions], 0, offset.x, offset.y, offset.z, size.x, size.y, size.z, gl.format, gl.type, data);
             break;
         }
 
         if (m_minimap)
         {
             glGenerateMipmap(TYPE[m_params.dimensions]);
-
-            //GLfloat anisoSetting = 0.0f; 
-            //glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &anisoSetting); 
-            //glTexParameterf(TYPE[m_params.dimensions], GL_TEXTURE_MAX_ANISOTROPY_EXT, anisoSetting);
         }
+    }
 
-        glBindTexture(TYPE[m_params.dimensions], 0);
+    void Texture::UploadLevel(u32 level, const u8* data)
+    {
+        // the level sizes halve down to 1, the layers of a 2D array do not
+        TexSize size = m_params.size;
+        size.x = glm::max(size.x >> level, 1u);
+        if (m_params.dimensions != DIM_1D) size.y = glm::max(size.y >> level, 1u);
+        if (m_params.dimensions == DIM_3D) size.z = glm::max(size.z >> level, 1u);
+
+        const GLTextureFormat gl = ToGL(m_params.format);
+
+        switch (m_params.dimensions)
+        {
+        case DIM_1D:
+            glTexImage1D(TYPE[m_params.dimensions], level,
+                gl.internalFormat, size.x, 0, gl.format, gl.type, data);
+            break;
+        case DIM_2D:
+            glTexImage2D(TYPE[m_params.dimensions], level,
+                gl.internalFormat, size.x, size.y, 0, gl.format, gl.type, data);
+            break;
+        case DIM_3D:
+            glTexImage3D(TYPE[m_params.dimensions], level,
+                gl.internalFormat, size.x, size.y, size.z, 0, gl.format, gl.type, data);
+            break;
+        case DIM_2D_ARRAY:
+            glTexImage3D(TYPE[m_params.dimensions], level,
+                gl.internalFormat, size.x, size.y, size.z, 0, gl.format, gl.type, data);
+            break;
+        }
     }
 
     void Texture::Resize(const TexSize& new_size)
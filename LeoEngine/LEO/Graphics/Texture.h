@@ -53,11 +53,11 @@ namespace leo
         using TexSize = glm::vec<3, u32>;
     public:
         Texture() = default;
-        Texture(u32 width, u32 height, TextureFormat format = TextureFormat::RGBA8UB, u8* data = nullptr);
+        Texture(u32 width, u32 height, TextureFormat format = TextureFormat::RGBA8UB, const u8* data = nullptr);
 
         Texture(TextureDimensions dimensions, TexSize size, TextureFormat format,
             TextureMinFiltering min_filter, TextureMagFiltering mag_filter,
-            TextureWrapping S, TextureWrapping T, u8* data
+            TextureWrapping S, TextureWrapping T, const u8* data
         );
 
         Texture(const Texture& other) = delete;
@@ -77,9 +77,17 @@ namespace leo
     public:
         void SetFiltering(TextureMinFiltering min_filter, TextureMagFiltering mag_filter);
         void SetWrapping(TextureWrapping S, TextureWrapping T);
-        void SetImageData(u8* data, TextureFormat format);
+        void SetImageData(const u8* data, TextureFormat format);
         void Resize(const TexSize& new_size);
+
+        // Uploads one level of a precomputed mip chain (level 0 is SetImageData), no mipmap is generated
+        void SetLevelData(u32 level, const u8* data);
+
+        // Replaces a box of level 0 (z is the layer of a 2D array), the rows of data are size.x texels.
+        // The mipmaps are generated again when the filter uses them
+        void SetSubImageData(const TexSize& offset, const TexSize& size, const u8* data);
     private:
+        void UploadLevel(u32 level, const u8* data);
         bool IsTexSizeValid(const TexSize& new_size) const;
     private:
         struct TextureParameters
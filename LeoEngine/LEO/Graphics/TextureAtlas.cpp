@@ -0,0 +1,349 @@
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <LEO/Log/Log.h>
+#include "CommandList.h"
+#include "TextureAtlas.h"
+
+namespace leo
+{
+	// ---------------- SkylinePacker ----------------
+
+	void SkylinePacker::Reset(u32 width, u32 height)
+	{
+		m_width = width;
+		m_height = height;
+		m_usedArea = 0;
+		m_skyline.clear();
+		m_skyline.push_back({ 0, 0, width });
+	}
+
+	bool SkylinePacker::Fit(u32 index, u32 width, u32 height, u32& y) const
+	{
+		if (m_skyline[index].x + width > m_width) return false;
+
+		// the rect rests on the highest segment under it
+		y = 0;
+		u32 remaining = width;
+		for (u32 i = index; ; i++)
+		{
+			y = std::max(y, m_skyline[i].y);
+			if (y + height > m_height) return false;
+			if (m_skyline[i].width >= remaining) return true;
+			remaining -= m_skyline[i].width;
+		}
+	}
+
+	bool SkylinePacker::Insert(u32 width, u32 height, AtlasRect& rect)
+	{
+		if (width == 0 || height == 0 || width > m_width || height > m_height) return false;
+
+		u32 best = (u32)m_skyline.size();
+		u32 best_top = UINT32_MAX;
+		u32 best_width = UINT32_MAX;
+		u32 best_y = 0;
+
+		for (u32 i = 0; i < (u32)m_skyline.size(); i++)
+		{
+			u32 y;
+			if (!Fit(i, width, height, y)) continue;
+
+			const u32 top = y + height;
+			if (top < best_top || (top == best_top && m_skyline[i].width < best_width))
+			{
+				best = i;
+				best_top = top;
+				best_width = m_skyline[i].width;
+				best_y = y;
+			}
+		}
+
+		if (best == (u32)m_skyline.size()) return false;
+
+		rect = { m_skyline[best].x, best_y, width, height };
+		m_skyline.insert(m_skyline.begin() + best, { rect.x, best_top, width });
+
+		// the segments under the new one are cut off or shortened
+		for (u32 i = best + 1; i < (u32)m_skyline.size(); )
+		{
+			const u32 covered = rect.x + width;
+			if (m_skyline[i].x >= covered) break;
+
+			const u32 shrink = covered - m_skyline[i].x;
+			if (m_skyline[i].width <= shrink)
+			{
+				m_skyline.erase(m_skyline.begin() + i);
+				continue;
+			}
+			m_skyline[i].x += shrink;
+			m_skyline[i].width -= shrink;
+			break;
+		}
+
+		// neighbours at the same height are one segment
+		for (u32 i = 0; i + 1 < (u32)m_skyline.size(); )
+		{
+			if (m_skyline[i].y == m_skyline[i + 1].y)
+			{
+				m_skyline[i].width += m_skyline[i + 1].width;
+				m_skyline.erase(m_skyline.begin() + i + 1);
+			}
+			else i++;
+		}
+
+		m_usedArea += (u64)width * height;
+		return true;
+	}
+
+	// ---------------- TextureAtlas ----------------
+
+	TextureAtlas::TextureAtlas(const AtlasParams& params)
+		:
+		m_params(params)
+	{
+		LEOASSERTF(params.pageSize > 2 * params.padding && params.maxPages > 0, "Atlas pages of {} texels with {} of padding",
+			params.pageSize, params.padding);
+	}
+
+	AtlasHandle TextureAtlas::Insert(const ImageData& image)
+	{
+		if (image.data == nullptr) return AtlasHandle{};
+		LEOASSERTF(image.bpp == 4, "The atlas packs RGBA8 images, not {} bytes per pixel", image.bpp);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return InsertLocked(image.data.get(), (u32)image.width, (u32)image.height);
+	}
+
+	AtlasHandle TextureAtlas::Insert(const u8* rgba, u32 width, u32 height)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return InsertLocked(rgba, width, height);
+	}
+
+	std::vector<AtlasHandle> TextureAtlas::Insert(std::span<const ImageData> images)
+	{
+		std::vector<u32> order(images.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b) {
+			if (images[a].height != images[b].height) return images[a].height > images[b].height;
+			return images[a].width > images[b].width;
+		});
+
+		std::vector<AtlasHandle> handles(images.size());
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (u32 i : order)
+		{
+			const ImageData& image = images[i];
+			if (image.data == nullptr) continue;
+			LEOASSERTF(image.bpp == 4, "The atlas packs RGBA8 images, not {} bytes per pixel", image.bpp);
+
+			handles[i] = InsertLocked(image.data.get(), (u32)image.width, (u32)image.height);
+		}
+		return handles;
+	}
+
+	AtlasHandle TextureAtlas::InsertLocked(const u8* rgba, u32 width, u32 height)
+	{
+		const u32 size = m_params.pageSize;
+		const u32 padded_width = width + 2 * m_params.padding;
+		const u32 padded_height = height + 2 * m_params.padding;
+
+		if (rgba == nullptr || width == 0 || height == 0) return AtlasHandle{};
+		if (padded_width > size || padded_height > size)
+		{
+			LEOLOGWARN("A {}x{} image does not fit in the {}x{} atlas pages", width, height, size, size);
+			m_stats.rejected++;
+			return AtlasHandle{};
+		}
+
+		// the first page with room, the evicted ones are empty again
+		AtlasRect rect;
+		u32 page = 0;
+		for (; page < (u32)m_pages.size(); page++)
+		{
+			if (m_pages[page]->packer.Insert(padded_width, padded_height, rect)) break;
+		}
+
+		if (page == (u32)m_pages.size())
+		{
+			if (m_pages.size() == m_params.maxPages)
+			{
+				m_stats.rejected++;
+				return AtlasHandle{};
+			}
+
+			std::unique_ptr<Page> new_page = std::make_unique<Page>();
+			new_page->packer.Reset(size, size);
+			new_page->pixels = std::make_unique<u8[]>((u64)size * size * 4); // transparent black
+			new_page->packer.Insert(padded_width, padded_height, rect);
+			m_pages.push_back(std::move(new_page));
+		}
+
+		Blit(*m_pages[page], rect, rgba, width, height);
+
+		AtlasEntry entry;
+		entry.page = page;
+		entry.rect = { rect.x + m_params.padding, rect.y + m_params.padding, width, height };
+		entry.uvMin = glm::vec2(entry.rect.x, entry.rect.y) / (f32)size;
+		entry.uvMax = glm::vec2(entry.rect.x + width, entry.rect.y + height) / (f32)size;
+
+		AtlasHandle handle{ (u32)m_entries.size() };
+		m_entries.push_back(entry);
+		m_live.push_back(true);
+		m_stats.images++;
+		return handle;
+	}
+
+	void TextureAtlas::Blit(Page& page, const AtlasRect& rect, const u8* rgba, u32 width, u32 height)
+	{
+		const u64 stride = (u64)m_params.pageSize * 4;
+		const u32 padding = m_params.padding;
+		const u32 x0 = rect.x + padding;
+		const u32 y0 = rect.y + padding;
+		u8* pixels = page.pixels.get();
+
+		// the rows, each extended with its first and last texel
+		for (u32 y = 0; y < height; y++)
+		{
+			u8* row = pixels + (y0 + y) * stride;
+			std::memcpy(row + x0 * 4, rgba + (u64)y * width * 4, (u64)width * 4);
+			for (u32 p = 1; p <= padding; p++)
+			{
+				std::memcpy(row + (x0 - p) * 4, row + x0 * 4, 4);
+				std::memcpy(row + (x0 + width - 1 + p) * 4, row + (x0 + width - 1) * 4, 4);
+			}
+		}
+
+		// then the first and last rows, padding included, copied down and up
+		const u64 row_bytes = (u64)rect.width * 4;
+		const u8* bottom = pixels + y0 * stride + rect.x * 4;
+		const u8* top = pixels + (y0 + height - 1) * stride + rect.x * 4;
+		for (u32 p = 1; p <= padding; p++)
+		{
+			std::memcpy(pixels + (y0 - p) * stride + rect.x * 4, bottom, row_bytes);
+			std::memcpy(pixels + (y0 + height - 1 + p) * stride + rect.x * 4, top, row_bytes);
+		}
+
+		if (page.dirtyBegin == page.dirtyEnd)
+		{
+			page.dirtyBegin = rect.y;
+			page.dirtyEnd = rect.y + rect.height;
+		}
+		else
+		{
+			page.dirtyBegin = std::min(page.dirtyBegin, rect.y);
+			page.dirtyEnd = std::max(page.dirtyEnd, rect.y + rect.height);
+		}
+	}
+
+	std::optional<AtlasEntry> TextureAtlas::Get(AtlasHandle handle) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!handle.IsValid() || handle.index >= m_entries.size() || !m_live[handle.index]) return std::nullopt;
+		return m_entries[handle.index];
+	}
+
+	void TextureAtlas::EvictPage(u32 page)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		LEOASSERTF(page < m_pages.size(), "Page {} of {}", page, m_pages.size());
+
+		// the pixels stay, nothing samples them until new images are written over
+		m_pages[page]->packer.Reset(m_params.pageSize, m_params.pageSize);
+
+		for (u32 i = 0; i < (u32)m_entries.size(); i++)
+		{
+			if (m_live[i] && m_entries[i].page == page)
+			{
+				m_live[i] = false;
+				m_stats.images--;
+			}
+		}
+	}
+
+	u32 TextureAtlas::PageCount() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return (u32)m_pages.size();
+	}
+
+	const Texture* TextureAtlas::PageTexture(u32 page) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		LEOASSERTF(page < m_pages.size(), "Page {} of {}", page, m_pages.size());
+		return m_params.arrayTexture ? &m_array : &m_pages[page]->texture;
+	}
+
+	u64 TextureAtlas::Upload()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		const u32 size = m_params.pageSize;
+		const u64 stride = (u64)size * 4;
+		u64 bytes = 0;
+
+		// the layer count is fixed at creation, a new page recreates the array and uploads every layer
+		if (m_params.arrayTexture && m_arrayLayers < m_pages.size())
+		{
+			m_arrayLayers = (u32)m_pages.size();
+			m_array = Texture(DIM_2D_ARRAY, { size, size, m_arrayLayers }, TextureFormat::RGBA8UB, m_params.minFilter,
+				m_params.magFilter, TextureWrapping::CLAMP_TO_EDGE, TextureWrapping::CLAMP_TO_EDGE, nullptr);
+			for (std::unique_ptr<Page>& page : m_pages)
+			{
+				page->dirtyBegin = 0;
+				page->dirtyEnd = size;
+			}
+		}
+
+		for (u32 i = 0; i < (u32)m_pages.size(); i++)
+		{
+			Page& page = *m_pages[i];
+
+			if (!m_params.arrayTexture && !page.created)
+			{
+				page.texture = Texture(DIM_2D, { size, size, 0 }, TextureFormat::RGBA8UB, m_params.minFilter,
+					m_params.magFilter, TextureWrapping::CLAMP_TO_EDGE, TextureWrapping::CLAMP_TO_EDGE, page.pixels.get());
+				page.created = true;
+				page.dirtyBegin = page.dirtyEnd = 0;
+				bytes += size * stride;
+				m_stats.uploads++;
+				continue;
+			}
+
+			if (page.dirtyBegin == page.dirtyEnd) continue;
+
+			// the band of whole rows is contiguous in the page, one call per page
+			const u32 rows = page.dirtyEnd - page.dirtyBegin;
+			const u8* data = page.pixels.get() + page.dirtyBegin * stride;
+			if (m_params.arrayTexture) m_array.SetSubImageData({ 0, page.dirtyBegin, i }, { size, rows, 1 }, data);
+			else page.texture.SetSubImageData({ 0, page.dirtyBegin, 0 }, { size, rows, 0 }, data);
+
+			page.dirtyBegin = page.dirtyEnd = 0;
+			bytes += rows * stride;
+			m_stats.uploads++;
+		}
+
+		m_stats.uploadBytes += bytes;
+		return bytes;
+	}
+
+	void TextureAtlas::RecordUpload(CommandList& commands)
+	{
+		commands.Callback([this]() { Upload(); });
+	}
+
+	TextureAtlasStats TextureAtlas::Stats() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		TextureAtlasStats stats = m_stats;
+		stats.pages = (u32)m_pages.size();
+
+		u64 used = 0;
+		for (const std::unique_ptr<Page>& page : m_pages) used += page->packer.UsedArea();
+		const f64 area = (f64)m_params.pageSize * m_params.pageSize * stats.pages;
+		stats.occupancy = area > 0.0 ? (f32)(used / area) : 0.0f;
+		return stats;
+	}
+}
@@ -0,0 +1,166 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+#include <LEO/Utilities/LeoTypes.h>
+#include <LEO/Utilities/LeoFileUtilities.h>
+#include "Texture.h"
+
+namespace leo
+{
+	class CommandList;
+
+	struct AtlasRect
+	{
+		u32 x = 0;
+		u32 y = 0;
+		u32 width = 0;
+		u32 height = 0;
+	};
+
+	/// <summary>
+	/// Skyline bottom-left packer: the free space is the profile of the top edges of the placed rects,
+	/// a rect goes where its top ends lowest (the narrower segment on a tie). Space below the skyline
+	/// is never reused, a page is only freed as a whole by Reset. It does not touch OpenGL.
+	/// </summary>
+	class SkylinePacker
+	{
+	public:
+		SkylinePacker() = default;
+		SkylinePacker(u32 width, u32 height) { Reset(width, height); }
+	public:
+		void Reset(u32 width, u32 height);
+
+		// false when the rect does not fit anywhere
+		bool Insert(u32 width, u32 height, AtlasRect& rect);
+
+		inline u32 Width() const { return m_width; }
+		inline u32 Height() const { return m_height; }
+		inline u64 UsedArea() const { return m_usedArea; }
+		inline f32 Occupancy() const { return m_width * m_height > 0 ? (f32)((f64)m_usedArea / ((f64)m_width * m_height)) : 0.0f; }
+	private:
+		struct Segment
+		{
+			u32 x;
+			u32 y;
+			u32 width;
+		};
+
+		// y of a rect of width placed at segment index, false when it goes past the page
+		bool Fit(u32 index, u32 width, u32 height, u32& y) const;
+	private:
+		u32 m_width = 0;
+		u32 m_height = 0;
+		u64 m_usedArea = 0;
+		std::vector<Segment> m_skyline; // left to right, covering the width
+	};
+
+	struct AtlasHandle
+	{
+		static constexpr u32 INVALID = 0xFFFFFFFF;
+		u32 index = INVALID;
+
+		inline bool IsValid() const { return index != INVALID; }
+	};
+
+	struct AtlasParams
+	{
+		u32  pageSize     = 2048;
+		u32  maxPages     = 8;
+		u32  padding      = 2;     // texels around each image, filled with its edge so filtering never reads a neighbour
+		bool arrayTexture = false; // one DIM_2D_ARRAY texture with a layer per page instead of a texture per page,
+		                           // drawn with a shader sampling a sampler2DArray at the entry's page
+		TextureMinFiltering minFilter = TextureMinFiltering::MIN_LINEAR;
+		TextureMagFiltering magFilter = TextureMagFiltering::MAG_LINEAR;
+	};
+
+	// Where an image went: the page (the layer in array mode) and its rect without the padding.
+	// The UVs cover the rect, the rows are bottom first as ReadImageData gives them
+	struct AtlasEntry
+	{
+		u32       page = 0;
+		AtlasRect rect;
+		glm::vec2 uvMin = glm::vec2(0.0f);
+		glm::vec2 uvMax = glm::vec2(0.0f);
+	};
+
+	struct TextureAtlasStats
+	{
+		u32 images      = 0; // live, evicted ones excluded
+		u32 rejected    = 0; // too large or no page had room
+		u32 pages       = 0;
+		f32 occupancy   = 0.0f; // packed area (padding included) over the area of the pages in use
+		u32 uploads     = 0; // texture creations and TexSubImage calls
+		u64 uploadBytes = 0;
+	};
+
+	/// <summary>
+	/// Packs RGBA8 images into a few large pages at run time so the sprites drawing them share a texture
+	/// and Batch2D keeps them in one draw call. Insert copies the pixels into the CPU copy of a page
+	/// (SkylinePacker, first page with room), Upload sends the rows that changed since the last call on the GL thread.
+	/// Space is reclaimed a page at a time: EvictPage drops all its images and their handles stop resolving.
+	/// Insert and Upload may run on different threads, the page textures stay where they are.
+	/// </summary>
+	class TextureAtlas
+	{
+	public:
+		explicit TextureAtlas(const AtlasParams& params = {}); // no GL work, the textures are created by Upload
+
+		TextureAtlas(const TextureAtlas&) = delete;
+		TextureAtlas& operator=(const TextureAtlas&) = delete;
+	public:
+		// An invalid handle when the image is larger than a page or every page is full
+		AtlasHandle Insert(const ImageData& image);
+		AtlasHandle Insert(const u8* rgba, u32 width, u32 height);
+
+		// Tallest first, which packs tighter than the given order. The handles are in the order of images
+		std::vector<AtlasHandle> Insert(std::span<const ImageData> images);
+
+		// A copy, Insert may grow the entries meanwhile. Empty once the page of the image was evicted
+		std::optional<AtlasEntry> Get(AtlasHandle handle) const;
+
+		// Frees a page for new images, the handles on it become invalid
+		void EvictPage(u32 page);
+
+		u32 PageCount() const;
+
+		// The texture to draw an entry of page with (the array texture in array mode), empty before the first Upload
+		const Texture* PageTexture(u32 page) const;
+	public:
+		// GL thread: creates the textures of new pages and uploads the changed rows, returns the bytes sent
+		u64 Upload();
+
+		// Records Upload to run on the thread that replays the commands
+		void RecordUpload(CommandList& commands);
+
+		TextureAtlasStats Stats() const;
+	private:
+		struct Page
+		{
+			SkylinePacker packer;
+			std::unique_ptr<u8[]> pixels; // RGBA8, pageSize x pageSize
+			Texture texture;              // unused in array mode
+			u32 dirtyBegin = 0;           // rows to upload, empty when begin == end
+			u32 dirtyEnd = 0;
+			bool created = false;
+		};
+
+		// Copies the image and extrudes its edges into the padding, rect includes the padding
+		void Blit(Page& page, const AtlasRect& rect, const u8* rgba, u32 width, u32 height);
+		AtlasHandle InsertLocked(const u8* rgba, u32 width, u32 height);
+	private:
+		AtlasParams m_params;
+
+		mutable std::mutex m_mutex;
+		std::vector<std::unique_ptr<Page>> m_pages;
+		std::vector<AtlasEntry> m_entries; // by handle, never shrinks: an evicted handle is not given out again
+		std::vector<bool> m_live;
+
+		Texture m_array;
+		u32 m_arrayLayers = 0;
+		TextureAtlasStats m_stats;
+	};
+}
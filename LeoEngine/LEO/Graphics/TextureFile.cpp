@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <LEO/Log/Log.h>
+#include <LEO/Utilities/LeoImageUtilities.h>
+#include "TextureFile.h"
+
+namespace leo
+{
+	static_assert(sizeof(TextureFormat) == sizeof(u32), "TextureFormat is stored as a u32");
+	static_assert(sizeof(TextureFileHeader) == 176, "The header layout is the file format");
+
+	static u64 AlignUp(u64 value)
+	{
+		return (value + TEXTURE_FILE_ALIGNMENT - 1) & ~(u64)(TEXTURE_FILE_ALIGNMENT - 1);
+	}
+
+	static u64 LevelBytes(u32 width, u32 height, u32 level)
+	{
+		return (u64)MipLevelSize(width, level) * MipLevelSize(height, level) * 4;
+	}
+
+	u64 HashTextureSource(std::span<const u8> bytes)
+	{
+		// FNV-1a over 8 byte words, a source is hashed on every load
+		u64 hash = 14695981039346656037ull ^ bytes.size();
+		u64 i = 0;
+		for (; i + sizeof(u64) <= bytes.size(); i += sizeof(u64))
+		{
+			u64 word;
+			std::memcpy(&word, bytes.data() + i, sizeof(u64));
+			hash = (hash ^ word) * 1099511628211ull;
+		}
+		for (; i < bytes.size(); i++)
+		{
+			hash = (hash ^ bytes[i]) * 1099511628211ull;
+		}
+		return hash;
+	}
+
+	bool WriteTextureFile(const std::string& filepath, u32 width, u32 height, u32 flags, u64 source_hash, u64 source_size,
+		std::span<const std::span<const u8>> levels)
+	{
+		LEOASSERTF(levels.size() == MipLevelCount(width, height) && levels.size() <= TEXTURE_FILE_MAX_LEVELS,
+			"A {}x{} texture has {} levels, not {}", width, height, MipLevelCount(width, height), levels.size());
+
+		TextureFileHeader header = {};
+		header.magic = TEXTURE_FILE_MAGIC;
+		header.version = TEXTURE_FILE_VERSION;
+		header.width = width;
+		header.height = height;
+		header.format = TextureFormat::RGBA8UB;
+		header.levelCount = (u32)levels.size();
+		header.flags = flags;
+		header.sourceHash = source_hash;
+		header.sourceSize = source_size;
+
+		u64 offset = AlignUp(sizeof(TextureFileHeader));
+		for (u32 level = 0; level < header.levelCount; level++)
+		{
+			LEOASSERTF(levels[level].size() == LevelBytes(width, height, level), "Level {} is {} bytes, expected {}",
+				level, levels[level].size(), LevelBytes(width, height, level));
+			header.levelOffsets[level] = offset;
+			offset = AlignUp(offset + levels[level].size());
+		}
+
+		// written next to the final file and renamed, a crash never leaves a truncated texture behind.
+		// Two workers may cook the same source, each writes its own temporary
+		std::filesystem::path path = filepath;
+		std::filesystem::path temp = path;
+		temp += std::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+		{
+			static const char padding[TEXTURE_FILE_ALIGNMENT] = {};
+
+			std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			u64 written = sizeof(header);
+			for (u32 level = 0; level < header.levelCount; level++)
+			{
+				file.write(padding, header.levelOffsets[level] - written);
+				file.write(reinterpret_cast<const char*>(levels[level].data()), levels[level].size());
+				written = header.levelOffsets[level] + levels[level].size();
+			}
+			if (!file)
+			{
+				LEOLOGERROR("Failed to write the texture file {}", temp.string());
+				return false;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temp, path, error);
+		if (error)
+		{
+			LEOLOGERROR("Failed to write the texture file {}: {}", filepath, error.message());
+			std::filesystem::remove(temp, error);
+			return false;
+		}
+
+		return true;
+	}
+
+	std::string ValidateTextureFile(std::span<const u8> file)
+	{
+		if (file.size() < sizeof(TextureFileHeader)) return std::format("{} bytes, smaller than the header", file.size());
+
+		TextureFileHeader header;
+		std::memcpy(&header, file.data(), sizeof(header));
+
+		if (header.magic != TEXTURE_FILE_MAGIC)     return "not a .leotex file";
+		if (header.version != TEXTURE_FILE_VERSION) return std::format("version {}, expected {}", header.version, TEXTURE_FILE_VERSION);
+		if (header.format != TextureFormat::RGBA8UB) return std::format("format {}, only RGBA8 is stored", (u32)header.format);
+
+		if (header.width == 0 || header.height == 0) return std::format("{}x{} pixels", header.width, header.height);
+		if (header.levelCount != MipLevelCount(header.width, header.height) || header.levelCount > TEXTURE_FILE_MAX_LEVELS) {
+			return std::format("{} levels, a {}x{} chain has {}", header.levelCount, header.width, header.height, MipLevelCount(header.width, header.height));
+		}
+
+		u64 end = sizeof(TextureFileHeader);
+		for (u32 level = 0; level < header.levelCount; level++)
+		{
+			u64 offset = header.levelOffsets[level];
+			u64 bytes = LevelBytes(header.width, header.height, level);
+
+			if (offset % TEXTURE_FILE_ALIGNMENT != 0) return std::format("level {} is unaligned", level);
+			if (offset < end) return std::format("level {} overlaps the data before it", level);
+			if (offset > file.size() || bytes > file.size() - offset) {
+				return std::format("truncated: {} bytes, level {} ends at {}", file.size(), level, offset + bytes);
+			}
+			end = offset + bytes;
+		}
+
+		return {};
+	}
+
+	TextureFileView ViewTextureFile(std::span<const u8> file)
+	{
+		LEOASSERT(file.size() >= sizeof(TextureFileHeader), "ViewTextureFile needs a validated file");
+
+		TextureFileView view;
+		view.header = reinterpret_cast<const TextureFileHeader*>(file.data());
+		for (u32 level = 0; level < view.header->levelCount; level++)
+		{
+			view.levels[level] = file.subspan(view.header->levelOffsets[level], LevelBytes(view.header->width, view.header->height, level));
+		}
+		return view;
+	}
+
+	std::filesystem::path CookedTexturePath(const std::string& source_path, const std::filesystem::path& cache_directory)
+	{
+		u64 path_hash = HashTextureSource({ reinterpret_cast<const u8*>(source_path.data()), source_path.size() });
+		std::string stem = std::filesystem::path(source_path).stem().string();
+		return cache_directory / std::format("{}_{:016x}.leotex", stem, path_hash);
+	}
+
+	MappedFile CookTexture(const std::string& source_path, const std::filesystem::path& cache_directory, bool srgb, bool* cooked)
+	{
+		if (cooked != nullptr) *cooked = false;
+
+		MappedFile source(source_path);
+		if (!source.IsOpen()) return MappedFile{};
+
+		const u64 source_hash = HashTextureSource(source.Bytes());
+		const u32 flags = srgb ? (u32)TEXTURE_FILE_SRGB : 0u;
+		const std::filesystem::path path = CookedTexturePath(source_path, cache_directory);
+
+		MappedFile file(path.string());
+		if (file.IsOpen() && ValidateTextureFile(file.Bytes()).empty())
+		{
+			const TextureFileHeader* header = ViewTextureFile(file.Bytes()).header;
+			if (header->sourceHash == source_hash && header->sourceSize == source.Bytes().size() && header->flags == flags) return file;
+		}
+		file.Close();
+
+		ImageData image = DecodeImageData(source.Bytes());
+		if (image.data == nullptr) return MappedFile{};
+
+		const u32 width = (u32)image.width, height = (u32)image.height;
+		std::vector<std::vector<u8>> mips = GenerateMipChain(image.data.get(), width, height, srgb);
+
+		std::vector<std::span<const u8>> levels;
+		levels.reserve(mips.size() + 1);
+		levels.emplace_back(image.data.get(), (u64)width * height * 4);
+		for (const std::vector<u8>& mip : mips) levels.emplace_back(mip);
+
+		std::error_code error;
+		std::filesystem::create_directories(cache_directory, error);
+		if (!WriteTextureFile(path.string(), width, height, flags, source_hash, source.Bytes().size(), levels)) return MappedFile{};
+
+		if (cooked != nullptr) *cooked = true;
+		LEOLOGVERBOSE("Cooked {} into {}: {}x{}, {} levels", source_path, path.string(), width, height, levels.size());
+
+		file.Open(path.string());
+		if (!file.IsOpen() || !ValidateTextureFile(file.Bytes()).empty()) return MappedFile{};
+		return file;
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <filesystem>
+#include <span>
+#include <string>
+#include <LEO/Utilities/LeoTypes.h>
+#include <LEO/Utilities/LeoFileUtilities.h>
+#include "Texture.h"
+
+namespace leo
+{
+	constexpr u32 TEXTURE_FILE_MAGIC      = 0x5845544C; // "LTEX"
+	constexpr u32 TEXTURE_FILE_VERSION    = 1;
+	constexpr u32 TEXTURE_FILE_ALIGNMENT  = 64;         // each level starts on a cache line
+	constexpr u32 TEXTURE_FILE_MAX_LEVELS = 16;         // a full chain of 32768 x 32768
+
+	enum TextureFileFlags : u32
+	{
+		TEXTURE_FILE_SRGB = 1 << 0 // the mips were filtered in linear space, the pixels are sRGB encoded
+	};
+
+	/// <summary>
+	/// Header of a .leotex file, followed by the levels of a full mip chain at aligned offsets, level 0 first.
+	/// The levels are in the layout glTexImage2D reads (rows bottom first), a loader maps the file and uploads
+	/// them as they are. The hash of the source image is kept to know when the file is stale.
+	/// </summary>
+	struct TextureFileHeader
+	{
+		u32 magic;
+		u32 version;
+		u32 width;          // of level 0
+		u32 height;
+		TextureFormat format;
+		u32 levelCount;     // MipLevelCount(width, height)
+		u32 flags;          // TextureFileFlags
+		u32 reserved;
+		u64 sourceHash;     // HashTextureSource of the file the levels were cooked from
+		u64 sourceSize;
+		u64 levelOffsets[TEXTURE_FILE_MAX_LEVELS]; // from the start of the file
+	};
+
+	// The levels of a validated file, they point into the file bytes
+	struct TextureFileView
+	{
+		const TextureFileHeader* header = nullptr;
+		std::span<const u8> levels[TEXTURE_FILE_MAX_LEVELS];
+	};
+
+	// Hash of the bytes of a source image, compared with TextureFileHeader::sourceHash
+	u64 HashTextureSource(std::span<const u8> bytes);
+
+	// Writes a .leotex of RGBA8 levels (level 0 and GenerateMipChain's). Logs and returns false on failure
+	bool WriteTextureFile(const std::string& filepath, u32 width, u32 height, u32 flags, u64 source_hash, u64 source_size,
+		std::span<const std::span<const u8>> levels);
+
+	// Empty when the bytes are a valid .leotex, the reason otherwise
+	std::string ValidateTextureFile(std::span<const u8> file);
+
+	// The levels of a file ValidateTextureFile accepted
+	TextureFileView ViewTextureFile(std::span<const u8> file);
+
+	// Where the cooked file of a source goes, named after the source and a hash of its path
+	std::filesystem::path CookedTexturePath(const std::string& source_path, const std::filesystem::path& cache_directory);
+
+	/// <summary>
+	/// The mapped .leotex of source_path in cache_directory. It is cooked first (decoded, mips generated and
+	/// written) when it is missing, invalid or older than the source: the hash of the source bytes differs.
+	/// The file is not open when the source can't be read or decoded. cooked tells whether it was rebuilt.
+	/// </summary>
+	MappedFile CookTexture(const std::string& source_path, const std::filesystem::path& cache_directory, bool srgb = true, bool* cooked = nullptr);
+}
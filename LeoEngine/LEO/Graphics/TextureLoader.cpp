@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <LEO/Log/Log.h>
+#include <LEO/Utilities/LeoThreadPool.h>
+#include <LEO/Utilities/LeoTimer.h>
+#include "CommandList.h"
+#include "TextureFile.h"
+#include "TextureLoader.h"
+
+namespace leo
+{
+	TextureLoader::TextureLoader(ThreadPool* pool)
+		:
+		m_pool(pool)
+	{
+		ImageData checker = FallbackImageData();
+		m_placeholder = Texture((u32)checker.width, (u32)checker.height, TextureFormat::RGBA8UB, checker.data.get());
+	}
+
+	TextureLoader::~TextureLoader()
+	{
+		for (Request& request : m_requests)
+		{
+			if (request.decode.valid()) request.decode.wait();
+		}
+	}
+
+	void TextureLoader::SetCacheDirectory(const std::filesystem::path& directory)
+	{
+		LEOASSERT(m_requests.empty(), "The cache directory is read by the decodes in flight, set it before the first Load");
+		m_cacheDirectory = directory;
+	}
+
+	TextureHandle TextureLoader::Load(const std::string& filepath, const TextureLoadParams& params)
+	{
+		TextureHandle handle{ (u32)m_requests.size() };
+		Request& request = m_requests.emplace_back();
+		request.filepath = filepath;
+		request.params = params;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stats.requested++;
+			if (m_pool == nullptr) m_queued.push_back(&request);
+		}
+
+		if (m_pool != nullptr) {
+			request.decode = m_pool->Submit([this, &request]() { Decode(request); });
+		}
+
+		return handle;
+	}
+
+	void TextureLoader::Decode(Request& request)
+	{
+		Timer timer;
+		bool cooked = false;
+		if (!m_cacheDirectory.empty()) request.cooked = CookTexture(request.filepath, m_cacheDirectory, request.params.srgb, &cooked);
+		if (!request.cooked.IsOpen()) request.image = ReadImageData(request.filepath);
+		f32 ms = timer.ElapsedMillis();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (request.cooked.IsOpen())
+		{
+			if (cooked) m_stats.cooked++;
+			else m_stats.cached++;
+		}
+		if (m_pool != nullptr) m_decoded.push_back(&request); // without a pool Upload decoded it and uploads it now
+		m_stats.decoded++;
+		m_stats.decodeMs += ms;
+	}
+
+	const Texture* TextureLoader::Get(TextureHandle handle) const
+	{
+		LEOASSERTF(handle.index < m_requests.size(), "Texture handle {} was not returned by this loader", handle.index);
+		const Request& request = m_requests[handle.index];
+		return request.ready.load(std::memory_order_acquire) ? &request.texture : &m_placeholder;
+	}
+
+	bool TextureLoader::IsReady(TextureHandle handle) const
+	{
+		LEOASSERTF(handle.index < m_requests.size(), "Texture handle {} was not returned by this loader", handle.index);
+		return m_requests[handle.index].ready.load(std::memory_order_acquire);
+	}
+
+	u32 TextureLoader::Pending() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_stats.requested - m_stats.uploaded;
+	}
+
+	u32 TextureLoader::Upload(f32 budget_ms)
+	{
+		Timer timer;
+		u32 uploaded = 0;
+
+		// at least one per call, a budget smaller than one upload still makes progress
+		while (uploaded == 0 || timer.ElapsedMillis() < budget_ms)
+		{
+			Request* request = nullptr;
+			bool decode = false;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (!m_decoded.empty())
+				{
+					request = m_decoded.front();
+					m_decoded.erase(m_decoded.begin());
+				}
+				else if (!m_queued.empty())
+				{
+					request = m_queued.front();
+					m_queued.erase(m_queued.begin());
+					decode = true;
+				}
+			}
+			if (request == nullptr) break;
+
+			if (decode) Decode(*request);
+
+			if (request->cooked.IsOpen()) UploadCooked(*request);
+			else
+			{
+				ImageData image = std::move(request->image);
+				const TextureLoadParams& params = request->params;
+				request->texture = Texture(DIM_2D, { (u32)image.width, (u32)image.height, 0 }, TextureFormat::RGBA8UB,
+					params.minFilter, params.magFilter, params.wrapping, params.wrapping, image.data.get());
+			}
+			request->ready.store(true, std::memory_order_release);
+			uploaded++;
+		}
+
+		f32 ms = timer.ElapsedMillis();
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stats.uploaded += uploaded;
+		m_stats.uploadMs += ms;
+		m_stats.maxUploadMs = std::max(m_stats.maxUploadMs, ms);
+		return uploaded;
+	}
+
+	void TextureLoader::UploadCooked(Request& request)
+	{
+		TextureFileView view = ViewTextureFile(request.cooked.Bytes());
+		const TextureLoadParams& params = request.params;
+		const u32 width = view.header->width, height = view.header->height;
+
+		const bool mipmapped = params.minFilter != TextureMinFiltering::MIN_NEAREST && params.minFilter != TextureMinFiltering::MIN_LINEAR;
+		if (mipmapped)
+		{
+			// created without a mipmap filter, the driver would generate the levels we already have
+			request.texture = Texture(DIM_2D, { width, height, 0 }, TextureFormat::RGBA8UB, TextureMinFiltering::MIN_LINEAR,
+				params.magFilter, params.wrapping, params.wrapping, view.levels[0].data());
+			for (u32 level = 1; level < view.header->levelCount; level++)
+			{
+				request.texture.SetLevelData(level, view.levels[level].data());
+			}
+			request.texture.SetFiltering(params.minFilter, params.magFilter);
+		}
+		else
+		{
+			request.texture = Texture(DIM_2D, { width, height, 0 }, TextureFormat::RGBA8UB, params.minFilter,
+				params.magFilter, params.wrapping, params.wrapping, view.levels[0].data());
+		}
+
+		request.cooked.Close();
+	}
+
+	void TextureLoader::RecordUpload(CommandList& commands, f32 budget_ms)
+	{
+		commands.Callback([this, budget_ms]() { Upload(budget_ms); });
+	}
+
+	TextureLoaderStats TextureLoader::Stats() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_stats;
+	}
+}
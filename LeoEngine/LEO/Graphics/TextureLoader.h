@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <LEO/Utilities/LeoTypes.h>
+#include <LEO/Utilities/LeoFileUtilities.h>
+#include "Texture.h"
+
+namespace leo
+{
+	class ThreadPool;
+	class CommandList;
+
+	struct TextureHandle
+	{
+		static constexpr u32 INVALID = 0xFFFFFFFF;
+		u32 index = INVALID;
+
+		inline bool IsValid() const { return index != INVALID; }
+	};
+
+	struct TextureLoadParams
+	{
+		TextureMinFiltering minFilter = TextureMinFiltering::MIN_NEAREST;
+		TextureMagFiltering magFilter = TextureMagFiltering::MAG_NEAREST;
+		TextureWrapping     wrapping  = TextureWrapping::CLAMP_TO_EDGE;
+		bool                srgb      = true; // color: the cooked mips are filtered in linear space, false for data
+	};
+
+	struct TextureLoaderStats
+	{
+		u32 requested = 0;
+		u32 decoded   = 0;
+		u32 uploaded  = 0;
+		u32 cached    = 0; // loaded from a cooked .leotex
+		u32 cooked    = 0; // .leotex written because it was missing or stale
+		f32 decodeMs  = 0.0f; // worker time
+		f32 uploadMs  = 0.0f; // GL thread time, the sum over the Upload calls
+		f32 maxUploadMs = 0.0f; // the longest Upload call, what a frame paid at most
+	};
+
+	/// <summary>
+	/// Loads textures without blocking the frame: Load() returns at once, the file is decoded on the ThreadPool
+	/// and Upload() creates the Texture on the GL thread, a few per call within a time budget.
+	/// Until then Get() gives a placeholder (the fallback checker), so the handle can be drawn with right away.
+	/// The textures live as long as the loader, the pointers recorded in a CommandList stay valid.
+	/// With a cache directory the sources are cooked to .leotex files (CookTexture) and the mip chain computed
+	/// then is uploaded level by level, instead of decoding the source and letting the driver generate the mips.
+	/// </summary>
+	class TextureLoader
+	{
+	public:
+		explicit TextureLoader(ThreadPool* pool = nullptr); // nullptr: Upload decodes too, still within its budget
+
+		TextureLoader(const TextureLoader&) = delete;
+		TextureLoader& operator=(const TextureLoader&) = delete;
+
+		~TextureLoader(); // waits for the decodes in flight
+	public:
+		// Main thread, before the first Load. An empty path (the default) decodes the sources every time
+		void SetCacheDirectory(const std::filesystem::path& directory);
+
+		// Main thread
+		TextureHandle Load(const std::string& filepath, const TextureLoadParams& params = {});
+
+		// The texture once uploaded, the placeholder before
+		const Texture* Get(TextureHandle handle) const;
+		bool IsReady(TextureHandle handle) const;
+
+		inline const Texture* Placeholder() const { return &m_placeholder; }
+
+		// Textures requested and not uploaded yet
+		u32 Pending() const;
+	public:
+		// GL thread: uploads decoded images until budget_ms is spent (at least one per call), returns how many
+		u32 Upload(f32 budget_ms);
+
+		// Records Upload to run on the thread that replays the commands
+		void RecordUpload(CommandList& commands, f32 budget_ms);
+
+		TextureLoaderStats Stats() const;
+	private:
+		struct Request
+		{
+			std::string filepath;
+			TextureLoadParams params;
+			ImageData image;
+			MappedFile cooked; // the .leotex, uploaded instead of image when open
+			Texture texture;
+			std::future<void> decode;
+			std::atomic<bool> ready = false;
+		};
+
+		void Decode(Request& request);
+		void UploadCooked(Request& request); // GL thread
+	private:
+		ThreadPool* m_pool = nullptr;
+		Texture m_placeholder;
+		std::filesystem::path m_cacheDirectory;
+
+		std::deque<Request> m_requests; // main thread, never shrinks: the textures stay where they are
+
+		mutable std::mutex m_mutex;
+		std::vector<Request*> m_queued;  // waiting for Upload to decode them (no pool)
+		std::vector<Request*> m_decoded; // waiting for Upload, in decode order
+		TextureLoaderStats m_stats;
+	};
+}
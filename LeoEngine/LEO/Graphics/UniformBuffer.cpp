@@ -0,0 +1,88 @@
+#include <cstring>
+#include <glad/glad.h>
+#include <LEO/Log/Log.h>
+#include "GLStateCache.h"
+#include "UniformBuffer.h"
+
+namespace leo
+{
+	// ---------------- UniformBuffer ----------------
+
+	UniformBuffer::UniformBuffer(u32 size, const void* data)
+		:
+		m_size(size)
+	{
+		glGenBuffers(1, &m_id);
+		GetGLStateCache().BindBuffer(GL_UNIFORM_BUFFER, m_id);
+		glBufferData(GL_UNIFORM_BUFFER, size, data, GL_DYNAMIC_DRAW);
+	}
+
+	UniformBuffer::UniformBuffer(UniformBuffer&& other) noexcept
+		:
+		m_id(other.m_id),
+		m_size(other.m_size)
+	{
+		other.m_id = 0;
+		other.m_size = 0;
+	}
+
+	UniformBuffer& UniformBuffer::operator=(UniformBuffer&& other) noexcept
+	{
+		GetGLStateCache().DeleteBuffer(m_id);
+
+		m_id = other.m_id;
+		m_size = other.m_size;
+
+		other.m_id = 0;
+		other.m_size = 0;
+		return *this;
+	}
+
+	UniformBuffer::~UniformBuffer()
+	{
+		GetGLStateCache().DeleteBuffer(m_id);
+	}
+
+	void UniformBuffer::SetData(const void* data, u32 size)
+	{
+		LEOASSERTF(size <= m_size, "Uniform block of {} bytes in a buffer of {}", size, m_size);
+
+		GetGLStateCache().BindBuffer(GL_UNIFORM_BUFFER, m_id);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+	}
+
+	void UniformBuffer::Bind(u32 binding) const
+	{
+		GetGLStateCache().BindUniformBuffer(binding, m_id);
+	}
+
+	// ---------------- UniformStream ----------------
+
+	static u32 UniformOffsetAlignment()
+	{
+		GLint alignment = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		return alignment > 0 ? (u32)alignment : 256; // 256 is the maximum the spec allows
+	}
+
+	UniformStream::UniformStream(u32 region_size, FenceBackend* fences)
+		:
+		m_buffer(region_size, StreamBuffer::DEFAULT_REGION_COUNT, fences),
+		m_alignment(UniformOffsetAlignment())
+	{
+	}
+
+	void UniformStream::Push(u32 binding, const void* data, u32 size)
+	{
+		StreamAllocation block = m_buffer.Allocate(size, m_alignment);
+		if (!block) return;
+
+		memcpy(block.ptr, data, size);
+		GetGLStateCache().BindUniformBuffer(binding, m_buffer.ID(), block.offset, size);
+	}
+
+	void UniformStream::EndFrame()
+	{
+		m_buffer.EndFrame();
+	}
+}
@@ -0,0 +1,175 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <glm/glm.hpp>
+#include <LEO/Utilities/LeoTypes.h>
+#include "StreamBuffer.h"
+
+namespace leo
+{
+	// ---------------- std140 ----------------
+
+	/*
+	* Base alignment and size of a member in a std140 uniform block.
+	* Only the types whose C++ layout can match std140 are defined: glm::mat3 (3 x vec3 columns)
+	* and scalar arrays (4 bytes stride) have no specialization, use mat4 / vec4 arrays instead.
+	*/
+	template<typename T>
+	struct Std140;
+
+	template<> struct Std140<f32>        { static constexpr u32 ALIGN = 4;  static constexpr u32 SIZE = 4; };
+	template<> struct Std140<i32>        { static constexpr u32 ALIGN = 4;  static constexpr u32 SIZE = 4; };
+	template<> struct Std140<u32>        { static constexpr u32 ALIGN = 4;  static constexpr u32 SIZE = 4; };
+	template<> struct Std140<glm::vec2>  { static constexpr u32 ALIGN = 8;  static constexpr u32 SIZE = 8; };
+	template<> struct Std140<glm::ivec2> { static constexpr u32 ALIGN = 8;  static constexpr u32 SIZE = 8; };
+	template<> struct Std140<glm::vec3>  { static constexpr u32 ALIGN = 16; static constexpr u32 SIZE = 12; };
+	template<> struct Std140<glm::ivec3> { static constexpr u32 ALIGN = 16; static constexpr u32 SIZE = 12; };
+	template<> struct Std140<glm::uvec3> { static constexpr u32 ALIGN = 16; static constexpr u32 SIZE = 12; };
+	template<> struct Std140<glm::vec4>  { static constexpr u32 ALIGN = 16; static constexpr u32 SIZE = 16; };
+	template<> struct Std140<glm::ivec4> { static constexpr u32 ALIGN = 16; static constexpr u32 SIZE = 16; };
+	template<> struct Std140<glm::uvec4> { static constexpr u32 ALIGN = 16; static constexpr u32 SIZE = 16; };
+	template<> struct Std140<glm::mat4>  { static constexpr u32 ALIGN = 16; static constexpr u32 SIZE = 64; };
+
+	// arrays have a 16 bytes aligned stride, only element types already 16 bytes wide match it
+	template<typename T, u64 N>
+	struct Std140<T[N]>
+	{
+		static_assert(Std140<T>::SIZE % 16 == 0, "std140 array elements are 16 bytes aligned, use vec4 or mat4 elements");
+		static constexpr u32 ALIGN = 16;
+		static constexpr u32 SIZE = Std140<T>::SIZE * (u32)N;
+	};
+
+	/*
+	* Compile time check of one member of a uniform block: the C++ offset must be the one written in
+	* the shader (or computed by hand from the std140 rules) and respect the std140 alignment of the type.
+	* List the members in order, LEO_STD140_END checks the last one reaches the end of the struct.
+	*/
+#define LEO_STD140_MEMBER(Type, member, offset)                                                          \
+	static_assert(offsetof(Type, member) == (offset), #Type "::" #member " is not at offset " #offset); \
+	static_assert((offset) % leo::Std140<decltype(Type::member)>::ALIGN == 0,                            \
+		#Type "::" #member " breaks the std140 alignment of its type");                                 \
+	static_assert(sizeof(Type::member) == leo::Std140<decltype(Type::member)>::SIZE,                    \
+		#Type "::" #member " does not have its std140 size")
+
+#define LEO_STD140_END(Type, last_member)                                                                \
+	static_assert(sizeof(Type) % 16 == 0, #Type " size must be a multiple of 16");                       \
+	static_assert(offsetof(Type, last_member) + sizeof(Type::last_member) + 16 > sizeof(Type),           \
+		#Type " has unchecked members after " #last_member)
+
+	// ---------------- Engine uniform blocks ----------------
+
+	// Binding points, they match the "layout(std140, binding = N)" of the shaders
+	enum UniformBinding : u32
+	{
+		UNIFORM_BINDING_FRAME    = 0,
+		UNIFORM_BINDING_MATERIAL = 1,
+		UNIFORM_BINDING_DRAW     = 2
+	};
+
+	// Per frame camera data, written once per frame
+	struct FrameUniforms
+	{
+		glm::mat4 view;
+		glm::mat4 proj;
+		glm::mat4 viewProj;
+		glm::vec3 cameraPosition;
+		f32       time;
+	};
+	LEO_STD140_MEMBER(FrameUniforms, view, 0);
+	LEO_STD140_MEMBER(FrameUniforms, proj, 64);
+	LEO_STD140_MEMBER(FrameUniforms, viewProj, 128);
+	LEO_STD140_MEMBER(FrameUniforms, cameraPosition, 192);
+	LEO_STD140_MEMBER(FrameUniforms, time, 204);
+	LEO_STD140_END(FrameUniforms, time);
+
+	// Per material constants, written when the material changes
+	struct MaterialUniforms
+	{
+		glm::vec4 tint = glm::vec4(1.0f);
+		glm::vec2 uvScale = glm::vec2(1.0f);
+		f32       alphaCutoff = 0.0f;
+		u32       flags = 0;
+	};
+	LEO_STD140_MEMBER(MaterialUniforms, tint, 0);
+	LEO_STD140_MEMBER(MaterialUniforms, uvScale, 16);
+	LEO_STD140_MEMBER(MaterialUniforms, alphaCutoff, 24);
+	LEO_STD140_MEMBER(MaterialUniforms, flags, 28);
+	LEO_STD140_END(MaterialUniforms, flags);
+
+	// Per draw transforms, ring allocated (UniformStream)
+	struct DrawUniforms
+	{
+		glm::mat4 model;
+		glm::mat4 modelView;
+	};
+	LEO_STD140_MEMBER(DrawUniforms, model, 0);
+	LEO_STD140_MEMBER(DrawUniforms, modelView, 64);
+	LEO_STD140_END(DrawUniforms, modelView);
+
+	// ---------------- Buffers ----------------
+
+	/// <summary>
+	/// A uniform buffer object holding one block, updated with glBufferSubData and bound by binding point.
+	/// For data written once per frame or less (camera, materials).
+	/// </summary>
+	class UniformBuffer
+	{
+	public:
+		UniformBuffer() = default;
+		UniformBuffer(u32 size, const void* data = nullptr);
+
+		UniformBuffer(const UniformBuffer&) = delete;
+		UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+		UniformBuffer(UniformBuffer&& other) noexcept;
+		UniformBuffer& operator=(UniformBuffer&& other) noexcept;
+
+		~UniformBuffer();
+
+		template<typename Block>
+		static UniformBuffer Create(const Block& block = {}) { return UniformBuffer(sizeof(Block), &block); }
+	public:
+		void SetData(const void* data, u32 size);
+
+		template<typename Block>
+		void Set(const Block& block) { SetData(&block, sizeof(Block)); }
+
+		void Bind(u32 binding) const;
+
+		inline u32 ID() const { return m_id; }
+		inline u32 GetSize() const { return m_size; }
+	private:
+		u32 m_id = 0;
+		u32 m_size = 0;
+	};
+
+	/// <summary>
+	/// Per draw uniform blocks sub-allocated from a StreamBuffer: Push copies the block in the ring
+	/// and binds its range (glBindBufferRange), no buffer is created or updated with a GL call.
+	/// Draw with the pushed data before the next Push, call EndFrame once per frame.
+	/// </summary>
+	class UniformStream
+	{
+	public:
+		static constexpr u32 DEFAULT_REGION_SIZE = 256 * 1024;
+	public:
+		UniformStream(u32 region_size = DEFAULT_REGION_SIZE, FenceBackend* fences = nullptr); // needs an OpenGL context
+
+		UniformStream(const UniformStream&) = delete;
+		UniformStream& operator=(const UniformStream&) = delete;
+	public:
+		void Push(u32 binding, const void* data, u32 size);
+
+		template<typename Block>
+		void Push(u32 binding, const Block& block) { Push(binding, &block, sizeof(Block)); }
+
+		void EndFrame();
+
+		// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, the stride of the pushed blocks
+		inline u32 Alignment() const { return m_alignment; }
+		inline const StreamBuffer& Buffer() const { return m_buffer; }
+	private:
+		StreamBuffer m_buffer;
+		u32 m_alignment = 256;
+	};
+}
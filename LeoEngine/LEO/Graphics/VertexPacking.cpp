@@ -0,0 +1,168 @@
+#include <cstring>
+#include <glad/glad.h>
+#include <glm/gtc/packing.hpp>
+#include <LEO/Log/Log.h>
+#include "VertexPacking.h"
+
+namespace leo
+{
+	u16 PackHalf(f32 v)
+	{
+		return glm::packHalf1x16(v);
+	}
+
+	f32 UnpackHalf(u16 h)
+	{
+		return glm::unpackHalf1x16(h);
+	}
+
+	u16 PackUnorm16(f32 v)
+	{
+		return glm::packUnorm1x16(v);
+	}
+
+	f32 UnpackUnorm16(u16 p)
+	{
+		return glm::unpackUnorm1x16(p);
+	}
+
+	u16 PackSnorm16(f32 v)
+	{
+		return glm::packSnorm1x16(v);
+	}
+
+	f32 UnpackSnorm16(u16 p)
+	{
+		return glm::unpackSnorm1x16(p);
+	}
+
+	u32 PackSnorm10(glm::vec4 v)
+	{
+		// x in the low bits, the GL_INT_2_10_10_10_REV order
+		return glm::packSnorm3x10_1x2(v);
+	}
+
+	glm::vec4 UnpackSnorm10(u32 p)
+	{
+		return glm::unpackSnorm3x10_1x2(p);
+	}
+
+	// ---------------- Octahedral ----------------
+
+	static glm::vec2 SignNotZero(glm::vec2 v)
+	{
+		return glm::vec2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	u32 PackOctahedral(glm::vec3 n)
+	{
+		n /= glm::abs(n.x) + glm::abs(n.y) + glm::abs(n.z);
+
+		// the lower half is folded over the diagonals
+		glm::vec2 e(n.x, n.y);
+		if (n.z < 0.0f) {
+			e = (1.0f - glm::abs(glm::vec2(e.y, e.x))) * SignNotZero(e);
+		}
+
+		return (u32)PackSnorm16(e.x) | ((u32)PackSnorm16(e.y) << 16);
+	}
+
+	glm::vec3 UnpackOctahedral(u32 p)
+	{
+		glm::vec2 e(UnpackSnorm16((u16)(p & 0xFFFF)), UnpackSnorm16((u16)(p >> 16)));
+
+		glm::vec3 n(e.x, e.y, 1.0f - glm::abs(e.x) - glm::abs(e.y));
+		if (n.z < 0.0f)
+		{
+			glm::vec2 folded = (1.0f - glm::abs(glm::vec2(n.y, n.x))) * SignNotZero(glm::vec2(n.x, n.y));
+			n.x = folded.x;
+			n.y = folded.y;
+		}
+		return glm::normalize(n);
+	}
+
+	// ---------------- Vertices ----------------
+
+	static void WriteAttribute(ElementType type, u32 src_count, glm::vec4 v, u8* out)
+	{
+		switch (type)
+		{
+		case ElementType::FLOAT1: case ElementType::FLOAT1_N: std::memcpy(out, &v, 1 * sizeof(f32)); break;
+		case ElementType::FLOAT2: case ElementType::FLOAT2_N: std::memcpy(out, &v, 2 * sizeof(f32)); break;
+		case ElementType::FLOAT3: case ElementType::FLOAT3_N: std::memcpy(out, &v, 3 * sizeof(f32)); break;
+		case ElementType::FLOAT4: case ElementType::FLOAT4_N: std::memcpy(out, &v, 4 * sizeof(f32)); break;
+		case ElementType::UCHAR3: case ElementType::UCHAR4:
+			for (u32 i = 0; i < GetAttributeDesc(type).count; i++) out[i] = (u8)glm::clamp(glm::round(v[i]), 0.0f, 255.0f);
+			break;
+		case ElementType::UCHAR3_N: case ElementType::UCHAR4_N:
+			for (u32 i = 0; i < GetAttributeDesc(type).count; i++) out[i] = glm::packUnorm1x8(v[i]);
+			break;
+		case ElementType::HALF2: case ElementType::HALF4:
+			for (u32 i = 0; i < GetAttributeDesc(type).count; i++)
+			{
+				u16 h = PackHalf(v[i]);
+				std::memcpy(out + i * sizeof(u16), &h, sizeof(u16));
+			}
+			break;
+		case ElementType::USHORT2_N:
+			for (u32 i = 0; i < 2; i++)
+			{
+				u16 p = PackUnorm16(v[i]);
+				std::memcpy(out + i * sizeof(u16), &p, sizeof(u16));
+			}
+			break;
+		case ElementType::SHORT2_N:
+		{
+			u32 p = src_count == 3 ? PackOctahedral(glm::vec3(v)) : (u32)PackSnorm16(v.x) | ((u32)PackSnorm16(v.y) << 16);
+			std::memcpy(out, &p, sizeof(u32));
+			break;
+		}
+		case ElementType::INT_2_10_10_10_N:
+		{
+			u32 p = PackSnorm10(v);
+			std::memcpy(out, &p, sizeof(u32));
+			break;
+		}
+		default: LEOASSERT(false, "ElementType can't be packed");
+		}
+	}
+
+	std::vector<u8> PackVertices(std::span<const f32> vertices, std::span<const ElementType> src_layout, std::span<const ElementType> dst_layout)
+	{
+		LEOASSERTF(src_layout.size() == dst_layout.size(), "PackVertices: {} source attributes for {} packed ones", src_layout.size(), dst_layout.size());
+
+		u32 src_stride = 0; // floats
+		u32 dst_stride = 0; // bytes
+		for (u64 i = 0; i < src_layout.size(); i++)
+		{
+			VertexAttributeDesc desc = GetAttributeDesc(src_layout[i]);
+			LEOASSERT(desc.type == GL_FLOAT && src_layout[i] != ElementType::MAT4, "PackVertices reads FLOATn attributes");
+			src_stride += desc.count;
+			dst_stride += GetAttributeDesc(dst_layout[i]).size_bytes;
+		}
+
+		LEOASSERTF(src_stride != 0 && vertices.size() % src_stride == 0, "{} floats is not a whole number of vertices of {} floats", vertices.size(), src_stride);
+		u64 vertex_count = vertices.size() / src_stride;
+
+		std::vector<u8> packed(vertex_count * dst_stride);
+		const f32* src = vertices.data();
+		u8* dst = packed.data();
+
+		for (u64 v = 0; v < vertex_count; v++)
+		{
+			for (u64 i = 0; i < src_layout.size(); i++)
+			{
+				u32 count = GetAttributeDesc(src_layout[i]).count;
+
+				glm::vec4 value(0.0f, 0.0f, 0.0f, 1.0f);
+				for (u32 c = 0; c < count; c++) value[c] = src[c];
+
+				WriteAttribute(dst_layout[i], count, value, dst);
+				src += count;
+				dst += GetAttributeDesc(dst_layout[i]).size_bytes;
+			}
+		}
+
+		return packed;
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+#include <LEO/Utilities/LeoTypes.h>
+#include "BufferObjects.h"
+
+namespace leo
+{
+	// Encoders of the quantized ElementTypes, the decoders give what the GPU reads back.
+	// Error bounds are for inputs in the range of the format, larger values are clamped
+
+	// HALF2/HALF4: relative error <= 2^-11 for |v| in [2^-14, 65504], absolute <= 2^-25 below
+	u16 PackHalf(f32 v);
+	f32 UnpackHalf(u16 h);
+
+	// USHORT2_N: v in [0, 1], error <= 1 / (2 * 65535)
+	u16 PackUnorm16(f32 v);
+	f32 UnpackUnorm16(u16 p);
+
+	// SHORT2_N: v in [-1, 1], error <= 1 / (2 * 32767)
+	u16 PackSnorm16(f32 v);
+	f32 UnpackSnorm16(u16 p);
+
+	// INT_2_10_10_10_N: xyz in [-1, 1] with error <= 1 / (2 * 511), w rounded to -1, 0 or 1
+	u32 PackSnorm10(glm::vec4 v);
+	glm::vec4 UnpackSnorm10(u32 p);
+
+	/// <summary>
+	/// Octahedral encoding of a unit vector into 2 snorm16 (SHORT2_N): the sphere is projected on an octahedron
+	/// that is unfolded on a square. 4 bytes instead of 12, angular error below 0.004 degrees.
+	/// The shader decodes it with:
+	///     vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	///     if (n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0); // not sign(), 0 is +
+	///     n = normalize(n);
+	/// </summary>
+	u32 PackOctahedral(glm::vec3 n);
+	glm::vec3 UnpackOctahedral(u32 p);
+
+	/// <summary>
+	/// Converts float vertices to a quantized layout, attribute by attribute: src_layout are the FLOATn types of the
+	/// input, dst_layout the types to write (same number of attributes). Components missing from the source are
+	/// (0, 0, 0, 1), as OpenGL fills them. A FLOAT3 converted to SHORT2_N is octahedral encoded, it must be a unit vector.
+	/// Returns the vertices with the stride of Layout(dst_layout).
+	/// </summary>
+	std::vector<u8> PackVertices(std::span<const f32> vertices, std::span<const ElementType> src_layout, std::span<const ElementType> dst_layout);
+}
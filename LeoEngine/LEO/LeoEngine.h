@@ -1,8 +1,10 @@
 #include "Utilities/LeoTypes.h"
 #include "Utilities/LeoColors.h"
 #include "Utilities/LeoFileUtilities.h"
+#include "Utilities/LeoImageUtilities.h"
 #include "Utilities/LeoRand.h"
 #include "Utilities/LeoTimer.h"
+#include "Utilities/LeoThreadPool.h"
 
 #include "Log/Log.h"
 
@@ -10,4 +12,9 @@
 
 #include "Graphics/LeoGraphics.h"
 
+#include "Physics/Collision2D.h"
+#include "Physics/ContactSolver.h"
+#include "Physics/SpatialQuery.h"
+#include "Physics/SimulationIslands.h"
+
 #include "Core/Application.h"
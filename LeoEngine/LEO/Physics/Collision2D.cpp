@@ -0,0 +1,211 @@
+#include <cfloat>
+#include <LEO/Log/LeoAssert.h>
+#include "Collision2D.h"
+
+namespace leo
+{
+	static f32 Cross(const glm::vec2& a, const glm::vec2& b)
+	{
+		return a.x * b.y - a.y * b.x;
+	}
+
+	// outward normal of the edge (i, i + 1) of a counter-clockwise polygon
+	static glm::vec2 EdgeNormal(const glm::vec2* poly, u32 count, u32 i)
+	{
+		glm::vec2 edge = poly[(i + 1) % count] - poly[i];
+		return glm::normalize(glm::vec2(edge.y, -edge.x));
+	}
+
+	// the edge of poly1 that separates the polygons the most, negative separation means overlap on every edge
+	static f32 FindMaxSeparation(const glm::vec2* poly1, u32 count1, const glm::vec2* poly2, u32 count2, u32& edge_index)
+	{
+		f32 max_separation = -FLT_MAX;
+		edge_index = 0;
+
+		for (u32 i = 0; i < count1; i++)
+		{
+			glm::vec2 n = EdgeNormal(poly1, count1, i);
+
+			// deepest point of poly2 along -n
+			f32 separation = FLT_MAX;
+			for (u32 j = 0; j < count2; j++)
+			{
+				separation = glm::min(separation, glm::dot(n, poly2[j] - poly1[i]));
+			}
+
+			if (separation > max_separation)
+			{
+				max_separation = separation;
+				edge_index = i;
+
+				if (max_separation > 0.0f) {
+					break; // early out, we found a separating axis
+				}
+			}
+		}
+
+		return max_separation;
+	}
+
+	// keeps the part of the segment where dot(normal, p) <= offset, returns the number of output points
+	static u32 ClipSegmentToLine(glm::vec2 out[2], const glm::vec2 in[2], const glm::vec2& normal, f32 offset)
+	{
+		u32 count = 0;
+
+		f32 distance0 = glm::dot(normal, in[0]) - offset;
+		f32 distance1 = glm::dot(normal, in[1]) - offset;
+
+		if (distance0 <= 0.0f) out[count++] = in[0];
+		if (distance1 <= 0.0f) out[count++] = in[1];
+
+		if (distance0 * distance1 < 0.0f)
+		{
+			f32 t = distance0 / (distance0 - distance1);
+			out[count++] = in[0] + t * (in[1] - in[0]);
+		}
+
+		return count;
+	}
+
+	bool CircleOverlap(const glm::vec2& a_center, f32 a_radius, const glm::vec2& b_center, f32 b_radius)
+	{
+		glm::vec2 d = b_center - a_center;
+		f32 r = a_radius + b_radius;
+		return glm::dot(d, d) <= r * r;
+	}
+
+	u32 ConvexHull(const glm::vec2* points, u32 count, glm::vec2* out)
+	{
+		LEOASSERT(points != nullptr && out != nullptr, "ConvexHull was called with a null array");
+
+		if (count < 3)
+		{
+			for (u32 i = 0; i < count; i++) {
+				out[i] = points[i];
+			}
+			return count;
+		}
+
+		// gift wrapping, no extra memory and polygons are small
+		u32 start = 0;
+		for (u32 i = 1; i < count; i++)
+		{
+			if (points[i].x < points[start].x || (points[i].x == points[start].x && points[i].y < points[start].y)) {
+				start = i;
+			}
+		}
+
+		u32 hull_count = 0;
+		u32 current = start;
+		do
+		{
+			out[hull_count++] = points[current];
+
+			u32 next = (current + 1) % count;
+			for (u32 i = 0; i < count; i++)
+			{
+				if (i == current) continue;
+
+				f32 c = Cross(points[next] - points[current], points[i] - points[current]);
+				if (c < 0.0f)
+				{
+					next = i;
+				}
+				else if (c == 0.0f)
+				{
+					// collinear, keep the farthest so we skip the middle points
+					glm::vec2 a = points[i] - points[current];
+					glm::vec2 b = points[next] - points[current];
+					if (glm::dot(a, a) > glm::dot(b, b)) {
+						next = i;
+					}
+				}
+			}
+
+			current = next;
+		} while (current != start && hull_count < count);
+
+		return hull_count;
+	}
+
+	bool CollidePolygons(const glm::vec2* a, u32 a_count, const glm::vec2* b, u32 b_count, ContactManifold& manifold)
+	{
+		LEOASSERT(a_count >= 3 && b_count >= 3, "CollidePolygons needs polygons with at least three vertices");
+
+		manifold.pointCount = 0;
+
+		u32 edge_a = 0;
+		f32 separation_a = FindMaxSeparation(a, a_count, b, b_count, edge_a);
+		if (separation_a > 0.0f) return false;
+
+		u32 edge_b = 0;
+		f32 separation_b = FindMaxSeparation(b, b_count, a, a_count, edge_b);
+		if (separation_b > 0.0f) return false;
+
+		// prefer A as the reference face so the result is stable from frame to frame
+		constexpr f32 k_relativeTol = 0.98f;
+		constexpr f32 k_absoluteTol = 0.001f;
+
+		const glm::vec2* ref = a;
+		const glm::vec2* inc = b;
+		u32 ref_count = a_count;
+		u32 inc_count = b_count;
+		u32 ref_edge = edge_a;
+		bool flip = false;
+
+		if (separation_b > k_relativeTol * separation_a + k_absoluteTol)
+		{
+			ref = b;
+			inc = a;
+			ref_count = b_count;
+			inc_count = a_count;
+			ref_edge = edge_b;
+			flip = true;
+		}
+
+		glm::vec2 ref_normal = EdgeNormal(ref, ref_count, ref_edge);
+
+		// incident edge: the edge of inc most anti-parallel to the reference normal
+		u32 inc_edge = 0;
+		f32 min_dot = FLT_MAX;
+		for (u32 i = 0; i < inc_count; i++)
+		{
+			f32 d = glm::dot(ref_normal, EdgeNormal(inc, inc_count, i));
+			if (d < min_dot)
+			{
+				min_dot = d;
+				inc_edge = i;
+			}
+		}
+
+		glm::vec2 incident[2] = { inc[inc_edge], inc[(inc_edge + 1) % inc_count] };
+
+		glm::vec2 v1 = ref[ref_edge];
+		glm::vec2 v2 = ref[(ref_edge + 1) % ref_count];
+		glm::vec2 tangent = glm::normalize(v2 - v1);
+
+		// clip the incident edge against the side planes of the reference edge
+		glm::vec2 clip1[2];
+		glm::vec2 clip2[2];
+
+		if (ClipSegmentToLine(clip1, incident, -tangent, -glm::dot(tangent, v1)) < 2) return false;
+		if (ClipSegmentToLine(clip2, clip1, tangent, glm::dot(tangent, v2)) < 2) return false;
+
+		// keep the points below the reference face
+		f32 front_offset = glm::dot(ref_normal, v1);
+		for (u32 i = 0; i < 2; i++)
+		{
+			f32 separation = glm::dot(ref_normal, clip2[i]) - front_offset;
+			if (separation <= 0.0f)
+			{
+				manifold.points[manifold.pointCount] = clip2[i];
+				manifold.depths[manifold.pointCount] = -separation;
+				manifold.pointCount++;
+			}
+		}
+
+		manifold.normal = flip ? -ref_normal : ref_normal;
+
+		return manifold.pointCount > 0;
+	}
+}
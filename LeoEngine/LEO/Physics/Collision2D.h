@@ -0,0 +1,35 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <LEO/Utilities/LeoTypes.h>
+
+namespace leo
+{
+	// Contact information between two shapes A and B
+	struct ContactManifold
+	{
+		glm::vec2 normal     = glm::vec2(0.0f); // unit vector pointing from A to B
+		u32       pointCount = 0;               // 0, 1 or 2
+		glm::vec2 points[2]  = {};              // world space contact points
+		f32       depths[2]  = {};              // penetration depth of each point (>= 0)
+
+		// The deepest penetration of the manifold
+		f32 MaxDepth() const { return pointCount == 2 ? glm::max(depths[0], depths[1]) : depths[0]; }
+	};
+
+	// Returns true if the circles overlap
+	bool CircleOverlap(const glm::vec2& a_center, f32 a_radius, const glm::vec2& b_center, f32 b_radius);
+
+	/// <summary>
+	/// Computes the convex hull of the points (gift wrapping, O(n h) for h hull points).
+	/// `out` must have room for `count` points, the hull is written counter-clockwise
+	/// (in a y-up frame) without collinear points. Returns the number of hull points.
+	/// </summary>
+	u32 ConvexHull(const glm::vec2* points, u32 count, glm::vec2* out);
+
+	/// <summary>
+	/// Exact Separating Axis Test between two convex polygons given in world space
+	/// and counter-clockwise order (as produced by ConvexHull).
+	/// On overlap fills the manifold (reference face clipping, up to two points) and returns true.
+	/// </summary>
+	bool CollidePolygons(const glm::vec2* a, u32 a_count, const glm::vec2* b, u32 b_count, ContactManifold& manifold);
+}
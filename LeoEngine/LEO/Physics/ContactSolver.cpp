@@ -0,0 +1,169 @@
+#include <bit>
+#include <LEO/Log/LeoAssert.h>
+#include "ContactSolver.h"
+
+namespace leo
+{
+	ContactSolver::ContactSolver(ThreadPool* pool)
+		:
+		m_pool(pool),
+		m_colorOffsets(MAX_COLORS + 1, 0)
+	{
+	}
+
+	void ContactSolver::Solve(std::span<SolverBody> bodies, std::span<Contact> contacts, const ContactSolverSettings& settings)
+	{
+		ColorContacts(bodies, contacts, settings);
+
+		m_startPositions.resize(bodies.size());
+		for (u32 i = 0; i < (u32)bodies.size(); i++)
+		{
+			m_startPositions[i] = bodies[i].position;
+		}
+
+		for (u32 it = 0; it < settings.velocityIterations; it++)
+		{
+			ForEachBatch(settings.minContactsPerTask, [&](u32 begin, u32 end) {
+				for (u32 i = begin; i < end; i++) {
+					SolveVelocity(m_constraints[i], bodies);
+				}
+			});
+		}
+
+		for (u32 it = 0; it < settings.positionIterations; it++)
+		{
+			ForEachBatch(settings.minContactsPerTask, [&](u32 begin, u32 end) {
+				for (u32 i = begin; i < end; i++) {
+					SolvePosition(m_constraints[i], bodies, m_startPositions, settings.correction, settings.slop);
+				}
+			});
+		}
+
+		for (const Constraint& c : m_constraints)
+		{
+			contacts[c.contact].normalImpulse = c.impulse;
+		}
+	}
+
+	void ContactSolver::ColorContacts(std::span<const SolverBody> bodies, std::span<const Contact> contacts, const ContactSolverSettings& settings)
+	{
+		m_bodyColors.assign(bodies.size(), 0ull);
+		m_colorOf.resize(contacts.size());
+
+		u32 counts[MAX_COLORS + 1] = {};
+		m_colorCount = 0;
+
+		// greedy first fit in contact order, static bodies can be shared by every contact of a color
+		for (u32 i = 0; i < (u32)contacts.size(); i++)
+		{
+			const Contact& contact = contacts[i];
+			LEOASSERT(contact.bodyA < bodies.size() && contact.bodyB < bodies.size(), "Contact references a body out of range");
+
+			bool dynamicA = bodies[contact.bodyA].invMass > 0.0f;
+			bool dynamicB = bodies[contact.bodyB].invMass > 0.0f;
+
+			u64 used = (dynamicA ? m_bodyColors[contact.bodyA] : 0ull) | (dynamicB ? m_bodyColors[contact.bodyB] : 0ull);
+			u32 color = (u32)std::countr_one(used); // MAX_COLORS when every color is taken
+
+			if (color < MAX_COLORS)
+			{
+				if (dynamicA) m_bodyColors[contact.bodyA] |= 1ull << color;
+				if (dynamicB) m_bodyColors[contact.bodyB] |= 1ull << color;
+				m_colorCount = glm::max(m_colorCount, color + 1);
+			}
+
+			m_colorOf[i] = color;
+			counts[color]++;
+		}
+
+		// counting sort, stable so the order inside a color is the contact order
+		u32 offset = 0;
+		for (u32 c = 0; c <= MAX_COLORS; c++)
+		{
+			m_colorOffsets[c] = offset;
+			offset += counts[c];
+			counts[c] = m_colorOffsets[c]; // reused as the insert cursor
+		}
+
+		m_constraints.resize(contacts.size());
+		for (u32 i = 0; i < (u32)contacts.size(); i++)
+		{
+			const Contact& contact = contacts[i];
+			const SolverBody& a = bodies[contact.bodyA];
+			const SolverBody& b = bodies[contact.bodyB];
+
+			Constraint& c = m_constraints[counts[m_colorOf[i]]++];
+			c.bodyA = contact.bodyA;
+			c.bodyB = contact.bodyB;
+			c.contact = i;
+			c.normal = contact.normal;
+			c.invMassA = a.invMass;
+			c.invMassB = b.invMass;
+
+			f32 k = a.invMass + b.invMass;
+			c.normalMass = k > 0.0f ? 1.0f / k : 0.0f;
+			c.depth = contact.depth;
+
+			f32 vn = glm::dot(b.velocity - a.velocity, contact.normal);
+			c.targetSpeed = glm::max(-settings.restitution * vn, 0.0f);
+			c.impulse = 0.0f;
+		}
+	}
+
+	template<typename Func>
+	void ContactSolver::ForEachBatch(u32 min_range, Func&& solve_range)
+	{
+		for (u32 color = 0; color < m_colorCount; color++)
+		{
+			u32 begin = m_colorOffsets[color];
+			u32 count = m_colorOffsets[color + 1] - begin;
+
+			if (m_pool != nullptr && count >= 2 * min_range)
+			{
+				m_pool->ParallelFor(count, min_range, [&](u32 b, u32 e) { solve_range(begin + b, begin + e); });
+			}
+			else
+			{
+				solve_range(begin, begin + count);
+			}
+		}
+
+		// overflow, these may share bodies so they are solved in order
+		solve_range(m_colorOffsets[MAX_COLORS], (u32)m_constraints.size());
+	}
+
+	void ContactSolver::SolveVelocity(Constraint& c, std::span<SolverBody> bodies)
+	{
+		SolverBody& a = bodies[c.bodyA];
+		SolverBody& b = bodies[c.bodyB];
+
+		f32 vn = glm::dot(b.velocity - a.velocity, c.normal);
+		f32 lambda = c.normalMass * (c.targetSpeed - vn);
+
+		// the accumulated impulse can only push
+		f32 new_impulse = glm::max(c.impulse + lambda, 0.0f);
+		lambda = new_impulse - c.impulse;
+		c.impulse = new_impulse;
+
+		// static bodies are shared by the contacts of a color, they are only read
+		if (c.invMassA > 0.0f) a.velocity -= (c.invMassA * lambda) * c.normal;
+		if (c.invMassB > 0.0f) b.velocity += (c.invMassB * lambda) * c.normal;
+	}
+
+	void ContactSolver::SolvePosition(Constraint& c, std::span<SolverBody> bodies, const std::vector<glm::vec2>& start, f32 correction, f32 slop)
+	{
+		SolverBody& a = bodies[c.bodyA];
+		SolverBody& b = bodies[c.bodyB];
+
+		// the penetration left after the corrections already applied to both bodies
+		glm::vec2 moved = (b.position - start[c.bodyB]) - (a.position - start[c.bodyA]);
+		f32 depth = c.depth - glm::dot(moved, c.normal);
+
+		f32 C = correction * (depth - slop);
+		if (C <= 0.0f) return;
+
+		f32 lambda = c.normalMass * C;
+		if (c.invMassA > 0.0f) a.position -= (c.invMassA * lambda) * c.normal;
+		if (c.invMassB > 0.0f) b.position += (c.invMassB * lambda) * c.normal;
+	}
+}
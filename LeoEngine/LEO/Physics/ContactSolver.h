@@ -0,0 +1,97 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <glm/glm.hpp>
+#include <LEO/Utilities/LeoTypes.h>
+#include <LEO/Utilities/LeoThreadPool.h>
+
+namespace leo
+{
+	// A point mass as seen by the solver, invMass == 0 means static
+	struct SolverBody
+	{
+		glm::vec2 position = glm::vec2(0.0f);
+		glm::vec2 velocity = glm::vec2(0.0f);
+		f32       invMass  = 1.0f;
+	};
+
+	// A contact between two bodies, filled by the narrow phase
+	struct Contact
+	{
+		u32       bodyA         = 0;
+		u32       bodyB         = 0;
+		glm::vec2 normal        = glm::vec2(0.0f); // unit, from A to B
+		f32       depth         = 0.0f;            // penetration (>= 0)
+		f32       normalImpulse = 0.0f;            // output: the accumulated impulse of the last Solve
+	};
+
+	struct ContactSolverSettings
+	{
+		u32 velocityIterations = 8;
+		u32 positionIterations = 3;
+		f32 restitution        = 1.0f;   // 1 = elastic, like ResolveCollisionSphere
+		f32 correction         = 0.8f;   // fraction of the penetration removed per position iteration
+		f32 slop               = 0.01f;  // penetration allowed without correction
+		u32 minContactsPerTask = 256;    // below this a color batch is not split between threads
+	};
+
+	/// <summary>
+	/// Solves contacts between SolverBody(s) with sequential impulses.
+	/// The contact graph is colored so that no two contacts of a color share a dynamic body
+	/// (static bodies can be in many contacts of a color, the solver never writes them),
+	/// each color batch is then solved in parallel on the ThreadPool, colors one after the other.
+	/// Inside a color the contacts are independent, so the result does not depend on the thread count.
+	/// Contacts that do not fit in the first MAX_COLORS colors are solved single threaded at the end of each pass.
+	/// </summary>
+	class ContactSolver
+	{
+	public:
+		static constexpr u32 MAX_COLORS = 64;
+	public:
+		explicit ContactSolver(ThreadPool* pool = nullptr); // nullptr: single threaded
+
+		ContactSolver(const ContactSolver&) = delete;
+		ContactSolver& operator=(const ContactSolver&) = delete;
+	public:
+		// Updates the bodies velocities and positions and writes Contact::normalImpulse
+		void Solve(std::span<SolverBody> bodies, std::span<Contact> contacts, const ContactSolverSettings& settings = {});
+
+		void SetThreadPool(ThreadPool* pool) { m_pool = pool; }
+	public:
+		// Number of colors used by the last Solve (overflow not included)
+		u32 ColorCount() const { return m_colorCount; }
+		// Number of contacts solved single threaded by the last Solve
+		u32 OverflowCount() const { return (u32)m_constraints.size() - m_colorOffsets[m_colorCount]; }
+	private:
+		struct Constraint
+		{
+			u32       bodyA;
+			u32       bodyB;
+			u32       contact;       // index into the Contact span
+			glm::vec2 normal;
+			f32       invMassA;
+			f32       invMassB;
+			f32       normalMass;    // 1 / (invMassA + invMassB)
+			f32       depth;
+			f32       targetSpeed;   // relative normal speed we want after the solve (restitution)
+			f32       impulse;       // accumulated
+		};
+	private:
+		void ColorContacts(std::span<const SolverBody> bodies, std::span<const Contact> contacts, const ContactSolverSettings& settings);
+
+		template<typename Func>
+		void ForEachBatch(u32 min_range, Func&& solve_range);
+
+		static void SolveVelocity(Constraint& c, std::span<SolverBody> bodies);
+		static void SolvePosition(Constraint& c, std::span<SolverBody> bodies, const std::vector<glm::vec2>& start, f32 correction, f32 slop);
+	private:
+		ThreadPool* m_pool = nullptr;
+
+		std::vector<Constraint> m_constraints;          // sorted by color, overflow last
+		std::vector<u32>        m_colorOffsets;         // MAX_COLORS + 1 entries
+		std::vector<u64>        m_bodyColors;           // per body bit mask of the colors it is used in
+		std::vector<u32>        m_colorOf;              // per contact, MAX_COLORS = overflow
+		std::vector<glm::vec2>  m_startPositions;       // per body, used to track the penetration during the position pass
+		u32                     m_colorCount = 0;
+	};
+}
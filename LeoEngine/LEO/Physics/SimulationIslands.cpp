@@ -0,0 +1,146 @@
+#include <numeric>
+#include <LEO/Log/LeoAssert.h>
+#include "SimulationIslands.h"
+
+namespace leo
+{
+	bool SimulationIslands::Sync(u32 body, const glm::vec2& position, const glm::vec2& velocity)
+	{
+		BodyState& state = State(body);
+		if (state.island == AWAKE) return true;
+
+		if (state.position != position || state.velocity != velocity)
+		{
+			Wake(body);
+			return true;
+		}
+
+		return false;
+	}
+
+	u32 SimulationIslands::Update(std::span<const u32> ids, std::span<SolverBody> bodies, std::span<const Contact> contacts, const SleepSettings& settings)
+	{
+		LEOASSERT(ids.size() == bodies.size(), "SimulationIslands::Update needs one id per body");
+
+		const u32 count = (u32)bodies.size();
+
+		m_parent.resize(count);
+		std::iota(m_parent.begin(), m_parent.end(), 0u);
+
+		// static bodies do not link islands, a floor would otherwise merge everything resting on it
+		for (const Contact& contact : contacts)
+		{
+			if (bodies[contact.bodyA].invMass == 0.0f || bodies[contact.bodyB].invMass == 0.0f) continue;
+
+			u32 a = Find(contact.bodyA);
+			u32 b = Find(contact.bodyB);
+			if (a != b) {
+				m_parent[glm::max(a, b)] = glm::min(a, b); // smallest index as root, independent of the contact order
+			}
+		}
+
+		m_islandRest.assign(count, AWAKE);
+		m_islandSlot.assign(count, AWAKE);
+		m_awakeIslandCount = 0;
+
+		for (u32 i = 0; i < count; i++)
+		{
+			BodyState& state = State(ids[i]);
+			const SolverBody& body = bodies[i];
+			LEOASSERT(state.island == AWAKE, "SimulationIslands::Update was given a sleeping body");
+
+			f32 mass = body.invMass > 0.0f ? 1.0f / body.invMass : 0.0f;
+			f32 energy = 0.5f * mass * glm::dot(body.velocity, body.velocity);
+			state.restFrames = energy < settings.sleepEnergy ? state.restFrames + 1 : 0;
+
+			u32 root = Find(i);
+			if (root == i) m_awakeIslandCount++;
+			m_islandRest[root] = glm::min(m_islandRest[root], state.restFrames);
+		}
+
+		u32 slept = 0;
+		for (u32 i = 0; i < count; i++)
+		{
+			u32 root = Find(i);
+			if (m_islandRest[root] < settings.framesToSleep) continue;
+
+			if (m_islandSlot[root] == AWAKE)
+			{
+				if (m_freeIslands.empty())
+				{
+					m_islandSlot[root] = (u32)m_islands.size();
+					m_islands.emplace_back();
+				}
+				else
+				{
+					m_islandSlot[root] = m_freeIslands.back();
+					m_freeIslands.pop_back();
+				}
+				m_awakeIslandCount--;
+			}
+
+			bodies[i].velocity = glm::vec2(0.0f);
+
+			BodyState& state = State(ids[i]);
+			state.position = bodies[i].position;
+			state.velocity = bodies[i].velocity;
+			state.island = m_islandSlot[root];
+
+			m_islands[state.island].push_back(ids[i]);
+			slept++;
+		}
+
+		if (slept > 0)
+		{
+			m_sleepingBodyCount += slept;
+			m_sleepVersion++;
+		}
+
+		return slept;
+	}
+
+	void SimulationIslands::Wake(u32 body)
+	{
+		if (!IsAsleep(body)) return;
+
+		u32 island = m_bodies[body].island;
+		for (u32 member : m_islands[island])
+		{
+			m_bodies[member].island = AWAKE;
+			m_bodies[member].restFrames = 0;
+		}
+
+		m_sleepingBodyCount -= (u32)m_islands[island].size();
+		m_islands[island].clear();
+		m_freeIslands.push_back(island);
+		m_sleepVersion++;
+	}
+
+	void SimulationIslands::Remove(u32 body)
+	{
+		Wake(body);
+
+		if (body < m_bodies.size()) {
+			m_bodies[body] = BodyState{}; // the id may be reused by a new body
+		}
+	}
+
+	SimulationIslands::BodyState& SimulationIslands::State(u32 body)
+	{
+		if (body >= m_bodies.size()) {
+			m_bodies.resize(body + 1);
+		}
+		return m_bodies[body];
+	}
+
+	u32 SimulationIslands::Find(u32 i)
+	{
+		// path halving
+		while (m_parent[i] != i)
+		{
+			m_parent[i] = m_parent[m_parent[i]];
+			i = m_parent[i];
+		}
+		return i;
+	}
+}
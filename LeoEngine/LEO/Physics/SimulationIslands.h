@@ -0,0 +1,79 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <glm/glm.hpp>
+#include <LEO/Utilities/LeoTypes.h>
+#include "ContactSolver.h"
+
+namespace leo
+{
+	struct SleepSettings
+	{
+		f32 sleepEnergy   = 1.0f; // a body rests while 0.5 * m * v^2 is below this
+		u32 framesToSleep = 60;   // an island sleeps when all its bodies rested this many frames in a row
+	};
+
+	/// <summary>
+	/// Tracks which bodies are asleep. Bodies are identified by a stable id chosen by the caller (an entity_id for example).
+	/// Every frame the awake bodies and their contacts are given to Update, which links them in islands (union find)
+	/// and puts to sleep the islands that have been resting long enough.
+	/// A sleeping island is woken as a whole by Wake (an awake body touched it) or when Sync sees
+	/// one of its bodies no longer has the position/velocity it fell asleep with (it was changed from outside).
+	/// </summary>
+	class SimulationIslands
+	{
+	public:
+		SimulationIslands() = default;
+	public:
+		/// <summary>
+		/// Call once per body and per frame before building the awake set.
+		/// Returns true if the body is awake and must be simulated, false if it is asleep and can be skipped.
+		/// </summary>
+		bool Sync(u32 body, const glm::vec2& position, const glm::vec2& velocity);
+
+		/// <summary>
+		/// Links the awake bodies through their contacts and puts the resting islands to sleep.
+		/// ids[i] is the id of bodies[i], contacts index into bodies. The velocity of the bodies that fall asleep is zeroed.
+		/// Returns the number of bodies put to sleep.
+		/// </summary>
+		u32 Update(std::span<const u32> ids, std::span<SolverBody> bodies, std::span<const Contact> contacts, const SleepSettings& settings = {});
+
+		void Wake(u32 body);   // wakes the whole island of the body
+		void Remove(u32 body); // the body was destroyed, its island is woken so it settles again
+	public:
+		bool IsAsleep(u32 body) const { return body < m_bodies.size() && m_bodies[body].island != AWAKE; }
+
+		inline u32 AwakeIslandCount() const { return m_awakeIslandCount; }
+		inline u32 SleepingIslandCount() const { return (u32)(m_islands.size() - m_freeIslands.size()); }
+		inline u32 SleepingBodyCount() const { return m_sleepingBodyCount; }
+
+		// Changes every time a body falls asleep or wakes up, a cache of the sleeping bodies can be rebuilt when it changes
+		inline u64 SleepVersion() const { return m_sleepVersion; }
+	private:
+		static constexpr u32 AWAKE = 0xFFFFFFFF;
+
+		struct BodyState
+		{
+			glm::vec2 position   = glm::vec2(0.0f); // values the body fell asleep with
+			glm::vec2 velocity   = glm::vec2(0.0f);
+			u32       restFrames = 0;
+			u32       island     = AWAKE;           // index in m_islands while asleep
+		};
+	private:
+		BodyState& State(u32 body);
+		u32 Find(u32 i);
+	private:
+		std::vector<BodyState> m_bodies;                // indexed by body id
+		std::vector<std::vector<u32>> m_islands;        // members of the sleeping islands
+		std::vector<u32> m_freeIslands;
+
+		// Update scratch, indexed like the bodies span
+		std::vector<u32> m_parent;
+		std::vector<u32> m_islandRest;                  // per root, the smallest restFrames of the island
+		std::vector<u32> m_islandSlot;                  // per root, the sleeping island it goes to
+
+		u32 m_awakeIslandCount = 0;
+		u32 m_sleepingBodyCount = 0;
+		u64 m_sleepVersion = 0;
+	};
+}
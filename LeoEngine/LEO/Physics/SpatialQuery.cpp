@@ -0,0 +1,281 @@
+#include <algorithm>
+#include <LEO/Log/LeoAssert.h>
+#include "SpatialQuery.h"
+
+namespace leo
+{
+	// the tree is balanced (median split) so 64 levels is far more than 65536 entities need
+	static constexpr u32 k_stackSize = 64;
+
+	static f32 BoxDistance2(const glm::vec2& min, const glm::vec2& max, const glm::vec2& point)
+	{
+		glm::vec2 d = point - glm::clamp(point, min, max);
+		return glm::dot(d, d);
+	}
+
+	// entry distance of the ray in the box, FLT_MAX if it misses
+	static f32 RayBox(const glm::vec2& origin, const glm::vec2& inv_direction, const glm::vec2& min, const glm::vec2& max, f32 max_t)
+	{
+		glm::vec2 t1 = (min - origin) * inv_direction;
+		glm::vec2 t2 = (max - origin) * inv_direction;
+
+		glm::vec2 t_near = glm::min(t1, t2);
+		glm::vec2 t_far = glm::max(t1, t2);
+
+		f32 enter = glm::max(glm::max(t_near.x, t_near.y), 0.0f);
+		f32 exit = glm::min(glm::min(t_far.x, t_far.y), max_t);
+
+		return enter <= exit ? enter : FLT_MAX;
+	}
+
+	void SpatialQuery::Clear()
+	{
+		m_items.clear();
+		m_nodes.clear();
+		m_built = false;
+	}
+
+	void SpatialQuery::Add(entity_id entity, const glm::vec2& center, f32 radius)
+	{
+		LEOASSERT(radius >= 0.0f, "SpatialQuery::Add radius must be positive");
+		m_items.push_back(Item{ center, radius, entity });
+		m_built = false;
+	}
+
+	void SpatialQuery::Build()
+	{
+		m_nodes.clear();
+		m_built = true;
+
+		if (m_items.empty()) return;
+
+		m_nodes.reserve(2 * m_items.size());
+		m_nodes.push_back(Node{});
+		BuildNode(0, 0, (u32)m_items.size());
+	}
+
+	void SpatialQuery::BuildNode(u32 node_index, u32 first, u32 count)
+	{
+		glm::vec2 min(FLT_MAX);
+		glm::vec2 max(-FLT_MAX);
+		glm::vec2 center_min(FLT_MAX);
+		glm::vec2 center_max(-FLT_MAX);
+
+		for (u32 i = first; i < first + count; i++)
+		{
+			const Item& item = m_items[i];
+			min = glm::min(min, item.center - item.radius);
+			max = glm::max(max, item.center + item.radius);
+			center_min = glm::min(center_min, item.center);
+			center_max = glm::max(center_max, item.center);
+		}
+
+		m_nodes[node_index].min = min;
+		m_nodes[node_index].max = max;
+
+		if (count <= MAX_LEAF_SIZE)
+		{
+			m_nodes[node_index].first = first;
+			m_nodes[node_index].count = count;
+			return;
+		}
+
+		// median split of the centers along the longest axis
+		glm::vec2 extent = center_max - center_min;
+		u32 axis = extent.x >= extent.y ? 0 : 1;
+		u32 half = count / 2;
+
+		std::nth_element(m_items.begin() + first, m_items.begin() + first + half, m_items.begin() + first + count,
+			[axis](const Item& a, const Item& b) { return a.center[axis] < b.center[axis]; });
+
+		u32 left = (u32)m_nodes.size();
+		m_nodes.push_back(Node{});
+		m_nodes.push_back(Node{});
+
+		m_nodes[node_index].first = left;
+		m_nodes[node_index].count = 0;
+
+		BuildNode(left, first, half);
+		BuildNode(left + 1, first + half, count - half);
+	}
+
+	u32 SpatialQuery::QueryRadius(const glm::vec2& center, f32 radius, std::span<entity_id> out) const
+	{
+		LEOASSERT(m_built, "SpatialQuery::Build must be called before querying");
+		if (m_nodes.empty()) return 0;
+
+		u32 found = 0;
+		u32 stack[k_stackSize];
+		u32 top = 0;
+		stack[top++] = 0;
+
+		while (top > 0)
+		{
+			const Node& node = m_nodes[stack[--top]];
+			if (BoxDistance2(node.min, node.max, center) > radius * radius) continue;
+
+			if (node.count == 0)
+			{
+				stack[top++] = node.first;
+				stack[top++] = node.first + 1;
+				continue;
+			}
+
+			for (u32 i = node.first; i < node.first + node.count; i++)
+			{
+				const Item& item = m_items[i];
+				glm::vec2 d = item.center - center;
+				f32 r = radius + item.radius;
+
+				if (glm::dot(d, d) <= r * r)
+				{
+					if (found < out.size()) out[found] = item.entity;
+					found++;
+				}
+			}
+		}
+
+		return found;
+	}
+
+	u32 SpatialQuery::QueryAABB(const glm::vec2& min, const glm::vec2& max, std::span<entity_id> out) const
+	{
+		LEOASSERT(m_built, "SpatialQuery::Build must be called before querying");
+		if (m_nodes.empty()) return 0;
+
+		u32 found = 0;
+		u32 stack[k_stackSize];
+		u32 top = 0;
+		stack[top++] = 0;
+
+		while (top > 0)
+		{
+			const Node& node = m_nodes[stack[--top]];
+			if (node.max.x < min.x || node.min.x > max.x || node.max.y < min.y || node.min.y > max.y) continue;
+
+			if (node.count == 0)
+			{
+				stack[top++] = node.first;
+				stack[top++] = node.first + 1;
+				continue;
+			}
+
+			for (u32 i = node.first; i < node.first + node.count; i++)
+			{
+				const Item& item = m_items[i];
+				if (BoxDistance2(min, max, item.center) <= item.radius * item.radius)
+				{
+					if (found < out.size()) out[found] = item.entity;
+					found++;
+				}
+			}
+		}
+
+		return found;
+	}
+
+	u32 SpatialQuery::QueryNearest(const glm::vec2& point, std::span<SpatialHit> out, f32 max_distance) const
+	{
+		LEOASSERT(m_built, "SpatialQuery::Build must be called before querying");
+		if (m_nodes.empty() || out.empty()) return 0;
+
+		const u32 k = (u32)out.size();
+		u32 found = 0;
+
+		u32 stack[k_stackSize];
+		u32 top = 0;
+		stack[top++] = 0;
+
+		while (top > 0)
+		{
+			const Node& node = m_nodes[stack[--top]];
+
+			// out is sorted, once full only something closer than the last one matters
+			f32 bound = found == k ? out[k - 1].distance : max_distance;
+			if (BoxDistance2(node.min, node.max, point) > bound * bound) continue;
+
+			if (node.count == 0)
+			{
+				// push the far child first so the near one is visited first and shrinks the bound
+				const Node& left = m_nodes[node.first];
+				const Node& right = m_nodes[node.first + 1];
+				bool left_first = BoxDistance2(left.min, left.max, point) <= BoxDistance2(right.min, right.max, point);
+
+				stack[top++] = left_first ? node.first + 1 : node.first;
+				stack[top++] = left_first ? node.first : node.first + 1;
+				continue;
+			}
+
+			for (u32 i = node.first; i < node.first + node.count; i++)
+			{
+				const Item& item = m_items[i];
+				f32 distance = glm::max(glm::length(item.center - point) - item.radius, 0.0f);
+
+				if (distance > max_distance) continue;
+				if (found == k && distance >= out[k - 1].distance) continue;
+
+				// insertion into the sorted output, dropping the last one when full
+				u32 j = found < k ? found++ : k - 1;
+				while (j > 0 && out[j - 1].distance > distance)
+				{
+					out[j] = out[j - 1];
+					j--;
+				}
+				out[j] = SpatialHit{ item.entity, distance };
+			}
+		}
+
+		return found;
+	}
+
+	bool SpatialQuery::Raycast(const glm::vec2& origin, const glm::vec2& direction, f32 max_distance, SpatialHit& hit) const
+	{
+		LEOASSERT(m_built, "SpatialQuery::Build must be called before querying");
+		if (m_nodes.empty()) return false;
+
+		const glm::vec2 inv_direction = 1.0f / direction;
+		f32 best = max_distance;
+		bool any = false;
+
+		u32 stack[k_stackSize];
+		u32 top = 0;
+		stack[top++] = 0;
+
+		while (top > 0)
+		{
+			const Node& node = m_nodes[stack[--top]];
+			if (RayBox(origin, inv_direction, node.min, node.max, best) == FLT_MAX) continue;
+
+			if (node.count == 0)
+			{
+				stack[top++] = node.first;
+				stack[top++] = node.first + 1;
+				continue;
+			}
+
+			for (u32 i = node.first; i < node.first + node.count; i++)
+			{
+				const Item& item = m_items[i];
+
+				glm::vec2 m = origin - item.center;
+				f32 b = glm::dot(m, direction);
+				f32 c = glm::dot(m, m) - item.radius * item.radius;
+
+				if (c > 0.0f && b > 0.0f) continue; // outside and pointing away
+
+				f32 discriminant = b * b - c;
+				if (discriminant < 0.0f) continue;
+
+				f32 t = glm::max(-b - glm::sqrt(discriminant), 0.0f); // 0 when the origin is inside
+				if (t <= best)
+				{
+					best = t;
+					hit = SpatialHit{ item.entity, t };
+					any = true;
+				}
+			}
+		}
+
+		return any;
+	}
+}
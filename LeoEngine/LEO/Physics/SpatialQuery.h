@@ -0,0 +1,88 @@
+#pragma once
+#include <cfloat>
+#include <vector>
+#include <span>
+#include <glm/glm.hpp>
+#include <LEO/Utilities/LeoTypes.h>
+#include <LEO/ECS/EntityManager.h>
+
+namespace leo
+{
+	// An entity found by a nearest or ray query
+	struct SpatialHit
+	{
+		entity_id entity   = 0;
+		f32       distance = 0.0f; // to the surface of the entity circle, along the ray for Raycast
+	};
+
+	/// <summary>
+	/// Answers radius, AABB, k-nearest and ray queries on entities seen as circles.
+	/// The entities are fed once per frame (Rebuild from a component store, or Clear/Add/Build),
+	/// then put in a bounding volume hierarchy so each query only visits the nodes it touches.
+	/// Queries are const and write into caller buffers: they never allocate and can run from several threads.
+	/// </summary>
+	class SpatialQuery
+	{
+	public:
+		static constexpr u32 MAX_LEAF_SIZE = 4;
+	public:
+		SpatialQuery() = default;
+	public:
+		void Clear();
+		void Add(entity_id entity, const glm::vec2& center, f32 radius);
+		void Build(); // must be called after the last Add and before querying
+
+		/// <summary>
+		/// Clears and rebuilds from every T of the EntityManager.
+		/// shape(const T&, glm::vec2& center, f32& radius) extracts the circle of a component.
+		/// </summary>
+		template<typename T, typename Func>
+		void Rebuild(EntityManager& entity_manager, Func&& shape)
+		{
+			Clear();
+			entity_manager.ForEach<T>([&](entity_id id, T& comp) {
+				glm::vec2 center(0.0f);
+				f32 radius = 0.0f;
+				shape((const T&)comp, center, radius);
+				Add(id, center, radius);
+			});
+			Build();
+		}
+	public:
+		// All the queries return the number of entities found, only the first out.size() are written
+
+		// Entities whose circle overlaps the circle (center, radius)
+		u32 QueryRadius(const glm::vec2& center, f32 radius, std::span<entity_id> out) const;
+		// Entities whose circle overlaps the box [min, max]
+		u32 QueryAABB(const glm::vec2& min, const glm::vec2& max, std::span<entity_id> out) const;
+		// The out.size() entities closest to point, sorted by distance. max_distance limits the search
+		u32 QueryNearest(const glm::vec2& point, std::span<SpatialHit> out, f32 max_distance = FLT_MAX) const;
+
+		// First entity hit by the ray origin + t * direction (direction normalized), t in [0, max_distance]
+		bool Raycast(const glm::vec2& origin, const glm::vec2& direction, f32 max_distance, SpatialHit& hit) const;
+	public:
+		inline u32 EntityCount() const { return (u32)m_items.size(); }
+		inline u32 NodeCount() const { return (u32)m_nodes.size(); }
+	private:
+		struct Item
+		{
+			glm::vec2 center;
+			f32       radius;
+			entity_id entity;
+		};
+
+		struct Node
+		{
+			glm::vec2 min;
+			glm::vec2 max;
+			u32       first; // leaf: first item, internal: left child (right child is first + 1)
+			u32       count; // leaf: number of items, 0 for internal nodes
+		};
+	private:
+		void BuildNode(u32 node_index, u32 first, u32 count);
+	private:
+		std::vector<Item> m_items;
+		std::vector<Node> m_nodes;
+		bool m_built = false;
+	};
+}
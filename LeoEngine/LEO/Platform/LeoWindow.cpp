@@ -180,6 +180,16 @@ namespace leo
 		glfwSwapBuffers(m_window);
 	}
 
+	void Window::MakeContextCurrent()
+	{
+		glfwMakeContextCurrent(m_window);
+	}
+
+	void Window::DetachContext()
+	{
+		glfwMakeContextCurrent(nullptr);
+	}
+
 	//-----------------------------------------------------------
 
 	void Window::SetTitle(const std::string& title)
@@ -48,6 +48,10 @@ namespace leo
 		void SwapBuffers();
 		// Close window
 		void Close();
+		// Make the OpenGL context current on the calling thread
+		void MakeContextCurrent();
+		// Release the OpenGL context from the calling thread (so another thread can make it current)
+		void DetachContext();
 	public:
 		// Set title for window
 		void SetTitle(const std::string& title);
@@ -1,8 +1,24 @@
 #include <stb/stb_image.h>
+#include <atomic>
 #include <fstream>
 #include <sstream>
+#include <utility>
 #include <LEO/Log/Log.h>
 #include "LeoFileUtilities.h"
+#include "LeoImageUtilities.h"
+#include "LeoThreadPool.h"
+#include "LeoTimer.h"
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
 
 
 namespace leo
@@ -26,47 +42,123 @@ namespace leo
         return (std::string::npos == pos) ? "" : filepath.substr(0, pos);
     }
 
-    ImageData ReadImageData(const std::string& filepath)
+    // Decoded with the channels of the file and without stb's flip (its flag is global state), then expanded
+    // to RGBA8 and flipped here: each row is written where it goes, the flip costs no extra pass
+    ImageData DecodeImageData(std::span<const u8> file)
     {
         ImageData image_data;
+        if (file.empty() || file.size() > (u64)INT32_MAX) return image_data;
+
+        // stb's JPEG color conversion writes RGBA itself (with SIMD), the other formats are kept as stored,
+        // the conversion stb does for them is a per pixel switch
+        const bool jpeg = file.size() >= 2 && file[0] == 0xFF && file[1] == 0xD8;
+
+        int width, height, channels;
+        u8* raw = stbi_load_from_memory(file.data(), (int)file.size(), &width, &height, &channels, jpeg ? 4 : 0);
+        if (raw == nullptr) return image_data;
+        if (jpeg) channels = 4;
+
+        const u64 row_pixels = (u64)width;
+        if (channels == 4)
+        {
+            FlipRowsVertically(raw, row_pixels * 4, (u32)height);
+            image_data.data.reset(raw);
+        }
+        else
+        {
+            // freed by stbi_image_free (ImageDataDeleter), our stb allocates with new[]
+            u8* rgba = reinterpret_cast<u8*>(new char[row_pixels * height * 4]);
+            for (i32 y = 0; y < height; y++)
+            {
+                ExpandToRGBA8(raw + y * row_pixels * channels, (u32)channels, rgba + (height - 1 - y) * row_pixels * 4, row_pixels);
+            }
+            stbi_image_free(raw);
+            image_data.data.reset(rgba);
+        }
+
+        image_data.width = width;
+        image_data.height = height;
+        image_data.bpp = 4;
 
-        stbi_set_flip_vertically_on_load(1);
+        return image_data;
+    }
 
-        int width, height, bpp;
-        u8* raw = stbi_load(filepath.c_str(), &width, &height, &bpp, 4);
+    ImageData ReadImageData(const std::string& filepath)
+    {
+        MappedFile file(filepath);
+        ImageData image_data = DecodeImageData(file.Bytes());
 
-        if (raw == nullptr)
+        if (image_data.data == nullptr)
         {
             LEOLOGERROR("Failed to read image data From: {}", filepath);
+            return FallbackImageData();
+        }
 
-            // Fallback 2x2 magenta checker
-            const u8 fallback[16] = {
-                255,   0, 255, 255,   0,   0,   0, 255,
-                  0,   0,   0, 255, 255,   0, 255, 255
-            };
+        return image_data;
+    }
+
+    std::vector<ImageData> ReadImageDataBatch(std::span<const std::string> filepaths, ThreadPool* pool, ImageBatchStats* stats)
+    {
+        Timer timer;
+        const u32 count = (u32)filepaths.size();
+        std::vector<ImageData> images(count);
+
+        std::atomic<u32> next = 0;
+        std::atomic<u32> failed = 0;
+        std::atomic<u64> file_bytes = 0;
+        std::atomic<u64> pixels = 0;
 
-            u8* fallbackHeap = static_cast<u8*>(std::malloc(16));
-            if (!fallbackHeap)
+        // the files take very different times, each range takes the next file when it is done with one
+        auto decode = [&](u32, u32) {
+            for (u32 i = next.fetch_add(1); i < count; i = next.fetch_add(1))
             {
-                LEOLOGERROR("Fallback allocation failed for image: {}", filepath);
-                return image_data; // empty image
-            }
+                MappedFile file(filepaths[i]);
+                images[i] = DecodeImageData(file.Bytes());
+                file_bytes += file.Bytes().size();
 
-            std::memcpy(fallbackHeap, fallback, 16);
+                if (images[i].data == nullptr)
+                {
+                    LEOLOGERROR("Failed to read image data From: {}", filepaths[i]);
+                    images[i] = FallbackImageData();
+                    failed++;
+                }
+                pixels += (u64)images[i].width * images[i].height;
+            }
+        };
 
-            image_data.width = 2;
-            image_data.height = 2;
-            image_data.bpp = 4;
-            image_data.data.reset(fallbackHeap);
+        if (pool != nullptr) pool->ParallelFor(count, 1, decode);
+        else decode(0, count);
 
-            return image_data;
+        if (stats != nullptr)
+        {
+            stats->images = count;
+            stats->failed = failed;
+            stats->fileBytes = file_bytes;
+            stats->pixels = pixels;
+            stats->ms = timer.ElapsedMillis();
         }
 
-        image_data.width = width;
-        image_data.height = height;
-        image_data.bpp = 4;
+        return images;
+    }
+
+    ImageData FallbackImageData()
+    {
+        ImageData image_data;
 
-        image_data.data.reset(raw);
+        // Fallback 2x2 magenta checker
+        const u8 fallback[16] = {
+            255,   0, 255, 255,   0,   0,   0, 255,
+              0,   0,   0, 255, 255,   0, 255, 255
+        };
+
+        // freed by stbi_image_free (ImageDataDeleter), our stb allocates with new[]
+        u8* fallbackHeap = reinterpret_cast<u8*>(new char[16]);
+        std::memcpy(fallbackHeap, fallback, 16);
+
+        image_data.width = 2;
+        image_data.height = 2;
+        image_data.bpp = 4;
+        image_data.data.reset(fallbackHeap);
 
         return image_data;
     }
@@ -77,4 +169,108 @@ namespace leo
             stbi_image_free(ptr);
         }
     }
+
+    // ---------------- MappedFile ----------------
+
+    MappedFile::MappedFile(const std::string& filepath)
+    {
+        Open(filepath);
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        :
+        m_data(std::exchange(other.m_data, nullptr)),
+        m_size(std::exchange(other.m_size, 0)),
+        m_mapping(std::exchange(other.m_mapping, nullptr))
+    {}
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Close();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_mapping = std::exchange(other.m_mapping, nullptr);
+        }
+        return *this;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        Close();
+    }
+
+#ifdef _WIN32
+    bool MappedFile::Open(const std::string& filepath)
+    {
+        Close();
+
+        HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER size = {};
+        HANDLE mapping = nullptr;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        }
+        CloseHandle(file); // the mapping keeps the file open
+
+        if (mapping == nullptr) return false;
+
+        const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == nullptr)
+        {
+            CloseHandle(mapping);
+            return false;
+        }
+
+        m_data = static_cast<const u8*>(view);
+        m_size = (u64)size.QuadPart;
+        m_mapping = mapping;
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (m_data != nullptr) UnmapViewOfFile(m_data);
+        if (m_mapping != nullptr) CloseHandle(m_mapping);
+
+        m_data = nullptr;
+        m_size = 0;
+        m_mapping = nullptr;
+    }
+#else
+    bool MappedFile::Open(const std::string& filepath)
+    {
+        Close();
+
+        int file = open(filepath.c_str(), O_RDONLY);
+        if (file < 0) return false;
+
+        struct stat info = {};
+        void* view = MAP_FAILED;
+        if (fstat(file, &info) == 0 && info.st_size > 0) {
+            view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        }
+        close(file); // the mapping keeps the file open
+
+        if (view == MAP_FAILED) return false;
+
+        // read once front to back, the OS can read ahead
+        madvise(view, (size_t)info.st_size, MADV_SEQUENTIAL);
+
+        m_data = static_cast<const u8*>(view);
+        m_size = (u64)info.st_size;
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (m_data != nullptr) munmap(const_cast<u8*>(m_data), (size_t)m_size);
+
+        m_data = nullptr;
+        m_size = 0;
+    }
+#endif
 }
\ No newline at end of file
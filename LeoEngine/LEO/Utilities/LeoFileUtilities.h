@@ -1,10 +1,14 @@
 #pragma once
 #include <string>
 #include <memory>
+#include <span>
+#include <vector>
 #include "LeoTypes.h"
 
 namespace leo
 {
+	class ThreadPool;
+
 	std::string ReadFile(const std::string& filepath);
 
 	std::string DirNameOf(const std::string& filepath);
@@ -31,5 +35,60 @@ namespace leo
 		std::unique_ptr<u8, ImageDataDeleter> data;
 	};
 
+	// RGBA8, flipped for OpenGL. A file that can't be read is logged and gives FallbackImageData()
 	ImageData ReadImageData(const std::string& filepath);
+
+	// 2x2 magenta and black checker, RGBA8
+	ImageData FallbackImageData();
+
+	// The decoding of ReadImageData from the bytes of a file, an empty ImageData (no data) when it fails
+	ImageData DecodeImageData(std::span<const u8> file);
+
+	struct ImageBatchStats
+	{
+		u32 images    = 0;
+		u32 failed    = 0; // given the fallback
+		u64 fileBytes = 0; // encoded
+		u64 pixels    = 0;
+		f32 ms        = 0.0f;
+
+		f32 MBPerSecond() const { return ms > 0.0f ? (f32)((f64)fileBytes / (1024.0 * 1024.0) / (ms / 1000.0f)) : 0.0f; }
+		f32 MegapixelsPerSecond() const { return ms > 0.0f ? (f32)((f64)pixels / 1e6 / (ms / 1000.0f)) : 0.0f; }
+	};
+
+	/// <summary>
+	/// ReadImageData over many files at once, the files are decoded concurrently over the ThreadPool
+	/// (nullptr: one after the other on the calling thread). The images are in the order of the paths.
+	/// </summary>
+	std::vector<ImageData> ReadImageDataBatch(std::span<const std::string> filepaths, ThreadPool* pool = nullptr, ImageBatchStats* stats = nullptr);
+
+	/// <summary>
+	/// Read only memory mapping of a whole file: the pages are read by the OS when they are first touched,
+	/// nothing is copied to the heap. The bytes stay valid until the MappedFile is closed or destroyed.
+	/// </summary>
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		explicit MappedFile(const std::string& filepath);
+
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		~MappedFile();
+	public:
+		// False when the file is missing or empty
+		bool Open(const std::string& filepath);
+		void Close();
+
+		inline bool IsOpen() const { return m_data != nullptr; }
+		inline std::span<const u8> Bytes() const { return { m_data, m_size }; }
+	private:
+		const u8* m_data = nullptr;
+		u64 m_size = 0;
+		void* m_mapping = nullptr; // the file mapping handle on Windows
+	};
 }
\ No newline at end of file
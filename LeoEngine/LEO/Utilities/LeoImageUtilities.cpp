@@ -0,0 +1,336 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <LEO/Log/LeoAssert.h>
+#include "LeoImageUtilities.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define LEO_IMAGE_X86 1
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#endif
+#else
+	#define LEO_IMAGE_X86 0
+#endif
+
+// SSE2 is part of x86-64, the row swap and the mip filter need nothing more
+#if LEO_IMAGE_X86 && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define LEO_IMAGE_SSE2 1
+#else
+	#define LEO_IMAGE_SSE2 0
+#endif
+
+// MSVC compiles SSSE3 intrinsics without /arch, gcc and clang need the target on the function
+#if LEO_IMAGE_X86 && (defined(__GNUC__) || defined(__clang__))
+	#define LEO_TARGET_SSSE3 __attribute__((target("ssse3")))
+#else
+	#define LEO_TARGET_SSSE3
+#endif
+
+namespace leo
+{
+	static bool DetectSSSE3()
+	{
+#if LEO_IMAGE_X86 && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+		return (info[2] & (1 << 9)) != 0;
+#elif LEO_IMAGE_X86
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("ssse3");
+#else
+		return false;
+#endif
+	}
+
+	bool HasSSSE3()
+	{
+		static const bool s_ssse3 = DetectSSSE3();
+		return s_ssse3;
+	}
+
+	// ---------------- Expansion ----------------
+
+	static void ExpandScalar(const u8* src, u32 channels, u8* dst, u64 count)
+	{
+		for (u64 i = 0; i < count; i++)
+		{
+			const u8* in = src + i * channels;
+			u8* out = dst + i * 4;
+			switch (channels)
+			{
+			case 1: out[0] = in[0]; out[1] = in[0]; out[2] = in[0]; out[3] = 255;   break;
+			case 2: out[0] = in[0]; out[1] = in[0]; out[2] = in[0]; out[3] = in[1]; break;
+			case 3: out[0] = in[0]; out[1] = in[1]; out[2] = in[2]; out[3] = 255;   break;
+			}
+		}
+	}
+
+#if LEO_IMAGE_X86
+	// the whole blocks, returns how many pixels were done (the rest is left to ExpandScalar)
+	LEO_TARGET_SSSE3 static u64 ExpandSSSE3(const u8* src, u32 channels, u8* dst, u64 count)
+	{
+		const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+		u64 i = 0;
+
+		switch (channels)
+		{
+		case 1: // 16 gray pixels per load, -1 lanes are zeroed by pshufb and filled by the alpha
+		{
+			const __m128i m0 = _mm_setr_epi8(0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1);
+			const __m128i m1 = _mm_setr_epi8(4, 4, 4, -1, 5, 5, 5, -1, 6, 6, 6, -1, 7, 7, 7, -1);
+			const __m128i m2 = _mm_setr_epi8(8, 8, 8, -1, 9, 9, 9, -1, 10, 10, 10, -1, 11, 11, 11, -1);
+			const __m128i m3 = _mm_setr_epi8(12, 12, 12, -1, 13, 13, 13, -1, 14, 14, 14, -1, 15, 15, 15, -1);
+			for (; i + 16 <= count; i += 16)
+			{
+				__m128i gray = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+				__m128i* out = reinterpret_cast<__m128i*>(dst + i * 4);
+				_mm_storeu_si128(out + 0, _mm_or_si128(_mm_shuffle_epi8(gray, m0), alpha));
+				_mm_storeu_si128(out + 1, _mm_or_si128(_mm_shuffle_epi8(gray, m1), alpha));
+				_mm_storeu_si128(out + 2, _mm_or_si128(_mm_shuffle_epi8(gray, m2), alpha));
+				_mm_storeu_si128(out + 3, _mm_or_si128(_mm_shuffle_epi8(gray, m3), alpha));
+			}
+			break;
+		}
+		case 2: // 8 gray and alpha pixels per load
+		{
+			const __m128i m0 = _mm_setr_epi8(0, 0, 0, 1, 2, 2, 2, 3, 4, 4, 4, 5, 6, 6, 6, 7);
+			const __m128i m1 = _mm_setr_epi8(8, 8, 8, 9, 10, 10, 10, 11, 12, 12, 12, 13, 14, 14, 14, 15);
+			for (; i + 8 <= count; i += 8)
+			{
+				__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+				__m128i* out = reinterpret_cast<__m128i*>(dst + i * 4);
+				_mm_storeu_si128(out + 0, _mm_shuffle_epi8(pixels, m0));
+				_mm_storeu_si128(out + 1, _mm_shuffle_epi8(pixels, m1));
+			}
+			break;
+		}
+		case 3: // 4 RGB pixels (12 of the 16 bytes) per load, the last load of a block reads 4 bytes past it
+		{
+			const __m128i mask = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+			for (; i + 18 <= count; i += 16)
+			{
+				const u8* in = src + i * 3;
+				__m128i* out = reinterpret_cast<__m128i*>(dst + i * 4);
+				_mm_storeu_si128(out + 0, _mm_or_si128(_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 0)), mask), alpha));
+				_mm_storeu_si128(out + 1, _mm_or_si128(_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 12)), mask), alpha));
+				_mm_storeu_si128(out + 2, _mm_or_si128(_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 24)), mask), alpha));
+				_mm_storeu_si128(out + 3, _mm_or_si128(_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 36)), mask), alpha));
+			}
+			break;
+		}
+		}
+
+		return i;
+	}
+#endif
+
+	void ExpandToRGBA8(const u8* src, u32 channels, u8* dst, u64 count)
+	{
+		LEOASSERTF(channels >= 1 && channels <= 4, "{} channels, images have 1 to 4", channels);
+
+		if (channels == 4)
+		{
+			std::memcpy(dst, src, count * 4);
+			return;
+		}
+
+		u64 done = 0;
+#if LEO_IMAGE_X86
+		if (HasSSSE3()) done = ExpandSSSE3(src, channels, dst, count);
+#endif
+		ExpandScalar(src + done * channels, channels, dst + done * 4, count - done);
+	}
+
+	// ---------------- Flip ----------------
+
+	void FlipRowsVertically(u8* pixels, u64 row_bytes, u32 rows)
+	{
+		for (u32 y = 0; y < rows / 2; y++)
+		{
+			u8* top = pixels + (u64)y * row_bytes;
+			u8* bottom = pixels + (u64)(rows - 1 - y) * row_bytes;
+
+			u64 x = 0;
+#if LEO_IMAGE_SSE2
+			for (; x + 16 <= row_bytes; x += 16)
+			{
+				__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + x));
+				__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + x));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(top + x), b);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(bottom + x), a);
+			}
+#endif
+			std::swap_ranges(top + x, top + row_bytes, bottom + x);
+		}
+	}
+
+	// ---------------- Mip chain ----------------
+
+	u32 MipLevelCount(u32 width, u32 height)
+	{
+		return (u32)std::bit_width(std::max(std::max(width, height), 1u));
+	}
+
+	// 2^14 steps of linear intensity, the encoded byte is within one of the exact encoding (the dark end is the steepest)
+	constexpr u32 SRGB_ENCODE_STEPS = 1 << 14;
+
+	struct SrgbTables
+	{
+		f32 decode[256];
+		u8 encode[SRGB_ENCODE_STEPS];
+
+		SrgbTables()
+		{
+			for (u32 i = 0; i < 256; i++)
+			{
+				f64 c = i / 255.0;
+				decode[i] = (f32)(c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+			}
+			for (u32 i = 0; i < SRGB_ENCODE_STEPS; i++)
+			{
+				f64 l = i / (f64)(SRGB_ENCODE_STEPS - 1);
+				f64 c = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+				encode[i] = (u8)(c * 255.0 + 0.5);
+			}
+		}
+	};
+
+	static const SrgbTables& GetSrgbTables()
+	{
+		static const SrgbTables s_tables;
+		return s_tables;
+	}
+
+	// one RGBA pixel in linear space
+#if LEO_IMAGE_SSE2
+	using LinearPixel = __m128;
+
+	static inline LinearPixel Pixel(f32 r, f32 g, f32 b, f32 a) { return _mm_setr_ps(r, g, b, a); }
+	static inline LinearPixel LoadPixel(const f32* p) { return _mm_loadu_ps(p); }
+	static inline void StorePixel(f32* p, LinearPixel v) { _mm_storeu_ps(p, v); }
+	static inline LinearPixel Average(LinearPixel a, LinearPixel b, LinearPixel c, LinearPixel d)
+	{
+		return _mm_mul_ps(_mm_add_ps(_mm_add_ps(a, b), _mm_add_ps(c, d)), _mm_set1_ps(0.25f));
+	}
+#else
+	struct LinearPixel { f32 v[4]; };
+
+	static inline LinearPixel Pixel(f32 r, f32 g, f32 b, f32 a) { return LinearPixel{ { r, g, b, a } }; }
+	static inline LinearPixel LoadPixel(const f32* p) { return LinearPixel{ { p[0], p[1], p[2], p[3] } }; }
+	static inline void StorePixel(f32* p, LinearPixel v) { std::memcpy(p, v.v, sizeof(v.v)); }
+	static inline LinearPixel Average(LinearPixel a, LinearPixel b, LinearPixel c, LinearPixel d)
+	{
+		LinearPixel r;
+		for (int i = 0; i < 4; i++) r.v[i] = (a.v[i] + b.v[i] + c.v[i] + d.v[i]) * 0.25f;
+		return r;
+	}
+#endif
+
+	// level 0 is read as bytes (decode is nullptr for linear data), the next ones from the f32 level above
+	static inline LinearPixel LoadLinear(const u8* p, const f32* decode)
+	{
+		constexpr f32 unorm = 1.0f / 255.0f;
+		if (decode == nullptr) return Pixel(p[0] * unorm, p[1] * unorm, p[2] * unorm, p[3] * unorm);
+		return Pixel(decode[p[0]], decode[p[1]], decode[p[2]], p[3] * unorm);
+	}
+
+	static inline LinearPixel LoadLinear(const f32* p, const f32*) { return LoadPixel(p); }
+
+	template<typename T>
+	static void Downsample(const T* src, u32 src_width, u32 src_height, f32* dst, u32 dst_width, u32 dst_height, const f32* decode)
+	{
+		for (u32 y = 0; y < dst_height; y++)
+		{
+			const T* row0 = src + (u64)std::min(2 * y, src_height - 1) * src_width * 4;
+			const T* row1 = src + (u64)std::min(2 * y + 1, src_height - 1) * src_width * 4;
+			f32* out = dst + (u64)y * dst_width * 4;
+
+			// dst_width is src_width / 2, the right pixel only falls outside a 1 pixel wide level
+			const u32 right = src_width > 1 ? 4 : 0;
+			for (u32 x = 0; x < dst_width; x++)
+			{
+				const u32 x0 = x * 8;
+				StorePixel(out + x * 4, Average(
+					LoadLinear(row0 + x0, decode), LoadLinear(row0 + x0 + right, decode),
+					LoadLinear(row1 + x0, decode), LoadLinear(row1 + x0 + right, decode)));
+			}
+		}
+	}
+
+	static void EncodeLevel(const f32* src, u64 count, u8* dst, const u8* encode)
+	{
+		// colors index the sRGB table (or are scaled to bytes for linear data), alpha is always scaled to bytes
+		const f32 color_scale = encode != nullptr ? (f32)(SRGB_ENCODE_STEPS - 1) : 255.0f;
+#if LEO_IMAGE_SSE2
+		const __m128 scale = _mm_setr_ps(color_scale, color_scale, color_scale, 255.0f);
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		alignas(16) i32 lanes[4];
+#endif
+		for (u64 i = 0; i < count; i++)
+		{
+#if LEO_IMAGE_SSE2
+			__m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i * 4), zero), one);
+			_mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half)));
+#else
+			i32 lanes[4];
+			for (int c = 0; c < 4; c++)
+			{
+				f32 v = std::clamp(src[i * 4 + c], 0.0f, 1.0f);
+				lanes[c] = (i32)(v * (c < 3 ? color_scale : 255.0f) + 0.5f);
+			}
+#endif
+			u8* out = dst + i * 4;
+			if (encode != nullptr)
+			{
+				out[0] = encode[lanes[0]];
+				out[1] = encode[lanes[1]];
+				out[2] = encode[lanes[2]];
+			}
+			else
+			{
+				out[0] = (u8)lanes[0];
+				out[1] = (u8)lanes[1];
+				out[2] = (u8)lanes[2];
+			}
+			out[3] = (u8)lanes[3];
+		}
+	}
+
+	std::vector<std::vector<u8>> GenerateMipChain(const u8* rgba, u32 width, u32 height, bool srgb)
+	{
+		const SrgbTables* tables = srgb ? &GetSrgbTables() : nullptr;
+		const f32* decode = tables != nullptr ? tables->decode : nullptr;
+		const u8* encode = tables != nullptr ? tables->encode : nullptr;
+
+		const u32 level_count = MipLevelCount(width, height);
+		std::vector<std::vector<u8>> levels(level_count > 0 ? level_count - 1 : 0);
+
+		// level 1 is the largest, both buffers are allocated once and not cleared
+		const u64 largest = level_count > 1 ? (u64)MipLevelSize(width, 1) * MipLevelSize(height, 1) * 4 : 0;
+		std::unique_ptr<f32[]> above(new f32[largest]);
+		std::unique_ptr<f32[]> current(new f32[largest]);
+
+		for (u32 level = 1; level < level_count; level++)
+		{
+			const u32 src_width = MipLevelSize(width, level - 1), src_height = MipLevelSize(height, level - 1);
+			const u32 dst_width = MipLevelSize(width, level), dst_height = MipLevelSize(height, level);
+
+			if (level == 1) Downsample(rgba, src_width, src_height, current.get(), dst_width, dst_height, decode);
+			else Downsample(above.get(), src_width, src_height, current.get(), dst_width, dst_height, decode);
+
+			std::vector<u8>& bytes = levels[level - 1];
+			bytes.resize((u64)dst_width * dst_height * 4);
+			EncodeLevel(current.get(), (u64)dst_width * dst_height, bytes.data(), encode);
+
+			std::swap(above, current);
+		}
+
+		return levels;
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+#include "LeoTypes.h"
+
+namespace leo
+{
+	// Checked once, the CPU must support SSSE3 (pshufb) for the SIMD expansion
+	bool HasSSSE3();
+
+	/// <summary>
+	/// Converts count pixels of 1 to 4 channels (gray, gray and alpha, RGB, RGBA) to RGBA8, the missing alpha is 255.
+	/// 16 pixels at a time with SSSE3 shuffles when the CPU has it. src and dst must not overlap.
+	/// </summary>
+	void ExpandToRGBA8(const u8* src, u32 channels, u8* dst, u64 count);
+
+	// Swaps the rows top to bottom in place (OpenGL wants the bottom row first), 16 bytes at a time
+	void FlipRowsVertically(u8* pixels, u64 row_bytes, u32 rows);
+
+	// Levels of a full mip chain, down to 1x1
+	u32 MipLevelCount(u32 width, u32 height);
+
+	// Width or height of a level, halved per level and at least 1
+	inline u32 MipLevelSize(u32 size, u32 level) { return (size >> level) > 0 ? (size >> level) : 1; }
+
+	/// <summary>
+	/// Levels 1 to MipLevelCount() - 1 of an RGBA8 image, each a 2x2 box filter of the one above (odd sizes drop
+	/// the last row or column). With srgb the colors are averaged in linear space and encoded back,
+	/// alpha is always linear. The levels are kept in f32 between steps, one pixel per SSE register, so the
+	/// rounding does not add up down the chain.
+	/// </summary>
+	std::vector<std::vector<u8>> GenerateMipChain(const u8* rgba, u32 width, u32 height, bool srgb = true);
+}
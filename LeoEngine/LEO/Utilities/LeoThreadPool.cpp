@@ -0,0 +1,110 @@
+#include <LEO/Log/LeoAssert.h>
+#include "LeoThreadPool.h"
+
+namespace leo
+{
+	ThreadPool::ThreadPool(u32 threadCount)
+	{
+		LEOASSERT(threadCount > 0, "ThreadPool needs at least one worker thread");
+
+		m_workers.reserve(threadCount);
+		for (u32 i = 0; i < threadCount; i++)
+		{
+			m_workers.emplace_back([this]() { WorkerLoop(); });
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_jobAvailable.notify_all();
+
+		for (std::thread& worker : m_workers)
+		{
+			worker.join();
+		}
+	}
+
+	std::future<void> ThreadPool::Submit(std::function<void()> job)
+	{
+		std::packaged_task<void()> task(std::move(job));
+		std::future<void> future = task.get_future();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_jobs.emplace_back(std::move(task));
+		}
+		m_jobAvailable.notify_one();
+
+		return future;
+	}
+
+	void ThreadPool::WaitIdle()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_idle.wait(lock, [this]() { return m_jobs.empty() && m_busy == 0; });
+	}
+
+	u32 ThreadPool::DefaultThreadCount()
+	{
+		u32 hw = std::thread::hardware_concurrency();
+		return hw > 1 ? hw - 1 : 1;
+	}
+
+	void ThreadPool::WorkerLoop()
+	{
+		while (true)
+		{
+			std::packaged_task<void()> task;
+
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_jobAvailable.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+
+				// on stop we still drain the queue, so no future is left hanging
+				if (m_jobs.empty()) {
+					return;
+				}
+
+				task = std::move(m_jobs.front());
+				m_jobs.pop_front();
+				m_busy++;
+			}
+
+			RunJob(task);
+		}
+	}
+
+	bool ThreadPool::RunPendingJob()
+	{
+		std::packaged_task<void()> task;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_jobs.empty()) {
+				return false;
+			}
+
+			task = std::move(m_jobs.front());
+			m_jobs.pop_front();
+			m_busy++;
+		}
+
+		RunJob(task);
+		return true;
+	}
+
+	void ThreadPool::RunJob(std::packaged_task<void()>& task)
+	{
+		task();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_busy--;
+		if (m_jobs.empty() && m_busy == 0) {
+			m_idle.notify_all();
+		}
+	}
+}
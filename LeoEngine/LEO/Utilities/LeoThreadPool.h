@@ -0,0 +1,93 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include "LeoTypes.h"
+
+namespace leo
+{
+	/// <summary>
+	/// LeoEngine ThreadPool
+	/// a fixed number of worker threads consuming a FIFO job queue
+	/// </summary>
+	class ThreadPool final
+	{
+	public:
+		explicit ThreadPool(u32 threadCount = DefaultThreadCount());
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		~ThreadPool(); // waits for the queued jobs to finish
+	public:
+		// Queues a job, the returned future becomes ready when the job has run
+		std::future<void> Submit(std::function<void()> job);
+
+		// Blocks until the queue is empty and every worker is idle
+		void WaitIdle();
+
+		/// <summary>
+		/// Calls func(begin, end) over [0, count) split in ThreadCount() + 1 contiguous ranges,
+		/// the calling thread runs the last range. Returns when every range is done.
+		/// The split only depends on count and ThreadCount(), so the work given to each range is deterministic.
+		/// It may be called from several threads at once and from inside a job: a caller waiting for its ranges
+		/// runs the queued jobs meanwhile, so a nested call never blocks the workers its ranges need.
+		/// </summary>
+		template<typename Func>
+		void ParallelFor(u32 count, u32 min_range, Func&& func)
+		{
+			if (count == 0) return;
+
+			u32 ranges = std::min(ThreadCount() + 1, std::max(1u, count / std::max(1u, min_range)));
+			u32 range_size = (count + ranges - 1) / ranges;
+
+			std::vector<std::future<void>> futures;
+			futures.reserve(ranges - 1);
+			for (u32 begin = 0; begin + range_size < count; begin += range_size)
+			{
+				u32 end = begin + range_size;
+				futures.emplace_back(Submit([&func, begin, end]() { func(begin, end); }));
+			}
+
+			u32 last_begin = (u32)futures.size() * range_size;
+			func(last_begin, count);
+
+			for (std::future<void>& future : futures)
+			{
+				while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+				{
+					// an empty queue means the range is running on another thread
+					if (!RunPendingJob()) future.wait();
+				}
+				future.get();
+			}
+		}
+
+		inline u32 ThreadCount() const { return (u32)m_workers.size(); }
+
+		// hardware threads - 1 (the caller thread is expected to work too), at least 1
+		static u32 DefaultThreadCount();
+	private:
+		void WorkerLoop();
+
+		// Runs the next queued job on the calling thread, false when the queue is empty
+		bool RunPendingJob();
+		void RunJob(std::packaged_task<void()>& task); // a job taken off the queue, counted as busy
+	private:
+		std::vector<std::thread> m_workers;
+		std::deque<std::packaged_task<void()>> m_jobs;
+
+		std::mutex m_mutex;
+		std::condition_variable m_jobAvailable;
+		std::condition_variable m_idle;
+
+		u32 m_busy = 0;
+		bool m_stop = false;
+	};
+}
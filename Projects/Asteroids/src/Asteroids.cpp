@@ -7,6 +7,12 @@
 #define PLAYER_ROT_SPEED glm::radians(60.0f)
 #define PLAYER_MAX_SPEED 150.0f
 
+#define ASTEROID_SIZE 15.0f
+#define ASTEROID_MAX_SPEED 80.0f
+
+#define WINDOW_WIDTH 1600.0f
+#define WINDOW_HEIGHT 900.0f
+
 #define MAX_ENTITIES 500
 
 Game::Game()
@@ -21,6 +27,7 @@ Game::Game()
 	m_entityManager.RegisterDenseStore<Sphere, MAX_ENTITIES>();
 	m_entityManager.RegisterDenseStore<HitPoints, MAX_ENTITIES>();
 	m_entityManager.RegisterDenseStore<Polygon, MAX_ENTITIES>();
+	m_entityManager.RegisterDenseStore<WorldPolygon, MAX_ENTITIES>();
 
 	m_player_id = m_entityManager.CreateEntity();
 	m_entityManager.Update(0.0f);
@@ -34,6 +41,12 @@ Game::Game()
 
 	m_entityManager.AddComponent<Transform>(m_player_id, {{800, 300}, 0.0f});
 	m_entityManager.AddComponent<Polygon>(m_player_id, player_poly);
+	m_entityManager.AddComponent<WorldPolygon>(m_player_id, {});
+
+	for (u32 i = 0; i < 8; i++)
+	{
+		SpawnAsteroid(glm::vec2(100.0f + 180.0f * i, i % 2 == 0 ? 150.0f : 750.0f), 1 + i % 3);
+	}
 	m_entityManager.Update(0.0f);
 }
 
@@ -42,6 +55,27 @@ Game::~Game()
 
 }
 
+void Game::SpawnAsteroid(const glm::vec2 pos, u32 size)
+{
+	LEO::entity_id id = m_entityManager.CreateEntity();
+	const f32 radius = ASTEROID_SIZE * size;
+
+	// jagged and concave in places, the SAT narrow phase uses its convex hull
+	Polygon poly = GenerateRandomPolygon(10, radius * 0.7f, radius);
+
+	const f32 angle = LEO::RandFloat(0.0f, glm::two_pi<f32>());
+	Velocity velocity;
+	velocity.velocity = glm::vec2(glm::cos(angle), glm::sin(angle)) * LEO::RandFloat(0.2f, 1.0f) * ASTEROID_MAX_SPEED / (f32)size;
+	velocity.rotationSpeed = LEO::RandFloat(-1.0f, 1.0f);
+
+	m_entityManager.AddComponent<Transform>(id, {pos, 0.0f});
+	m_entityManager.AddComponent<Velocity>(id, velocity);
+	m_entityManager.AddComponent<Polygon>(id, poly);
+	m_entityManager.AddComponent<HitPoints>(id, {size});
+	// every WorldPolygon takes part in CollidePolygons(), asteroid pairs go through SAT like the player
+	m_entityManager.AddComponent<WorldPolygon>(id, {});
+}
+
 void Game::UpdateGame()
 {
 	// Build current input mask
@@ -55,16 +89,73 @@ void Game::UpdateGame()
 	Transform& player_t = *m_entityManager.GetComponent<Transform>(m_player_id);
 	ApplyMovementInput(input, player_t, 150.0f, 1.5f, LEO::DeltaTime());
 
+	m_entityManager.ForEach<Velocity>([&](LEO::entity_id id, Velocity& v)
+	{
+		Transform& t = *m_entityManager.GetComponent<Transform>(id);
+		UpdateTransform(t, v, LEO::DeltaTime());
+		BounceOffEdges(t, v, m_entityManager.GetComponent<Polygon>(id)->approximateRadius, WINDOW_WIDTH, WINDOW_HEIGHT);
+	});
+
+	UpdateWorldPolygons();
+	CollidePolygons();
+
 	m_entityManager.Update(LEO::DeltaTime());
+
+	// the update moved the entities again, rebuild the caches RenderGame() draws
+	UpdateWorldPolygons();
+}
+
+void Game::UpdateWorldPolygons()
+{
+	m_entityManager.ForEach<WorldPolygon>([&](LEO::entity_id id, WorldPolygon& world)
+	{
+		Transform* t = m_entityManager.GetComponent<Transform>(id);
+		Polygon* p = m_entityManager.GetComponent<Polygon>(id);
+		if (t && p)
+		{
+			UpdateWorldPolygon(*t, *p, world);
+		}
+	});
+}
+
+void Game::CollidePolygons()
+{
+	auto& store = *m_entityManager.GetComponentStore<WorldPolygon>();
+
+	for (auto itA = store.begin(); itA != store.end(); ++itA)
+	{
+		auto [idA, a] = *itA;
+		for (auto itB = itA.next(); itB != store.end(); ++itB)
+		{
+			auto [idB, b] = *itB;
+
+			LEO::ContactManifold manifold;
+			if (!CheckCollisionPolygon(a, b, manifold))
+				continue;
+
+			Transform& ta = *m_entityManager.GetComponent<Transform>(idA);
+			Transform& tb = *m_entityManager.GetComponent<Transform>(idB);
+			ResolveCollisionPolygon(manifold,
+				ta, m_entityManager.GetComponent<Velocity>(idA), a.boundingRadius,
+				tb, m_entityManager.GetComponent<Velocity>(idB), b.boundingRadius);
+
+			// the transforms moved, refresh the caches for the remaining pairs
+			Polygon& pa = *m_entityManager.GetComponent<Polygon>(idA);
+			Polygon& pb = *m_entityManager.GetComponent<Polygon>(idB);
+			UpdateWorldPolygon(ta, pa, a);
+			UpdateWorldPolygon(tb, pb, b);
+		}
+	}
 }
 
 void Game::RenderGame()
 {
-	m_entityManager.ForEach<Polygon>([&](LEO::entity_id id, Polygon& p)
+	// the WorldPolygon caches are up to date, UpdateGame() rebuilt the ones whose Transform changed after the update
+	m_entityManager.ForEach<WorldPolygon>([&](LEO::entity_id id, WorldPolygon& world)
 	{
-		if(Transform* t = m_entityManager.GetComponent<Transform>(id))
+		if (world.valid)
 		{
-			RenderPolygon(*t, p, LEO_RED);
+			RenderPolygon(world, LEO_RED);
 		}
 	});
 }
@@ -15,10 +15,13 @@ public:
 public:
 	void UpdateGame();
 	void RenderGame();
+private:
+	void UpdateWorldPolygons();
+	void CollidePolygons();
 private:
 	//void SpawnShip();
 	//void SpawnBullet(const glm::vec2 pos, const glm::vec2 dir);
-	//void SpawnAsteroid(const glm::vec2 pos, u32 size);
+	void SpawnAsteroid(const glm::vec2 pos, u32 size);
 private:
 	LEO::EntityManager m_entityManager;
 	LEO::entity_id m_player_id = 0;
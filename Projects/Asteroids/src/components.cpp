@@ -127,8 +127,14 @@ void ResolveCollisionSphere(glm::vec2& a_pos, glm::vec2& a_vel, f32 a_radius,
 	b_vel += (newVb - vb) * normal;
 }
 
-void RenderPolygon(const Transform& t, const Polygon& poly, LEO::Color color)
+bool UpdateWorldPolygon(const Transform& t, const Polygon& poly, WorldPolygon& world)
 {
+	if (world.valid && world.vertexCount == poly.vertexCount &&
+		world.builtFrom.position == t.position && world.builtFrom.rotation == t.rotation)
+	{
+		return false;
+	}
+
 	LEOASSERTF(poly.vertexCount >= 3u, "Polygon vertex count can't be less that three, {} provided", poly.vertexCount);
 
 	// Precompute rotation
@@ -136,15 +142,69 @@ void RenderPolygon(const Transform& t, const Polygon& poly, LEO::Color color)
 	float s = glm::sin(t.rotation);
 	glm::mat2 rot = { {c, -s}, {s, c} };
 
-	// Transform vertices once
-	std::array<glm::vec2, MAX_VERTICES> transformed;
+	f32 radius2 = 0.0f;
 	for (u32 i = 0; i < poly.vertexCount; i++) {
-		transformed[i] = t.position + rot * poly.baseShape[i];
+		world.vertices[i] = t.position + rot * poly.baseShape[i];
+		radius2 = glm::max(radius2, glm::length2(poly.baseShape[i]));
 	}
 
+	world.vertexCount    = poly.vertexCount;
+	world.hullCount      = LEO::ConvexHull(world.vertices, world.vertexCount, world.hull);
+	world.center         = t.position;
+	world.boundingRadius = glm::sqrt(radius2);
+	world.builtFrom      = t;
+	world.valid          = true;
+
+	return true;
+}
+
+bool CheckCollisionPolygon(const WorldPolygon& a, const WorldPolygon& b, LEO::ContactManifold& manifold)
+{
+	if (!CheckCollisionSphere(a.center, a.boundingRadius, b.center, b.boundingRadius))
+		return false;
+
+	return LEO::CollidePolygons(a.hull, a.hullCount, b.hull, b.hullCount, manifold);
+}
+
+void ResolveCollisionPolygon(const LEO::ContactManifold& manifold, 
+	                          Transform& a_t, Velocity* a_vel, f32 a_radius,
+	                          Transform& b_t, Velocity* b_vel, f32 b_radius)
+{
+	const glm::vec2& normal = manifold.normal;
+	float penetration = manifold.MaxDepth();
+
+	// Mass proportional to radius
+	float massA = a_radius;
+	float massB = b_radius;
+	float totalMass = massA + massB;
+	if (totalMass == 0.0f) return;
+
+	// Separate based on relative mass
+	a_t.position -= normal * (penetration * (massB / totalMass));
+	b_t.position += normal * (penetration * (massA / totalMass));
+
+	if (a_vel == nullptr || b_vel == nullptr) return;
+
+	// Velocity resolution (elastic collision along normal)
+	float va = glm::dot(a_vel->velocity, normal);
+	float vb = glm::dot(b_vel->velocity, normal);
+
+	if (va - vb <= 0.0f) return; // already separating
+
+	float newVa = (va * (massA - massB) + 2.0f * massB * vb) / totalMass;
+	float newVb = (vb * (massB - massA) + 2.0f * massA * va) / totalMass;
+
+	a_vel->velocity += (newVa - va) * normal;
+	b_vel->velocity += (newVb - vb) * normal;
+}
+
+void RenderPolygon(const WorldPolygon& world, LEO::Color color)
+{
+	LEOASSERTF(world.vertexCount >= 3u, "Polygon vertex count can't be less that three, {} provided", world.vertexCount);
+
 	// Draw as triangle fan
-	const glm::vec2& v0 = transformed[0];
-	for (u32 i = 1; i < poly.vertexCount - 1; i++) {
-		LEO::RenderTriangle(transformed[i + 1], transformed[i], v0, color);
+	const glm::vec2& v0 = world.vertices[0];
+	for (u32 i = 1; i < world.vertexCount - 1; i++) {
+		LEO::RenderTriangle(world.vertices[i + 1], world.vertices[i], v0, color);
 	}
 }
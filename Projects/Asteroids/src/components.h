@@ -58,6 +58,20 @@ struct Polygon
 	f32       approximateRadius          = 0.0f;
 };
 
+// World space vertices of a Polygon, shared by the collision and the rendering.
+// Rebuilt by UpdateWorldPolygon() only when the Transform it was built from changes.
+struct WorldPolygon
+{
+	glm::vec2 vertices[MAX_VERTICES]     = {}; // baseShape order, used for rendering
+	glm::vec2 hull[MAX_VERTICES]         = {}; // convex hull (counter-clockwise), used by the SAT narrow phase
+	u32       vertexCount                = 0;
+	u32       hullCount                  = 0;
+	glm::vec2 center                     = glm::vec2(0.0f, 0.0f);
+	f32       boundingRadius             = 0.0f; // exact, used by the circle pre-check
+	Transform builtFrom                  = {};
+	bool      valid                      = false;
+};
+
 
 void UpdateTransform(Transform& t, const Velocity& v, f32 dt);
 void BounceOffEdges(Transform& t, Velocity& v, f32 radius, f32 winW, f32 winH);
@@ -67,6 +81,26 @@ bool CheckCollisionSphere(const glm::vec2& a_pos, f32 a_radius, const glm::vec2&
 void ResolveCollisionSphere(glm::vec2& a_pos, glm::vec2& a_vel, f32 a_radius, 
 	                          glm::vec2& b_pos, glm::vec2& b_vel, f32 b_radius);
 
+/// <summary>
+/// Rebuilds the world space vertices of the polygon if the transform changed since the last build.
+/// Call InvalidateWorldPolygon() if the Polygon shape itself was modified.
+/// Returns true if the cache was rebuilt.
+/// </summary>
+bool UpdateWorldPolygon(const Transform& t, const Polygon& poly, WorldPolygon& world);
+inline void InvalidateWorldPolygon(WorldPolygon& world) { world.valid = false; }
+
+/// <summary>
+/// Circle pre-check on the bounding radius, then the exact SAT test on the convex hulls.
+/// On collision fills the manifold, the normal points from a to b.
+/// </summary>
+bool CheckCollisionPolygon(const WorldPolygon& a, const WorldPolygon& b, LEO::ContactManifold& manifold);
+
+// Separates the two bodies along the manifold normal (mass proportional to the bounding radius)
+// and reflects their velocities along it.
+void ResolveCollisionPolygon(const LEO::ContactManifold& manifold, 
+	                          Transform& a_t, Velocity* a_vel, f32 a_radius,
+	                          Transform& b_t, Velocity* b_vel, f32 b_radius);
+
 
 /// <summary>
 /// Generates a random polygon with the specified number of vertices.
@@ -84,10 +118,9 @@ Polygon GenerateRandomPolygon(u32 vertex_count, f32 vertex_dist_min, f32 vertex_
 
 /// <summary>
 /// Renders a polygon by triangulating it into a fan of triangles.
-/// Each vertex of the polygon is transformed by the given position and rotation,
-/// then passed to the rendering system. The polygon is drawn in the specified color.
+/// The world space vertices come from the WorldPolygon cache, so nothing is transformed here.
+/// The polygon is drawn in the specified color.
 /// </summary>
-/// <param name="t">Transform containing the position and rotation of the polygon.</param>
-/// <param name="poly">Polygon data containing vertices in local space.</param>
+/// <param name="world">The world space vertices of the polygon, see UpdateWorldPolygon.</param>
 /// <param name="color">Color used to render the polygon.</param>
-void RenderPolygon(const Transform& t, const Polygon& poly, LEO::Color color);
+void RenderPolygon(const WorldPolygon& world, LEO::Color color);
@@ -19,9 +19,9 @@ void SandBoxLayer::OnCreate()
 			20.0f, LEO::RandDir2D(150.0f), LEO::RandInt(20, 40) });
 	}
 
-    m_entityManager.RegisterSystem<MoveSystem>();
-	m_entityManager.RegisterSystem<CollisionSystem>();
-	m_entityManager.RegisterSystem<SpawnSystem>();
+    m_entityManager.RegisterSystem<MoveSystem>(&m_islands);
+	m_entityManager.RegisterSystem<CollisionSystem>(&m_islands);
+	m_entityManager.RegisterSystem<SpawnSystem>(&m_islands);
 	m_entityManager.RegisterSystem<RenderSystem>();
 }
 
@@ -32,6 +32,7 @@ void SandBoxLayer::OnUpdate()
     ImGui::Begin("Stress Test");
     ImGui::Text("FPS: %u", LEO::CurrentFPS());
     ImGui::Text("Sphere count exits: %u", m_entityManager.GetComponentStore<Particle>()->NumOfComponents());
+    ImGui::Text("Sleeping: %u (%u islands)", m_islands.SleepingBodyCount(), m_islands.SleepingIslandCount());
     ImGui::End();
 
 }
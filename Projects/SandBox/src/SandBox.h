@@ -9,6 +9,7 @@ public:
     virtual void OnUpdate() override;
 private:
     LEO::EntityManager m_entityManager;
+    LEO::SimulationIslands m_islands;
 };
 
 
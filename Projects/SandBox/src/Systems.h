@@ -16,12 +16,15 @@ static void DestroyEntity(LEO::EntityManager& entity_manager, LEO::entity_id id)
 class SpawnSystem : public LEO::ISystem
 {
 public:
+	SpawnSystem(LEO::SimulationIslands* islands) : m_islands(islands) {}
+
 	virtual void Update(f32 dt) override
 	{
 		p_entityManager->ForEach<Particle>([&](LEO::entity_id id, Particle& particle){
 			if (particle.hp <= 0) {
 				
                 p_entityManager->DestroyEntity(id);
+				m_islands->Remove(id);
 
 				if (particle.radius <= 5.0f) return;
 
@@ -31,14 +34,20 @@ public:
 			}
 		});
 	}
+private:
+	LEO::SimulationIslands* m_islands;
 };
 
 class MoveSystem : public LEO::ISystem
 {
 public:
+	MoveSystem(LEO::SimulationIslands* islands) : m_islands(islands) {}
+
 	virtual void Update(f32 dt) override
 	{
 		p_entityManager->ForEach<Particle>([&](LEO::entity_id id, Particle& particle){
+			if (m_islands->IsAsleep(id)) return;
+
 			particle.pos += particle.vel * dt;
 
 			const f32 r = particle.radius;
@@ -51,45 +60,120 @@ public:
 			if (particle.pos.y + r > winH) { particle.pos.y = winH - r;  particle.vel.y *= -1; }
 		});
 	}
+private:
+	LEO::SimulationIslands* m_islands;
 };
 
 class CollisionSystem : public LEO::ISystem
 {
 public:
+	CollisionSystem(LEO::SimulationIslands* islands) : m_islands(islands), m_solver(&m_pool), m_neighbors(64) {}
+
 	virtual void Update(f32 dt) override
 	{
-		auto& particle_store = *p_entityManager->GetComponentStore<Particle>();
+		m_ids.clear();
+		m_bodies.clear();
+		m_particles.clear();
+		m_contacts.clear();
+		m_bodyOf.resize(LEO::entity_id(-1) + 1);
+
+		// only the awake particles are simulated
+		p_entityManager->ForEach<Particle>([&](LEO::entity_id id, Particle& particle) {
+			if (!m_islands->Sync(id, particle.pos, particle.vel)) return;
 
-		for (auto itA = particle_store.begin(); itA != particle_store.end(); ++itA)
+			m_bodyOf[id] = (u32)m_bodies.size();
+			m_ids.push_back(id);
+			m_bodies.push_back(LEO::SolverBody{ particle.pos, particle.vel, 1.0f });
+			m_particles.push_back(&particle);
+		});
+
+		m_awakeQuery.Clear();
+		for (u32 i = 0; i < (u32)m_particles.size(); i++)
 		{
-			Particle& a = (*itA).comp;
-			for (auto itB = itA.next(); itB != particle_store.end(); ++itB)
-			{
-				Particle& b = (*itB).comp;
-
-				glm::vec2 delta = b.pos - a.pos;
-				float dist2 = glm::dot(delta, delta);
-				float r = a.radius + b.radius;
-
-				if (dist2 < r * r) // collision!
-				{
-					float dist = std::sqrt(dist2);
-					if (dist == 0.0f) dist = 0.01f; // avoid divide by zero
-					glm::vec2 normal = delta / dist;
-					// Push Particles apart by half the overlap each
-					float overlap = 0.5f * (r - dist);
-					a.pos -= normal * overlap;
-					b.pos += normal * overlap;
-					// Reflect velocities along the collision normal
-					a.vel = glm::reflect(a.vel, normal);
-					b.vel = glm::reflect(b.vel, -normal);
-					a.hp -= 1;
-					b.hp -= 1;
+			m_awakeQuery.Add((LEO::entity_id)m_ids[i], m_particles[i]->pos, m_particles[i]->radius);
+		}
+		m_awakeQuery.Build();
+
+		// the sleeping particles do not move, their tree only changes when one falls asleep or wakes up
+		if (m_sleepVersion != m_islands->SleepVersion())
+		{
+			m_sleepingQuery.Clear();
+			p_entityManager->ForEach<Particle>([&](LEO::entity_id id, Particle& particle) {
+				if (m_islands->IsAsleep(id)) {
+					m_sleepingQuery.Add(id, particle.pos, particle.radius);
 				}
+			});
+			m_sleepingQuery.Build();
+			m_sleepVersion = m_islands->SleepVersion();
+		}
+
+		for (u32 a = 0; a < (u32)m_particles.size(); a++)
+		{
+			const Particle& pa = *m_particles[a];
+
+			// an awake particle touching a sleeping one wakes its island, it joins the simulation next frame
+			u32 sleeping = QueryNeighbors(m_sleepingQuery, pa);
+			for (u32 i = 0; i < sleeping; i++)
+			{
+				m_islands->Wake(m_neighbors[i]);
+			}
+
+			u32 count = QueryNeighbors(m_awakeQuery, pa);
+			for (u32 i = 0; i < count; i++)
+			{
+				u32 b = m_bodyOf[m_neighbors[i]];
+				if (b <= a) continue; // each pair once
+
+				glm::vec2 delta = m_particles[b]->pos - pa.pos;
+				float dist = glm::length(delta);
+				float r = pa.radius + m_particles[b]->radius;
+
+				glm::vec2 normal = dist > 0.0f ? delta / dist : glm::vec2(1.0f, 0.0f);
+				m_contacts.push_back(LEO::Contact{ a, b, normal, r - dist });
+
+				m_particles[a]->hp -= 1;
+				m_particles[b]->hp -= 1;
 			}
 		}
-	}	
 
+		m_solver.Solve(m_bodies, m_contacts, m_settings);
+		m_islands->Update(m_ids, m_bodies, m_contacts);
+
+		for (u32 i = 0; i < (u32)m_particles.size(); i++)
+		{
+			m_particles[i]->pos = m_bodies[i].position;
+			m_particles[i]->vel = m_bodies[i].velocity;
+		}
+	}
+
+private:
+	// The particles overlapping p, in m_neighbors. The query returns the full count, a crowded spot grows the buffer
+	u32 QueryNeighbors(const LEO::SpatialQuery& query, const Particle& p)
+	{
+		u32 count = query.QueryRadius(p.pos, p.radius, m_neighbors);
+		if (count > m_neighbors.size())
+		{
+			m_neighbors.resize(count);
+			count = query.QueryRadius(p.pos, p.radius, m_neighbors);
+		}
+		return count;
+	}
+private:
+	LEO::SimulationIslands* m_islands;
+	u64 m_sleepVersion = ~0ull;
+
+	LEO::ThreadPool m_pool;
+	LEO::ContactSolver m_solver;
+	LEO::ContactSolverSettings m_settings;
+	LEO::SpatialQuery m_awakeQuery;
+	LEO::SpatialQuery m_sleepingQuery;
+	std::vector<LEO::entity_id> m_neighbors;
+
+	std::vector<u32> m_ids;
+	std::vector<LEO::SolverBody> m_bodies;
+	std::vector<Particle*> m_particles;
+	std::vector<LEO::Contact> m_contacts;
+	std::vector<u32> m_bodyOf; // entity id -> index in m_bodies
 };
 
 class RenderSystem : public LEO::ISystem
@@ -97,11 +181,21 @@ class RenderSystem : public LEO::ISystem
 public:
 	virtual void Update(f32 dt) override
 	{
+		const f32 winW = (f32)LEO::WinWidth();
+		const f32 winH = (f32)LEO::WinHeight();
+
+		// every particle in one instanced draw call
+		m_circles.Begin(glm::ortho(0.0f, winW, 0.0f, winH));
+
 		p_entityManager->ForEach<Particle>([&](LEO::entity_id id, Particle& Particle) {
 			LEO::Color color = Particle.radius <= 10.0f ? LEO_DARKGREEN : LEO_BLEU;
 			color = Particle.radius <= 5.0f ? LEO_RED : color;
 
-			LEO::RenderCircle(Particle.pos, Particle.radius, color);
+			m_circles.Circle(Particle.pos, Particle.radius, color);
 		});
+
+		m_circles.End();
 	}
+private:
+	LEO::CircleRenderer m_circles;
 };
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "StressLayer.h"
+
+void StressLayer::OnCreate()
+{
+	renderer2D = std::make_unique<leo::Renderer2D>();
+
+	leo::Random random(1234);
+	positions.resize(PARTICLES);
+	velocities.resize(PARTICLES);
+	for (leo::u32 i = 0; i < PARTICLES; i++)
+	{
+		positions[i] = random.Float2(0.05f, 0.95f);
+		velocities[i] = random.Dir2D(0.1f);
+	}
+
+	LEOLOGINFO("Stress: {} particles, {} frames per simulation mode", PARTICLES, MEASURED_FRAMES);
+	StartPhase(Phase::WarmUp);
+}
+
+void StressLayer::OnUpdate(leo::f32)
+{
+	leo::Application& app = leo::Application::Get();
+
+	// the stats of the previous frame, it ran in the mode of this phase once the first frames are skipped
+	PhaseTotals* totals = phase == Phase::Serial ? &serial : phase == Phase::Pipelined ? &pipelined : nullptr;
+	if (totals != nullptr && phaseFrames >= SETTLE_FRAMES)
+	{
+		const leo::FrameStats& stats = app.GetFrameStats();
+		totals->frameMs += stats.frameMs;
+		totals->simulateMs += stats.simulateMs;
+		totals->renderMs += stats.renderMs;
+		totals->waitMs += stats.waitMs;
+		totals->frames++;
+	}
+	phaseFrames++;
+
+	switch (phase)
+	{
+	case Phase::WarmUp:
+		if (phaseFrames >= WARMUP_FRAMES) StartPhase(Phase::Serial);
+		break;
+	case Phase::Serial:
+		if (serial.frames >= MEASURED_FRAMES)
+		{
+			LogPhase("Serial", serial);
+			StartPhase(Phase::Pipelined);
+		}
+		break;
+	case Phase::Pipelined:
+		if (pipelined.frames >= MEASURED_FRAMES)
+		{
+			LogPhase("Pipelined", pipelined);
+			LEOLOGINFO("Stress: pipelined frames take {:.2f}ms against {:.2f}ms serial, {:.2f}x",
+				pipelined.AverageFrameMs(), serial.AverageFrameMs(), serial.AverageFrameMs() / pipelined.AverageFrameMs());
+			StartPhase(Phase::Done);
+		}
+		break;
+	case Phase::Done:
+		break;
+	}
+}
+
+void StressLayer::StartPhase(Phase next)
+{
+	phase = next;
+	phaseFrames = 0;
+
+	leo::Application& app = leo::Application::Get();
+	if (next == Phase::Serial) app.SetSimulationMode(leo::SimulationMode::Serial);
+	if (next == Phase::Pipelined) app.SetSimulationMode(leo::SimulationMode::Pipelined);
+}
+
+void StressLayer::LogPhase(const char* name, const PhaseTotals& totals) const
+{
+	const leo::f64 frames = totals.frames;
+	LEOLOGINFO("Stress {}: frame {:.2f}ms (sim {:.2f}ms render {:.2f}ms wait {:.2f}ms) over {} frames",
+		name, totals.frameMs / frames, totals.simulateMs / frames, totals.renderMs / frames, totals.waitMs / frames, totals.frames);
+}
+
+void StressLayer::OnSimulate(leo::f32 dt)
+{
+	// a fixed dt would keep the motion the same in both modes, the cost is what is measured here
+	const leo::f32 step = glm::min(dt, 1.0f / 30.0f) / SUBSTEPS;
+	const glm::vec2 center(0.5f);
+
+	for (leo::u32 s = 0; s < SUBSTEPS; s++)
+	{
+		time += step;
+		for (leo::u32 i = 0; i < PARTICLES; i++)
+		{
+			glm::vec2& p = positions[i];
+			glm::vec2& v = velocities[i];
+
+			// swirl around the center plus a moving noise field
+			glm::vec2 to_center = center - p;
+			leo::f32 distance2 = glm::dot(to_center, to_center) + 0.01f;
+			glm::vec2 swirl = glm::vec2(-to_center.y, to_center.x) * (0.02f / distance2) + to_center * 0.3f;
+			glm::vec2 noise(glm::sin(p.y * 13.0f + time * 1.7f), glm::cos(p.x * 11.0f - time * 1.3f));
+
+			v += (swirl + noise * 0.4f) * step;
+			v *= 0.995f;
+			p += v * step;
+
+			if (p.x < 0.0f || p.x > 1.0f) { v.x = -v.x; p.x = glm::clamp(p.x, 0.0f, 1.0f); }
+			if (p.y < 0.0f || p.y > 1.0f) { v.y = -v.y; p.y = glm::clamp(p.y, 0.0f, 1.0f); }
+		}
+	}
+
+	ParticleFrame& frame = frames.Back();
+	frame.positions.assign(positions.begin(), positions.end());
+	frame.colors.resize(PARTICLES);
+	for (leo::u32 i = 0; i < PARTICLES; i++)
+	{
+		leo::f32 speed = glm::min(glm::length(velocities[i]) * 4.0f, 1.0f);
+		frame.colors[i] = leo::Color((leo::u8)(80 + 175 * speed), (leo::u8)(120 + 60 * speed), (leo::u8)(255 - 200 * speed), 255);
+	}
+}
+
+void StressLayer::OnSync()
+{
+	frames.Publish();
+}
+
+void StressLayer::OnRecord(leo::CommandList& commands)
+{
+	leo::Window& window = leo::Application::Get().GetWindow();
+	glm::vec2 size(window.Size());
+
+	commands.Clear(leo::CLEAR_COLOR | leo::CLEAR_DEPTH, leo::BLACK);
+
+	const ParticleFrame& frame = frames.Front();
+	renderer2D->Begin(glm::ortho(0.0f, size.x, 0.0f, size.y));
+	for (leo::u64 i = 0; i < frame.positions.size(); i++)
+	{
+		renderer2D->Circle(frame.positions[i] * size, 2.5f, frame.colors[i], 6);
+	}
+	renderer2D->End(commands);
+}
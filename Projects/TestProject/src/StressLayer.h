@@ -0,0 +1,57 @@
+#pragma once
+#include <LEO/LeoEngine.h>
+
+struct ParticleFrame
+{
+	std::vector<glm::vec2> positions; // in [0, 1], scaled to the window when drawn
+	std::vector<leo::Color> colors;
+};
+
+/// <summary>
+/// Frame time benchmark of the simulation modes (--stress on the command line, vsync off):
+/// a particle field heavy on both sides, simulated in OnSimulate and drawn with one circle per particle.
+/// After a warm up it runs MEASURED_FRAMES in Serial then in Pipelined and logs the average FrameStats of each.
+/// </summary>
+class StressLayer : public leo::Layer
+{
+public:
+	static constexpr leo::u32 WARMUP_FRAMES   = 60;
+	static constexpr leo::u32 SETTLE_FRAMES   = 10; // skipped after a mode switch
+	static constexpr leo::u32 MEASURED_FRAMES = 300;
+	static constexpr leo::u32 PARTICLES       = 20000;
+	static constexpr leo::u32 SUBSTEPS        = 4;
+public:
+	virtual void OnCreate() override;
+	virtual void OnUpdate(leo::f32 dt) override;
+	virtual void OnSimulate(leo::f32 dt) override;
+	virtual void OnSync() override;
+	virtual void OnRecord(leo::CommandList& commands) override;
+private:
+	enum class Phase { WarmUp, Serial, Pipelined, Done };
+
+	struct PhaseTotals
+	{
+		leo::f64 frameMs    = 0.0;
+		leo::f64 simulateMs = 0.0;
+		leo::f64 renderMs   = 0.0;
+		leo::f64 waitMs     = 0.0;
+		leo::u32 frames     = 0;
+
+		leo::f64 AverageFrameMs() const { return frames > 0 ? frameMs / frames : 0.0; }
+	};
+
+	void StartPhase(Phase next);
+	void LogPhase(const char* name, const PhaseTotals& totals) const;
+private:
+	std::vector<glm::vec2> positions;
+	std::vector<glm::vec2> velocities;
+	leo::f32 time = 0.0f;
+
+	leo::FrameState<ParticleFrame> frames;
+	std::unique_ptr<leo::Renderer2D> renderer2D;
+
+	Phase phase = Phase::WarmUp;
+	leo::u32 phaseFrames = 0;
+	PhaseTotals serial;
+	PhaseTotals pipelined;
+};
@@ -1,9 +1,16 @@
 #include <LEO/LeoEngine.h>
+#include "StressLayer.h"
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
 
+struct CubeFrame
+{
+	glm::mat4 model = glm::mat4(1.0f);
+	leo::f32 angle = 0.0f;
+};
+
 class TestLayer : public leo::Layer
 {
 public:
@@ -11,64 +18,160 @@ public:
 	{
 		leo::GetDefaultLogChannel().SetLoggingLevel(leo::VERBOSE);
 
-		shader = leo::ShaderProgram(RESOURCES_PATH"TestProject/basicTex");
+		// the driver compiles the program while the rest of the scene loads
+		leo::ShaderCompiler shaders;
+		leo::ShaderTicket basicTex = shaders.Submit(RESOURCES_PATH"TestProject/basicTex");
+
+		frameUniforms = leo::UniformBuffer::Create<leo::FrameUniforms>();
 		cube = leo::Mesh::GenerateCube();
 
-		leo::ImageData image = leo::ReadImageData(RESOURCES_PATH"TestProject/brick1.jpg");
+		// decoded on the pool, drawn with the placeholder checker until it is uploaded.
+		// Cooked once to a .leotex with its mips, the next runs map it instead of decoding the jpg
+		textures = std::make_unique<leo::TextureLoader>(&decodePool);
+		textures->SetCacheDirectory("texture_cache");
+		brick = textures->Load(RESOURCES_PATH"TestProject/brick1.jpg",
+			{ leo::TextureMinFiltering::MIN_LINEAR_MIPMAP_LINEAR, leo::TextureMagFiltering::MAG_LINEAR });
 
-		texture = leo::Texture(image.width, image.height, leo::TextureFormat::RGBA8UB, image.data.get());
+		renderer2D = std::make_unique<leo::Renderer2D>();
 
+		shaders.WaitAll();
+		shader = shaders.Take(basicTex);
 
-		leo::Color c = leo::SKYBLUE;
-		glClearColor(c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, c.a / 255.0f);
+		// compare with a run using --no-shader-cache
+		leo::GetShaderCache().LogReport();
 	}
 
 	virtual void OnEvent(leo::Event& e)
 	{
 		LEOLOGVERBOSE("{}", e.ToString());
+
+		leo::EventDispatcher dispatcher(e);
+		dispatcher.Dispatch<leo::KeyPressedEvent>([](leo::KeyPressedEvent& key) {
+			if (key.isRepeat) return false;
+
+			leo::Application& app = leo::Application::Get();
+			if (key.keyCode == KEY_P)
+			{
+				bool pipelined = app.GetSimulationMode() == leo::SimulationMode::Pipelined;
+				app.SetSimulationMode(pipelined ? leo::SimulationMode::Serial : leo::SimulationMode::Pipelined);
+				LEOLOGINFO("Simulation mode: {}", pipelined ? "Serial" : "Pipelined");
+				return true;
+			}
+			if (key.keyCode == KEY_R)
+			{
+				bool threaded = app.GetRenderMode() == leo::RenderMode::RenderThread;
+				app.SetRenderMode(threaded ? leo::RenderMode::MainThread : leo::RenderMode::RenderThread);
+				LEOLOGINFO("Render mode: {}", threaded ? "MainThread" : "RenderThread");
+				return true;
+			}
+			return false;
+		});
 	}
 
 	virtual void OnUpdate(leo::f32 dt) override
+	{
+		statsTimer += dt;
+		if (statsTimer < 1.0f) return;
+		statsTimer = 0.0f;
+
+		leo::Application& app = leo::Application::Get();
+		const leo::FrameStats& stats = app.GetFrameStats();
+		app.GetWindow().SetTitle(std::format("Leonidas Engine [{}, {}] frame {:.2f}ms sim {:.2f}ms render {:.2f}ms replay {:.2f}ms wait {:.2f}ms",
+			app.GetSimulationMode() == leo::SimulationMode::Pipelined ? "Pipelined" : "Serial",
+			app.GetRenderMode() == leo::RenderMode::RenderThread ? "RenderThread" : "MainThread",
+			stats.frameMs, stats.simulateMs, stats.renderMs, stats.replayMs, stats.waitMs));
+	}
+
+	virtual void OnSimulate(leo::f32 dt) override
+	{
+		angle += dt;
+
+		CubeFrame& frame = frames.Back();
+		frame.model = glm::translate(glm::mat4(1.0f), glm::vec3(-1.5f, -1.0f, 0.0f));
+		frame.model = glm::rotate(frame.model, angle, glm::vec3(0.0f, 1.0f, 0.0f));
+		frame.angle = angle;
+	}
+
+	virtual void OnSync() override
+	{
+		frames.Publish();
+	}
+
+	virtual void OnRecord(leo::CommandList& commands) override
 	{
 		leo::Window& window = leo::Application::Get().GetWindow();
 		glm::uvec2 size = window.Size();
 
-		// Do the Rendering here for now since Renderer does to exits
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		// recorded here, replayed on the thread that owns the GL context
+		commands.Clear(leo::CLEAR_COLOR | leo::CLEAR_DEPTH, leo::SKYBLUE);
+		commands.SetRenderState(leo::RenderState{ true, false });
+		textures->RecordUpload(commands, 2.0f);
 
-		glEnable(GL_DEPTH_TEST);
-		glDepthFunc(GL_LEQUAL);
-
-		glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(-1.5f, -1.0f, 0.0f));
+		const glm::mat4& model = frames.Front().model;
 		glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -3.0f));
 		leo::f32 aspect = (float)size.x / (float)size.y;
 		glm::mat4 proj = glm::perspective(1.0472f, aspect, 0.1f, 100.0f);
 		
-		shader.Bind();
-		texture.Bind(1);
-
-		shader.SetUniform("mv_matrix", view * model);
-		shader.SetUniform("proj_matrix", proj);
-		shader.SetUniform("samp", 1);
-
-		cube.Draw();
-
-		shader.UnBind();
+		// std140 blocks: the camera once per frame, the transforms per draw (ring allocated by the backend)
+		const leo::f32 frame_angle = frames.Front().angle;
+		commands.UpdateUniformBuffer(frameUniforms, leo::FrameUniforms{ view, proj, proj * view, glm::vec3(0.0f, 0.0f, 3.0f), frame_angle });
+		commands.BindUniformBuffer(frameUniforms, leo::UNIFORM_BINDING_FRAME);
+
+		glm::mat4 mv = view * model;
+		queue.Clear();
+		queue.Submit(leo::RenderPass::Opaque, &shader, textures->Get(brick), &cube, -mv[3].z);
+		queue.Record(commands, [&](leo::CommandList& list, const leo::ShaderProgram&, const leo::RenderCommand&) {
+			list.PushUniforms(leo::UNIFORM_BINDING_DRAW, leo::DrawUniforms{ model, mv });
+		});
+
+		// 2D overlay in pixels, one draw call per texture
+		renderer2D->Begin(glm::ortho(0.0f, (float)size.x, 0.0f, (float)size.y));
+		renderer2D->Quad({ 20.0f, 20.0f }, { 220.0f, 40.0f }, leo::DARKGRAY);
+		renderer2D->Quad({ 20.0f, 20.0f }, { 20.0f + 200.0f * glm::fract(frame_angle / glm::two_pi<float>()), 40.0f }, leo::GOLD);
+		for (int i = 0; i < 16; i++)
+		{
+			glm::vec2 center((float)size.x - 40.0f - i * 30.0f, (float)size.y - 40.0f);
+			renderer2D->Circle(center, 10.0f + 3.0f * glm::sin(frame_angle * 2.0f + i), i % 2 ? leo::RED : leo::GREEN);
+		}
+		renderer2D->SetTexture(textures->Get(brick));
+		renderer2D->Quad({ 20.0f, 60.0f }, { 148.0f, 188.0f }, leo::WHITE);
+		renderer2D->End(commands);
 	}
 
 private:
 	leo::ShaderProgram shader;
+	leo::UniformBuffer frameUniforms;
 	leo::Mesh cube;
-	leo::Texture texture;
+	leo::ThreadPool decodePool{ 2 };
+	std::unique_ptr<leo::TextureLoader> textures;
+	leo::TextureHandle brick;
+	std::unique_ptr<leo::Renderer2D> renderer2D;
+	leo::RenderQueue queue;
 	leo::f32 offset = 0.0f;
 	leo::f32 speed = 800.0f;
+
+	leo::FrameState<CubeFrame> frames;
+	leo::f32 angle = 0.0f;
+	leo::f32 statsTimer = 0.0f;
 };
 
-int main(void) 
+int main(int argc, char** argv) 
 {
-	leo::Application app({ 1600, 900, "Leonidas Engine", leo::WIN_FLAG_VSYNC | leo::WIN_FLAG_ESC_CLOSE });
+	bool shader_cache = true;
+	bool stress = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::string_view(argv[i]) == "--no-shader-cache") shader_cache = false;
+		if (std::string_view(argv[i]) == "--stress") stress = true;
+	}
+	if (shader_cache) leo::GetShaderCache().SetDirectory("shader_cache");
+
+	// vsync would hide the frame time difference the stress scene measures
+	leo::u32 flags = stress ? leo::WIN_FLAG_ESC_CLOSE : leo::WIN_FLAG_VSYNC | leo::WIN_FLAG_ESC_CLOSE;
+	leo::Application app({ 1600, 900, "Leonidas Engine", flags });
 
-	app.GetLayerStack().PushLayer<TestLayer>();
+	if (stress) app.GetLayerStack().PushLayer<StressLayer>();
+	else app.GetLayerStack().PushLayer<TestLayer>();
 
 	app.Run();
 
@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glad/glad.h>
+#include <LEO/Graphics/BufferObjects.h>
+#include <LEO/Graphics/CommandList.h>
+#include <LEO/Graphics/GLBackend.h>
+#include <LEO/Graphics/GLStateCache.h>
+#include <LEO/Graphics/RenderBackend.h>
+#include <LEO/Graphics/RenderThread.h>
+#include <LEO/Graphics/Shader.h>
+#include "LeoTest.h"
+#include "MockUniforms.h"
+
+using namespace leo;
+
+// The values the replay gives to glUniform*, by location
+static std::map<GLint, std::vector<f32>> s_uniformValues;
+static PFNGLUNIFORM1FPROC s_uniform1f;
+static PFNGLUNIFORM4FPROC s_uniform4f;
+static PFNGLUNIFORMMATRIX4FVPROC s_uniformMatrix4fv;
+
+static void APIENTRY Uniform1f(GLint location, GLfloat v0)
+{
+	s_uniform1f(location, v0);
+	s_uniformValues[location] = { v0 };
+}
+
+static void APIENTRY Uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+{
+	s_uniform4f(location, v0, v1, v2, v3);
+	s_uniformValues[location] = { v0, v1, v2, v3 };
+}
+
+static void APIENTRY UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+	s_uniformMatrix4fv(location, count, transpose, value);
+	s_uniformValues[location] = std::vector<f32>(value, value + 16 * count);
+}
+
+// The objects a frame draws with, created under the mock backend
+struct Scene
+{
+	ShaderProgram shader{ "vertex", "fragment" };
+	VertexBuffer vertices{ nullptr, 64, BufferUsage::Stream };
+	VertexArray vertexArray;
+
+	Scene()
+	{
+		const u32 indices[6] = {};
+		vertexArray.SetIndexBuffer(IndexBuffer(indices, 6, BufferUsage::Stream));
+	}
+};
+
+static const glm::mat4 k_viewProj = glm::mat4(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f, 16.0f);
+
+// One command of each kind the GL backend can replay without extra objects, the uniform names are temporaries
+static void RecordFrame(CommandList& commands, Scene& scene, f32 time, u32* callbacks)
+{
+	const f32 vertices[16] = { time };
+	const u32 indices[6] = { 0, 1, 2, 2, 3, 0 };
+
+	commands.Clear(CLEAR_COLOR | CLEAR_DEPTH, SKYBLUE);
+	commands.SetRenderState(RenderState{ true, false });
+	commands.BindShader(scene.shader);
+	commands.SetUniforms(scene.shader, {
+		{ std::string("u_time").c_str(), time },
+		{ std::string("u_color").c_str(), glm::vec4(0.25f, 0.5f, 0.75f, 1.0f) },
+		{ std::string("u_viewProj").c_str(), k_viewProj },
+	});
+	commands.UpdateVertexBuffer(scene.vertices, vertices, sizeof(vertices));
+	commands.UpdateIndexBuffer(scene.vertexArray, indices, 6);
+	commands.BindVertexArray(scene.vertexArray);
+	commands.DrawIndexed(0, 6);
+	commands.Callback([callbacks]() { (*callbacks)++; });
+}
+
+static const CommandType k_frameCommands[] = {
+	CommandType::Clear, CommandType::SetRenderState, CommandType::BindShader, CommandType::SetUniforms,
+	CommandType::UpdateVertexBuffer, CommandType::UpdateIndexBuffer, CommandType::BindVertexArray,
+	CommandType::DrawIndexed, CommandType::Callback,
+};
+
+static bool SameTrace(std::span<const CommandType> trace)
+{
+	return std::equal(trace.begin(), trace.end(), std::begin(k_frameCommands), std::end(k_frameCommands));
+}
+
+// The mock calls since the last ResetMockGLCallCounts are expected, in order
+static bool SameCalls(std::span<const GLFunction> expected)
+{
+	std::span<const GLFunction> trace = GetMockGLCallTrace();
+	if (std::equal(trace.begin(), trace.end(), expected.begin(), expected.end())) return true;
+
+	std::printf("GL calls:");
+	for (GLFunction function : trace) std::printf(" %s", GLFunctionName(function));
+	std::printf("\n");
+	return false;
+}
+
+static void TestUniformValues()
+{
+	glm::mat3 m3(1.0f, -2.0f, 3.0f, 4.0f, 5.5f, 6.0f, 7.0f, 8.0f, -9.0f);
+	LEO_CHECK(UniformValue("a", 1.5f).As<f32>() == 1.5f);
+	LEO_CHECK(UniformValue("a", -7).As<i32>() == -7);
+	LEO_CHECK(UniformValue("a", 0xFFFFFFF0u).As<u32>() == 0xFFFFFFF0u);
+	LEO_CHECK(UniformValue("a", glm::uvec3(1, 2, 0xFFFFFFFFu)).As<glm::uvec3>() == glm::uvec3(1, 2, 0xFFFFFFFFu));
+	LEO_CHECK(UniformValue("a", glm::ivec3(-1, 2, -3)).As<glm::ivec3>() == glm::ivec3(-1, 2, -3));
+	LEO_CHECK(UniformValue("a", m3).As<glm::mat3>() == m3);
+	LEO_CHECK(UniformValue("a", k_viewProj).As<glm::mat4>() == k_viewProj);
+
+	// the name is hashed when the value is made, a temporary string is not kept
+	LEO_CHECK(UniformValue(std::string("u_time").c_str(), 1.0f).name.hash == HashUniformName("u_time"));
+}
+
+static void TestArena()
+{
+	FrameArena arena;
+	u8* small = static_cast<u8*>(arena.Allocate(3, 1));
+	small[0] = 1; small[1] = 2; small[2] = 3;
+	u8* aligned = static_cast<u8*>(arena.Allocate(8, 64));
+	LEO_CHECK((u64)aligned % 64 == 0 && aligned >= small + 3);
+
+	// bigger than a block, in a block of its own
+	u8* big = static_cast<u8*>(arena.Allocate(FrameArena::BLOCK_SIZE * 2, 16));
+	LEO_CHECK((u64)big % 16 == 0);
+	std::memset(big, 0xAB, FrameArena::BLOCK_SIZE * 2);
+	LEO_CHECK(small[0] == 1 && small[1] == 2 && small[2] == 3);
+	LEO_CHECK(arena.BytesUsed() == 3 + 8 + FrameArena::BLOCK_SIZE * 2);
+
+	// the memory is kept and reused
+	u64 capacity = arena.Capacity();
+	arena.Reset();
+	LEO_CHECK(arena.BytesUsed() == 0);
+	LEO_CHECK(arena.Allocate(3, 1) == small);
+	LEO_CHECK(arena.Capacity() == capacity);
+}
+
+static void TestNullReplay(Scene& scene)
+{
+	u32 callbacks = 0;
+	NullRenderBackend backend;
+
+	CommandList commands;
+	RecordFrame(commands, scene, 1.0f, &callbacks);
+	LEO_CHECK(commands.CommandCount() == std::size(k_frameCommands));
+	LEO_CHECK(callbacks == 0); // recording runs nothing
+
+	commands.Replay(backend);
+	LEO_CHECK(SameTrace(backend.Trace()));
+	LEO_CHECK(callbacks == 1 && backend.FramesReplayed() == 1);
+	u64 hash = backend.Hash();
+
+	// the same frame recorded again after a Reset: same commands and arguments, the names were hashed
+	commands.Reset();
+	RecordFrame(commands, scene, 1.0f, &callbacks);
+	commands.Replay(backend);
+	LEO_CHECK(SameTrace(backend.Trace()) && backend.Hash() == hash);
+
+	// another uniform value changes the hash
+	commands.Reset();
+	RecordFrame(commands, scene, 2.0f, &callbacks);
+	commands.Replay(backend);
+	LEO_CHECK(SameTrace(backend.Trace()) && backend.Hash() != hash);
+	LEO_CHECK(callbacks == 3);
+}
+
+static void TestRenderThread(Scene& scene)
+{
+	// three frames recorded on this thread, replayed on the render thread one behind
+	u32 callbacks = 0;
+	NullRenderBackend backend;
+	NullRenderBackend reference;
+	{
+		RenderThread thread(backend);
+		for (u32 frame = 0; frame < 3; frame++)
+		{
+			RecordFrame(thread.Recording(), scene, (f32)frame, &callbacks);
+			thread.Submit();
+		}
+		thread.Flush();
+		LEO_CHECK(thread.FramesReplayed() == 3);
+	}
+	LEO_CHECK(callbacks == 3);
+	LEO_CHECK(backend.ReplayThread() != std::this_thread::get_id());
+	LEO_CHECK(SameTrace(backend.Trace()));
+
+	// the last frame replayed the same as on this thread
+	CommandList commands;
+	RecordFrame(commands, scene, 2.0f, &callbacks);
+	commands.Replay(reference);
+	LEO_CHECK(reference.Hash() == backend.Hash());
+}
+
+static void TestGLReplay(Scene& scene)
+{
+	u32 callbacks = 0;
+	CommandList commands;
+	RecordFrame(commands, scene, 0.5f, &callbacks);
+
+	GLRenderBackend backend;
+	GetGLStateCache().Invalidate();
+	EnableMockGLCallTrace(true);
+
+	// the first frame sets every state
+	ResetMockGLCallCounts();
+	s_uniformValues.clear();
+	commands.Replay(backend);
+	{
+		using F = GLFunction;
+		const GLFunction expected[] = {
+			F::ClearColor, F::ClearDepth, F::Clear,                // Clear
+			F::Enable, F::DepthFunc, F::Disable,                   // SetRenderState
+			F::UseProgram,                                         // BindShader
+			F::Uniform1f, F::Uniform4f, F::UniformMatrix4fv,       // SetUniforms
+			F::BindBuffer, F::BufferSubData,                       // UpdateVertexBuffer
+			F::BindVertexArray, F::BindBuffer, F::BufferSubData,   // UpdateIndexBuffer, binds the vertex array
+			F::DrawElements,                                       // BindVertexArray is already bound
+		};
+		LEO_CHECK(SameCalls(expected));
+	}
+	LEO_CHECK(callbacks == 1);
+
+	// by location, the order of MockUniforms
+	LEO_CHECK(s_uniformValues[0] == std::vector<f32>({ 0.5f }));
+	LEO_CHECK(s_uniformValues[1] == std::vector<f32>({ 0.25f, 0.5f, 0.75f, 1.0f }));
+	LEO_CHECK(s_uniformValues[2] == std::vector<f32>(&k_viewProj[0][0], &k_viewProj[0][0] + 16));
+
+	// the second frame only issues what the cache cannot skip
+	ResetMockGLCallCounts();
+	commands.Replay(backend);
+	{
+		using F = GLFunction;
+		const GLFunction expected[] = {
+			F::ClearColor, F::ClearDepth, F::Clear,
+			F::Uniform1f, F::Uniform4f, F::UniformMatrix4fv,
+			F::BufferSubData,
+			F::BufferSubData,
+			F::DrawElements,
+		};
+		LEO_CHECK(SameCalls(expected));
+	}
+	LEO_CHECK(callbacks == 2);
+
+	EnableMockGLCallTrace(false);
+	backend.Release();
+}
+
+int main()
+{
+	TestUniformValues();
+	TestArena();
+
+	InstallMockGLBackend();
+	test::SetMockUniforms({ { "u_time", GL_FLOAT }, { "u_color", GL_FLOAT_VEC4 }, { "u_viewProj", GL_FLOAT_MAT4 } });
+	s_uniform1f = glad_glUniform1f;
+	s_uniform4f = glad_glUniform4f;
+	s_uniformMatrix4fv = glad_glUniformMatrix4fv;
+	glad_glUniform1f = Uniform1f;
+	glad_glUniform4f = Uniform4f;
+	glad_glUniformMatrix4fv = UniformMatrix4fv;
+	{
+		Scene scene;
+		LEO_CHECK(scene.shader.Uniforms().size() == 3);
+
+		TestNullReplay(scene);
+		TestRenderThread(scene);
+		TestGLReplay(scene);
+	}
+	RestoreGLBackend();
+
+	return test::Result("CommandListTests");
+}
@@ -0,0 +1,190 @@
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <LEO/Physics/ContactSolver.h>
+#include <LEO/Utilities/LeoThreadPool.h>
+#include "LeoTest.h"
+
+using namespace leo;
+
+struct Scene
+{
+	std::vector<SolverBody> bodies;
+	std::vector<Contact> contacts;
+};
+
+// A jittered grid of overlapping circles touching their right and upper neighbours,
+// the bottom row resting on one static floor body shared by all of its contacts
+static Scene GridScene(u32 columns, u32 rows, u32 seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<f32> jitter(-0.05f, 0.05f);
+	std::uniform_real_distribution<f32> speed(-1.0f, 1.0f);
+
+	Scene scene;
+	scene.bodies.resize((u64)columns * rows + 1);
+	const u32 floor = columns * rows;
+	scene.bodies[floor].invMass = 0.0f;
+	scene.bodies[floor].position = glm::vec2(columns * 0.5f, -1.0f);
+
+	for (u32 y = 0; y < rows; y++)
+	{
+		for (u32 x = 0; x < columns; x++)
+		{
+			SolverBody& body = scene.bodies[y * columns + x];
+			body.position = glm::vec2(x * 0.9f + jitter(rng), y * 0.9f + jitter(rng)); // radius 0.5
+			body.velocity = glm::vec2(speed(rng), speed(rng));
+			body.invMass = 1.0f / (1.0f + (rng() % 4));
+		}
+	}
+
+	auto add_contact = [&](u32 a, u32 b) {
+		glm::vec2 delta = scene.bodies[b].position - scene.bodies[a].position;
+		f32 distance = glm::length(delta);
+		scene.contacts.push_back({ a, b, delta / distance, glm::max(1.0f - distance, 0.0f) });
+	};
+
+	for (u32 y = 0; y < rows; y++)
+	{
+		for (u32 x = 0; x < columns; x++)
+		{
+			u32 i = y * columns + x;
+			if (x + 1 < columns) add_contact(i, i + 1);
+			if (y + 1 < rows) add_contact(i, i + columns);
+			if (y == 0) scene.contacts.push_back({ floor, i, glm::vec2(0.0f, 1.0f), 0.1f });
+		}
+	}
+	return scene;
+}
+
+static bool SameBits(const Scene& a, const Scene& b)
+{
+	if (a.bodies.size() != b.bodies.size() || a.contacts.size() != b.contacts.size()) return false;
+	return std::memcmp(a.bodies.data(), b.bodies.data(), a.bodies.size() * sizeof(SolverBody)) == 0 &&
+		std::memcmp(a.contacts.data(), b.contacts.data(), a.contacts.size() * sizeof(Contact)) == 0;
+}
+
+static void TestSingleContacts()
+{
+	ContactSolver solver;
+
+	// equal masses head on, elastic: the velocities are exchanged
+	std::vector<SolverBody> bodies = { { glm::vec2(0.0f), glm::vec2(1.0f, 0.0f), 1.0f }, { glm::vec2(0.9f, 0.0f), glm::vec2(-1.0f, 0.0f), 1.0f } };
+	std::vector<Contact> contacts = { { 0, 1, glm::vec2(1.0f, 0.0f), 0.1f } };
+	solver.Solve(bodies, contacts);
+	LEO_CHECK(bodies[0].velocity == glm::vec2(-1.0f, 0.0f) && bodies[1].velocity == glm::vec2(1.0f, 0.0f));
+	LEO_CHECK(contacts[0].normalImpulse == 2.0f);
+	LEO_CHECK(bodies[1].position.x - bodies[0].position.x > 0.9f); // pushed apart
+
+	// a ball falling on a static body bounces, the static body is never written
+	const SolverBody ground = { glm::vec2(3.0f, -1.0f), glm::vec2(0.25f, 0.5f), 0.0f }; // a velocity the solver must not change
+	bodies = { ground, { glm::vec2(3.0f, -0.5f), glm::vec2(0.0f, -1.0f), 1.0f } };
+	contacts = { { 0, 1, glm::vec2(0.0f, 1.0f), 0.5f } };
+	solver.Solve(bodies, contacts);
+	LEO_CHECK(std::memcmp(&bodies[0], &ground, sizeof(SolverBody)) == 0);
+	LEO_CHECK(bodies[1].velocity.y > 0.0f && bodies[1].position.y > -0.5f);
+
+	// separating bodies are left alone
+	bodies = { { glm::vec2(0.0f), glm::vec2(-1.0f, 0.0f), 1.0f }, { glm::vec2(0.95f, 0.0f), glm::vec2(1.0f, 0.0f), 1.0f } };
+	contacts = { { 0, 1, glm::vec2(1.0f, 0.0f), 0.0f } };
+	solver.Solve(bodies, contacts);
+	LEO_CHECK(bodies[0].velocity == glm::vec2(-1.0f, 0.0f) && bodies[1].velocity == glm::vec2(1.0f, 0.0f));
+	LEO_CHECK(contacts[0].normalImpulse == 0.0f);
+}
+
+static void TestDeterminism(ThreadPool& pool)
+{
+	// the same bits with 1 thread and with pools of any size, static bodies shared by many contacts of a color included
+	ContactSolverSettings settings;
+	settings.minContactsPerTask = 16; // split even the small scenes between the threads
+
+	ThreadPool small_pool(3);
+	for (u32 size : { 1u, 40u, 160u })
+	{
+		const Scene initial = GridScene(size, size / 2 + 1, size);
+
+		Scene reference = initial;
+		ContactSolver solver;
+		solver.Solve(reference.bodies, reference.contacts, settings);
+		LEO_CHECK(solver.OverflowCount() == 0 && solver.ColorCount() <= 7); // at most 4 contacts per body
+		LEO_CHECK(std::memcmp(&reference.bodies.back(), &initial.bodies.back(), sizeof(SolverBody)) == 0); // the floor
+
+		for (ThreadPool* solver_pool : { &pool, &small_pool })
+		{
+			// twice with the same solver, nothing carried over between Solve calls
+			ContactSolver pooled(solver_pool);
+			for (u32 run = 0; run < 2; run++)
+			{
+				Scene scene = initial;
+				pooled.Solve(scene.bodies, scene.contacts, settings);
+				LEO_CHECK(SameBits(scene, reference));
+			}
+		}
+	}
+
+	// past MAX_COLORS: a body touching every other one, the overflow is solved in order
+	Scene star;
+	star.bodies.resize(ContactSolver::MAX_COLORS + 11);
+	for (u32 i = 1; i < (u32)star.bodies.size(); i++)
+	{
+		star.bodies[i].position = glm::vec2(glm::cos((f32)i), glm::sin((f32)i)) * 0.9f;
+		star.contacts.push_back({ 0, i, glm::normalize(star.bodies[i].position), 0.1f });
+	}
+	Scene star_pooled = star;
+	ContactSolver solver;
+	solver.Solve(star.bodies, star.contacts, settings);
+	LEO_CHECK(solver.ColorCount() == ContactSolver::MAX_COLORS && solver.OverflowCount() == 10);
+
+	ContactSolver pooled(&small_pool);
+	pooled.Solve(star_pooled.bodies, star_pooled.contacts, settings);
+	LEO_CHECK(SameBits(star, star_pooled));
+}
+
+static void BenchSolve()
+{
+	const Scene initial = GridScene(250, 201, 7); // 100299 contacts
+	std::printf("ContactSolver, %zu contacts between %zu bodies (8 velocity + 3 position iterations), best of 5:\n",
+		initial.contacts.size(), initial.bodies.size());
+
+	std::vector<u32> thread_counts = { 0 }; // 0: no pool
+	for (u32 threads = 1; threads < ThreadPool::DefaultThreadCount(); threads *= 2) thread_counts.push_back(threads);
+	thread_counts.push_back(ThreadPool::DefaultThreadCount());
+
+	Scene reference;
+	f32 single_ms = 0.0f;
+	for (u32 threads : thread_counts)
+	{
+		std::unique_ptr<ThreadPool> pool = threads > 0 ? std::make_unique<ThreadPool>(threads) : nullptr;
+		ContactSolver solver(pool.get());
+
+		Scene scene;
+		f32 ms = test::BestMillis(5, [&]() {
+			scene = initial;
+			solver.Solve(scene.bodies, scene.contacts);
+		});
+
+		if (threads == 0)
+		{
+			reference = scene;
+			single_ms = ms;
+		}
+		LEO_CHECK(SameBits(scene, reference));
+
+		std::string name = threads > 0 ? std::to_string(threads + 1) + " threads" : "1 thread"; // the caller works too
+		std::printf("  %-10s %7.2f ms  %6.2f M contacts/s  %.2fx  (%u colors)\n",
+			name.c_str(), ms, initial.contacts.size() / ms / 1000.0f, single_ms / ms, solver.ColorCount());
+	}
+}
+
+int main()
+{
+	ThreadPool pool;
+
+	TestSingleContacts();
+	TestDeterminism(pool);
+	BenchSolve();
+
+	return test::Result("ContactSolverTests");
+}
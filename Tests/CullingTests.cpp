@@ -0,0 +1,195 @@
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+#include <LEO/Graphics/Culling.h>
+#include <LEO/Utilities/LeoThreadPool.h>
+#include "LeoTest.h"
+
+using namespace leo;
+
+static Frustum CameraFrustum()
+{
+	glm::mat4 proj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 400.0f);
+	glm::mat4 view = glm::lookAt(glm::vec3(10.0f, 5.0f, 0.0f), glm::vec3(0.0f, 0.0f, -100.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	return Frustum::FromMatrix(proj * view);
+}
+
+// Rotated, non uniformly scaled transforms around the camera, about a tenth of them visible
+static std::vector<glm::mat4> RandomTransforms(u32 count, u32 seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<f32> position(-300.0f, 300.0f);
+	std::uniform_real_distribution<f32> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<f32> scale(0.2f, 4.0f);
+
+	std::vector<glm::mat4> transforms(count);
+	for (glm::mat4& m : transforms)
+	{
+		glm::vec3 axis(unit(rng), unit(rng), unit(rng) + 1.5f);
+		m = glm::translate(glm::mat4(1.0f), glm::vec3(position(rng), position(rng), position(rng)));
+		m = glm::rotate(m, unit(rng) * 3.14159f, glm::normalize(axis));
+		m = glm::scale(m, glm::vec3(scale(rng), scale(rng), scale(rng)));
+	}
+	return transforms;
+}
+
+// The documented test in double: the bounds moved by m, the radius scaled by the longest axis.
+// margin is the distance of the sphere to the closest plane, the float paths may round either way below it
+static bool ReferenceVisible(const Frustum& frustum, const BoundingSphere& bounds, const glm::mat4& m, f64& margin)
+{
+	glm::dmat4 dm(m);
+	glm::dvec3 center = glm::dvec3(dm * glm::dvec4(glm::dvec3(bounds.center), 1.0));
+	f64 scale = std::max(std::max(glm::length(glm::dvec3(dm[0])), glm::length(glm::dvec3(dm[1]))), glm::length(glm::dvec3(dm[2])));
+	f64 radius = bounds.radius * scale;
+
+	bool visible = true;
+	margin = INFINITY;
+	for (const glm::vec4& plane : frustum.planes)
+	{
+		f64 distance = glm::dot(glm::dvec3(plane), center) + plane.w + radius;
+		margin = std::min(margin, std::abs(distance));
+		if (distance < 0.0) visible = false;
+	}
+	return visible;
+}
+
+// out must be the visible transforms in input order, the ones within tolerance of a plane may go either way
+static void CheckAgainstReference(const Frustum& frustum, const BoundingSphere& bounds, const std::vector<glm::mat4>& transforms,
+	const glm::mat4* out, u32 visible)
+{
+	u32 next = 0;
+	u32 mismatches = 0;
+	u32 near_plane = 0;
+	for (const glm::mat4& m : transforms)
+	{
+		bool culled_visible = next < visible && std::memcmp(&out[next], &m, sizeof(glm::mat4)) == 0;
+		if (culled_visible) next++;
+
+		f64 margin;
+		bool expected = ReferenceVisible(frustum, bounds, m, margin);
+		if (margin < 1e-3)
+		{
+			near_plane++;
+			continue;
+		}
+		if (culled_visible != expected) mismatches++;
+	}
+
+	LEO_CHECK(next == visible); // nothing written out of order or twice
+	LEO_CHECK(mismatches == 0);
+	LEO_CHECK(near_plane <= transforms.size() / 1000);
+}
+
+static void TestFrustum()
+{
+	Frustum frustum = CameraFrustum();
+	LEO_CHECK(frustum.IsVisible(glm::vec3(0.0f, 0.0f, -100.0f), 0.0f));
+	LEO_CHECK(!frustum.IsVisible(glm::vec3(20.0f, 5.0f, 100.0f), 1.0f));  // behind
+	LEO_CHECK(!frustum.IsVisible(glm::vec3(0.0f, 0.0f, -1000.0f), 1.0f)); // past the far plane
+	LEO_CHECK(frustum.IsVisible(glm::vec3(20.0f, 5.0f, 100.0f), INFINITY));
+
+	BoundingSphere box = BoundingSphere::FromAABB(glm::vec3(-1.0f, -2.0f, -3.0f), glm::vec3(1.0f, 2.0f, 3.0f));
+	LEO_CHECK(box.center == glm::vec3(0.0f) && std::abs(box.radius - std::sqrt(14.0f)) < 1e-5f);
+
+	f32 positions[] = { 0.0f, 0.0f, 0.0f, 9.0f, 2.0f, 2.0f, 2.0f, 9.0f };
+	BoundingSphere points = BoundingSphere::FromPositions(positions, 2, 4);
+	LEO_CHECK(points.center == glm::vec3(1.0f) && std::abs(points.radius - std::sqrt(3.0f)) < 1e-5f);
+}
+
+static void TestCuller(ThreadPool& pool)
+{
+	Frustum frustum = CameraFrustum();
+	BoundingSphere bounds{ glm::vec3(0.5f, -0.25f, 0.0f), 1.5f };
+
+	InstanceCuller culler;
+	std::vector<glm::mat4> out;
+
+	// empty input
+	LEO_CHECK(culler.Cull(frustum, bounds, {}, nullptr) == 0);
+	LEO_CHECK(culler.LastStats().tested == 0);
+
+	// counts around the 8 wide groups and the chunks, the scalar and AVX2 paths give the same bits with and without the pool
+	for (u32 count : { 1u, 7u, 9u, InstanceCuller::CHUNK_SIZE - 1, InstanceCuller::CHUNK_SIZE + 13, 100003u })
+	{
+		std::vector<glm::mat4> transforms = RandomTransforms(count, count);
+		out.assign(count, glm::mat4(0.0f));
+		std::vector<glm::mat4> scalar_out(count, glm::mat4(0.0f));
+
+		culler.SetThreadPool(nullptr);
+		culler.SetUseSimd(false);
+		u32 scalar_visible = culler.Cull(frustum, bounds, transforms, scalar_out.data());
+		LEO_CHECK(culler.LastStats().tested == count && culler.LastStats().visible == scalar_visible);
+		CheckAgainstReference(frustum, bounds, transforms, scalar_out.data(), scalar_visible);
+
+		for (ThreadPool* culler_pool : { (ThreadPool*)nullptr, &pool })
+		{
+			for (bool simd : { false, true })
+			{
+				culler.SetThreadPool(culler_pool);
+				culler.SetUseSimd(simd);
+				u32 visible = culler.Cull(frustum, bounds, transforms, out.data());
+				LEO_CHECK(visible == scalar_visible);
+				LEO_CHECK(std::memcmp(out.data(), scalar_out.data(), visible * sizeof(glm::mat4)) == 0);
+			}
+		}
+	}
+
+	// unknown bounds are never culled
+	std::vector<glm::mat4> transforms = RandomTransforms(1001, 3);
+	out.resize(transforms.size());
+	for (bool simd : { false, true })
+	{
+		culler.SetUseSimd(simd);
+		LEO_CHECK(culler.Cull(frustum, BoundingSphere{}, transforms, out.data()) == transforms.size());
+		LEO_CHECK(std::memcmp(out.data(), transforms.data(), transforms.size() * sizeof(glm::mat4)) == 0);
+	}
+}
+
+static void BenchCuller(ThreadPool& pool)
+{
+	constexpr u32 COUNT = 1000000;
+	Frustum frustum = CameraFrustum();
+	BoundingSphere bounds{ glm::vec3(0.0f), 1.0f };
+	std::vector<glm::mat4> transforms = RandomTransforms(COUNT, 1);
+	std::vector<glm::mat4> out(COUNT);
+
+	std::printf("Culling %u instances (AVX2 %s, %u workers), best of 5:\n", COUNT, InstanceCuller::HasAVX2() ? "yes" : "no", pool.ThreadCount());
+
+	InstanceCuller culler;
+	u32 reference_visible = 0;
+	for (ThreadPool* culler_pool : { (ThreadPool*)nullptr, &pool })
+	{
+		for (bool simd : { false, true })
+		{
+			if (simd && !InstanceCuller::HasAVX2()) continue;
+
+			culler.SetThreadPool(culler_pool);
+			culler.SetUseSimd(simd);
+			u32 visible = 0;
+			f32 ms = test::BestMillis(5, [&]() { visible = culler.Cull(frustum, bounds, transforms, out.data()); });
+
+			if (reference_visible == 0)
+			{
+				reference_visible = visible;
+				CheckAgainstReference(frustum, bounds, transforms, out.data(), visible);
+			}
+			LEO_CHECK(visible == reference_visible);
+
+			std::printf("  %-6s %-9s %7.2f ms  %6.1f M instances/s  (%u visible)\n",
+				simd ? "AVX2" : "scalar", culler_pool ? "pool" : "1 thread", ms, COUNT / ms / 1000.0f, visible);
+		}
+	}
+}
+
+int main()
+{
+	ThreadPool pool;
+
+	TestFrustum();
+	TestCuller(pool);
+	BenchCuller(pool);
+
+	return test::Result("CullingTests");
+}
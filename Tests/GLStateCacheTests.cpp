@@ -0,0 +1,171 @@
+#include <glad/glad.h>
+#include <LEO/Graphics/GLBackend.h>
+#include <LEO/Graphics/GLStateCache.h>
+#include <LEO/Graphics/Mesh.h>
+#include <LEO/Graphics/Shader.h>
+#include <LEO/Graphics/Texture.h>
+#include "LeoTest.h"
+
+using namespace leo;
+
+// The GL calls of a frame, by kind
+struct FrameCalls
+{
+	u64 useProgram = 0;
+	u64 bindVertexArray = 0;
+	u64 bindBuffer = 0;
+	u64 activeTexture = 0;
+	u64 bindTexture = 0;
+	u64 enable = 0;
+	u64 disable = 0;
+	u64 depthFunc = 0;
+	u64 draws = 0;
+
+	u64 StateCalls() const { return useProgram + bindVertexArray + bindBuffer + activeTexture + bindTexture + enable + disable + depthFunc; }
+	bool operator==(const FrameCalls&) const = default;
+};
+
+static FrameCalls CountCalls()
+{
+	const GLCallCounts& counts = GetMockGLCallCounts();
+	FrameCalls calls;
+	calls.useProgram = counts[GLFunction::UseProgram];
+	calls.bindVertexArray = counts[GLFunction::BindVertexArray];
+	calls.bindBuffer = counts[GLFunction::BindBuffer];
+	calls.activeTexture = counts[GLFunction::ActiveTexture];
+	calls.bindTexture = counts[GLFunction::BindTexture];
+	calls.enable = counts[GLFunction::Enable];
+	calls.disable = counts[GLFunction::Disable];
+	calls.depthFunc = counts[GLFunction::DepthFunc];
+	calls.draws = counts[GLFunction::DrawElements];
+	return calls;
+}
+
+static void PrintCalls(const char* name, const FrameCalls& calls)
+{
+	std::printf("  %-22s program %3llu  vao %3llu  buffer %3llu  unit %3llu  texture %3llu  enable %3llu  disable %3llu  depth %3llu  draws %3llu\n", name,
+		(unsigned long long)calls.useProgram, (unsigned long long)calls.bindVertexArray, (unsigned long long)calls.bindBuffer,
+		(unsigned long long)calls.activeTexture, (unsigned long long)calls.bindTexture, (unsigned long long)calls.enable,
+		(unsigned long long)calls.disable, (unsigned long long)calls.depthFunc, (unsigned long long)calls.draws);
+}
+
+struct Scene
+{
+	ShaderProgram shader{ "vertex", "fragment" };
+	Mesh meshes[2] = { Mesh::GenerateCube(), Mesh::GenerateQuad() };
+	Texture textures[2] = { Texture(4, 4), Texture(4, 4) };
+};
+
+constexpr u32 OBJECTS_PER_BATCH = 8;
+constexpr u32 OBJECTS = 2 * 2 * OBJECTS_PER_BATCH;
+
+// Sorted by mesh then texture like a render queue would, every object sets all of its state
+static FrameCalls DrawFrame(const Scene& scene)
+{
+	GLStateCache& cache = GetGLStateCache();
+	ResetMockGLCallCounts();
+	cache.ResetStats();
+
+	for (const Mesh& mesh : scene.meshes)
+	{
+		for (const Texture& texture : scene.textures)
+		{
+			for (u32 i = 0; i < OBJECTS_PER_BATCH; i++)
+			{
+				scene.shader.Bind();
+				cache.SetEnabled(GL_DEPTH_TEST, true);
+				cache.SetEnabled(GL_BLEND, false);
+				cache.DepthFunc(GL_LESS);
+				texture.Bind(0);
+				mesh.Draw();
+			}
+		}
+	}
+	return CountCalls();
+}
+
+// State changed behind the cache's back, e.g. by a UI library
+static void ExternalCalls()
+{
+	glUseProgram(0);
+	glBindVertexArray(0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+}
+
+static void TestDrawSequence(const Scene& scene)
+{
+	GLStateCache& cache = GetGLStateCache();
+	std::printf("GLStateCache, %u draws of 2 meshes x 2 textures, GL calls per frame:\n", OBJECTS);
+
+	// every call issued
+	cache.SetBypass(true);
+	const FrameCalls bypassed = DrawFrame(scene);
+	PrintCalls("bypassed", bypassed);
+	LEO_CHECK(bypassed == FrameCalls({ OBJECTS, OBJECTS, OBJECTS, OBJECTS, OBJECTS, OBJECTS, OBJECTS, OBJECTS, OBJECTS }));
+	LEO_CHECK(cache.Stats().skipped == 0 && cache.Stats().issued == bypassed.StateCalls());
+	cache.SetBypass(false);
+
+	// from unknown state: everything once, then only the changes.
+	// The element buffer is part of the vertex array, it is bound again after each vertex array change
+	cache.Invalidate();
+	const FrameCalls first = DrawFrame(scene);
+	PrintCalls("cached, first frame", first);
+	LEO_CHECK(first == FrameCalls({ 1, 2, 2, 1, 4, 1, 1, 1, OBJECTS }));
+	LEO_CHECK(cache.Stats().issued == first.StateCalls() && cache.Stats().skipped > 0);
+
+	// the program, capabilities, depth function and texture unit are still set from the last frame
+	const FrameCalls second = DrawFrame(scene);
+	PrintCalls("cached, next frame", second);
+	LEO_CHECK(second == FrameCalls({ 0, 2, 2, 0, 4, 0, 0, 0, OBJECTS }));
+
+	// without Invalidate the cache still believes the old state and skips the calls that would fix it
+	ExternalCalls();
+	const FrameCalls stale = DrawFrame(scene);
+	LEO_CHECK(stale.useProgram == 0 && stale.enable == 0 && stale.disable == 0);
+
+	// after Invalidate everything is bound again, like the first frame
+	ExternalCalls();
+	cache.Invalidate();
+	const FrameCalls invalidated = DrawFrame(scene);
+	PrintCalls("cached, invalidated", invalidated);
+	LEO_CHECK(invalidated == first);
+
+	// an unknown capability is queried once, then known
+	cache.Invalidate();
+	ResetMockGLCallCounts();
+	cache.IsEnabled(GL_CULL_FACE);
+	cache.IsEnabled(GL_CULL_FACE);
+	LEO_CHECK(GetMockGLCallCounts()[GLFunction::IsEnabled] == 1);
+}
+
+static void TestDeletedObjects()
+{
+	// a deleted object is unbound by GL, a new object can reuse its id and must be bound again
+	GLStateCache& cache = GetGLStateCache();
+	cache.Invalidate();
+	cache.UseProgram(7);
+	cache.BindTextureUnit(3, GL_TEXTURE_2D, 9);
+	cache.DeleteProgram(7);
+	cache.DeleteTexture(9);
+
+	ResetMockGLCallCounts();
+	cache.UseProgram(7);
+	cache.BindTextureUnit(3, GL_TEXTURE_2D, 9);
+	LEO_CHECK(GetMockGLCallCounts()[GLFunction::UseProgram] == 1);
+	LEO_CHECK(GetMockGLCallCounts()[GLFunction::BindTexture] == 1);
+}
+
+int main()
+{
+	InstallMockGLBackend();
+	{
+		Scene scene;
+		TestDrawSequence(scene);
+		TestDeletedObjects();
+	}
+	RestoreGLBackend();
+
+	return test::Result("GLStateCacheTests");
+}
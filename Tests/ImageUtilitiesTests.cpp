@@ -0,0 +1,248 @@
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+#include <stb/stb_image_write.h>
+#include <LEO/Utilities/LeoFileUtilities.h>
+#include <LEO/Utilities/LeoImageUtilities.h>
+#include <LEO/Utilities/LeoThreadPool.h>
+#include "LeoTest.h"
+
+using namespace leo;
+
+// One pixel at a time, what ExpandToRGBA8 must give whatever path it takes
+static void ExpandReference(const u8* src, u32 channels, u8* dst, u64 count)
+{
+	for (u64 i = 0; i < count; i++, src += channels, dst += 4)
+	{
+		switch (channels)
+		{
+		case 1: dst[0] = dst[1] = dst[2] = src[0]; dst[3] = 255; break;
+		case 2: dst[0] = dst[1] = dst[2] = src[0]; dst[3] = src[1]; break;
+		case 3: dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2]; dst[3] = 255; break;
+		case 4: std::memcpy(dst, src, 4); break;
+		}
+	}
+}
+
+static std::vector<u8> RandomBytes(u64 count, u32 seed)
+{
+	std::mt19937 rng(seed);
+	std::vector<u8> bytes(count);
+	for (u8& b : bytes) b = (u8)rng();
+	return bytes;
+}
+
+static void TestExpand()
+{
+	// every count up to a few SIMD blocks (16 pixels, 18 needed for RGB), from unaligned sources,
+	// nothing written past count pixels
+	constexpr u64 GUARD = 64;
+	u32 mismatches = 0;
+	u32 overruns = 0;
+
+	for (u32 channels = 1; channels <= 4; channels++)
+	{
+		for (u64 count = 0; count <= 80; count++)
+		{
+			for (u64 offset = 0; offset < 4; offset++)
+			{
+				std::vector<u8> src = RandomBytes(offset + count * channels, (u32)(channels * 1000 + count * 4 + offset));
+				std::vector<u8> expected(count * 4);
+				std::vector<u8> dst(count * 4 + GUARD, 0xCD);
+
+				ExpandReference(src.data() + offset, channels, expected.data(), count);
+				ExpandToRGBA8(src.data() + offset, channels, dst.data(), count);
+
+				if (std::memcmp(dst.data(), expected.data(), expected.size()) != 0) mismatches++;
+				for (u64 i = expected.size(); i < dst.size(); i++) if (dst[i] != 0xCD) { overruns++; break; }
+			}
+		}
+	}
+	LEO_CHECK(mismatches == 0);
+	LEO_CHECK(overruns == 0);
+
+	// a long run
+	for (u32 channels = 1; channels <= 4; channels++)
+	{
+		const u64 count = 100003;
+		std::vector<u8> src = RandomBytes(count * channels, channels);
+		std::vector<u8> expected(count * 4);
+		std::vector<u8> dst(count * 4);
+		ExpandReference(src.data(), channels, expected.data(), count);
+		ExpandToRGBA8(src.data(), channels, dst.data(), count);
+		LEO_CHECK(dst == expected);
+	}
+}
+
+static void TestFlip()
+{
+	for (u64 row_bytes : { 1, 3, 4, 15, 16, 17, 31, 32, 33, 48, 100, 2049 })
+	{
+		for (u32 rows : { 0, 1, 2, 3, 4, 7, 8, 9 })
+		{
+			std::vector<u8> pixels = RandomBytes(row_bytes * rows, (u32)(row_bytes * 16 + rows));
+			std::vector<u8> expected(pixels.size());
+			for (u32 y = 0; y < rows; y++)
+			{
+				std::memcpy(expected.data() + y * row_bytes, pixels.data() + (rows - 1 - y) * row_bytes, row_bytes);
+			}
+
+			FlipRowsVertically(pixels.data(), row_bytes, rows);
+			LEO_CHECK(pixels == expected);
+		}
+	}
+}
+
+static void TestMips()
+{
+	LEO_CHECK(MipLevelCount(1, 1) == 1);
+	LEO_CHECK(MipLevelCount(256, 64) == 9);
+	LEO_CHECK(MipLevelCount(5, 3) == 3);
+	LEO_CHECK(MipLevelSize(5, 1) == 2 && MipLevelSize(5, 2) == 1 && MipLevelSize(5, 7) == 1);
+
+	// a flat color stays flat down the chain, in both color spaces
+	std::vector<u8> rgba(37 * 20 * 4);
+	for (u64 i = 0; i < rgba.size(); i += 4) { rgba[i] = 200; rgba[i + 1] = 100; rgba[i + 2] = 7; rgba[i + 3] = 128; }
+	for (bool srgb : { false, true })
+	{
+		std::vector<std::vector<u8>> levels = GenerateMipChain(rgba.data(), 37, 20, srgb);
+		LEO_CHECK_OR_RETURN(levels.size() == MipLevelCount(37, 20) - 1);
+		for (u32 level = 1; level <= levels.size(); level++)
+		{
+			const std::vector<u8>& pixels = levels[level - 1];
+			LEO_CHECK(pixels.size() == (u64)MipLevelSize(37, level) * MipLevelSize(20, level) * 4);
+			bool flat = true;
+			for (u64 i = 0; i < pixels.size(); i++) flat &= pixels[i] == rgba[i % 4];
+			LEO_CHECK(flat);
+		}
+	}
+}
+
+// Smooth gradients with some noise, so the PNGs compress like pictures do
+static std::vector<u8> MakePixels(u32 width, u32 height, u32 channels, u32 seed)
+{
+	std::mt19937 rng(seed);
+	std::vector<u8> pixels((u64)width * height * channels);
+	for (u32 y = 0; y < height; y++)
+	{
+		for (u32 x = 0; x < width; x++)
+		{
+			for (u32 c = 0; c < channels; c++)
+			{
+				pixels[((u64)y * width + x) * channels + c] = (u8)((x * (c + 1) + y * (3 - c) + seed) / 2 + (rng() & 7));
+			}
+		}
+	}
+	return pixels;
+}
+
+static void TestAndBenchBatch(ThreadPool& pool)
+{
+	struct File
+	{
+		std::string path;
+		u32 width;
+		u32 height;
+		u32 channels;
+		std::vector<u8> pixels;
+	};
+
+	// every channel count, odd widths for the SIMD tails, PNG and TGA
+	const std::filesystem::path dir = std::filesystem::temp_directory_path();
+	std::vector<File> files;
+	for (u32 i = 0; i < 32; i++)
+	{
+		File file;
+		file.channels = i % 4 + 1;
+		file.width = i % 3 == 0 ? 509 : 512;
+		file.height = i % 5 == 0 ? 301 : 512;
+		file.pixels = MakePixels(file.width, file.height, file.channels, i);
+
+		bool tga = i % 8 == 7;
+		file.path = (dir / ("LeoImageBatch" + std::to_string(i) + (tga ? ".tga" : ".png"))).string();
+		int written = tga
+			? stbi_write_tga(file.path.c_str(), file.width, file.height, file.channels, file.pixels.data())
+			: stbi_write_png(file.path.c_str(), file.width, file.height, file.channels, file.pixels.data(), file.width * file.channels);
+		LEO_CHECK_OR_RETURN(written != 0);
+		files.push_back(std::move(file));
+	}
+
+	std::vector<std::string> paths;
+	for (const File& file : files) paths.push_back(file.path);
+
+	std::printf("ReadImageDataBatch, %zu files (%u workers), best of 3:\n", paths.size(), pool.ThreadCount());
+
+	std::vector<ImageData> reference;
+	for (ThreadPool* batch_pool : { (ThreadPool*)nullptr, &pool })
+	{
+		ImageBatchStats best;
+		test::BestMillis(3, [&]() {
+			ImageBatchStats stats;
+			std::vector<ImageData> images = ReadImageDataBatch(paths, batch_pool, &stats);
+			if (best.ms == 0.0f || stats.ms < best.ms) best = stats;
+			if (reference.empty()) reference = std::move(images);
+		});
+
+		LEO_CHECK(best.images == paths.size() && best.failed == 0);
+		std::printf("  %-8s %8.2f ms  %7.1f MB/s  %6.1f Mpixels/s\n",
+			batch_pool ? "pool" : "1 thread", best.ms, best.MBPerSecond(), best.MegapixelsPerSecond());
+	}
+
+	// RGBA8 with the bottom row first, in the order of the paths
+	LEO_CHECK_OR_RETURN(reference.size() == files.size());
+	for (u64 i = 0; i < files.size(); i++)
+	{
+		const File& file = files[i];
+		const ImageData& image = reference[i];
+		LEO_CHECK_OR_RETURN(image.data && image.width == (i32)file.width && image.height == (i32)file.height && image.bpp == 4);
+
+		std::vector<u8> expected((u64)file.width * file.height * 4);
+		for (u32 y = 0; y < file.height; y++)
+		{
+			ExpandReference(file.pixels.data() + (u64)y * file.width * file.channels, file.channels,
+				expected.data() + (u64)(file.height - 1 - y) * file.width * 4, file.width);
+		}
+		LEO_CHECK(std::memcmp(image.data.get(), expected.data(), expected.size()) == 0);
+	}
+
+	// a missing file is given the fallback, the others are still read
+	std::vector<std::string> with_missing = { paths[0], (dir / "LeoImageBatchMissing.png").string(), paths[1] };
+	ImageBatchStats stats;
+	std::vector<ImageData> images = ReadImageDataBatch(with_missing, &pool, &stats);
+	ImageData fallback = FallbackImageData();
+	LEO_CHECK(stats.images == 3 && stats.failed == 1);
+	LEO_CHECK(images[1].width == fallback.width && images[1].height == fallback.height);
+	LEO_CHECK(images[2].width == (i32)files[1].width && images[2].height == (i32)files[1].height);
+
+	for (const File& file : files) std::filesystem::remove(file.path);
+}
+
+static void BenchExpand()
+{
+	constexpr u64 COUNT = 4 << 20;
+	std::printf("ExpandToRGBA8, %llu pixels (SSSE3 %s), best of 5:\n", (unsigned long long)COUNT, HasSSSE3() ? "yes" : "no");
+
+	std::vector<u8> dst(COUNT * 4);
+	for (u32 channels = 1; channels <= 4; channels++)
+	{
+		std::vector<u8> src = RandomBytes(COUNT * channels, channels);
+		f32 reference_ms = test::BestMillis(5, [&]() { ExpandReference(src.data(), channels, dst.data(), COUNT); });
+		f32 ms = test::BestMillis(5, [&]() { ExpandToRGBA8(src.data(), channels, dst.data(), COUNT); });
+		std::printf("  %u channels: %6.2f ms, one pixel at a time %6.2f ms (%.1fx)\n", channels, ms, reference_ms, reference_ms / ms);
+	}
+}
+
+int main()
+{
+	ThreadPool pool;
+
+	TestExpand();
+	TestFlip();
+	TestMips();
+	TestAndBenchBatch(pool);
+	BenchExpand();
+
+	return test::Result("ImageUtilitiesTests");
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdio>
+#include <algorithm>
+#include <LEO/Utilities/LeoTypes.h>
+#include <LEO/Utilities/LeoTimer.h>
+
+// Each test is an executable run by ctest: the checks print what failed and main returns Result().
+// The benchmarks in them print their timings, run the executable directly (or ctest -V) to read them.
+
+namespace leo::test
+{
+	inline u32& Failures()
+	{
+		static u32 s_failures = 0;
+		return s_failures;
+	}
+
+	// Best time of runs calls of func, in milliseconds
+	template<typename Func>
+	f32 BestMillis(u32 runs, Func&& func)
+	{
+		f32 best = 0.0f;
+		for (u32 i = 0; i < runs; i++)
+		{
+			Timer timer;
+			func();
+			f32 ms = timer.ElapsedMillis();
+			best = i == 0 ? ms : std::min(best, ms);
+		}
+		return best;
+	}
+
+	// The exit code of a test
+	inline int Result(const char* name)
+	{
+		if (Failures() == 0) std::printf("%s: passed\n", name);
+		else std::printf("%s: %u checks failed\n", name, Failures());
+		return Failures() == 0 ? 0 : 1;
+	}
+}
+
+#define LEO_CHECK(x) \
+	do { if (!(x)) { leo::test::Failures()++; std::printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #x); } } while (0)
+
+// Stops at the first failure, for checks run over many values
+#define LEO_CHECK_OR_RETURN(x, ...) \
+	do { if (!(x)) { LEO_CHECK(x); return __VA_ARGS__; } } while (0)
@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <LEO/Graphics/GLBackend.h>
+#include <LEO/Graphics/MeshFile.h>
+#include <LEO/Graphics/ObjImporter.h>
+#include <LEO/Utilities/LeoFileUtilities.h>
+#include <LEO/Utilities/LeoThreadPool.h>
+#include "LeoTest.h"
+#include "SyntheticMesh.h"
+
+using namespace leo;
+
+// Load time of a .leomesh against importing the same mesh from OBJ text.
+// The files are written to the temp directory first, so both are read from a warm page cache
+
+static const ElementType VERTEX_LAYOUT[] = { ElementType::FLOAT3, ElementType::FLOAT2, ElementType::FLOAT3_N };
+
+static bool WriteText(const std::string& filepath, const std::string& text)
+{
+	std::ofstream file(filepath, std::ios::binary);
+	file.write(text.data(), (std::streamsize)text.size());
+	return (bool)file;
+}
+
+static bool WriteLeoMesh(const std::string& filepath, const ObjMeshData& data)
+{
+	std::span<const u8> vertices(reinterpret_cast<const u8*>(data.vertices.data()), data.vertices.size() * sizeof(Vertex));
+	BoundingSphere bounds = BoundingSphere::FromPositions(&data.vertices[0].pos.x, (u32)data.vertices.size(), 8);
+	return WriteMeshFile(filepath, VERTEX_LAYOUT, vertices, data.indices, bounds);
+}
+
+// The file holds the imported blobs unchanged, the indices in 16 bits when they fit
+static void CheckRoundTrip(const std::string& filepath, const ObjMeshData& data)
+{
+	MappedFile file(filepath);
+	LEO_CHECK_OR_RETURN(file.IsOpen());
+	LEO_CHECK_OR_RETURN(ValidateMeshFile(file.Bytes()).empty());
+
+	MeshFileView view = ViewMeshFile(file.Bytes());
+	LEO_CHECK(view.header->vertexCount == data.vertices.size() && view.header->indexCount == data.indices.size());
+	LEO_CHECK(view.layout.size() == std::size(VERTEX_LAYOUT) && std::equal(view.layout.begin(), view.layout.end(), VERTEX_LAYOUT));
+	LEO_CHECK(view.vertices.size() == data.vertices.size() * sizeof(Vertex));
+	LEO_CHECK(std::memcmp(view.vertices.data(), data.vertices.data(), view.vertices.size()) == 0);
+
+	const u32 expected_index_size = data.vertices.size() <= 0xFFFF ? sizeof(u16) : sizeof(u32);
+	LEO_CHECK_OR_RETURN(view.header->indexSize == expected_index_size);
+	u32 mismatches = 0;
+	for (u64 i = 0; i < data.indices.size(); i++)
+	{
+		u32 index = 0;
+		std::memcpy(&index, view.indices.data() + i * expected_index_size, expected_index_size);
+		if (index != data.indices[i]) mismatches++;
+	}
+	LEO_CHECK(mismatches == 0);
+
+	// a truncated file is rejected
+	LEO_CHECK(!ValidateMeshFile(file.Bytes().first(file.Bytes().size() - 1)).empty());
+}
+
+// Out of range indices are never written, and a file corrupted after writing does not load
+static void CheckRejected(const std::string& filepath, const ObjMeshData& data)
+{
+	const std::string bad_path = filepath + ".bad";
+	std::span<const u8> vertices(reinterpret_cast<const u8*>(data.vertices.data()), data.vertices.size() * sizeof(Vertex));
+	std::vector<u32> indices = data.indices;
+	indices[indices.size() / 2] = (u32)data.vertices.size();
+	LEO_CHECK(!WriteMeshFile(bad_path, VERTEX_LAYOUT, vertices, indices));
+	LEO_CHECK(!std::filesystem::exists(bad_path) && !std::filesystem::exists(bad_path + ".tmp"));
+
+	// the last index of a valid file overwritten, the header still describes the file
+	std::vector<u8> bytes(std::filesystem::file_size(filepath));
+	{
+		std::ifstream file(filepath, std::ios::binary);
+		file.read(reinterpret_cast<char*>(bytes.data()), (std::streamsize)bytes.size());
+	}
+	std::memset(bytes.data() + bytes.size() - ViewMeshFile(bytes).header->indexSize, 0xFF, ViewMeshFile(bytes).header->indexSize);
+	LEO_CHECK(ValidateMeshFile(bytes, false).empty());
+	LEO_CHECK(!ValidateMeshFile(bytes).empty());
+	{
+		std::ofstream file(bad_path, std::ios::binary);
+		file.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize)bytes.size());
+	}
+	LEO_CHECK(!std::isfinite(Mesh::Load(bad_path).GetBounds().radius)); // the empty mesh
+	LEO_CHECK(std::isfinite(Mesh::Load(filepath).GetBounds().radius));
+	std::filesystem::remove(bad_path);
+}
+
+int main()
+{
+	ThreadPool pool;
+	const std::filesystem::path dir = std::filesystem::temp_directory_path();
+	const std::string obj_path = (dir / "LeoMeshFileBench.obj").string();
+	const std::string mesh_path = (dir / "LeoMeshFileBench.leomesh").string();
+	const std::string small_mesh_path = (dir / "LeoMeshFileBenchSmall.leomesh").string();
+
+	// 16 bit indices
+	{
+		ObjMeshData small = ImportObj(test::GenerateObjSphere(16, 32));
+		LEO_CHECK(small.error.empty() && small.vertices.size() == 17 * 33);
+		LEO_CHECK(WriteLeoMesh(small_mesh_path, small));
+		CheckRoundTrip(small_mesh_path, small);
+	}
+
+	// 32 bit indices, about 260k triangles
+	const std::string text = test::GenerateObjSphere(256, 512);
+	LEO_CHECK(WriteText(obj_path, text));
+	ObjMeshData data = ImportObj(text, &pool);
+	LEO_CHECK_OR_RETURN(data.error.empty(), 1);
+	LEO_CHECK(data.vertices.size() == 257 * 513 && data.indices.size() == 256 * 512 * 6);
+	LEO_CHECK(WriteLeoMesh(mesh_path, data));
+	CheckRoundTrip(mesh_path, data);
+
+	const f64 obj_mb = (f64)std::filesystem::file_size(obj_path) / (1024.0 * 1024.0);
+	const f64 mesh_mb = (f64)std::filesystem::file_size(mesh_path) / (1024.0 * 1024.0);
+	std::printf("%zu vertices, %zu triangles: OBJ %.1f MB, .leomesh %.1f MB (%u workers), best of 5:\n",
+		data.vertices.size(), data.indices.size() / 3, obj_mb, mesh_mb, pool.ThreadCount());
+
+	// CPU side: parsing the text against mapping and validating the file
+	f32 parse_ms = test::BestMillis(5, [&]() { LEO_CHECK(ImportObjFile(obj_path).error.empty()); });
+	f32 parse_pool_ms = test::BestMillis(5, [&]() { LEO_CHECK(ImportObjFile(obj_path, &pool).error.empty()); });
+	f32 map_ms = test::BestMillis(5, [&]() {
+		MappedFile file(mesh_path);
+		LEO_CHECK(ValidateMeshFile(file.Bytes(), false).empty());
+		LEO_CHECK(ViewMeshFile(file.Bytes()).vertices.size() == data.vertices.size() * sizeof(Vertex));
+	});
+	f32 map_checked_ms = test::BestMillis(5, [&]() {
+		MappedFile file(mesh_path);
+		LEO_CHECK(ValidateMeshFile(file.Bytes(), true).empty());
+	});
+	// what an upload reads from the mapped pages, the mock backend below does not
+	f32 map_read_ms = test::BestMillis(5, [&]() {
+		MappedFile file(mesh_path);
+		u64 sum = 0;
+		for (u64 i = 0; i + sizeof(u64) <= file.Bytes().size(); i += sizeof(u64))
+		{
+			u64 word;
+			std::memcpy(&word, file.Bytes().data() + i, sizeof(u64));
+			sum += word;
+		}
+		LEO_CHECK(sum != 0);
+	});
+
+	std::printf("  OBJ import, 1 thread          %8.2f ms  %7.1f MB/s\n", parse_ms, obj_mb / (parse_ms / 1000.0));
+	std::printf("  OBJ import, pool              %8.2f ms  %7.1f MB/s\n", parse_pool_ms, obj_mb / (parse_pool_ms / 1000.0));
+	std::printf("  .leomesh map + validate       %8.2f ms\n", map_ms);
+	std::printf("  .leomesh map + index check    %8.2f ms\n", map_checked_ms);
+	std::printf("  .leomesh map + read all       %8.2f ms  (%.0fx faster than the pooled import)\n", map_read_ms, parse_pool_ms / map_read_ms);
+
+	// Mesh::LoadObj against Mesh::Load, the GL calls go to the mock backend (no upload cost)
+	InstallMockGLBackend();
+	{
+		CheckRejected(small_mesh_path, ImportObj(test::GenerateObjSphere(16, 32)));
+
+		f32 load_obj_ms = test::BestMillis(5, [&]() { LEO_CHECK(std::isfinite(Mesh::LoadObj(obj_path, &pool).GetBounds().radius)); });
+		f32 load_ms = test::BestMillis(5, [&]() { LEO_CHECK(std::isfinite(Mesh::Load(mesh_path).GetBounds().radius)); });
+
+		std::printf("  Mesh::LoadObj, pool           %8.2f ms\n", load_obj_ms);
+		std::printf("  Mesh::Load (index check)      %8.2f ms  (pages not read by the mock)\n", load_ms);
+	}
+	RestoreGLBackend();
+
+	for (const std::string& path : { obj_path, mesh_path, small_mesh_path }) {
+		std::filesystem::remove(path);
+	}
+
+	return test::Result("MeshFileBench");
+}
@@ -0,0 +1,256 @@
+#include <cstring>
+#include <map>
+#include <vector>
+#include <glad/glad.h>
+#include <LEO/Graphics/GLBackend.h>
+#include <LEO/Graphics/GLStateCache.h>
+#include <LEO/Graphics/Mesh.h>
+#include "LeoTest.h"
+
+using namespace leo;
+
+// ---------------- Buffer memory behind the mock backend ----------------
+// The hooks keep a copy of what would be in each GL buffer and where each attribute points,
+// an orphaned or newly allocated buffer is filled with garbage
+
+static constexpr u8 GARBAGE = 0xCD;
+
+struct Attribute
+{
+	u32 buffer;
+	i32 size;
+	u32 stride;
+	u64 offset;
+	u32 divisor;
+};
+
+static std::map<u32, std::vector<u8>> s_buffers;
+static std::map<u32, u32> s_bound;                          // by target
+static u32 s_vertexArray = 0;
+static std::map<std::pair<u32, u32>, Attribute> s_attributes; // by (vertex array, index)
+static std::vector<i32> s_instancedDraws;                    // instance count of each instanced draw
+
+static PFNGLGENBUFFERSPROC s_genBuffers;
+static PFNGLDELETEBUFFERSPROC s_deleteBuffers;
+static PFNGLBINDBUFFERPROC s_bindBuffer;
+static PFNGLBUFFERDATAPROC s_bufferData;
+static PFNGLBUFFERSUBDATAPROC s_bufferSubData;
+static PFNGLCOPYBUFFERSUBDATAPROC s_copyBufferSubData;
+static PFNGLBINDVERTEXARRAYPROC s_bindVertexArray;
+static PFNGLVERTEXATTRIBPOINTERPROC s_vertexAttribPointer;
+static PFNGLVERTEXATTRIBDIVISORPROC s_vertexAttribDivisor;
+static PFNGLDRAWELEMENTSINSTANCEDPROC s_drawElementsInstanced;
+
+static void APIENTRY GenBuffers(GLsizei n, GLuint* buffers)
+{
+	s_genBuffers(n, buffers);
+	for (GLsizei i = 0; i < n; i++) s_buffers[buffers[i]].clear();
+}
+
+static void APIENTRY DeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+	s_deleteBuffers(n, buffers);
+	for (GLsizei i = 0; i < n; i++) s_buffers.erase(buffers[i]);
+}
+
+static void APIENTRY BindBuffer(GLenum target, GLuint buffer)
+{
+	s_bindBuffer(target, buffer);
+	s_bound[target] = buffer;
+}
+
+static void APIENTRY BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+	s_bufferData(target, size, data, usage);
+	std::vector<u8>& bytes = s_buffers[s_bound[target]];
+	bytes.assign(size, GARBAGE);
+	if (data != nullptr) std::memcpy(bytes.data(), data, size);
+}
+
+static void APIENTRY BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+	s_bufferSubData(target, offset, size, data);
+	std::vector<u8>& bytes = s_buffers[s_bound[target]];
+	LEO_CHECK_OR_RETURN(offset >= 0 && offset + size <= (GLsizeiptr)bytes.size());
+	std::memcpy(bytes.data() + offset, data, size);
+}
+
+static void APIENTRY CopyBufferSubData(GLenum read_target, GLenum write_target, GLintptr read_offset, GLintptr write_offset, GLsizeiptr size)
+{
+	s_copyBufferSubData(read_target, write_target, read_offset, write_offset, size);
+	const std::vector<u8>& src = s_buffers[s_bound[read_target]];
+	std::vector<u8>& dst = s_buffers[s_bound[write_target]];
+	LEO_CHECK_OR_RETURN(read_offset + size <= (GLsizeiptr)src.size() && write_offset + size <= (GLsizeiptr)dst.size());
+	std::memcpy(dst.data() + write_offset, src.data() + read_offset, size);
+}
+
+static void APIENTRY BindVertexArray(GLuint array)
+{
+	s_bindVertexArray(array);
+	s_vertexArray = array;
+}
+
+static void APIENTRY VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer)
+{
+	s_vertexAttribPointer(index, size, type, normalized, stride, pointer);
+	Attribute& attribute = s_attributes[{ s_vertexArray, index }];
+	attribute.buffer = s_bound[GL_ARRAY_BUFFER];
+	attribute.size = size;
+	attribute.stride = (u32)stride;
+	attribute.offset = (u64)pointer;
+}
+
+static void APIENTRY VertexAttribDivisor(GLuint index, GLuint divisor)
+{
+	s_vertexAttribDivisor(index, divisor);
+	s_attributes[{ s_vertexArray, index }].divisor = divisor;
+}
+
+static void APIENTRY DrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instance_count)
+{
+	s_drawElementsInstanced(mode, count, type, indices, instance_count);
+	s_instancedDraws.push_back(instance_count);
+}
+
+static void InstallHooks()
+{
+	s_genBuffers = glad_glGenBuffers;                 glad_glGenBuffers = GenBuffers;
+	s_deleteBuffers = glad_glDeleteBuffers;           glad_glDeleteBuffers = DeleteBuffers;
+	s_bindBuffer = glad_glBindBuffer;                 glad_glBindBuffer = BindBuffer;
+	s_bufferData = glad_glBufferData;                 glad_glBufferData = BufferData;
+	s_bufferSubData = glad_glBufferSubData;           glad_glBufferSubData = BufferSubData;
+	s_copyBufferSubData = glad_glCopyBufferSubData;   glad_glCopyBufferSubData = CopyBufferSubData;
+	s_bindVertexArray = glad_glBindVertexArray;       glad_glBindVertexArray = BindVertexArray;
+	s_vertexAttribPointer = glad_glVertexAttribPointer; glad_glVertexAttribPointer = VertexAttribPointer;
+	s_vertexAttribDivisor = glad_glVertexAttribDivisor; glad_glVertexAttribDivisor = VertexAttribDivisor;
+	s_drawElementsInstanced = glad_glDrawElementsInstanced; glad_glDrawElementsInstanced = DrawElementsInstanced;
+}
+
+// ---------------- Tests ----------------
+
+static glm::mat4 Transform(u32 i)
+{
+	return glm::mat4(glm::vec4((f32)i, 1, 2, 3), glm::vec4(4, 5, 6, 7), glm::vec4(8, 9, 10, 11), glm::vec4(12, 13, 14, (f32)-i));
+}
+
+// The first per instance attribute of a vertex array, the mat4 takes it and the next 3
+static u32 FirstInstanceAttribute(u32 vertex_array)
+{
+	for (const auto& [key, attribute] : s_attributes) {
+		if (key.first == vertex_array && attribute.divisor == 1) return key.second;
+	}
+	return 0xFFFFFFFF;
+}
+
+// The buffer the instance attributes of the mesh's vertex array read from, the attributes checked on the way
+static const std::vector<u8>* InstanceBuffer(u32 vertex_array)
+{
+	const u32 first = FirstInstanceAttribute(vertex_array);
+	u32 buffer = 0;
+	for (u32 column = 0; column < 4; column++)
+	{
+		auto it = s_attributes.find({ vertex_array, first + column });
+		if (it == s_attributes.end()) return nullptr;
+
+		// one tightly packed mat4 per instance, a column per attribute
+		const Attribute& attribute = it->second;
+		if (attribute.size != 4 || attribute.stride != sizeof(glm::mat4) || attribute.offset != column * sizeof(glm::vec4) || attribute.divisor != 1) return nullptr;
+		if (column > 0 && attribute.buffer != buffer) return nullptr;
+		buffer = attribute.buffer;
+	}
+	auto it = s_buffers.find(buffer);
+	return it != s_buffers.end() ? &it->second : nullptr;
+}
+
+// The first count instances of the buffer are transforms [0, count)
+static bool SameInstances(u32 vertex_array, const std::vector<glm::mat4>& transforms)
+{
+	const std::vector<u8>* buffer = InstanceBuffer(vertex_array);
+	return buffer != nullptr && buffer->size() >= transforms.size() * sizeof(glm::mat4) &&
+		std::memcmp(buffer->data(), transforms.data(), transforms.size() * sizeof(glm::mat4)) == 0;
+}
+
+static void TestInstancing()
+{
+	Mesh mesh = Mesh::GenerateCube();
+
+	// the vertex array the mesh binds
+	GetGLStateCache().Invalidate();
+	mesh.Bind();
+	const u32 vertex_array = s_vertexArray;
+	mesh.UnBind();
+
+	LEO_CHECK(!mesh.HasInstanceArray() && InstanceBuffer(vertex_array) == nullptr);
+
+	std::vector<glm::mat4> transforms;
+	for (u32 i = 0; i < 10; i++) transforms.push_back(Transform(i));
+	mesh.MakeInstancedArray(transforms.data(), 10);
+	LEO_CHECK(mesh.HasInstanceArray() && mesh.GetInstanceCapacity() == 10);
+	LEO_CHECK(mesh.GetUploadedInstanceCount() == 10 && mesh.GetInstanceCount() == 10);
+	LEO_CHECK(SameInstances(vertex_array, transforms));
+	LEO_CHECK(FirstInstanceAttribute(vertex_array) == 5); // after position, uv, normal, tangent and bitangent
+	const u32 first_buffer = s_attributes[{ vertex_array, FirstInstanceAttribute(vertex_array) }].buffer;
+
+	// appended past the capacity: a new buffer, the old instances copied on the GPU, the attributes moved to it
+	ResetMockGLCallCounts();
+	for (u32 i = 10; i < 15; i++) transforms.push_back(Transform(i));
+	mesh.UpdateInstances(std::span(transforms).subspan(10), 10);
+	LEO_CHECK(mesh.GetInstanceCapacity() == 15 && mesh.GetUploadedInstanceCount() == 15 && mesh.GetInstanceCount() == 15);
+	LEO_CHECK(GetMockGLCallCounts()[GLFunction::CopyBufferSubData] == 1);
+	LEO_CHECK(SameInstances(vertex_array, transforms));
+	LEO_CHECK(!s_buffers.contains(first_buffer)); // the old buffer is deleted
+
+	// one at a time: the capacity grows by 1.5x, a logarithmic number of reallocations
+	ResetMockGLCallCounts();
+	u32 reallocations = 0;
+	for (u32 i = 15; i < 1000; i++)
+	{
+		u32 capacity = mesh.GetInstanceCapacity();
+		transforms.push_back(Transform(i));
+		mesh.UpdateInstances(std::span(transforms).subspan(i), i);
+		reallocations += mesh.GetInstanceCapacity() != capacity;
+	}
+	LEO_CHECK(reallocations > 0 && reallocations <= 11);
+	LEO_CHECK(GetMockGLCallCounts()[GLFunction::CopyBufferSubData] == reallocations);
+	LEO_CHECK(mesh.GetInstanceCapacity() >= 1000 && mesh.GetInstanceCount() == 1000);
+	LEO_CHECK(SameInstances(vertex_array, transforms));
+
+	// a few instances in the middle: no reallocation, no orphaning, the rest is kept
+	ResetMockGLCallCounts();
+	transforms[500] = Transform(5000);
+	transforms[501] = Transform(5001);
+	mesh.UpdateInstances(std::span(transforms).subspan(500, 2), 500);
+	LEO_CHECK(GetMockGLCallCounts()[GLFunction::BufferData] == 0 && GetMockGLCallCounts()[GLFunction::BufferSubData] == 1);
+	LEO_CHECK(SameInstances(vertex_array, transforms) && mesh.GetInstanceCount() == 1000);
+
+	// every instance rewritten: the buffer is orphaned instead of waited on, nothing is copied
+	ResetMockGLCallCounts();
+	for (u32 i = 0; i < 1000; i++) transforms[i] = Transform(i + 7);
+	const u32 capacity = mesh.GetInstanceCapacity();
+	mesh.UpdateInstances(transforms);
+	LEO_CHECK(GetMockGLCallCounts()[GLFunction::BufferData] == 1 && GetMockGLCallCounts()[GLFunction::CopyBufferSubData] == 0);
+	LEO_CHECK(mesh.GetInstanceCapacity() == capacity && SameInstances(vertex_array, transforms));
+
+	// fewer drawn than uploaded (culling), the rest survives a reallocation
+	mesh.SetInstanceCount(300);
+	mesh.ReserveInstances(capacity * 2);
+	LEO_CHECK(mesh.GetInstanceCount() == 300 && mesh.GetUploadedInstanceCount() == 1000);
+	LEO_CHECK(SameInstances(vertex_array, transforms));
+
+	// draws use the drawn count, none when it is 0
+	s_instancedDraws.clear();
+	mesh.Draw();
+	mesh.SetInstanceCount(0);
+	mesh.Draw();
+	LEO_CHECK(s_instancedDraws == std::vector<i32>({ 300 }));
+}
+
+int main()
+{
+	InstallMockGLBackend();
+	InstallHooks();
+	TestInstancing();
+	RestoreGLBackend();
+
+	return test::Result("MeshInstancingTests");
+}
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+#include <LEO/Graphics/MeshOptimizer.h>
+#include <LEO/Graphics/ObjImporter.h>
+#include "LeoTest.h"
+#include "SyntheticMesh.h"
+
+using namespace leo;
+
+constexpr u32 STRIDE = 8; // position, uv, normal
+
+struct SyntheticMesh
+{
+	std::vector<f32> vertices;
+	std::vector<u32> indices;
+
+	u32 VertexCount() const { return (u32)(vertices.size() / STRIDE); }
+};
+
+// An imported UV sphere with its triangles shuffled and their corners rotated (the winding is kept),
+// the worst case for the vertex cache
+static SyntheticMesh ShuffledSphere(u32 rings, u32 segments, u32 seed)
+{
+	ObjMeshData data = ImportObj(test::GenerateObjSphere(rings, segments));
+	LEO_CHECK(data.error.empty());
+
+	SyntheticMesh mesh;
+	mesh.vertices.assign(&data.vertices[0].pos.x, &data.vertices[0].pos.x + data.vertices.size() * STRIDE);
+
+	std::vector<std::array<u32, 3>> triangles;
+	for (u64 i = 0; i + 2 < data.indices.size(); i += 3) triangles.push_back({ data.indices[i], data.indices[i + 1], data.indices[i + 2] });
+
+	std::mt19937 rng(seed);
+	std::shuffle(triangles.begin(), triangles.end(), rng);
+	for (std::array<u32, 3>& triangle : triangles)
+	{
+		std::rotate(triangle.begin(), triangle.begin() + rng() % 3, triangle.end());
+		mesh.indices.insert(mesh.indices.end(), triangle.begin(), triangle.end());
+	}
+	return mesh;
+}
+
+// A triangle as the contents of its 3 vertices, rotated to start at the smallest one: the same triangle
+// with the same winding gives the same value whatever its corner order and vertex indices
+using TriangleKey = std::array<std::array<f32, STRIDE>, 3>;
+
+static std::vector<TriangleKey> Triangles(const SyntheticMesh& mesh)
+{
+	std::vector<TriangleKey> triangles;
+	for (u64 i = 0; i + 2 < mesh.indices.size(); i += 3)
+	{
+		TriangleKey key;
+		for (u32 c = 0; c < 3; c++) std::copy_n(&mesh.vertices[(u64)mesh.indices[i + c] * STRIDE], STRIDE, key[c].begin());
+		std::rotate(key.begin(), std::min_element(key.begin(), key.end()), key.end());
+		triangles.push_back(key);
+	}
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+static void TestEachPass()
+{
+	const SyntheticMesh original = ShuffledSphere(32, 64, 1);
+	const std::vector<TriangleKey> triangles = Triangles(original);
+	const VertexCacheStats shuffled = AnalyzeVertexCache(original.indices, original.VertexCount());
+
+	// the vertex cache pass: same triangles, far fewer vertices transformed
+	SyntheticMesh mesh = original;
+	OptimizeVertexCache(mesh.indices, mesh.VertexCount());
+	const VertexCacheStats cached = AnalyzeVertexCache(mesh.indices, mesh.VertexCount());
+	LEO_CHECK(Triangles(mesh) == triangles);
+	LEO_CHECK(cached.acmr < shuffled.acmr * 0.5f && cached.atvr < shuffled.atvr * 0.5f);
+	LEO_CHECK(cached.acmr < 0.8f && cached.atvr < 1.6f);
+
+	// the overdraw pass trades at most the threshold of the cache efficiency
+	OptimizeOverdraw(mesh.indices, mesh.vertices.data(), mesh.VertexCount(), STRIDE);
+	const VertexCacheStats overdraw = AnalyzeVertexCache(mesh.indices, mesh.VertexCount());
+	LEO_CHECK(Triangles(mesh) == triangles);
+	LEO_CHECK(overdraw.transformed <= (u32)(cached.transformed * 1.05f) + 1);
+
+	// the vertex fetch pass: vertices in first use order, the unused one dropped, the triangles unchanged
+	const u32 unused = mesh.VertexCount();
+	mesh.vertices.insert(mesh.vertices.end(), STRIDE, 123.0f);
+	const u32 vertex_count = OptimizeVertexFetch(mesh.indices, mesh.vertices, STRIDE);
+	LEO_CHECK(vertex_count == unused && mesh.VertexCount() == unused);
+	LEO_CHECK(Triangles(mesh) == triangles);
+
+	u32 next = 0, out_of_order = 0;
+	for (u32 index : mesh.indices)
+	{
+		if (index == next) next++;
+		else if (index > next) out_of_order++;
+	}
+	LEO_CHECK(out_of_order == 0 && next == vertex_count);
+	LEO_CHECK(AnalyzeVertexCache(mesh.indices, vertex_count).transformed == overdraw.transformed); // only renamed
+
+	std::printf("MeshOptimizer, %u triangles, %u vertices:\n", (u32)original.indices.size() / 3, original.VertexCount());
+	std::printf("  shuffled      ACMR %.3f  ATVR %.3f\n", shuffled.acmr, shuffled.atvr);
+	std::printf("  vertex cache  ACMR %.3f  ATVR %.3f\n", cached.acmr, cached.atvr);
+	std::printf("  + overdraw    ACMR %.3f  ATVR %.3f\n", overdraw.acmr, overdraw.atvr);
+}
+
+static void TestOptimizeMesh()
+{
+	for (u32 seed = 2; seed < 5; seed++)
+	{
+		SyntheticMesh mesh = ShuffledSphere(16 * seed, 24 * seed, seed);
+		const std::vector<TriangleKey> triangles = Triangles(mesh);
+
+		MeshOptimizationReport report = OptimizeMesh(mesh.vertices, STRIDE, mesh.indices);
+		LEO_CHECK(Triangles(mesh) == triangles);
+		LEO_CHECK(report.after.acmr < report.before.acmr && report.after.atvr < report.before.atvr);
+		LEO_CHECK(report.verticesAfter == report.verticesBefore && report.shortIndices);
+		if (seed == 4) std::printf("  OptimizeMesh  %s\n", report.ToString().c_str());
+	}
+
+	// nothing to do
+	std::vector<f32> vertices;
+	std::vector<u32> indices;
+	MeshOptimizationReport report = OptimizeMesh(vertices, STRIDE, indices);
+	LEO_CHECK(indices.empty() && report.verticesAfter == 0 && report.after.transformed == 0);
+}
+
+int main()
+{
+	TestEachPass();
+	TestOptimizeMesh();
+
+	return test::Result("MeshOptimizerTests");
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <LEO/Graphics/GLBackend.h>
+
+// Active uniforms for the programs created under the mock GL backend, so ShaderProgram reflects them.
+// The hooks forward to the mock entries first, the calls are still counted (and traced).
+// Call SetMockUniforms after InstallMockGLBackend, RestoreGLBackend removes the hooks.
+
+namespace leo::test
+{
+	struct MockUniform
+	{
+		std::string name;
+		u32 type; // GL_FLOAT, GL_FLOAT_MAT4, ...
+	};
+
+	// Every program reports these, the location of a uniform is its index
+	inline std::vector<MockUniform>& MockUniforms()
+	{
+		static std::vector<MockUniform> s_uniforms;
+		return s_uniforms;
+	}
+
+	struct MockUniformHooks
+	{
+		PFNGLGETPROGRAMIVPROC getProgramiv = nullptr;
+		PFNGLGETACTIVEUNIFORMPROC getActiveUniform = nullptr;
+		PFNGLGETUNIFORMLOCATIONPROC getUniformLocation = nullptr;
+	};
+
+	inline MockUniformHooks& SavedMockUniformHooks()
+	{
+		static MockUniformHooks s_saved;
+		return s_saved;
+	}
+
+	inline void APIENTRY MockUniformsGetProgramiv(GLuint program, GLenum pname, GLint* params)
+	{
+		SavedMockUniformHooks().getProgramiv(program, pname, params);
+
+		const std::vector<MockUniform>& uniforms = MockUniforms();
+		if (pname == GL_ACTIVE_UNIFORMS) *params = (GLint)uniforms.size();
+		if (pname == GL_ACTIVE_UNIFORM_MAX_LENGTH)
+		{
+			u64 length = 0;
+			for (const MockUniform& uniform : uniforms) length = std::max(length, uniform.name.size() + 1);
+			*params = (GLint)length;
+		}
+	}
+
+	inline void APIENTRY MockUniformsGetActiveUniform(GLuint program, GLuint index, GLsizei buf_size, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+	{
+		SavedMockUniformHooks().getActiveUniform(program, index, buf_size, length, size, type, name);
+
+		const MockUniform& uniform = MockUniforms()[index];
+		GLsizei copied = std::min((GLsizei)uniform.name.size(), buf_size - 1);
+		std::memcpy(name, uniform.name.c_str(), copied);
+		name[copied] = '\0';
+		*length = copied;
+		*size = 1;
+		*type = uniform.type;
+	}
+
+	inline GLint APIENTRY MockUniformsGetUniformLocation(GLuint program, const GLchar* name)
+	{
+		SavedMockUniformHooks().getUniformLocation(program, name);
+
+		const std::vector<MockUniform>& uniforms = MockUniforms();
+		for (u64 i = 0; i < uniforms.size(); i++)
+		{
+			if (uniforms[i].name == name) return (GLint)i;
+		}
+		return -1;
+	}
+
+	inline void SetMockUniforms(std::vector<MockUniform> uniforms)
+	{
+		MockUniforms() = std::move(uniforms);
+
+		MockUniformHooks& saved = SavedMockUniformHooks();
+		if (glad_glGetProgramiv != MockUniformsGetProgramiv)
+		{
+			saved.getProgramiv = glad_glGetProgramiv;
+			saved.getActiveUniform = glad_glGetActiveUniform;
+			saved.getUniformLocation = glad_glGetUniformLocation;
+		}
+		glad_glGetProgramiv = MockUniformsGetProgramiv;
+		glad_glGetActiveUniform = MockUniformsGetActiveUniform;
+		glad_glGetUniformLocation = MockUniformsGetUniformLocation;
+	}
+}
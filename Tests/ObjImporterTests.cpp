@@ -0,0 +1,173 @@
+#include <string>
+#include <vector>
+#include <LEO/Graphics/ObjImporter.h>
+#include <LEO/Utilities/LeoThreadPool.h>
+#include "LeoTest.h"
+#include "SyntheticMesh.h"
+
+using namespace leo;
+
+// The vertex of every triangle corner, what a draw of the imported mesh reads
+static std::vector<Vertex> Corners(const ObjMeshData& data)
+{
+	std::vector<Vertex> corners;
+	corners.reserve(data.indices.size());
+	for (u32 index : data.indices) corners.push_back(index < data.vertices.size() ? data.vertices[index] : Vertex{});
+	return corners;
+}
+
+static Vertex MakeVertex(glm::vec3 pos, glm::vec2 uv = glm::vec2(0.0f), glm::vec3 normal = glm::vec3(0.0f))
+{
+	Vertex vertex = {};
+	vertex.pos = pos;
+	vertex.texCord = uv;
+	vertex.normal = normal;
+	return vertex;
+}
+
+static void TestDeduplication()
+{
+	// a cube: 8 positions, 4 uvs and 6 normals shared by the faces, 24 distinct corners
+	const char* cube =
+		"v -1 -1 -1\nv 1 -1 -1\nv 1 1 -1\nv -1 1 -1\nv -1 -1 1\nv 1 -1 1\nv 1 1 1\nv -1 1 1\n"
+		"vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+		"vn 0 0 -1\nvn 0 0 1\nvn -1 0 0\nvn 1 0 0\nvn 0 -1 0\nvn 0 1 0\n"
+		"f 1/1/1 4/4/1 3/3/1 2/2/1\n"
+		"f 5/1/2 6/2/2 7/3/2 8/4/2\n"
+		"f 1/1/3 5/2/3 8/3/3 4/4/3\n"
+		"f 2/1/4 3/4/4 7/3/4 6/2/4\n"
+		"f 1/1/5 2/2/5 6/3/5 5/4/5\n"
+		"f 4/1/6 8/2/6 7/3/6 3/4/6\n";
+
+	ObjMeshData data = ImportObj(cube);
+	LEO_CHECK_OR_RETURN(data.error.empty());
+	LEO_CHECK(data.stats.positions == 8 && data.stats.texCoords == 4 && data.stats.normals == 6);
+	LEO_CHECK(data.stats.triangles == 12 && data.indices.size() == 36);
+	LEO_CHECK(data.vertices.size() == 24 && data.stats.vertices == 24);
+
+	// the same corner repeated is one vertex, a position with another normal is not
+	ObjMeshData shared = ImportObj("v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nvn 0 0 1\nvn 0 0 -1\nf 1//1 2//1 3//1\nf 3//1 2//1 4//1\nf 1//2 2//2 3//2\n");
+	LEO_CHECK_OR_RETURN(shared.error.empty());
+	LEO_CHECK(shared.vertices.size() == 7);
+	LEO_CHECK(shared.indices[1] == shared.indices[4] && shared.indices[2] == shared.indices[3]);
+	LEO_CHECK(shared.indices[0] != shared.indices[6]);
+}
+
+static void TestRelativeIndices()
+{
+	// a sphere written with negative indices imports exactly as the absolute one
+	ObjMeshData absolute = ImportObj(test::GenerateObjSphere(24, 48));
+	ObjMeshData relative = ImportObj(test::GenerateObjSphere(24, 48, true));
+	LEO_CHECK_OR_RETURN(absolute.error.empty() && relative.error.empty());
+	LEO_CHECK(absolute.vertices.size() == 25 * 49 && absolute.stats.triangles == 24 * 48 * 2);
+	LEO_CHECK(absolute.vertices == relative.vertices && absolute.indices == relative.indices);
+
+	// relative to the v lines before the face, not to the end of the file
+	ObjMeshData interleaved = ImportObj("v 0 0 0\nv 1 0 0\nv 0 1 0\nf -3 -2 -1\nv 5 0 0\nv 6 0 0\nv 5 1 0\nf -3 -2 -1\nf 1 -2 -1\n");
+	LEO_CHECK_OR_RETURN(interleaved.error.empty());
+	std::vector<Vertex> corners = Corners(interleaved);
+	std::vector<Vertex> expected = {
+		MakeVertex({ 0, 0, 0 }), MakeVertex({ 1, 0, 0 }), MakeVertex({ 0, 1, 0 }),
+		MakeVertex({ 5, 0, 0 }), MakeVertex({ 6, 0, 0 }), MakeVertex({ 5, 1, 0 }),
+		MakeVertex({ 0, 0, 0 }), MakeVertex({ 6, 0, 0 }), MakeVertex({ 5, 1, 0 }),
+	};
+	LEO_CHECK(corners == expected);
+
+	LEO_CHECK(!ImportObj("v 0 0 0\nv 1 0 0\nf -1 -2 -3\n").error.empty()); // before the first v
+}
+
+static void TestPolygons()
+{
+	// a pentagon and a hexagon are fans around their first corner
+	ObjMeshData data = ImportObj("v 0 0 0\nv 1 0 0\nv 2 1 0\nv 1 2 0\nv 0 1 0\nv -1 1 0\nf 1 2 3 4 5\nf 1 2 3 4 5 6\n");
+	LEO_CHECK_OR_RETURN(data.error.empty());
+	LEO_CHECK(data.stats.triangles == 3 + 4);
+
+	const u32 fans[] = { 0, 1, 2,  0, 2, 3,  0, 3, 4,   0, 1, 2,  0, 2, 3,  0, 3, 4,  0, 4, 5 };
+	std::vector<Vertex> corners = Corners(data);
+	LEO_CHECK_OR_RETURN(corners.size() == std::size(fans));
+	const glm::vec3 positions[] = { { 0, 0, 0 }, { 1, 0, 0 }, { 2, 1, 0 }, { 1, 2, 0 }, { 0, 1, 0 }, { -1, 1, 0 } };
+	for (u64 i = 0; i < corners.size(); i++) LEO_CHECK(corners[i].pos == positions[fans[i]]);
+
+	// every corner form, missing uvs and normals are 0
+	ObjMeshData forms = ImportObj("v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0.5 0.25\nvn 0 0 1\nf 1 2/1 3//1\nf 1/1/1 2/1 3\n");
+	LEO_CHECK_OR_RETURN(forms.error.empty());
+	std::vector<Vertex> expected = {
+		MakeVertex({ 0, 0, 0 }), MakeVertex({ 1, 0, 0 }, { 0.5f, 0.25f }), MakeVertex({ 0, 1, 0 }, {}, { 0, 0, 1 }),
+		MakeVertex({ 0, 0, 0 }, { 0.5f, 0.25f }, { 0, 0, 1 }), MakeVertex({ 1, 0, 0 }, { 0.5f, 0.25f }), MakeVertex({ 0, 1, 0 }),
+	};
+	LEO_CHECK(Corners(forms) == expected);
+}
+
+static void TestSyntax()
+{
+	// comments, ignored statements, tabs, CRLF and no final newline give the same mesh
+	const char* plain = "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nf 1 2 3 4\n";
+	const char* noisy = "# comment\r\nmtllib a.mtl\r\no quad\r\n\tv\t0 0 0\r\nv  1 0 0 1.0\r\n\r\nv 0 1 0\r\ng group\r\nusemtl red\r\nv 1 1 0\r\ns off\r\nf 1 2 3 4";
+	ObjMeshData a = ImportObj(plain);
+	ObjMeshData b = ImportObj(noisy);
+	LEO_CHECK_OR_RETURN(a.error.empty() && b.error.empty());
+	LEO_CHECK(a.vertices == b.vertices && a.indices == b.indices);
+
+	ObjMeshData empty = ImportObj("");
+	LEO_CHECK(empty.error.empty() && empty.vertices.empty() && empty.indices.empty());
+
+	// errors name the line
+	LEO_CHECK(ImportObj("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4\n").error.find("line 4") != std::string::npos);
+	LEO_CHECK(!ImportObj("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 0 1 2\n").error.empty());
+	LEO_CHECK(!ImportObj("v 0 0 0\nv 1 0 0\nf 1 2\n").error.empty());
+	LEO_CHECK(!ImportObj("v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0 0\nf 1/2 2/1 3/1\n").error.empty());
+	LEO_CHECK(!ImportObj("v 0 0\n").error.empty());
+	LEO_CHECK(!ImportObj("v 0 x 0\n").error.empty());
+}
+
+static void TestChunks(ThreadPool& pool)
+{
+	// several chunks: the result does not depend on the pool
+	std::string text = test::GenerateObjSphere(128, 256);
+	LEO_CHECK_OR_RETURN(text.size() > 3 * OBJ_CHUNK_SIZE);
+
+	ObjMeshData single = ImportObj(text);
+	ObjMeshData pooled = ImportObj(text, &pool);
+	LEO_CHECK_OR_RETURN(single.error.empty() && pooled.error.empty());
+	LEO_CHECK(single.stats.chunks > 3);
+	LEO_CHECK(single.vertices.size() == 129 * 257 && single.stats.triangles == 128 * 256 * 2);
+	LEO_CHECK(single.vertices == pooled.vertices && single.indices == pooled.indices);
+}
+
+static void BenchImport(ThreadPool& pool)
+{
+	std::printf("OBJ import (%u workers), best of 3:\n", pool.ThreadCount());
+
+	for (bool relative : { false, true })
+	{
+		std::string text = test::GenerateObjSphere(256, 512, relative);
+		for (ThreadPool* import_pool : { (ThreadPool*)nullptr, &pool })
+		{
+			ObjImportStats best;
+			test::BestMillis(3, [&]() {
+				ObjMeshData data = ImportObj(text, import_pool);
+				LEO_CHECK(data.error.empty());
+				if (best.ms == 0.0f || data.stats.ms < best.ms) best = data.stats;
+			});
+
+			std::printf("  %.1f MB, %-8s %-8s %8.2f ms (parse %.2f, dedup %.2f)  %7.1f MB/s  %u triangles, %u vertices\n",
+				best.bytes / (1024.0 * 1024.0), relative ? "relative" : "absolute", import_pool ? "pool" : "1 thread",
+				best.ms, best.parseMs, best.dedupMs, best.MBPerSecond(), best.triangles, best.vertices);
+		}
+	}
+}
+
+int main()
+{
+	ThreadPool pool;
+
+	TestDeduplication();
+	TestRelativeIndices();
+	TestPolygons();
+	TestSyntax();
+	TestChunks(pool);
+	BenchImport(pool);
+
+	return test::Result("ObjImporterTests");
+}
@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <vector>
+#include <LEO/Graphics/GLBackend.h>
+#include <LEO/Graphics/GLStateCache.h>
+#include <LEO/Graphics/RenderQueue.h>
+#include "LeoTest.h"
+
+using namespace leo;
+
+// The states a queue draws with, created under the mock backend
+struct States
+{
+	std::deque<ShaderProgram> shaders;
+	std::deque<Texture> textures;
+	std::deque<Mesh> meshes;
+
+	States(u32 shader_count, u32 texture_count, u32 mesh_count)
+	{
+		for (u32 i = 0; i < shader_count; i++) shaders.emplace_back("vertex", "fragment");
+		for (u32 i = 0; i < texture_count; i++) textures.emplace_back(4, 4);
+		for (u32 i = 0; i < mesh_count; i++) meshes.push_back(Mesh::GenerateQuad());
+	}
+};
+
+// The commands in the order of the Draw ops
+static std::vector<u32> DrawOrder(std::span<const RenderOp> ops)
+{
+	std::vector<u32> order;
+	for (const RenderOp& op : ops) {
+		if (op.type == RenderOp::Type::Draw) order.push_back(op.command);
+	}
+	return order;
+}
+
+// Binds a queue without sorting would issue: one per change between consecutive commands
+static RenderQueueStats SubmissionOrderBinds(std::span<const RenderCommand> commands, std::span<const u32> order)
+{
+	RenderQueueStats stats;
+	stats.commands = (u32)order.size();
+	for (u32 i = 0; i < (u32)order.size(); i++)
+	{
+		const RenderCommand& command = commands[order[i]];
+		const RenderCommand* previous = i > 0 ? &commands[order[i - 1]] : nullptr;
+		if (!previous || previous->shader != command.shader) stats.shaderBinds++;
+		if (!previous || previous->texture != command.texture) stats.textureBinds++;
+		if (!previous || previous->mesh != command.mesh) stats.meshBinds++;
+	}
+	return stats;
+}
+
+static bool SameStats(const RenderQueueStats& a, const RenderQueueStats& b)
+{
+	return a.commands == b.commands && a.shaderBinds == b.shaderBinds && a.textureBinds == b.textureBinds && a.meshBinds == b.meshBinds;
+}
+
+static void TestKeys()
+{
+	// the pass first, then the shader, texture, mesh and depth
+	const u64 opaque = RenderQueue::MakeKey(RenderPass::Opaque, 4095, 4095, 4095, 1e30f);
+	LEO_CHECK(opaque < RenderQueue::MakeKey(RenderPass::Transparent, 0, 0, 0, 1e30f));
+	LEO_CHECK(RenderQueue::MakeKey(RenderPass::Transparent, 4095, 4095, 4095, 0.0f) < RenderQueue::MakeKey(RenderPass::Overlay, 0, 0, 0, 0.0f));
+
+	LEO_CHECK(RenderQueue::MakeKey(RenderPass::Opaque, 1, 9, 9, 1000.0f) < RenderQueue::MakeKey(RenderPass::Opaque, 2, 0, 0, 0.0f));
+	LEO_CHECK(RenderQueue::MakeKey(RenderPass::Opaque, 1, 1, 9, 1000.0f) < RenderQueue::MakeKey(RenderPass::Opaque, 1, 2, 0, 0.0f));
+	LEO_CHECK(RenderQueue::MakeKey(RenderPass::Opaque, 1, 1, 1, 1000.0f) < RenderQueue::MakeKey(RenderPass::Opaque, 1, 1, 2, 0.0f));
+	LEO_CHECK(RenderQueue::MakeKey(RenderPass::Overlay, 1, 1, 9, 1000.0f) < RenderQueue::MakeKey(RenderPass::Overlay, 1, 2, 0, 0.0f));
+
+	// front to back, back to front for the transparent pass where the depth comes before the state
+	const f32 depths[] = { 0.0f, 1e-3f, 0.5f, 1.0f, 10.0f, 1000.0f, 1e6f };
+	for (u32 i = 1; i < std::size(depths); i++)
+	{
+		LEO_CHECK(RenderQueue::MakeKey(RenderPass::Opaque, 1, 1, 1, depths[i - 1]) < RenderQueue::MakeKey(RenderPass::Opaque, 1, 1, 1, depths[i]));
+		LEO_CHECK(RenderQueue::MakeKey(RenderPass::Transparent, 9, 9, 9, depths[i]) < RenderQueue::MakeKey(RenderPass::Transparent, 1, 1, 1, depths[i - 1]));
+	}
+	LEO_CHECK(RenderQueue::MakeKey(RenderPass::Opaque, 1, 1, 1, -5.0f) == RenderQueue::MakeKey(RenderPass::Opaque, 1, 1, 1, 0.0f));
+}
+
+// Every (pass, shader, texture, mesh) with random depths, submitted shuffled. Returns the depth of each command
+static std::vector<f32> SubmitShuffled(RenderQueue& queue, States& states, u32 copies, u32 seed)
+{
+	struct Entry { RenderPass pass; u32 shader, texture, mesh; f32 depth; };
+	std::vector<Entry> entries;
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<f32> depth(0.0f, 100.0f);
+
+	for (RenderPass pass : { RenderPass::Opaque, RenderPass::Transparent, RenderPass::Overlay })
+		for (u32 s = 0; s < states.shaders.size(); s++)
+			for (u32 t = 0; t <= states.textures.size(); t++) // the last one is no texture
+				for (u32 m = 0; m < states.meshes.size(); m++)
+					for (u32 c = 0; c < copies; c++) entries.push_back({ pass, s, t, m, depth(rng) });
+	std::shuffle(entries.begin(), entries.end(), rng);
+
+	std::vector<f32> depths;
+	for (u32 i = 0; i < (u32)entries.size(); i++)
+	{
+		const Entry& e = entries[i];
+		const Texture* texture = e.texture < states.textures.size() ? &states.textures[e.texture] : nullptr;
+		queue.Submit(e.pass, &states.shaders[e.shader], texture, &states.meshes[e.mesh], e.depth, i);
+		depths.push_back(e.depth);
+	}
+	return depths;
+}
+
+static void TestOrder(States& states)
+{
+	RenderQueue queue;
+	LEO_CHECK(queue.Compile().empty() && queue.Stats().commands == 0);
+
+	const std::vector<f32> depths = SubmitShuffled(queue, states, 3, 1);
+	const u32 count = (u32)queue.Commands().size();
+	std::vector<u32> order = DrawOrder(queue.Compile());
+	LEO_CHECK_OR_RETURN(order.size() == count);
+
+	// the same order as a stable sort of the keys
+	std::vector<u32> expected(count);
+	for (u32 i = 0; i < count; i++) expected[i] = i;
+	std::stable_sort(expected.begin(), expected.end(), [&](u32 a, u32 b) { return queue.Key(a) < queue.Key(b); });
+	LEO_CHECK(order == expected);
+
+	// passes in order, the transparent pass back to front, the others front to back for the same state.
+	// The key keeps 15 bits of mantissa, closer depths stay in submission order
+	const u32 per_pass = count / 3;
+	u32 pass_errors = 0, depth_errors = 0;
+	for (u32 i = 0; i < count; i++)
+	{
+		const RenderCommand& command = queue.Commands()[order[i]];
+		const u64 pass = queue.Key(order[i]) >> 60;
+		if (pass != i / per_pass) pass_errors++;
+		if (i % per_pass == 0) continue;
+
+		const RenderCommand& previous = queue.Commands()[order[i - 1]];
+		const f32 depth = depths[order[i]], previous_depth = depths[order[i - 1]];
+		if (pass == (u64)RenderPass::Transparent && depth > previous_depth * (1.0f + 1e-4f)) depth_errors++;
+		bool same_state = command.shader == previous.shader && command.texture == previous.texture && command.mesh == previous.mesh;
+		if (pass != (u64)RenderPass::Transparent && same_state && depth * (1.0f + 1e-4f) < previous_depth) depth_errors++;
+	}
+	LEO_CHECK(pass_errors == 0 && depth_errors == 0);
+
+	// the same commands again after Clear give the same ops
+	std::vector<RenderOp> ops(queue.Ops().begin(), queue.Ops().end());
+	queue.Clear();
+	LEO_CHECK(queue.Commands().empty() && queue.Ops().empty());
+	SubmitShuffled(queue, states, 3, 1);
+	std::span<const RenderOp> again = queue.Compile();
+	LEO_CHECK(again.size() == ops.size() && std::equal(again.begin(), again.end(), ops.begin(), [](const RenderOp& a, const RenderOp& b) {
+		return a.type == b.type && a.command == b.command;
+	}));
+}
+
+static void TestStateChanges(States& states)
+{
+	const u32 shaders = (u32)states.shaders.size();
+	const u32 textures = (u32)states.textures.size() + 1;
+	const u32 meshes = (u32)states.meshes.size();
+
+	// one pass: each shader bound once, each texture once per shader, each mesh once per (shader, texture)
+	RenderQueue queue;
+	std::vector<u32> submitted;
+	{
+		std::mt19937 rng(2);
+		std::vector<u32> combos;
+		for (u32 i = 0; i < shaders * textures * meshes * 4; i++) combos.push_back(i % (shaders * textures * meshes));
+		std::shuffle(combos.begin(), combos.end(), rng);
+		for (u32 combo : combos)
+		{
+			u32 t = combo / meshes % textures;
+			const Texture* texture = t + 1 < textures ? &states.textures[t] : nullptr;
+			queue.Submit(RenderPass::Opaque, &states.shaders[combo / (textures * meshes)], texture, &states.meshes[combo % meshes], (f32)(combo % 7));
+			submitted.push_back((u32)submitted.size());
+		}
+	}
+	std::span<const RenderOp> ops = queue.Compile();
+	const RenderQueueStats& stats = queue.Stats();
+	LEO_CHECK(stats.commands == shaders * textures * meshes * 4);
+	LEO_CHECK(stats.shaderBinds == shaders);
+	LEO_CHECK(stats.textureBinds == shaders * textures);
+	LEO_CHECK(stats.meshBinds == shaders * textures * meshes);
+
+	// the stats are the bind ops, and what a walk over the sorted commands counts
+	u32 binds = 0;
+	for (const RenderOp& op : ops) binds += op.type != RenderOp::Type::Draw;
+	LEO_CHECK(binds == stats.shaderBinds + stats.textureBinds + stats.meshBinds);
+	LEO_CHECK(SameStats(stats, SubmissionOrderBinds(queue.Commands(), DrawOrder(ops))));
+
+	const RenderQueueStats unsorted = SubmissionOrderBinds(queue.Commands(), submitted);
+	std::printf("RenderQueue, %u commands (%u shaders, %u textures, %u meshes), binds unsorted -> sorted:\n", stats.commands, shaders, textures, meshes);
+	std::printf("  shaders %5u -> %u\n  textures %4u -> %u\n  meshes %6u -> %u\n",
+		unsorted.shaderBinds, stats.shaderBinds, unsorted.textureBinds, stats.textureBinds, unsorted.meshBinds, stats.meshBinds);
+
+	// executed on the mock backend: one program and vertex array bind per bind op, one draw per command
+	GetGLStateCache().Invalidate();
+	ResetMockGLCallCounts();
+	u32 per_draw = 0;
+	queue.Execute([&](const ShaderProgram&, const RenderCommand&) { per_draw++; });
+	const GLCallCounts& calls = GetMockGLCallCounts();
+	LEO_CHECK(per_draw == stats.commands && calls[GLFunction::DrawElements] == stats.commands);
+	LEO_CHECK(calls[GLFunction::UseProgram] == stats.shaderBinds + 1); // + the UnBind at the end
+	LEO_CHECK(calls[GLFunction::BindVertexArray] == stats.meshBinds + 1);
+}
+
+static void BenchQueue(States& states)
+{
+	// a large frame: 100k opaque commands over every state, random depths
+	constexpr u32 COUNT = 100000;
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<f32> depth(0.0f, 500.0f);
+	struct Entry { u32 shader, texture, mesh; f32 depth; };
+	std::vector<Entry> entries(COUNT);
+	for (Entry& e : entries) e = { (u32)(rng() % states.shaders.size()), (u32)(rng() % states.textures.size()), (u32)(rng() % states.meshes.size()), depth(rng) };
+
+	RenderQueue queue;
+	auto submit = [&]() {
+		queue.Clear();
+		for (u32 i = 0; i < COUNT; i++)
+		{
+			const Entry& e = entries[i];
+			queue.Submit(RenderPass::Opaque, &states.shaders[e.shader], &states.textures[e.texture], &states.meshes[e.mesh], e.depth, i);
+		}
+	};
+
+	f32 submit_ms = test::BestMillis(5, submit);
+	f32 compile_ms = test::BestMillis(5, [&]() { submit(); queue.Compile(); }) - submit_ms;
+
+	// the radix sort against std::sort of the same keys
+	std::vector<std::pair<u64, u32>> keys(COUNT);
+	f32 std_sort_ms = test::BestMillis(5, [&]() {
+		for (u32 i = 0; i < COUNT; i++) keys[i] = { queue.Key(i), i };
+		std::sort(keys.begin(), keys.end());
+	});
+	LEO_CHECK(queue.Stats().commands == COUNT);
+
+	std::printf("RenderQueue, %u commands, best of 5:\n", COUNT);
+	std::printf("  submit              %7.2f ms\n", submit_ms);
+	std::printf("  compile (radix)     %7.2f ms  (%u ops)\n", compile_ms, (u32)queue.Ops().size());
+	std::printf("  std::sort of keys   %7.2f ms\n", std_sort_ms);
+}
+
+int main()
+{
+	TestKeys();
+
+	InstallMockGLBackend();
+	{
+		States states(4, 6, 5);
+		TestOrder(states);
+		TestStateChanges(states);
+
+		States large(32, 256, 64);
+		BenchQueue(large);
+	}
+	RestoreGLBackend();
+
+	return test::Result("RenderQueueTests");
+}
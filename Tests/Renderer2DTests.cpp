@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <glad/glad.h>
+#include <LEO/Graphics/GLBackend.h>
+#include <LEO/Graphics/RenderBackend.h>
+#include <LEO/Graphics/Renderer2D.h>
+#include "LeoTest.h"
+
+using namespace leo;
+
+// The last bytes uploaded to each buffer target, whole buffer uploads only
+static std::vector<u8> s_arrayBytes;
+static std::vector<u8> s_elementBytes;
+static PFNGLBUFFERDATAPROC s_bufferData;
+static PFNGLBUFFERSUBDATAPROC s_bufferSubData;
+
+static void Capture(GLenum target, GLsizeiptr size, const void* data)
+{
+	std::vector<u8>* bytes = target == GL_ARRAY_BUFFER ? &s_arrayBytes : target == GL_ELEMENT_ARRAY_BUFFER ? &s_elementBytes : nullptr;
+	if (bytes == nullptr) return;
+	if (data == nullptr) bytes->clear();
+	else bytes->assign(static_cast<const u8*>(data), static_cast<const u8*>(data) + size);
+}
+
+static void APIENTRY BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+	s_bufferData(target, size, data, usage);
+	Capture(target, size, data);
+}
+
+static void APIENTRY BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+	s_bufferSubData(target, offset, size, data);
+	if (offset == 0) Capture(target, size, data);
+}
+
+template<typename T>
+static bool SameBytes(const std::vector<u8>& bytes, std::span<const T> values)
+{
+	return bytes.size() == values.size_bytes() && std::memcmp(bytes.data(), values.data(), bytes.size()) == 0;
+}
+
+static bool SameVertex(const Vertex2D& v, glm::vec2 position, glm::vec2 uv, Color color)
+{
+	return v.position == position && v.uv == uv && v.color == color;
+}
+
+// Every triangle of the index stream is counter-clockwise (or degenerate)
+static bool CounterClockwise(const Batch2D& batch)
+{
+	std::span<const Vertex2D> vertices = batch.Vertices();
+	std::span<const u32> indices = batch.Indices();
+	for (u64 i = 0; i + 2 < indices.size(); i += 3)
+	{
+		glm::vec2 a = vertices[indices[i]].position, b = vertices[indices[i + 1]].position, c = vertices[indices[i + 2]].position;
+		f32 cross = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+		if (cross < -1e-5f) return false;
+	}
+	return true;
+}
+
+static bool SameCall(const DrawCall2D& call, const ShaderProgram* shader, const Texture* texture, u32 first_index, u32 index_count)
+{
+	return call.shader == shader && call.texture == texture && call.firstIndex == first_index && call.indexCount == index_count;
+}
+
+static void TestPrimitives()
+{
+	// no shader or texture: nothing here needs OpenGL
+	Batch2D batch;
+	batch.Triangle({ 0.0f, 0.0f }, { 1.0f, 0.0f }, { 0.0f, 1.0f }, RED);
+	batch.Quad({ 0.0f, 0.0f }, { 2.0f, 1.0f }, GREEN, { 0.25f, 0.5f }, { 0.75f, 1.0f });
+
+	const glm::vec2 pentagon[5] = { { 1.0f, 0.0f }, { 0.31f, 0.95f }, { -0.81f, 0.59f }, { -0.81f, -0.59f }, { 0.31f, -0.95f } };
+	batch.Polygon(pentagon, 5, BLUE);
+	batch.Polygon(pentagon, 2, BLUE); // not a polygon, nothing added
+	batch.Circle({ 5.0f, 5.0f }, 2.0f, WHITE, 8);
+	batch.Line({ 0.0f, 0.0f }, { 4.0f, 0.0f }, 2.0f, GOLD);
+	batch.Line({ 1.0f, 1.0f }, { 1.0f, 1.0f }, 2.0f, GOLD); // zero length, nothing added
+	batch.Build();
+
+	std::span<const Vertex2D> v = batch.Vertices();
+	std::span<const u32> indices = batch.Indices();
+	LEO_CHECK_OR_RETURN(v.size() == 3 + 4 + 5 + 9 + 4 && indices.size() == 3 + 6 + 9 + 24 + 6);
+
+	LEO_CHECK(SameVertex(v[0], { 0.0f, 0.0f }, { 0.0f, 0.0f }, RED) && SameVertex(v[2], { 0.0f, 1.0f }, { 0.5f, 1.0f }, RED));
+	LEO_CHECK(SameVertex(v[3], { 0.0f, 0.0f }, { 0.25f, 0.5f }, GREEN) && SameVertex(v[4], { 2.0f, 0.0f }, { 0.75f, 0.5f }, GREEN));
+	LEO_CHECK(SameVertex(v[5], { 2.0f, 1.0f }, { 0.75f, 1.0f }, GREEN) && SameVertex(v[6], { 0.0f, 1.0f }, { 0.25f, 1.0f }, GREEN));
+	LEO_CHECK(SameVertex(v[7], pentagon[0], glm::vec2(0.0f), BLUE) && SameVertex(v[11], pentagon[4], glm::vec2(0.0f), BLUE));
+	LEO_CHECK(SameVertex(v[12], { 5.0f, 5.0f }, glm::vec2(0.5f), WHITE) && SameVertex(v[13], { 7.0f, 5.0f }, { 1.0f, 0.5f }, WHITE));
+	LEO_CHECK(SameVertex(v[21], { 0.0f, -1.0f }, { 0.0f, 0.0f }, GOLD) && SameVertex(v[23], { 4.0f, 1.0f }, { 1.0f, 1.0f }, GOLD));
+
+	u32 off_ring = 0;
+	for (u32 i = 13; i < 21; i++) off_ring += glm::abs(glm::length(v[i].position - glm::vec2(5.0f)) - 2.0f) > 1e-5f;
+	LEO_CHECK(off_ring == 0);
+
+	const u32 expected_start[] = { 0, 1, 2, 3, 4, 5, 3, 5, 6, 7, 8, 9, 7, 9, 10, 7, 10, 11, 12, 13, 14 };
+	LEO_CHECK(std::equal(std::begin(expected_start), std::end(expected_start), indices.begin()));
+	LEO_CHECK(indices[3 + 6 + 9 + 21] == 12 && indices[3 + 6 + 9 + 22] == 20 && indices[3 + 6 + 9 + 23] == 13); // the circle closes
+	LEO_CHECK(CounterClockwise(batch));
+
+	// no key change: one draw call over the whole stream
+	LEO_CHECK(batch.DrawCalls().size() == 1 && SameCall(batch.DrawCalls()[0], nullptr, nullptr, 0, (u32)indices.size()));
+
+	batch.Clear();
+	batch.Build();
+	LEO_CHECK(batch.Vertices().empty() && batch.Indices().empty() && batch.DrawCalls().empty());
+}
+
+static void TestSplits(const ShaderProgram& shader, const Texture& a, const Texture& b)
+{
+	Batch2D batch;
+	auto quad = [&](f32 x) { batch.Quad({ x, 0.0f }, { x + 1.0f, 1.0f }, WHITE); };
+
+	batch.SetTexture(&a);
+	quad(0.0f);
+	batch.SetTexture(&a); // the same key again does not split
+	quad(1.0f);
+	batch.SetTexture(&b);
+	quad(2.0f);
+	batch.SetTexture(&a);
+	batch.Triangle({ 3.0f, 0.0f }, { 4.0f, 0.0f }, { 3.0f, 1.0f }, WHITE);
+	batch.SetShader(&shader);
+	quad(4.0f);
+	batch.SetShader(nullptr);
+	batch.SetTexture(&b);
+	quad(5.0f);
+
+	// submission order: a new draw call on each change
+	batch.Build();
+	std::span<const DrawCall2D> calls = batch.DrawCalls();
+	LEO_CHECK_OR_RETURN(calls.size() == 5);
+	LEO_CHECK(SameCall(calls[0], nullptr, &a, 0, 12));
+	LEO_CHECK(SameCall(calls[1], nullptr, &b, 12, 6));
+	LEO_CHECK(SameCall(calls[2], nullptr, &a, 18, 3));
+	LEO_CHECK(SameCall(calls[3], &shader, &a, 21, 6));
+	LEO_CHECK(SameCall(calls[4], nullptr, &b, 27, 6));
+	const std::vector<u32> submitted(batch.Indices().begin(), batch.Indices().end());
+
+	// by key: one call per (shader, texture) in first seen order, the primitives keep their order inside a call
+	batch.SetOrder(BatchOrder::ByKey);
+	batch.Build();
+	calls = batch.DrawCalls();
+	LEO_CHECK_OR_RETURN(calls.size() == 3);
+	LEO_CHECK(SameCall(calls[0], nullptr, &a, 0, 15));
+	LEO_CHECK(SameCall(calls[1], nullptr, &b, 15, 12));
+	LEO_CHECK(SameCall(calls[2], &shader, &a, 27, 6));
+
+	std::vector<u32> expected;
+	auto append = [&](u32 first, u32 count) { expected.insert(expected.end(), submitted.begin() + first, submitted.begin() + first + count); };
+	append(0, 12); append(18, 3);  // a
+	append(12, 6); append(27, 6);  // b
+	append(21, 6);                 // shader, a
+	LEO_CHECK(std::equal(expected.begin(), expected.end(), batch.Indices().begin(), batch.Indices().end()));
+	LEO_CHECK(CounterClockwise(batch));
+}
+
+static void TestRenderer(const Texture& a, const Texture& b)
+{
+	Renderer2D renderer;
+
+	// 100 quads, the texture changing every 10
+	auto frame = [&](u32 quads, u32 run) {
+		renderer.Begin(glm::mat4(1.0f));
+		for (u32 i = 0; i < quads; i++)
+		{
+			renderer.SetTexture(i / run % 2 == 0 ? &a : &b);
+			renderer.Quad({ (f32)i, 0.0f }, { i + 1.0f, 1.0f }, WHITE);
+		}
+		ResetMockGLCallCounts();
+		renderer.End();
+		return GetMockGLCallCounts();
+	};
+
+	// the first frame allocates the streams, the whole frame in one upload each
+	GLCallCounts calls = frame(100, 10);
+	LEO_CHECK(renderer.LastDrawCallCount() == 10 && calls[GLFunction::DrawElements] == 10);
+	LEO_CHECK(calls[GLFunction::BufferData] == 2 && calls[GLFunction::BufferSubData] == 0);
+	LEO_CHECK(SameBytes(s_arrayBytes, renderer.Vertices()) && SameBytes(s_elementBytes, renderer.Indices()));
+	LEO_CHECK(calls[GLFunction::UseProgram] == 2); // the default shader, unbound at the end
+
+	// the same size again fits in the streams
+	calls = frame(100, 10);
+	LEO_CHECK(calls[GLFunction::BufferData] == 0 && calls[GLFunction::BufferSubData] == 2);
+
+	// past the capacity of the streams: they grow, the draw list is not split by the size
+	calls = frame(5000, 5000);
+	LEO_CHECK(renderer.LastDrawCallCount() == 1 && calls[GLFunction::DrawElements] == 1);
+	LEO_CHECK(calls[GLFunction::BufferData] == 2 && calls[GLFunction::BufferSubData] == 0);
+	LEO_CHECK(s_arrayBytes.size() == 5000 * 4 * sizeof(Vertex2D) && s_elementBytes.size() == 5000 * 6 * sizeof(u32));
+	LEO_CHECK(SameBytes(s_elementBytes, renderer.Indices()));
+
+	// grouped by key: two draw calls whatever the submission order
+	renderer.SetOrder(BatchOrder::ByKey);
+	calls = frame(100, 10);
+	LEO_CHECK(renderer.LastDrawCallCount() == 2 && calls[GLFunction::DrawElements] == 2);
+	LEO_CHECK(SameBytes(s_elementBytes, renderer.Indices()));
+
+	// recorded: the same draw calls
+	CommandList commands;
+	renderer.Begin(glm::mat4(1.0f));
+	for (u32 i = 0; i < 30; i++)
+	{
+		renderer.SetTexture(i < 10 || i >= 20 ? &a : &b);
+		renderer.Circle({ (f32)i, 0.0f }, 0.5f, WHITE);
+	}
+	renderer.End(commands);
+	NullRenderBackend backend;
+	commands.Replay(backend);
+	LEO_CHECK(std::count(backend.Trace().begin(), backend.Trace().end(), CommandType::DrawIndexed) == 2);
+	LEO_CHECK(std::count(backend.Trace().begin(), backend.Trace().end(), CommandType::BindTexture) == 2);
+
+	// nothing submitted, nothing drawn
+	calls = frame(0, 1);
+	LEO_CHECK(renderer.LastDrawCallCount() == 0 && calls.Total() == 0);
+}
+
+int main()
+{
+	TestPrimitives();
+
+	InstallMockGLBackend();
+	s_bufferData = glad_glBufferData;
+	s_bufferSubData = glad_glBufferSubData;
+	glad_glBufferData = BufferData;
+	glad_glBufferSubData = BufferSubData;
+	{
+		ShaderProgram shader("vertex", "fragment");
+		Texture a(4, 4);
+		Texture b(4, 4);
+
+		TestSplits(shader, a, b);
+		TestRenderer(a, b);
+	}
+	RestoreGLBackend();
+
+	return test::Result("Renderer2DTests");
+}
@@ -0,0 +1,309 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+#include <LEO/Physics/SpatialQuery.h>
+#include <LEO/Utilities/LeoThreadPool.h>
+#include "LeoTest.h"
+
+using namespace leo;
+
+struct Circle
+{
+	glm::vec2 center;
+	f32 radius;
+};
+
+// Spread over [0, size]^2 with a dense cluster and an empty quarter (x and y above size * 0.75)
+static std::vector<Circle> RandomCircles(u32 count, f32 size, u32 seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<f32> position(0.0f, size);
+	std::uniform_real_distribution<f32> radius(0.5f, 4.0f);
+	std::normal_distribution<f32> cluster(size * 0.25f, size * 0.01f);
+
+	std::vector<Circle> circles;
+	circles.reserve(count);
+	while (circles.size() < count)
+	{
+		bool clustered = circles.size() % 8 == 0;
+		glm::vec2 center = clustered ? glm::vec2(cluster(rng), cluster(rng)) : glm::vec2(position(rng), position(rng));
+		if (center.x > size * 0.75f && center.y > size * 0.75f) continue;
+		circles.push_back({ center, radius(rng) });
+	}
+	return circles;
+}
+
+static SpatialQuery Build(const std::vector<Circle>& circles)
+{
+	SpatialQuery query;
+	for (u32 i = 0; i < (u32)circles.size(); i++) query.Add(i, circles[i].center, circles[i].radius);
+	query.Build();
+	return query;
+}
+
+// ---------------- Brute force, the same tests one circle at a time ----------------
+
+static std::vector<entity_id> BruteRadius(const std::vector<Circle>& circles, glm::vec2 center, f32 radius)
+{
+	std::vector<entity_id> found;
+	for (u32 i = 0; i < (u32)circles.size(); i++)
+	{
+		glm::vec2 d = circles[i].center - center;
+		f32 r = radius + circles[i].radius;
+		if (glm::dot(d, d) <= r * r) found.push_back(i);
+	}
+	return found;
+}
+
+static std::vector<entity_id> BruteAABB(const std::vector<Circle>& circles, glm::vec2 min, glm::vec2 max)
+{
+	std::vector<entity_id> found;
+	for (u32 i = 0; i < (u32)circles.size(); i++)
+	{
+		glm::vec2 d = circles[i].center - glm::clamp(circles[i].center, min, max);
+		if (glm::dot(d, d) <= circles[i].radius * circles[i].radius) found.push_back(i);
+	}
+	return found;
+}
+
+static std::vector<f32> BruteNearest(const std::vector<Circle>& circles, glm::vec2 point, u32 k, f32 max_distance)
+{
+	std::vector<f32> distances;
+	for (const Circle& circle : circles)
+	{
+		f32 distance = glm::max(glm::length(circle.center - point) - circle.radius, 0.0f);
+		if (distance <= max_distance) distances.push_back(distance);
+	}
+	std::sort(distances.begin(), distances.end());
+	distances.resize(std::min<u64>(k, distances.size()));
+	return distances;
+}
+
+static f32 BruteRaycast(const std::vector<Circle>& circles, glm::vec2 origin, glm::vec2 direction, f32 max_distance)
+{
+	f32 best = INFINITY;
+	for (const Circle& circle : circles)
+	{
+		glm::vec2 m = origin - circle.center;
+		f32 b = glm::dot(m, direction);
+		f32 c = glm::dot(m, m) - circle.radius * circle.radius;
+		f32 discriminant = b * b - c;
+		if (discriminant < 0.0f || (c > 0.0f && b > 0.0f)) continue;
+
+		f32 t = glm::max(-b - glm::sqrt(discriminant), 0.0f);
+		if (t <= max_distance) best = glm::min(best, t);
+	}
+	return best;
+}
+
+// The ids found by the tree, in any order, must be the expected ones
+static bool SameSet(std::vector<entity_id> found, std::vector<entity_id> expected)
+{
+	std::sort(found.begin(), found.end());
+	std::sort(expected.begin(), expected.end());
+	return found == expected;
+}
+
+// ---------------- Tests ----------------
+
+static void TestEmpty()
+{
+	SpatialQuery query;
+	query.Build();
+	entity_id ids[4];
+	SpatialHit hits[4];
+	SpatialHit hit;
+	LEO_CHECK(query.EntityCount() == 0 && query.NodeCount() == 0);
+	LEO_CHECK(query.QueryRadius(glm::vec2(0.0f), 1e6f, ids) == 0);
+	LEO_CHECK(query.QueryAABB(glm::vec2(-1e6f), glm::vec2(1e6f), ids) == 0);
+	LEO_CHECK(query.QueryNearest(glm::vec2(0.0f), hits) == 0);
+	LEO_CHECK(!query.Raycast(glm::vec2(0.0f), glm::vec2(1.0f, 0.0f), 1e6f, hit));
+
+	// cleared and rebuilt
+	query.Add(7, glm::vec2(1.0f), 1.0f);
+	query.Build();
+	LEO_CHECK(query.QueryRadius(glm::vec2(0.0f), 1.0f, ids) == 1 && ids[0] == 7);
+	query.Clear();
+	query.Build();
+	LEO_CHECK(query.QueryRadius(glm::vec2(0.0f), 1.0f, ids) == 0);
+}
+
+static void TestBoundaries()
+{
+	// circles on a grid, 10 apart with radius 5: neighbours touch exactly, the values are exact in float
+	std::vector<Circle> circles;
+	for (u32 y = 0; y < 16; y++)
+		for (u32 x = 0; x < 16; x++) circles.push_back({ glm::vec2(x * 10.0f, y * 10.0f), 5.0f });
+	SpatialQuery query = Build(circles);
+
+	std::vector<entity_id> out(circles.size());
+	auto radius = [&](glm::vec2 center, f32 r) {
+		u32 count = query.QueryRadius(center, r, out);
+		return std::vector<entity_id>(out.begin(), out.begin() + std::min<u64>(count, out.size()));
+	};
+	auto aabb = [&](glm::vec2 min, glm::vec2 max) {
+		u32 count = query.QueryAABB(min, max, out);
+		return std::vector<entity_id>(out.begin(), out.begin() + std::min<u64>(count, out.size()));
+	};
+
+	// touching counts as overlapping: the circle of (50, 50) and its 4 neighbours
+	LEO_CHECK(SameSet(radius(glm::vec2(50.0f), 5.0f), { 5 * 16 + 5, 5 * 16 + 4, 5 * 16 + 6, 4 * 16 + 5, 6 * 16 + 5 }));
+	// a point query exactly on the edge between two circles
+	LEO_CHECK(SameSet(radius(glm::vec2(55.0f, 50.0f), 0.0f), { 5 * 16 + 5, 5 * 16 + 6 }));
+	// a box edge on the rightmost point of a circle
+	LEO_CHECK(SameSet(aabb(glm::vec2(55.0f, 48.0f), glm::vec2(56.0f, 52.0f)), { 5 * 16 + 5, 5 * 16 + 6 }));
+	// between four circles, touching none
+	LEO_CHECK(radius(glm::vec2(55.0f), 2.0f).empty());
+	LEO_CHECK(aabb(glm::vec2(54.0f), glm::vec2(56.0f)).empty());
+	// outside the bounds of the tree
+	LEO_CHECK(radius(glm::vec2(-10.0f), 4.0f).empty() && aabb(glm::vec2(200.0f), glm::vec2(300.0f)).empty());
+
+	// axis aligned rays starting on the edge of the tree bounds and of a circle
+	SpatialHit hit;
+	LEO_CHECK(query.Raycast(glm::vec2(-5.0f, 50.0f), glm::vec2(1.0f, 0.0f), 100.0f, hit) && hit.entity == 5 * 16 && hit.distance == 0.0f);
+	LEO_CHECK(query.Raycast(glm::vec2(50.0f, -20.0f), glm::vec2(0.0f, 1.0f), 100.0f, hit) && hit.entity == 5 && hit.distance == 15.0f);
+	LEO_CHECK(!query.Raycast(glm::vec2(50.0f, -20.0f), glm::vec2(0.0f, 1.0f), 14.0f, hit));
+	LEO_CHECK(!query.Raycast(glm::vec2(50.0f, -20.0f), glm::vec2(0.0f, -1.0f), 100.0f, hit));
+}
+
+static void TestAgainstBruteForce()
+{
+	const f32 SIZE = 1000.0f;
+	std::vector<Circle> circles = RandomCircles(20000, SIZE, 1);
+	SpatialQuery query = Build(circles);
+	LEO_CHECK(query.EntityCount() == circles.size());
+
+	std::mt19937 rng(2);
+	std::uniform_real_distribution<f32> position(-50.0f, SIZE + 50.0f);
+	std::uniform_real_distribution<f32> unit(-1.0f, 1.0f);
+	std::vector<entity_id> out(circles.size());
+	std::vector<SpatialHit> hits(64);
+
+	u32 radius_mismatches = 0, aabb_mismatches = 0, nearest_mismatches = 0, ray_mismatches = 0;
+	u32 empty_results = 0;
+	for (u32 q = 0; q < 600; q++)
+	{
+		// every 6th query is large, some hit the dense cluster, some the empty quarter
+		glm::vec2 center = q % 5 == 0 ? glm::vec2(SIZE * 0.25f) + glm::vec2(unit(rng), unit(rng)) * 20.0f : glm::vec2(position(rng), position(rng));
+		f32 radius = q % 6 == 0 ? 300.0f : 2.0f + 20.0f * (unit(rng) + 1.0f);
+
+		u32 count = query.QueryRadius(center, radius, out);
+		std::vector<entity_id> expected = BruteRadius(circles, center, radius);
+		if (count != expected.size() || !SameSet(std::vector<entity_id>(out.begin(), out.begin() + count), expected)) radius_mismatches++;
+		if (count == 0) empty_results++;
+
+		glm::vec2 half(radius, radius * 0.5f);
+		count = query.QueryAABB(center - half, center + half, out);
+		expected = BruteAABB(circles, center - half, center + half);
+		if (count != expected.size() || !SameSet(std::vector<entity_id>(out.begin(), out.begin() + count), expected)) aabb_mismatches++;
+
+		// nearest: the distances must match, ties may come in any order
+		u32 k = q % 3 == 0 ? 1 : q % 3 == 1 ? 8 : 64;
+		f32 max_distance = q % 4 == 0 ? 15.0f : FLT_MAX;
+		u32 found = query.QueryNearest(center, std::span<SpatialHit>(hits.data(), k), max_distance);
+		std::vector<f32> nearest = BruteNearest(circles, center, k, max_distance);
+		bool same = found == nearest.size();
+		for (u32 i = 0; same && i < found; i++) same = hits[i].distance == nearest[i];
+		if (!same) nearest_mismatches++;
+
+		// rays, every 4th along an axis
+		glm::vec2 direction = q % 4 == 0 ? glm::vec2(q % 8 == 0 ? 1.0f : 0.0f, q % 8 == 0 ? 0.0f : -1.0f) : glm::normalize(glm::vec2(unit(rng), unit(rng)) + glm::vec2(1e-3f));
+		SpatialHit hit;
+		bool any = query.Raycast(center, direction, radius, hit);
+		f32 expected_t = BruteRaycast(circles, center, direction, radius);
+		if (any != (expected_t != INFINITY) || (any && hit.distance != expected_t)) ray_mismatches++;
+	}
+	LEO_CHECK(radius_mismatches == 0);
+	LEO_CHECK(aabb_mismatches == 0);
+	LEO_CHECK(nearest_mismatches == 0);
+	LEO_CHECK(ray_mismatches == 0);
+	LEO_CHECK(empty_results > 0); // the empty quarter was queried
+
+	// a radius covering everything, with a buffer too small: the full count, the buffer filled
+	const entity_id unset = std::numeric_limits<entity_id>::max();
+	std::vector<entity_id> few(100, unset);
+	LEO_CHECK(query.QueryRadius(glm::vec2(SIZE * 0.5f), SIZE * 2.0f, few) == circles.size());
+	LEO_CHECK(std::none_of(few.begin(), few.end(), [&](entity_id id) { return id == unset; }));
+	LEO_CHECK(query.QueryAABB(glm::vec2(-SIZE), glm::vec2(SIZE * 2.0f), std::span<entity_id>()) == circles.size());
+}
+
+static void BenchQueries(ThreadPool& pool)
+{
+	// 60k entities (entity_id is 16 bits) and 100k queries of each kind
+	constexpr u32 COUNT = 60000;
+	constexpr u32 QUERIES = 100000;
+	const f32 SIZE = 4000.0f;
+	std::vector<Circle> circles = RandomCircles(COUNT, SIZE, 3);
+
+	std::mt19937 rng(4);
+	std::uniform_real_distribution<f32> position(0.0f, SIZE);
+	std::uniform_real_distribution<f32> unit(-1.0f, 1.0f);
+	std::vector<glm::vec2> centers(QUERIES);
+	std::vector<glm::vec2> directions(QUERIES);
+	for (u32 i = 0; i < QUERIES; i++)
+	{
+		centers[i] = position(rng) < SIZE * 0.5f ? circles[i % COUNT].center : glm::vec2(position(rng), position(rng));
+		directions[i] = glm::normalize(glm::vec2(unit(rng), unit(rng)) + glm::vec2(1e-3f));
+	}
+
+	std::printf("SpatialQuery, %u entities, %u queries of each kind (%u workers), best of 3:\n", COUNT, QUERIES, pool.ThreadCount());
+
+	SpatialQuery query;
+	f32 build_ms = test::BestMillis(3, [&]() { query = Build(circles); });
+	std::printf("  build %7.2f ms\n", build_ms);
+
+	// per range buffers, the queries never allocate
+	constexpr u32 MAX_RANGES = 64;
+	std::vector<std::vector<entity_id>> buffers(MAX_RANGES, std::vector<entity_id>(256));
+	std::vector<std::vector<SpatialHit>> hit_buffers(MAX_RANGES, std::vector<SpatialHit>(8));
+	std::vector<u64> results(MAX_RANGES);
+
+	auto run = [&](const char* name, ThreadPool* query_pool, auto&& func) {
+		u64 total = 0;
+		f32 ms = test::BestMillis(3, [&]() {
+			std::fill(results.begin(), results.end(), 0);
+			auto range = [&](u32 begin, u32 end) {
+				u32 slot = (u32)((u64)begin * MAX_RANGES / QUERIES);
+				for (u32 i = begin; i < end; i++) results[slot] += func(i, buffers[slot], hit_buffers[slot]);
+			};
+			if (query_pool != nullptr) query_pool->ParallelFor(QUERIES, QUERIES / MAX_RANGES + 1, range);
+			else range(0, QUERIES);
+			total = 0;
+			for (u64 r : results) total += r;
+		});
+		std::printf("  %-8s %-8s %7.2f ms  %6.2f M queries/s  (%llu found)\n",
+			name, query_pool ? "pool" : "1 thread", ms, QUERIES / ms / 1000.0f, (unsigned long long)total);
+		return total;
+	};
+
+	for (ThreadPool* query_pool : { (ThreadPool*)nullptr, &pool })
+	{
+		run("radius", query_pool, [&](u32 i, std::vector<entity_id>& out, std::vector<SpatialHit>&) { return query.QueryRadius(centers[i], 10.0f, out); });
+		run("aabb", query_pool, [&](u32 i, std::vector<entity_id>& out, std::vector<SpatialHit>&) { return query.QueryAABB(centers[i] - 10.0f, centers[i] + 10.0f, out); });
+		run("nearest8", query_pool, [&](u32 i, std::vector<entity_id>&, std::vector<SpatialHit>& hits) { return query.QueryNearest(centers[i], hits); });
+		run("raycast", query_pool, [&](u32 i, std::vector<entity_id>&, std::vector<SpatialHit>&) { SpatialHit hit; return (u32)query.Raycast(centers[i], directions[i], 200.0f, hit); });
+	}
+
+	// the same radius queries one circle at a time, on a sample
+	constexpr u32 SAMPLE = 200;
+	u64 brute_found = 0;
+	f32 brute_ms = test::BestMillis(1, [&]() {
+		for (u32 i = 0; i < SAMPLE; i++) brute_found += BruteRadius(circles, centers[i], 10.0f).size();
+	});
+	std::printf("  radius brute force %7.2f ms for %u queries, %.0f ms for %u  (%llu found)\n",
+		brute_ms, SAMPLE, brute_ms * QUERIES / SAMPLE, QUERIES, (unsigned long long)brute_found);
+}
+
+int main()
+{
+	ThreadPool pool;
+
+	TestEmpty();
+	TestBoundaries();
+	TestAgainstBruteForce();
+	BenchQueries(pool);
+
+	return test::Result("SpatialQueryTests");
+}
@@ -0,0 +1,180 @@
+#include <cstring>
+#include <utility>
+#include <LEO/Graphics/GLBackend.h>
+#include <LEO/Graphics/StreamBuffer.h>
+#include "LeoTest.h"
+
+using namespace leo;
+
+static constexpr u32 INVALID = StreamAllocator::INVALID_OFFSET;
+
+static void TestAlignment()
+{
+	FakeFenceBackend fences;
+	StreamAllocator ring(1024, 3, fences);
+
+	LEO_CHECK(ring.Allocate(3, 1) == 0);
+	LEO_CHECK(ring.Allocate(8, 16) == 16);
+	LEO_CHECK(ring.Allocate(4, 12) == 24); // not a power of two
+	LEO_CHECK(ring.Allocate(1, 256) == 256);
+	LEO_CHECK(ring.Allocate(1025, 1) == INVALID); // bigger than a region
+	ring.EndFrame();
+
+	// the second region starts at 1024, aligned in the whole buffer and not in the region
+	LEO_CHECK(ring.Allocate(4, 48) == 1056);
+	LEO_CHECK(ring.Allocate(4, 4) == 1060);
+	LEO_CHECK(ring.GetStats().allocations == 6 && ring.GetStats().bytes == 3 + 8 + 4 + 1 + 4 + 4);
+}
+
+static void TestWrapAround()
+{
+	FakeFenceBackend fences;
+	StreamAllocator ring(256, 3, fences);
+
+	// a frame bigger than a region spills into the next one, the first is fenced when the ring leaves it
+	LEO_CHECK(ring.Allocate(200, 16) == 0);
+	LEO_CHECK(ring.Allocate(100, 16) == 256);
+	LEO_CHECK(ring.Region() == 1 && ring.GetStats().wraps == 1);
+	LEO_CHECK(fences.LastInserted() == 1 && fences.LiveFences() == 1);
+
+	// the alignment padding does not fit in the next region either
+	LEO_CHECK(ring.Allocate(200, 384) == INVALID);
+	LEO_CHECK(ring.Region() == 2 && ring.GetStats().wraps == 2);
+
+	// the end of the ring goes back to region 0, after its fence
+	ring.EndFrame(); // nothing was written in region 2, it is kept
+	LEO_CHECK(ring.Region() == 2 && fences.LastInserted() == 2);
+	LEO_CHECK(ring.Allocate(256, 1) == 512);
+	fences.CompleteAll();
+	LEO_CHECK(ring.Allocate(1, 1) == 0 && ring.Region() == 0);
+	LEO_CHECK(ring.GetStats().stalls == 0 && fences.Waits() == 0);
+}
+
+static void TestStalls()
+{
+	// the GPU one frame behind: the ring never catches a pending fence
+	{
+		FakeFenceBackend fences;
+		StreamAllocator ring(64, 3, fences);
+		for (u32 frame = 0; frame < 100; frame++)
+		{
+			LEO_CHECK(ring.Allocate(32, 16) == ring.Region() * 64);
+			ring.EndFrame();
+			fences.Complete(fences.LastInserted() - 1);
+		}
+		LEO_CHECK(ring.GetStats().stalls == 0 && fences.Waits() == 0);
+		LEO_CHECK(ring.GetStats().frames == 100);
+	}
+
+	// the GPU never catches up: from the 4th frame on, each frame waits for the region it reuses
+	{
+		FakeFenceBackend fences;
+		StreamAllocator ring(64, 3, fences);
+		for (u32 frame = 0; frame < 3; frame++)
+		{
+			ring.Allocate(32, 16);
+			ring.EndFrame();
+		}
+		LEO_CHECK(ring.GetStats().stalls == 0 && fences.LiveFences() == 3);
+
+		LEO_CHECK(ring.Allocate(32, 16) == 0);
+		LEO_CHECK(ring.GetStats().stalls == 1 && fences.Waits() == 1);
+		LEO_CHECK(fences.IsSignaled(1) && !fences.IsSignaled(2)); // only the fence of region 0 was waited for
+		ring.EndFrame();
+
+		LEO_CHECK(ring.Allocate(32, 16) == 64);
+		LEO_CHECK(ring.GetStats().stalls == 2 && fences.Waits() == 2);
+	}
+
+	// a wrap in the middle of a frame stalls too
+	{
+		FakeFenceBackend fences;
+		StreamAllocator ring(64, 2, fences);
+		ring.Allocate(64, 1);
+		ring.EndFrame();
+		ring.Allocate(48, 1);
+		LEO_CHECK(ring.Allocate(32, 1) == 0); // region 1 full, region 0 still pending
+		LEO_CHECK(ring.GetStats().stalls == 1 && ring.GetStats().wraps == 1);
+	}
+}
+
+static void TestFencesReleased()
+{
+	FakeFenceBackend fences;
+	{
+		StreamAllocator ring(64, 3, fences);
+		for (u32 frame = 0; frame < 50; frame++)
+		{
+			ring.Allocate(16, 16);
+			ring.EndFrame();
+			if (frame % 2 == 0) fences.CompleteAll();
+			LEO_CHECK(fences.LiveFences() <= ring.RegionCount());
+		}
+
+		// a frame without allocations does not fence anything
+		u64 last = fences.LastInserted();
+		ring.EndFrame();
+		ring.EndFrame();
+		LEO_CHECK(fences.LastInserted() == last);
+
+		// moved: the fences follow the ring, the assigned-to ring deletes its own
+		StreamAllocator other(64, 3, fences);
+		other.Allocate(16, 16);
+		other.EndFrame();
+		StreamAllocator moved(std::move(ring));
+		other = std::move(moved);
+		LEO_CHECK(fences.LiveFences() <= other.RegionCount());
+	}
+	LEO_CHECK(fences.LiveFences() == 0);
+}
+
+static void TestStreamBuffer()
+{
+	FakeFenceBackend fences;
+	{
+		StreamBuffer buffer(4096, 3, &fences);
+		LEO_CHECK(buffer.ID() != 0 && buffer.Allocator().Size() == 3 * 4096);
+		ResetMockGLCallCounts();
+
+		u8* first = nullptr;
+		for (u32 frame = 0; frame < 10; frame++)
+		{
+			StreamAllocation a = buffer.Allocate(100, 64);
+			StreamAllocation b = buffer.Allocate(1000, 256);
+			LEO_CHECK_OR_RETURN(a && b);
+			if (frame == 0) first = (u8*)a.ptr - a.offset;
+
+			// the pointers are the mapping at the returned offsets, aligned like the offsets
+			LEO_CHECK((u8*)a.ptr == first + a.offset && (u8*)b.ptr == first + b.offset);
+			LEO_CHECK(a.offset % 64 == 0 && b.offset % 256 == 0 && b.offset >= a.offset + 100);
+			LEO_CHECK(a.offset / 4096 == frame % 3 && b.offset / 4096 == frame % 3);
+			std::memset(a.ptr, (int)frame, a.size);
+			std::memset(b.ptr, (int)frame, b.size);
+
+			buffer.EndFrame();
+			fences.Complete(fences.LastInserted() - 1);
+		}
+
+		// mapped once: writing frames never touches the GL buffer
+		LEO_CHECK(GetMockGLCallCounts().Total() == 0);
+		LEO_CHECK(buffer.GetStats().stalls == 0 && buffer.GetStats().allocations == 20);
+
+		// too big for a region: logged, an empty allocation
+		LEO_CHECK(!buffer.Allocate(4097));
+	}
+	LEO_CHECK(fences.LiveFences() == 0);
+}
+
+int main()
+{
+	TestAlignment();
+	TestWrapAround();
+	TestStalls();
+	TestFencesReleased();
+
+	InstallMockGLBackend();
+	TestStreamBuffer();
+	RestoreGLBackend();
+
+	return test::Result("StreamBufferTests");
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <LEO/Utilities/LeoTypes.h>
+
+namespace leo::test
+{
+	// A UV sphere as OBJ text: a v, vt and vn per grid point and a 4 sided face per grid cell, so the importer
+	// triangulates every face and merges the corners shared by neighbouring cells.
+	// The seam and the poles repeat positions with other uvs, they stay separate vertices:
+	// (rings + 1) * (segments + 1) vertices and rings * segments * 2 triangles once imported.
+	// relative_indices writes the faces with negative indices, counted back from the last v, vt and vn
+	inline std::string GenerateObjSphere(u32 rings, u32 segments, bool relative_indices = false)
+	{
+		std::string text;
+		text.reserve((u64)(rings + 1) * (segments + 1) * 110 + (u64)rings * segments * 60);
+		text += "# synthetic sphere\no sphere\n";
+
+		char line[128];
+		for (u32 r = 0; r <= rings; r++)
+		{
+			f32 v = (f32)r / rings;
+			f32 theta = v * 3.14159265f;
+			for (u32 s = 0; s <= segments; s++)
+			{
+				f32 u = (f32)s / segments;
+				f32 phi = u * 2.0f * 3.14159265f;
+				f32 x = std::sin(theta) * std::cos(phi);
+				f32 y = std::cos(theta);
+				f32 z = std::sin(theta) * std::sin(phi);
+
+				text.append(line, std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n", x, y, z));
+				text.append(line, std::snprintf(line, sizeof(line), "vt %.6f %.6f\n", u, 1.0f - v));
+				text.append(line, std::snprintf(line, sizeof(line), "vn %.6f %.6f %.6f\n", x, y, z));
+			}
+		}
+
+		text += "s 1\n";
+		for (u32 r = 0; r < rings; r++)
+		{
+			for (u32 s = 0; s < segments; s++)
+			{
+				// 1 based, the same index for v, vt and vn. -1 is the last point (long long for %lld)
+				long long a = (long long)r * (segments + 1) + s + 1;
+				long long b = a + segments + 1;
+				if (relative_indices)
+				{
+					const long long points = (long long)(rings + 1) * (segments + 1);
+					a -= points + 1;
+					b -= points + 1;
+				}
+				text.append(line, std::snprintf(line, sizeof(line), "f %lld/%lld/%lld %lld/%lld/%lld %lld/%lld/%lld %lld/%lld/%lld\n",
+					a, a, a, b, b, b, b + 1, b + 1, b + 1, a + 1, a + 1, a + 1));
+			}
+		}
+		return text;
+	}
+}
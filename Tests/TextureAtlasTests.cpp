@@ -0,0 +1,330 @@
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <random>
+#include <vector>
+#include <glad/glad.h>
+#include <LEO/Graphics/GLBackend.h>
+#include <LEO/Graphics/TextureAtlas.h>
+#include "LeoTest.h"
+
+using namespace leo;
+
+struct Size
+{
+	u32 width;
+	u32 height;
+};
+
+// ---------------- SkylinePacker ----------------
+
+// Packs sizes on as many pages as needed (first page with room), checks that every rect is inside its page
+// and that no two overlap, then reports the occupancy and the speed
+static void PackAndCheck(const char* name, std::vector<Size> sizes, bool sorted)
+{
+	constexpr u32 PAGE = 2048;
+	if (sorted)
+	{
+		std::stable_sort(sizes.begin(), sizes.end(), [](Size a, Size b) { return a.height != b.height ? a.height > b.height : a.width > b.width; });
+	}
+
+	std::vector<SkylinePacker> pages;
+	std::vector<AtlasRect> rects(sizes.size());
+	std::vector<u32> rect_pages(sizes.size());
+
+	Timer timer;
+	for (u64 i = 0; i < sizes.size(); i++)
+	{
+		u32 page = 0;
+		while (page < pages.size() && !pages[page].Insert(sizes[i].width, sizes[i].height, rects[i])) page++;
+		if (page == pages.size())
+		{
+			pages.emplace_back(PAGE, PAGE);
+			LEO_CHECK_OR_RETURN(pages.back().Insert(sizes[i].width, sizes[i].height, rects[i]));
+		}
+		rect_pages[i] = page;
+	}
+	f32 ms = timer.ElapsedMillis();
+
+	std::vector<std::vector<u8>> covered(pages.size(), std::vector<u8>((u64)PAGE * PAGE));
+	u32 outside = 0;
+	u32 overlaps = 0;
+	for (u64 i = 0; i < rects.size(); i++)
+	{
+		const AtlasRect& r = rects[i];
+		LEO_CHECK(r.width == sizes[i].width && r.height == sizes[i].height);
+		if (r.x + r.width > PAGE || r.y + r.height > PAGE)
+		{
+			outside++;
+			continue;
+		}
+		for (u32 y = r.y; y < r.y + r.height; y++)
+		{
+			for (u32 x = r.x; x < r.x + r.width; x++)
+			{
+				u8& texel = covered[rect_pages[i]][(u64)y * PAGE + x];
+				overlaps += texel;
+				texel = 1;
+			}
+		}
+	}
+	LEO_CHECK(outside == 0);
+	LEO_CHECK(overlaps == 0);
+
+	u64 area = 0;
+	for (const Size& size : sizes) area += (u64)size.width * size.height;
+	u64 used = 0;
+	for (const SkylinePacker& page : pages) used += page.UsedArea();
+	LEO_CHECK(used == area);
+
+	// the last page is partly filled, the occupancy of the full ones tells how tight the packing is
+	f64 full = 0.0;
+	for (u64 i = 0; i + 1 < pages.size(); i++) full += pages[i].Occupancy();
+
+	std::printf("  %-26s %-11s %zu pages, full pages %5.1f%% occupied, %6.2f ms, %5.2f M inserts/s\n",
+		name, sorted ? "tallest 1st" : "in order", pages.size(), pages.size() > 1 ? 100.0 * full / (pages.size() - 1) : 0.0,
+		ms, sizes.size() / ms / 1000.0f);
+}
+
+static void TestPacker()
+{
+	SkylinePacker packer(64, 32);
+	AtlasRect rect;
+	LEO_CHECK(!packer.Insert(65, 1, rect) && !packer.Insert(1, 33, rect));
+	LEO_CHECK(packer.Insert(64, 32, rect) && rect.x == 0 && rect.y == 0);
+	LEO_CHECK(!packer.Insert(1, 1, rect));
+	LEO_CHECK(packer.Occupancy() == 1.0f);
+
+	// bottom left: the second rect goes next to the first, the third on the lowest top
+	packer.Reset(64, 64);
+	LEO_CHECK(packer.Insert(32, 16, rect) && rect.x == 0 && rect.y == 0);
+	LEO_CHECK(packer.Insert(16, 8, rect) && rect.x == 32 && rect.y == 0);
+	LEO_CHECK(packer.Insert(16, 4, rect) && rect.x == 48 && rect.y == 0);
+	LEO_CHECK(packer.Insert(32, 4, rect) && rect.x == 32 && rect.y == 8);
+
+	std::printf("SkylinePacker, 4000 rects with 4 texels of padding on 2048x2048 pages:\n");
+	std::mt19937 rng(7);
+	for (u32 distribution = 0; distribution < 3; distribution++)
+	{
+		std::vector<Size> sizes;
+		for (u32 i = 0; i < 4000; i++)
+		{
+			if (distribution == 0)
+			{
+				std::uniform_int_distribution<u32> side(8, 128);
+				sizes.push_back({ side(rng) + 4, side(rng) + 4 });
+			}
+			else if (distribution == 1)
+			{
+				u32 side = 8u << (rng() % 5);
+				sizes.push_back({ side + 4, side + 4 });
+			}
+			else
+			{
+				std::uniform_int_distribution<u32> side(8, 64);
+				u32 width = side(rng);
+				sizes.push_back({ width + 4, width * (1 + (u32)(rng() % 3)) + 4 });
+			}
+		}
+
+		const char* name = distribution == 0 ? "uniform 8-128" : distribution == 1 ? "power of 2 squares 8-128" : "8-64, 1-3x as tall";
+		PackAndCheck(name, sizes, false);
+		PackAndCheck(name, sizes, true);
+	}
+}
+
+// ---------------- TextureAtlas ----------------
+
+// What the atlas uploaded, rebuilt from the calls the mock backend receives: a page per texture id (2D)
+// or per layer (array)
+static std::map<u32, std::vector<u8>> s_pages;
+static u32 s_pageSize = 0;
+static u32 s_boundTexture = 0;
+static PFNGLBINDTEXTUREPROC s_bindTexture;
+static PFNGLTEXIMAGE2DPROC s_texImage2D;
+static PFNGLTEXSUBIMAGE2DPROC s_texSubImage2D;
+static PFNGLTEXSUBIMAGE3DPROC s_texSubImage3D;
+
+static void CopyRows(std::vector<u8>& page, GLint x, GLint y, GLsizei width, GLsizei height, const void* pixels)
+{
+	page.resize((u64)s_pageSize * s_pageSize * 4);
+	for (GLsizei row = 0; row < height; row++)
+	{
+		std::memcpy(&page[((u64)(y + row) * s_pageSize + x) * 4], (const u8*)pixels + (u64)row * width * 4, (u64)width * 4);
+	}
+}
+
+static void APIENTRY BindTexture(GLenum target, GLuint texture)
+{
+	s_boundTexture = texture;
+	s_bindTexture(target, texture);
+}
+
+static void APIENTRY TexImage2D(GLenum target, GLint level, GLint internal_format, GLsizei width, GLsizei height, GLint border,
+	GLenum format, GLenum type, const void* pixels)
+{
+	s_texImage2D(target, level, internal_format, width, height, border, format, type, pixels);
+	if (level == 0 && pixels != nullptr) CopyRows(s_pages[s_boundTexture], 0, 0, width, height, pixels);
+}
+
+static void APIENTRY TexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
+{
+	s_texSubImage2D(target, level, x, y, width, height, format, type, pixels);
+	if (level == 0) CopyRows(s_pages[s_boundTexture], x, y, width, height, pixels);
+}
+
+static void APIENTRY TexSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height, GLsizei depth,
+	GLenum format, GLenum type, const void* pixels)
+{
+	s_texSubImage3D(target, level, x, y, z, width, height, depth, format, type, pixels);
+	if (level == 0) CopyRows(s_pages[z], x, y, width, height, pixels);
+}
+
+static ImageData MakeImage(u32 width, u32 height, u32 seed)
+{
+	ImageData image;
+	image.width = (i32)width;
+	image.height = (i32)height;
+	image.bpp = 4;
+	// freed by ImageDataDeleter, which frees like stb: new[]
+	u8* pixels = reinterpret_cast<u8*>(new char[(u64)width * height * 4]);
+	for (u32 i = 0; i < width * height; i++)
+	{
+		u32 texel = seed * 2654435761u + i * 40503u;
+		std::memcpy(pixels + (u64)i * 4, &texel, 4);
+	}
+	image.data.reset(pixels);
+	return image;
+}
+
+// The image is in its rect of the uploaded page and its edges fill the padding around it
+static bool CheckUploaded(const TextureAtlas& atlas, const AtlasParams& params, const ImageData& image, AtlasHandle handle)
+{
+	std::optional<AtlasEntry> entry = atlas.Get(handle);
+	LEO_CHECK_OR_RETURN(entry.has_value(), false);
+
+	const AtlasRect& r = entry->rect;
+	const i32 pad = (i32)params.padding;
+	const f32 size = (f32)params.pageSize;
+	LEO_CHECK_OR_RETURN(r.width == (u32)image.width && r.height == (u32)image.height, false);
+	LEO_CHECK_OR_RETURN(r.x >= params.padding && r.y >= params.padding, false);
+	LEO_CHECK_OR_RETURN(r.x + r.width + params.padding <= params.pageSize && r.y + r.height + params.padding <= params.pageSize, false);
+	LEO_CHECK_OR_RETURN(entry->uvMin == glm::vec2(r.x / size, r.y / size), false);
+	LEO_CHECK_OR_RETURN(entry->uvMax == glm::vec2((r.x + r.width) / size, (r.y + r.height) / size), false);
+
+	const u32 key = params.arrayTexture ? entry->page : atlas.PageTexture(entry->page)->GetID();
+	LEO_CHECK_OR_RETURN(s_pages.count(key) != 0, false);
+	const std::vector<u8>& page = s_pages[key];
+
+	for (i32 y = -pad; y < image.height + pad; y++)
+	{
+		for (i32 x = -pad; x < image.width + pad; x++)
+		{
+			i32 sx = std::clamp(x, 0, image.width - 1);
+			i32 sy = std::clamp(y, 0, image.height - 1);
+			const u8* texel = &page[((u64)(r.y + y) * params.pageSize + r.x + x) * 4];
+			LEO_CHECK_OR_RETURN(std::memcmp(texel, image.data.get() + ((u64)sy * image.width + sx) * 4, 4) == 0, false);
+		}
+	}
+	return true;
+}
+
+static void TestAtlas(bool array_texture)
+{
+	AtlasParams params;
+	params.pageSize = 512;
+	params.maxPages = 3;
+	params.padding = 2;
+	params.arrayTexture = array_texture;
+
+	s_pages.clear();
+	s_pageSize = params.pageSize;
+	TextureAtlas atlas(params);
+
+	LEO_CHECK(!atlas.Insert(MakeImage(509, 10, 1)).IsValid()); // larger than a page with its padding
+	AtlasHandle page_filler = atlas.Insert(MakeImage(508, 508, 2));
+	LEO_CHECK(page_filler.IsValid());
+
+	std::mt19937 rng(11);
+	std::vector<ImageData> images;
+	for (u32 i = 0; i < 120; i++) images.push_back(MakeImage(8 + rng() % 56, 8 + rng() % 56, i + 10));
+	std::vector<AtlasHandle> handles = atlas.Insert(std::span<const ImageData>(images));
+	LEO_CHECK_OR_RETURN(handles.size() == images.size());
+	LEO_CHECK(atlas.PageCount() >= 2 && atlas.Stats().rejected == 1);
+
+	LEO_CHECK(atlas.Upload() > 0);
+	for (u64 i = 0; i < images.size(); i++) LEO_CHECK_OR_RETURN(CheckUploaded(atlas, params, images[i], handles[i]));
+	LEO_CHECK(atlas.Upload() == 0); // nothing changed
+
+	// only the rows of a new image are sent again
+	ImageData small = MakeImage(16, 16, 999);
+	AtlasHandle small_handle = atlas.Insert(small);
+	LEO_CHECK(small_handle.IsValid());
+	LEO_CHECK(atlas.Upload() == (16ull + 2 * params.padding) * params.pageSize * 4);
+	LEO_CHECK(CheckUploaded(atlas, params, small, small_handle));
+
+	// an evicted page is reused in place, its handles stop resolving
+	const Texture* first_page = atlas.PageTexture(0);
+	atlas.EvictPage(0);
+	LEO_CHECK(!atlas.Get(page_filler).has_value());
+	LEO_CHECK(!atlas.Get(AtlasHandle{}).has_value());
+
+	ImageData large = MakeImage(500, 500, 5);
+	AtlasHandle large_handle = atlas.Insert(large);
+	LEO_CHECK_OR_RETURN(large_handle.IsValid() && atlas.Get(large_handle)->page == 0);
+	LEO_CHECK(atlas.PageTexture(0) == first_page);
+	atlas.Upload();
+	LEO_CHECK(CheckUploaded(atlas, params, large, large_handle));
+	for (u64 i = 0; i < images.size(); i++)
+	{
+		if (atlas.Get(handles[i]).has_value()) LEO_CHECK_OR_RETURN(CheckUploaded(atlas, params, images[i], handles[i]));
+	}
+
+	// full: the inserts are rejected, the pages stay as they are
+	u32 inserted = 0;
+	while (atlas.Insert(MakeImage(100, 100, inserted)).IsValid()) inserted++;
+	LEO_CHECK(atlas.PageCount() == params.maxPages);
+	atlas.Upload();
+	LEO_CHECK(atlas.Stats().occupancy > 0.5f);
+}
+
+static void TestAtlasMipmaps()
+{
+	// the mips of a page are regenerated when images are added after its creation
+	AtlasParams params;
+	params.pageSize = 64;
+	params.minFilter = TextureMinFiltering::MIN_LINEAR_MIPMAP_LINEAR;
+	s_pageSize = params.pageSize;
+
+	TextureAtlas atlas(params);
+	atlas.Insert(MakeImage(8, 8, 1));
+	atlas.Upload();
+
+	ResetMockGLCallCounts();
+	atlas.Insert(MakeImage(8, 8, 2));
+	atlas.Upload();
+	LEO_CHECK(GetMockGLCallCounts()[GLFunction::GenerateMipmap] > 0);
+}
+
+int main()
+{
+	TestPacker();
+
+	InstallMockGLBackend();
+	s_bindTexture = glad_glBindTexture;
+	s_texImage2D = glad_glTexImage2D;
+	s_texSubImage2D = glad_glTexSubImage2D;
+	s_texSubImage3D = glad_glTexSubImage3D;
+	glad_glBindTexture = BindTexture;
+	glad_glTexImage2D = TexImage2D;
+	glad_glTexSubImage2D = TexSubImage2D;
+	glad_glTexSubImage3D = TexSubImage3D;
+
+	TestAtlas(false);
+	TestAtlas(true);
+	TestAtlasMipmaps();
+
+	RestoreGLBackend();
+
+	return test::Result("TextureAtlasTests");
+}
@@ -0,0 +1,198 @@
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <LEO/Graphics/VertexPacking.h>
+#include "LeoTest.h"
+
+using namespace leo;
+
+// Round trips of every quantized format against the bounds documented in VertexPacking.h.
+// The bounds are exact in real numbers, SLACK covers the float rounding of the decode
+
+static constexpr f64 SLACK = 1e-7;
+
+static void TestHalf()
+{
+	// every finite half decodes to a float that encodes back to it
+	u32 mismatches = 0;
+	for (u32 h = 0; h <= 0xFFFF; h++)
+	{
+		if ((h & 0x7C00) == 0x7C00) continue; // inf and nan
+		if (PackHalf(UnpackHalf((u16)h)) != h) mismatches++;
+	}
+	LEO_CHECK(mismatches == 0);
+
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<f64> exponent(-14.0, std::log2(65504.0));
+	std::uniform_real_distribution<f32> subnormal(0.0f, std::ldexp(1.0f, -14));
+
+	f64 max_relative = 0.0;
+	f64 max_absolute = 0.0;
+	for (u32 i = 0; i < 1000000; i++)
+	{
+		f32 sign = (i & 1) ? -1.0f : 1.0f;
+
+		f32 v = sign * (f32)std::exp2(exponent(rng));
+		max_relative = std::max(max_relative, std::abs((f64)UnpackHalf(PackHalf(v)) - v) / std::abs(v));
+
+		f32 small = sign * subnormal(rng);
+		max_absolute = std::max(max_absolute, std::abs((f64)UnpackHalf(PackHalf(small)) - small));
+	}
+	LEO_CHECK(max_relative <= std::ldexp(1.0, -11));
+	LEO_CHECK(max_absolute <= std::ldexp(1.0, -25));
+	LEO_CHECK(UnpackHalf(PackHalf(65504.0f)) == 65504.0f && UnpackHalf(PackHalf(-65504.0f)) == -65504.0f);
+
+	std::printf("  half:        max relative error %.3g (bound %.3g), below 2^-14 max absolute %.3g (bound %.3g)\n",
+		max_relative, std::ldexp(1.0, -11), max_absolute, std::ldexp(1.0, -25));
+}
+
+template<typename Pack, typename Unpack>
+static f64 MaxScalarError(f32 min, f32 max, Pack pack, Unpack unpack)
+{
+	constexpr u32 STEPS = 1 << 20;
+
+	f64 max_error = 0.0;
+	for (u32 i = 0; i <= STEPS; i++)
+	{
+		f32 v = min + (max - min) * (f32)((f64)i / STEPS);
+		max_error = std::max(max_error, std::abs((f64)unpack(pack(v)) - v));
+	}
+	return max_error;
+}
+
+static void TestNormalized16()
+{
+	f64 unorm = MaxScalarError(0.0f, 1.0f, PackUnorm16, UnpackUnorm16);
+	LEO_CHECK(unorm <= 1.0 / (2.0 * 65535.0) + SLACK);
+	LEO_CHECK(UnpackUnorm16(PackUnorm16(0.0f)) == 0.0f && UnpackUnorm16(PackUnorm16(1.0f)) == 1.0f);
+	LEO_CHECK(UnpackUnorm16(PackUnorm16(-0.5f)) == 0.0f && UnpackUnorm16(PackUnorm16(2.0f)) == 1.0f);
+
+	f64 snorm = MaxScalarError(-1.0f, 1.0f, PackSnorm16, UnpackSnorm16);
+	LEO_CHECK(snorm <= 1.0 / (2.0 * 32767.0) + SLACK);
+	LEO_CHECK(UnpackSnorm16(PackSnorm16(0.0f)) == 0.0f);
+	LEO_CHECK(UnpackSnorm16(PackSnorm16(-1.0f)) == -1.0f && UnpackSnorm16(PackSnorm16(1.0f)) == 1.0f);
+	LEO_CHECK(UnpackSnorm16(PackSnorm16(-3.0f)) == -1.0f && UnpackSnorm16(PackSnorm16(3.0f)) == 1.0f);
+
+	std::printf("  unorm16:     max error %.3g (bound %.3g)\n", unorm, 1.0 / (2.0 * 65535.0));
+	std::printf("  snorm16:     max error %.3g (bound %.3g)\n", snorm, 1.0 / (2.0 * 32767.0));
+}
+
+static void TestSnorm10()
+{
+	std::mt19937 rng(2);
+	std::uniform_real_distribution<f32> component(-1.0f, 1.0f);
+
+	f64 max_error = 0.0;
+	for (u32 i = 0; i < 1000000; i++)
+	{
+		glm::vec4 v(component(rng), component(rng), component(rng), 1.0f);
+		glm::vec4 decoded = UnpackSnorm10(PackSnorm10(v));
+		for (u32 c = 0; c < 3; c++) max_error = std::max(max_error, std::abs((f64)decoded[c] - v[c]));
+	}
+	LEO_CHECK(max_error <= 1.0 / (2.0 * 511.0) + SLACK);
+
+	// the ends and the clamping
+	LEO_CHECK(UnpackSnorm10(PackSnorm10(glm::vec4(-1.0f, 1.0f, 0.0f, 1.0f))) == glm::vec4(-1.0f, 1.0f, 0.0f, 1.0f));
+	LEO_CHECK(UnpackSnorm10(PackSnorm10(glm::vec4(-2.0f, 2.0f, 0.0f, 1.0f))) == glm::vec4(-1.0f, 1.0f, 0.0f, 1.0f));
+
+	// w has 2 bits: -1, 0 or 1
+	for (f32 w : { -1.0f, -0.7f, -0.3f, 0.0f, 0.3f, 0.7f, 1.0f })
+	{
+		f32 decoded = UnpackSnorm10(PackSnorm10(glm::vec4(0.0f, 0.0f, 0.0f, w))).w;
+		LEO_CHECK(decoded == std::round(w));
+	}
+
+	std::printf("  2_10_10_10:  max xyz error %.3g (bound %.3g)\n", max_error, 1.0 / (2.0 * 511.0));
+}
+
+static f64 AngleDegrees(glm::dvec3 a, glm::dvec3 b)
+{
+	// atan2 keeps its precision for tiny angles, acos of the dot does not
+	return glm::degrees(std::atan2(glm::length(glm::cross(a, b)), glm::dot(a, b)));
+}
+
+static void TestOctahedral()
+{
+	std::vector<glm::vec3> normals = {
+		{ 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 },
+		{ -0.0f, 0, -1 }, { 0, -0.0f, -1 }, { 0.6f, 0.8f, 0 }, { -0.6f, 0, -0.8f },
+	};
+	for (f32 x : { -1.0f, 1.0f }) for (f32 y : { -1.0f, 1.0f }) for (f32 z : { -1.0f, 1.0f }) {
+		normals.push_back(glm::normalize(glm::vec3(x, y, z)));
+	}
+
+	std::mt19937 rng(3);
+	std::normal_distribution<f32> gaussian;
+	while (normals.size() < 1000000)
+	{
+		glm::vec3 n(gaussian(rng), gaussian(rng), gaussian(rng));
+		if (glm::length(n) > 1e-3f) normals.push_back(glm::normalize(n));
+	}
+
+	f64 max_degrees = 0.0;
+	for (const glm::vec3& n : normals)
+	{
+		glm::vec3 decoded = UnpackOctahedral(PackOctahedral(n));
+		max_degrees = std::max(max_degrees, AngleDegrees(glm::dvec3(n), glm::dvec3(decoded)));
+	}
+	LEO_CHECK(max_degrees < 0.004);
+	LEO_CHECK(UnpackOctahedral(PackOctahedral(glm::vec3(0, 0, -1))) == glm::vec3(0, 0, -1));
+
+	std::printf("  octahedral:  max angular error %.3g degrees (bound 0.004)\n", max_degrees);
+}
+
+static void TestPackVertices()
+{
+	// position, normal, uv
+	const f32 vertices[] = {
+		1.5f, -2.0f, 0.25f,   0.0f, 0.0f, -1.0f,   0.25f, 0.75f,
+		-3.0f, 4.0f, 8.0f,    0.6f, 0.8f, 0.0f,    1.0f, 0.0f,
+	};
+	const ElementType src[] = { ElementType::FLOAT3, ElementType::FLOAT3, ElementType::FLOAT2 };
+	const ElementType dst[] = { ElementType::HALF4, ElementType::SHORT2_N, ElementType::USHORT2_N };
+
+	std::vector<u8> packed = PackVertices(vertices, src, dst);
+	const u32 stride = 4 * sizeof(u16) + sizeof(u32) + 2 * sizeof(u16);
+	LEO_CHECK_OR_RETURN(packed.size() == 2 * stride);
+
+	for (u32 v = 0; v < 2; v++)
+	{
+		const f32* in = vertices + v * 8;
+		const u8* out = packed.data() + v * stride;
+
+		u16 half[4];
+		std::memcpy(half, out, sizeof(half));
+		for (u32 c = 0; c < 3; c++) LEO_CHECK(UnpackHalf(half[c]) == in[c]);
+		LEO_CHECK(UnpackHalf(half[3]) == 1.0f); // the missing w
+
+		u32 normal;
+		std::memcpy(&normal, out + 8, sizeof(u32));
+		LEO_CHECK(AngleDegrees(glm::dvec3(UnpackOctahedral(normal)), glm::dvec3(in[3], in[4], in[5])) < 0.004);
+
+		u16 uv[2];
+		std::memcpy(uv, out + 12, sizeof(uv));
+		for (u32 c = 0; c < 2; c++) LEO_CHECK(std::abs(UnpackUnorm16(uv[c]) - in[6 + c]) <= 1.0 / (2.0 * 65535.0) + SLACK);
+	}
+
+	// a normal as 2_10_10_10 with w = 1
+	const ElementType src_normal[] = { ElementType::FLOAT3 };
+	const ElementType dst_normal[] = { ElementType::INT_2_10_10_10_N };
+	std::vector<u8> normals = PackVertices(std::span<const f32>(vertices + 3, 3), src_normal, dst_normal);
+	LEO_CHECK_OR_RETURN(normals.size() == sizeof(u32));
+	u32 normal;
+	std::memcpy(&normal, normals.data(), sizeof(u32));
+	LEO_CHECK(UnpackSnorm10(normal) == glm::vec4(0.0f, 0.0f, -1.0f, 1.0f));
+}
+
+int main()
+{
+	std::printf("Round trip errors:\n");
+	TestHalf();
+	TestNormalized16();
+	TestSnorm10();
+	TestOctahedral();
+	TestPackVertices();
+
+	return test::Result("VertexPackingTests");
+}
@@ -0,0 +1,19 @@
+#version 430 core
+
+in vec2 vLocal;
+in float vRadius;
+in vec4 vColor;
+
+out vec4 outColor;
+
+void main(void)
+{
+	// signed distance to the circle edge, fwidth keeps the edge one pixel wide at any scale
+	float d = length(vLocal) - vRadius;
+	float w = fwidth(d);
+	float alpha = 1.0f - smoothstep(-w, w, d);
+
+	if (alpha <= 0.0f) discard;
+
+	outColor = vec4(vColor.rgb, vColor.a * alpha);
+}
\ No newline at end of file
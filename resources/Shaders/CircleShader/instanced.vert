@@ -0,0 +1,22 @@
+#version 430 core
+layout(location = 0) in vec2 aCorner;   // unit quad in [-1, 1]
+layout(location = 1) in vec2 iCenter;   // per instance
+layout(location = 2) in float iRadius;
+layout(location = 3) in vec4 iColor;
+
+uniform mat4 u_ViewProj;
+
+out vec2 vLocal;
+out float vRadius;
+out vec4 vColor;
+
+void main(void)
+{
+	// one pixel of margin so the antialiased edge is not cut by the quad
+	float extent = iRadius + 1.0f;
+
+	vLocal = aCorner * extent;
+	vRadius = iRadius;
+	vColor = iColor;
+	gl_Position = u_ViewProj * vec4(iCenter + vLocal, 0.0f, 1.0f);
+}
\ No newline at end of file
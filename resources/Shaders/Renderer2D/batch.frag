@@ -0,0 +1,13 @@
+#version 430 core
+
+in vec2 vUV;
+in vec4 vColor;
+
+out vec4 outColor;
+
+uniform sampler2D u_Texture;
+
+void main(void)
+{
+	outColor = vColor * texture(u_Texture, vUV);
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#version 430 core
+layout(location = 0) in vec2 aPos;
+layout(location = 1) in vec2 aUV;
+layout(location = 2) in vec4 aColor;
+
+uniform mat4 u_ViewProj;
+
+out vec2 vUV;
+out vec4 vColor;
+
+void main(void)
+{
+	vUV = aUV;
+	vColor = aColor;
+	gl_Position = u_ViewProj * vec4(aPos, 0.0f, 1.0f);
+}
\ No newline at end of file
@@ -3,9 +3,7 @@
 in vec2 tc;
 out vec4 color;
 
-uniform mat4 mv_matrix;
-uniform mat4 proj_matrix;
-uniform sampler2D samp;
+layout (binding = 0) uniform sampler2D samp;
 
 void main(void)
 {	
@@ -4,11 +4,25 @@ layout (location=0) in vec3 pos;
 layout (location=1) in vec2 texCoord;
 out vec2 tc;
 
-uniform mat4 mv_matrix;
-uniform mat4 proj_matrix;
+// leo::FrameUniforms
+layout (std140, binding = 0) uniform Frame
+{
+	mat4 view;
+	mat4 proj;
+	mat4 viewProj;
+	vec3 cameraPosition;
+	float time;
+} frame;
+
+// leo::DrawUniforms
+layout (std140, binding = 2) uniform Draw
+{
+	mat4 model;
+	mat4 modelView;
+} draw;
 
 void main(void)
 {	
-	gl_Position = proj_matrix * mv_matrix * vec4(pos,1.0);
+	gl_Position = frame.proj * draw.modelView * vec4(pos,1.0);
 	tc = texCoord;
 } 
@@ -343,15 +343,15 @@ inline void *STBIMAGE_CUSTOM_REALOC(void *p, size_t oldSize, size_t newsz)
 {
 	void* newPtr = new char[newsz];
 
-	std::memcpy(newPtr, p, oldSize);
+	if (p != nullptr) std::memcpy(newPtr, p, oldSize);
 
-	delete[] p;
+	delete[] static_cast<char*>(p);
 	return newPtr;
 };
 
 #define STBI_MALLOC(sz)           new char[(sz)]
 #define STBI_REALLOC_SIZED(p, oldsz, newsz) STBIMAGE_CUSTOM_REALOC((p), (oldsz), (newsz))
-#define STBI_FREE(p)              delete[] (p)
+#define STBI_FREE(p)              delete[] (char*)(p)
 
 
 